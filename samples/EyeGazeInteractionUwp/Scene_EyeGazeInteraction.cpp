@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include <XrSceneLib/PbrModelObject.h>
+#include <XrSceneLib/RayTargets.h>
 #include <XrSceneLib/Scene.h>
 
 using namespace DirectX;
@@ -19,15 +20,6 @@ namespace {
     constexpr float layoutRadius = 1.5f;   // In meters
     constexpr int numberOfObjects = 36;    // Number of objects for a full circle.
 
-    bool IsLookingAtObject(const XrPosef& gazeInAppSpace, const XrPosef& objectInAppSpace, float objectRadius) {
-        const XrPosef appSpaceInGaze = Pose::Invert(gazeInAppSpace);
-        const XrPosef objectInGaze = objectInAppSpace * appSpaceInGaze;
-        const float projectionOnZ = Normalize(objectInGaze.position).z;
-        const float distance = Length(objectInGaze.position);
-        const float angleTolerance = std::atan2(objectRadius, distance);
-        return projectionOnZ < -std::cos(angleTolerance);
-    }
-
     struct EyeGazeInteractionScene : public engine::Scene {
         EyeGazeInteractionScene(engine::Context& context)
             : Scene(context)
@@ -75,6 +67,7 @@ namespace {
                 object->Pose().position.x = layoutRadius * std::sin(i * angleDistance);
                 object->Pose().position.z = layoutRadius * std::cos(i * angleDistance);
                 object->Motion.SetRotation({0, 0, 1}, XM_2PI); // Rotate around per second
+                m_lookAtTargets.AddSphere(object->Pose().position, objectDiameter / 2);
                 m_lookAtObjects.emplace_back(std::move(object));
             }
         }
@@ -86,15 +79,22 @@ namespace {
             if (Pose::IsPoseValid(location)) {
                 m_gazeObject->SetVisible(true);
                 m_gazeObject->Pose() = location.pose;
-                for (auto& object : m_lookAtObjects) {
-                    XrPosef objectInAppSpace;
-                    StoreXrPose(&objectInAppSpace, object->WorldTransform());
-                    object->Motion.Enabled = IsLookingAtObject(location.pose, objectInAppSpace, objectDiameter / 2);
+
+                // Only the translation of the world transform is needed for a sphere target, so avoid decomposing the matrix.
+                for (uint32_t i = 0; i < m_lookAtObjects.size(); i++) {
+                    XrVector3f center;
+                    StoreXrVector3(&center, m_lookAtObjects[i]->WorldTransform().r[3]);
+                    m_lookAtTargets.UpdateSphere(i, center, objectDiameter / 2);
+                }
+
+                const engine::RayHit hit = m_lookAtTargets.CastRay(engine::MakeRayFromPose(location.pose));
+                for (uint32_t i = 0; i < m_lookAtObjects.size(); i++) {
+                    m_lookAtObjects[i]->Motion.SetEnabled(hit.TargetIndex == i);
                 }
             } else {
                 m_gazeObject->SetVisible(false);
                 for (auto& object : m_lookAtObjects) {
-                    object->Motion.Enabled = false;
+                    object->Motion.SetEnabled(false);
                 }
             }
         }
@@ -105,6 +105,7 @@ namespace {
         std::shared_ptr<engine::Object> m_gazeObject;
         std::shared_ptr<engine::Object> m_gazeLookAtAxis;
         std::vector<std::shared_ptr<engine::Object>> m_lookAtObjects;
+        engine::RayTargets m_lookAtTargets; // Indexed the same as m_lookAtObjects.
     };
 } // namespace
 
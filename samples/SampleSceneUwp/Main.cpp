@@ -33,6 +33,8 @@ namespace {
     std::unique_ptr<engine::XrApp> CreateUwpXrApp(XrHolographicWindowAttachmentMSFT&& holographicWindowAttachment) {
         engine::XrAppConfiguration appConfig({"SampleSceneUwp", 2});
         appConfig.HolographicWindowAttachment = std::move(holographicWindowAttachment);
+        // Lower the resolution of the views when rendering the scenes does not fit in the display period on the device.
+        appConfig.DynamicResolution = engine::DynamicResolutionOptions{};
 
         appConfig.RequestedExtensions.push_back(XR_EXT_WIN32_APPCONTAINER_COMPATIBLE_EXTENSION_NAME);
         appConfig.RequestedExtensions.push_back(XR_MSFT_UNBOUNDED_REFERENCE_SPACE_EXTENSION_NAME);
@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include <XrSceneLib/PbrModelObject.h>
+#include <XrSceneLib/HandMeshObject.h>
 #include <XrSceneLib/Scene.h>
 
 using namespace DirectX;
@@ -97,17 +98,12 @@ namespace {
                 m_mode = HandDisplayMode::Mesh;
                 m_meshMaterial = Pbr::Material::CreateFlat(m_context.PbrResources, Pbr::RGBA::White, 1, 0);
 
-                // For each hand, initialize hand mesh buffer and corresponding space.
+                // For each hand, initialize hand mesh object and corresponding space.
                 for (const auto& [hand, handData] : hands) {
-                    // Initialize buffers to receive hand mesh indices and vertices
-                    const XrSystemHandTrackingMeshPropertiesMSFT& handMeshSystemProperties = context.System.HandMeshProperties;
-                    handData.IndexBuffer = std::make_unique<uint32_t[]>(handMeshSystemProperties.maxHandMeshIndexCount);
-                    handData.VertexBuffer = std::make_unique<XrHandMeshVertexMSFT[]>(handMeshSystemProperties.maxHandMeshVertexCount);
-
-                    handData.meshState.indexBuffer.indexCapacityInput = handMeshSystemProperties.maxHandMeshIndexCount;
-                    handData.meshState.indexBuffer.indices = handData.IndexBuffer.get();
-                    handData.meshState.vertexBuffer.vertexCapacityInput = handMeshSystemProperties.maxHandMeshVertexCount;
-                    handData.meshState.vertexBuffer.vertices = handData.VertexBuffer.get();
+                    // The hand mesh object preallocates its buffers for the largest hand mesh the system supports.
+                    handData.MeshObject = AddObject(std::make_shared<engine::HandMeshObject>(
+                        m_context.PbrResources, context.System.HandMeshProperties, m_meshMaterial));
+                    handData.MeshObject->SetVisible(false);
 
                     XrHandMeshSpaceCreateInfoMSFT meshSpaceCreateInfo{XR_TYPE_HAND_MESH_SPACE_CREATE_INFO_MSFT};
                     meshSpaceCreateInfo.poseInHandMeshSpace = xr::math::Pose::Identity();
@@ -179,7 +175,7 @@ namespace {
                 }
 
                 handData.JointModel->SetVisible(jointsVisible);
-                if (handData.MeshObject != nullptr) { // Pbr mesh object creation is deferred.
+                if (handData.MeshObject != nullptr) { // Hand mesh objects are only created if hand mesh is enabled.
                     handData.MeshObject->SetVisible(meshVisible);
                 }
             }
@@ -199,13 +195,7 @@ namespace {
             // Data to display hand mesh tracking
             xr::SpaceHandle MeshSpace;
             xr::SpaceHandle ReferenceMeshSpace;
-            std::vector<XMFLOAT4> VertexColors;
-            std::shared_ptr<engine::PbrModelObject> MeshObject;
-
-            // Data to process open-palm reference hand.
-            XrHandMeshMSFT meshState{XR_TYPE_HAND_MESH_MSFT};
-            std::unique_ptr<uint32_t[]> IndexBuffer{};
-            std::unique_ptr<XrHandMeshVertexMSFT[]> VertexBuffer{};
+            std::shared_ptr<engine::HandMeshObject> MeshObject;
 
             HandData() = default;
             HandData(HandData&&) = delete;
@@ -230,52 +220,22 @@ namespace {
         }
 
         bool UpdateMesh(HandData& handData, XrSpace referenceSpace, XrTime time) {
-            XrHandMeshUpdateInfoMSFT meshUpdateInfo{XR_TYPE_HAND_MESH_UPDATE_INFO_MSFT};
-            meshUpdateInfo.time = time;
-            meshUpdateInfo.handPoseType = XR_HAND_POSE_TYPE_TRACKED_MSFT;
-            CHECK_XRCMD(xrUpdateHandMeshMSFT(handData.TrackerHandle.Get(), &meshUpdateInfo, &handData.meshState));
-
-            if (!handData.meshState.isActive) {
+            if (!handData.MeshObject->UpdateHandMesh(handData.TrackerHandle.Get(), time)) {
                 return false;
             }
 
-            bool indicesChanged = handData.meshState.indexBufferChanged;
-            bool verticesChanged = handData.meshState.vertexBufferChanged;
-
-            if (indicesChanged) {
+            if (handData.MeshObject->GetHandMesh().indexBufferChanged) {
                 // Index buffer is changed, recalculate vertices color based on neutral hand pose.
                 ComputeHandMeshColor(handData, time);
             }
 
-            if (verticesChanged) {
-                Pbr::PrimitiveBuilder meshBuilder = CreateHandMeshPrimitiveBuilder(handData.meshState.indexBuffer.indices,
-                                                                                   handData.meshState.indexBuffer.indexCountOutput,
-                                                                                   handData.meshState.vertexBuffer.vertices,
-                                                                                   handData.meshState.vertexBuffer.vertexCountOutput,
-                                                                                   handData.VertexColors);
-
-                if (!handData.MeshObject) {
-                    // The hand mesh scene object doesn't exist yet and must be created.
-                    Pbr::Primitive surfacePrimitive(m_context.PbrResources, meshBuilder, m_meshMaterial, false /* updatableBuffers */);
-
-                    auto surfaceModel = std::make_shared<Pbr::Model>();
-                    surfaceModel->AddPrimitive(std::move(surfacePrimitive));
-
-                    handData.MeshObject = AddObject(std::make_shared<engine::PbrModelObject>(surfaceModel));
-                } else {
-                    // Update vertices and indices of the existing hand mesh scene object's primitive.
-                    handData.MeshObject->GetModel()->GetPrimitive(0).UpdateBuffers(
-                        m_context.Device.get(), m_context.DeviceContext.get(), meshBuilder);
-                }
-            }
+            handData.MeshObject->UploadChanges(m_context);
 
-            if (handData.MeshObject) {
-                XrSpaceLocation meshLocation{XR_TYPE_SPACE_LOCATION};
-                CHECK_XRCMD(xrLocateSpace(handData.MeshSpace.Get(), referenceSpace, time, &meshLocation));
-                if (xr::math::Pose::IsPoseValid(meshLocation)) {
-                    handData.MeshObject->Pose() = meshLocation.pose;
-                    return true;
-                }
+            XrSpaceLocation meshLocation{XR_TYPE_SPACE_LOCATION};
+            CHECK_XRCMD(xrLocateSpace(handData.MeshSpace.Get(), referenceSpace, time, &meshLocation));
+            if (xr::math::Pose::IsPoseValid(meshLocation)) {
+                handData.MeshObject->Pose() = meshLocation.pose;
+                return true;
             }
 
             return false;
@@ -305,8 +265,8 @@ namespace {
             const XrVector3f& hZero = handData.JointLocations[XR_HAND_JOINT_LITTLE_TIP_EXT].pose.position;
             const XrVector3f& hOne = handData.JointLocations[XR_HAND_JOINT_THUMB_TIP_EXT].pose.position;
 
-            const XrHandMeshVertexBufferMSFT& vertexBuffer = handData.meshState.vertexBuffer;
-            handData.VertexColors.resize(vertexBuffer.vertexCountOutput);
+            const XrHandMeshVertexBufferMSFT& vertexBuffer = handData.MeshObject->GetHandMesh().vertexBuffer;
+            XMFLOAT4* vertexColors = handData.MeshObject->GetVertexColors();
 
             // Calculate the normalized length of a vertex to a line segment defined by two point [zero, one].
             auto weight = [](const XrVector3f& v, const XrVector3f& zero, const XrVector3f& one) -> float {
@@ -323,38 +283,8 @@ namespace {
                 const float v = weight(vertexPosition, vZero, vOne);
                 const float h = weight(vertexPosition, hZero, hOne);
                 // Pick a simple psuedo color map to visualize figers in colors.
-                handData.VertexColors[i] = {v, (1 - h), h, 1};
-            }
-        }
-
-        Pbr::PrimitiveBuilder CreateHandMeshPrimitiveBuilder(uint32_t* indices,
-                                                             uint32_t indexCount,
-                                                             XrHandMeshVertexMSFT* vertices,
-                                                             uint32_t vertexCount,
-                                                             const std::vector<XMFLOAT4>& vertexColors) {
-            Pbr::PrimitiveBuilder builder;
-            builder.Vertices.resize(vertexCount);
-
-            builder.Indices = std::vector<uint32_t>(indices, indices + indexCount);
-
-            for (uint32_t i = 0; i < vertexCount; i++, vertices++) {
-                Pbr::Vertex& vertex = builder.Vertices[i];
-
-                vertex.Position = xr::math::cast(vertices->position);
-                vertex.Normal = xr::math::cast(vertices->normal);
-                vertex.Color0 = vertexColors[i];
-
-                bool xDominant = std::abs(vertex.Normal.x) > std::abs(vertex.Normal.y);
-                XMVECTOR basis = xDominant ? g_XMIdentityR1 : g_XMIdentityR0;
-                XMVECTOR normal = XMLoadFloat3(&vertex.Normal);
-                XMVECTOR tangent = XMVector3Cross(normal, basis);
-                XMStoreFloat4(&vertex.Tangent, tangent);
-
-                XMStoreFloat2(&vertex.TexCoord0, g_XMZero);
-                vertex.ModelTransformIndex = Pbr::RootNodeIndex; // Index into the node transforms
+                vertexColors[i] = {v, (1 - h), h, 1};
             }
-
-            return builder;
         }
 
         // Detects two spaces collide to each other
@@ -90,7 +90,7 @@ namespace {
                         axis->SetParent(controllerData.pinchRoot);
 
                         // Load Key object to vizualise pinch pose and plane
-                        auto glbData = sample::ReadFileBytes(sample::FindFileInAppFolder(L"Key.glb"));
+                        const auto glbData = sample::MapFileBytes(sample::FindFileInAppFolder(L"Key.glb"));
                         controllerData.pinchPlaneObject =
                             std::make_shared<engine::PbrModelObject>(Gltf::FromGltfBinary(m_context.PbrResources, glbData));
                         controllerData.pinchPlane = AddObject(controllerData.pinchPlaneObject);
@@ -600,7 +600,7 @@ namespace {
                         scene.AddObject(component.valueObject);
                     }
                 }
-                sample::Trace(fmt::to_string(buffer));
+                sample::Trace("{}", fmt::to_string(buffer));
 
                 // Draw text object for the new interaction profile and components
                 controllerData.text = fmt::to_string(buffer);
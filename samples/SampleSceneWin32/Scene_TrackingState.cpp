@@ -5,7 +5,7 @@
 #include <XrUtility/XrToString.h>
 #include <XrUtility/XrSide.h>
 #include <XrSceneLib/PbrModelObject.h>
-#include <XrSceneLib/TextTexture.h>
+#include <XrSceneLib/TextObject.h>
 #include <XrSceneLib/Scene.h>
 
 using namespace xr::math;
@@ -22,7 +22,8 @@ namespace {
     //
     struct TrackingStateScene : public engine::Scene {
         TrackingStateScene(engine::Context& context)
-            : Scene(context) {
+            : Scene(context)
+            , m_textAtlas(std::make_shared<engine::TextAtlas>(context, L"Segoe UI", 16.0f /* DIPs */)) {
             sample::ActionSet& actionSet = ActionContext().CreateActionSet("tracking_state_action_set", "Tracking state action set");
             const std::vector<std::string> subactionPathBothHands = {"/user/hand/right", "/user/hand/left"};
             m_gripSpaceAction = actionSet.CreateAction("grip_pose", "Grip Pose", XR_ACTION_TYPE_POSE_INPUT, subactionPathBothHands);
@@ -146,36 +147,25 @@ namespace {
 
     private:
         struct TextBlock {
-            std::string Text;
-            std::unique_ptr<engine::TextTexture> TextTexture;
-            std::shared_ptr<engine::PbrModelObject> Object;
+            std::shared_ptr<engine::TextObject> Object;
         };
 
         void AddTextBlock(TextBlock& textBlock, const XrPosef& center, const XrExtent2Df& size, const XrExtent2Di& pixelSize) {
             uint32_t pixelWidth = pixelSize.width;
             uint32_t pixelHeight = (uint32_t)std::floor(size.height * pixelWidth / size.width); // Keep texture aspect ratio
 
-            textBlock.TextTexture = std::make_unique<engine::TextTexture>(m_context, GetTextInfo(pixelWidth, pixelHeight));
-            textBlock.TextTexture->Draw(textBlock.Text);
-
-            const auto material = textBlock.TextTexture->CreatePbrMaterial(m_context.PbrResources);
-            textBlock.Object = AddObject(engine::CreateQuad(m_context.PbrResources, {size.width, size.height}, material));
+            textBlock.Object = AddObject(std::make_shared<engine::TextObject>(
+                m_context, m_textAtlas, GetTextInfo(pixelWidth, pixelHeight), DirectX::XMFLOAT2{size.width, size.height}));
             textBlock.Object->Pose() = center;
         }
 
         void UpdateTextBlock(TextBlock& textBlock, const char* text) {
-            if (strcmp(textBlock.Text.c_str(), text) != 0) {
-                textBlock.Text = text;
-                textBlock.TextTexture->Draw(textBlock.Text);
-                const auto material = textBlock.TextTexture->CreatePbrMaterial(m_context.PbrResources);
-                textBlock.Object->GetModel()->GetPrimitive(0).SetMaterial(material);
-            }
+            textBlock.Object->SetText(text);
         }
 
         static engine::TextTextureInfo GetTextInfo(uint32_t pixelWidth, uint32_t pixelHeight) {
             engine::TextTextureInfo textInfo(pixelWidth, pixelHeight); // pixels
             textInfo.Margin = 5;                                       // pixels
-            textInfo.FontSize = 16.0f;                                 // DPI
             textInfo.Foreground = Pbr::RGBA::White;
             textInfo.Background = Pbr::FromSRGB(DirectX::Colors::DarkSlateBlue);
             textInfo.TextAlignment = DWRITE_TEXT_ALIGNMENT_LEADING;
@@ -184,6 +174,7 @@ namespace {
         }
 
     private:
+        std::shared_ptr<engine::TextAtlas> m_textAtlas;
         xr::SpaceHandle m_viewSpace;
         xr::SpaceHandle m_gripSpace[xr::Side::Count];
         XrAction m_gripSpaceAction{};
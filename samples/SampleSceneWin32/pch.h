@@ -26,6 +26,7 @@
 #include <d3d11_2.h>
 #include <DirectXColors.h>
 
+#define XR_NO_PROTOTYPES
 #define XR_USE_PLATFORM_WIN32
 #define XR_USE_GRAPHICS_API_D3D11
 #include <openxr/openxr.h>
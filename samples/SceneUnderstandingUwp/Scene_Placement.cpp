@@ -6,9 +6,13 @@
 #include <winrt/Windows.Security.Cryptography.h>
 #include <XrUtility/XrString.h>
 #include <XrUtility/XrSceneUnderstanding.hpp>
+#include <XrUtility/XrSceneComputeScheduler.hpp>
+#include <XrUtility/XrSceneFragmentStore.hpp>
 #include <pbr/GltfLoader.h>
+#include <pbr/PbrMeshSimplifier.h>
 #include <SampleShared/FileUtility.h>
 #include <SampleShared/TextureUtility.h>
+#include <XrSceneLib/LodModelObject.h>
 #include <XrSceneLib/PbrModelObject.h>
 #include <XrSceneLib/Scene.h>
 #include <XrSceneLib/SpaceObject.h>
@@ -21,12 +25,16 @@
 //
 
 using namespace std::chrono_literals;
-using TimePoint = engine::FrameTime::clock::time_point;
 
 namespace {
     using namespace DirectX;
-    constexpr auto UpdateInterval = 5s; // Time to wait between SU requests
-    constexpr float ScanRadius = 4.8f;  // meters
+    constexpr float ScanRadius = 4.8f; // meters
+    constexpr float PointedRegionDistance = 2.0f; // meters
+    constexpr float PointedRegionRadius = 1.5f;   // meters
+    constexpr uint32_t MeshLodLevelCount = 4;
+    constexpr float MeshLodMaxError = 0.05f; // meters
+    constexpr size_t MeshLodMinTriangleCount = 64;
+    constexpr const wchar_t* SceneFragmentStoreFileName = L"placement_scene_fragments.bin";
     constexpr size_t TextureSideLength = 32;
     constexpr float CubeSideLength = 0.1f;
     constexpr int LeftHand = 0;
@@ -211,8 +219,13 @@ namespace {
         explicit PlacementScene(engine::Context& context)
             : Scene(context)
             , m_planeMaterial(CreateTextureMaterial(context.PbrResources))
-            , m_nextUpdate{engine::FrameTime::clock::now() + UpdateInterval}
+            , m_computeScheduler{CreateComputeSchedulerOptions()}
             , m_handRays{context, ActionContext(), *this} {
+            if (context.Extensions.SupportsSceneUnderstandingSerialization) {
+                const std::filesystem::path localFolder{winrt::Windows::Storage::ApplicationData::Current().LocalFolder().Path().c_str()};
+                m_fragmentStorePath = localFolder / SceneFragmentStoreFileName;
+            }
+
             XrReferenceSpaceCreateInfo spaceCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
             spaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
             spaceCreateInfo.poseInReferenceSpace = xr::math::Pose::Identity();
@@ -225,7 +238,7 @@ namespace {
                 object->SetVisible(false);
                 AddObject(object);
             }
-            m_sceneBounds.sphereBounds.push_back({{}, ScanRadius});
+            m_sceneBounds.sphereBounds.push_back({});
         }
 
         ~PlacementScene() override {
@@ -247,7 +260,11 @@ namespace {
                 m_sceneVisuals = m_future.get();
                 m_sceneVisuals.ForEachEngineObject([this](const std::shared_ptr<engine::Object>& object) { AddObject(object); });
                 m_scanState = ScanState::Idle;
-                m_nextUpdate = frameTime.Now + UpdateInterval;
+                if (m_restoringScene) {
+                    m_restoringScene = false;
+                } else {
+                    m_computeScheduler.OnComputeCompleted(frameTime.PredictedDisplayTime, true);
+                }
             }
 
             // Update the location of all scene objects
@@ -257,6 +274,7 @@ namespace {
                                       frameTime.PredictedDisplayTime,
                                       m_sceneVisuals.componentIds,
                                       m_componentLocations);
+                m_collisionPlanes.clear();
                 for (size_t i = 0; i < m_sceneVisuals.componentIds.size(); ++i) {
                     const XrSceneComponentLocationMSFT& location = m_componentLocations[i];
                     const std::shared_ptr<engine::Object>& object = m_sceneVisuals.visuals[i];
@@ -267,16 +285,14 @@ namespace {
                     }
                     if (xr::math::Pose::IsPoseValid(location.flags)) {
                         object->Pose() = location.pose;
+                        m_collisionPlanes.push_back({location.pose, scenePlane.size});
                     } else {
                         object->SetVisible(false);
                     }
                 }
-            }
 
-            XrSpaceLocation viewInLocal{XR_TYPE_SPACE_LOCATION};
-            CHECK_XRCMD(xrLocateSpace(m_viewSpace.Get(), m_context.AppSpace, frameTime.PredictedDisplayTime, &viewInLocal));
-            if (xr::math::Pose::IsPoseValid(viewInLocal)) {
-                m_sceneBounds.sphereBounds[0].center = viewInLocal.pose.position;
+                // Moving objects in this scene bounce off the located planes.
+                MotionSystem().SetCollisionPlanes(m_collisionPlanes.data(), m_collisionPlanes.size());
             }
 
             UpdatePlacedObjects(frameTime.PredictedDisplayTime);
@@ -286,28 +302,45 @@ namespace {
                 // Check if the results are available
                 const XrSceneComputeStateMSFT state = m_sceneObserver->GetSceneComputeState();
                 if (state == XR_SCENE_COMPUTE_STATE_COMPLETED_MSFT) {
-                    // Send the scene compute result to the background thread for processing
+                    // Send the scene compute result to the background thread for processing. A computed scene also updates the
+                    // stored fragments there, a restored scene came from the store and is not written back.
+                    xr::su::SceneFragmentStore* const store = m_fragmentStore && !m_restoringScene ? &*m_fragmentStore : nullptr;
                     m_future = std::async(std::launch::async,
-                                          &CreateSceneVisuals,
-                                          std::cref(m_context.PbrResources),
-                                          m_planeMaterial,
-                                          m_sceneObserver->CreateScene());
+                                          [this, store, scene = m_sceneObserver->CreateScene()]() mutable {
+                                              if (store) {
+                                                  SaveSceneFragments(*store, scene->Handle(), m_fragmentStorePath);
+                                              }
+                                              return CreateSceneVisuals(m_context.PbrResources, m_planeMaterial, std::move(scene));
+                                          });
                     m_scanState = ScanState::Processing;
                 } else if (state == XR_SCENE_COMPUTE_STATE_COMPLETED_WITH_ERROR_MSFT) {
-                    sample::Trace("Compute completed with error");
                     m_scanState = ScanState::Idle;
+                    if (m_restoringScene) {
+                        sample::Trace("Restoring the stored scene completed with error");
+                        DiscardFragmentStore();
+                        m_restoringScene = false;
+                    } else {
+                        sample::Trace("Compute completed with error");
+                        m_computeScheduler.OnComputeCompleted(frameTime.PredictedDisplayTime, false);
+                    }
                 }
-            } else if (m_scanState == ScanState::Idle) {
-                // no active query, start one if enough time has passed
-                if (frameTime.Now > m_nextUpdate) {
-                    // Start the async query
+            }
+
+            // The scheduler decides from the head motion when a new scene is worth computing, and only while no query is active.
+            XrSpaceLocation viewInLocal{XR_TYPE_SPACE_LOCATION};
+            CHECK_XRCMD(xrLocateSpace(m_viewSpace.Get(), m_context.AppSpace, frameTime.PredictedDisplayTime, &viewInLocal));
+            if (!m_restoringScene && xr::math::Pose::IsPoseValid(viewInLocal)) {
+                if (const auto request = m_computeScheduler.Update(frameTime.PredictedDisplayTime, viewInLocal.pose)) {
+                    // Start the async query. The level of detail only applies to visual meshes, which this sample does not request.
                     m_sceneBounds.space = m_context.AppSpace;
                     m_sceneBounds.time = m_lastTimeOfUpdate;
+                    m_sceneBounds.sphereBounds[0] = {request->Center, request->Radius};
                     static const std::vector<XrSceneComputeFeatureMSFT> Features{XR_SCENE_COMPUTE_FEATURE_PLANE_MSFT,
                                                                                  XR_SCENE_COMPUTE_FEATURE_PLANE_MESH_MSFT};
-                    m_sceneObserver->ComputeNewScene(Features, m_sceneBounds);
-
-                    m_nextUpdate = frameTime.Now + UpdateInterval;
+                    static const std::vector<XrSceneComputeFeatureMSFT> SerializedFeatures{XR_SCENE_COMPUTE_FEATURE_PLANE_MSFT,
+                                                                                           XR_SCENE_COMPUTE_FEATURE_PLANE_MESH_MSFT,
+                                                                                           XR_SCENE_COMPUTE_FEATURE_SERIALIZE_SCENE_MSFT};
+                    m_sceneObserver->ComputeNewScene(m_fragmentStore ? SerializedFeatures : Features, m_sceneBounds);
                     m_scanState = ScanState::Waiting;
                 }
             }
@@ -401,6 +434,14 @@ namespace {
                     m_visiblePlanes.insert(plane.id);
                     m_placedObjects.emplace_back(std::move(placedObject));
                 }
+            } else if (raycastAction == RaycastAction::Activate) {
+                // The user tapped where no plane was found yet. Compute the region they pointed at, so they can place a cube there.
+                const XMVECTOR rayDirection = XMVector3Rotate(XMVectorSet(0, 0, -1, 0), xr::math::LoadXrQuaternion(handPose.orientation));
+                const XMVECTOR rayPosition = xr::math::LoadXrVector3(handPose.position);
+                XrVector3f pointedCenter;
+                xr::math::StoreXrVector3(&pointedCenter,
+                                         XMVectorMultiplyAdd(rayDirection, XMVectorReplicate(PointedRegionDistance), rayPosition));
+                m_computeScheduler.RequestRegion(pointedCenter, PointedRegionRadius);
             }
         }
 
@@ -415,9 +456,35 @@ namespace {
     private:
         enum class ScanState { Idle, Waiting, Processing };
 
+        static xr::su::SceneComputeSchedulerOptions CreateComputeSchedulerOptions() {
+            xr::su::SceneComputeSchedulerOptions options;
+            options.MaxRadius = ScanRadius;
+            return options;
+        }
+
         void Enable() {
             m_sceneObserver = std::make_unique<xr::su::SceneObserver>(m_context.Session.Handle);
             m_scanState = ScanState::Idle;
+            m_restoringScene = false;
+            m_computeScheduler.Reset();
+
+            // Show the scene stored by a previous run while the first compute is running. The restored scene is retrieved like a
+            // computed one, the scheduler starts computing once it is shown.
+            if (!m_fragmentStorePath.empty()) {
+                if (!m_fragmentStore) {
+                    m_fragmentStore = xr::su::LoadSceneFragmentStore(m_fragmentStorePath);
+                }
+                if (!m_fragmentStore->empty()) {
+                    const XrResult result = xr::su::DeserializeScene(m_sceneObserver->Handle(), *m_fragmentStore);
+                    if (XR_SUCCEEDED(result)) {
+                        m_scanState = ScanState::Waiting;
+                        m_restoringScene = true;
+                    } else {
+                        sample::Trace("The runtime rejected the stored scene: {}", xr::ToCString(result));
+                        DiscardFragmentStore();
+                    }
+                }
+            }
 
             const auto createPointerRay = [this](const std::shared_ptr<engine::PbrModelObject>& parent, const Pbr::RGBAColor& color) {
                 auto aimRay = AddObject(engine::CreateCube(m_context.PbrResources, {1.0f, 1.0f, 1.0f}, color));
@@ -443,6 +510,24 @@ namespace {
             m_sceneObserver = nullptr;
         }
 
+        // Forget the stored scene and delete its file, so it is not restored again. The next computed scene starts a new store.
+        void DiscardFragmentStore() {
+            m_fragmentStore.emplace();
+            if (!xr::su::DeleteSceneFragmentStore(m_fragmentStorePath)) {
+                sample::Trace("Failed to delete {}", m_fragmentStorePath.string());
+            }
+        }
+
+        // Runs on the worker thread. Enable is the only other user of the store, and it never runs while a worker is running.
+        static void SaveSceneFragments(xr::su::SceneFragmentStore& store, XrSceneMSFT scene, const std::filesystem::path& path) {
+            const size_t readCount = xr::su::UpdateSceneFragmentStore(store, scene);
+            if (!xr::su::SaveSceneFragmentStore(store, path)) {
+                sample::Trace("Failed to save the scene fragments to {}", path.string());
+            } else if (readCount > 0) {
+                sample::Trace("Saved {} changed scene fragments of {}", readCount, store.size());
+            }
+        }
+
         std::shared_ptr<engine::PbrModelObject> CreatePlacementCube() {
             return engine::CreateCube(
                 m_context.PbrResources, {CubeSideLength, CubeSideLength, CubeSideLength}, Pbr::FromSRGB(Colors::Yellow));
@@ -484,8 +569,12 @@ namespace {
         XrTime m_lastTimeOfUpdate{};
         xr::SceneBounds m_sceneBounds;
         std::vector<XrSceneComponentLocationMSFT> m_componentLocations;
-        TimePoint m_nextUpdate{};
+        std::vector<engine::CollisionPlane> m_collisionPlanes;
+        xr::su::SceneComputeScheduler m_computeScheduler;
         ScanState m_scanState{ScanState::Idle};
+        bool m_restoringScene{false}; // The scene being retrieved was deserialized from the store instead of computed.
+        std::filesystem::path m_fragmentStorePath; // Empty when scene serialization is not supported.
+        std::optional<xr::su::SceneFragmentStore> m_fragmentStore;
         HandRays m_handRays;
     };
 
@@ -544,10 +633,9 @@ namespace {
         }
     }
 
-    void FillMeshPrimitiveBuilder(const std::vector<XrVector3f>& positions,
-                                  const std::vector<uint32_t>& indices,
-                                  const Pbr::RGBAColor& color,
-                                  Pbr::PrimitiveBuilder& builder) {
+    // Fill the builder from a mesh whose vertices are shared between triangles, only the positions of its vertices are used.
+    void FillMeshPrimitiveBuilder(const Pbr::PrimitiveBuilder& mesh, const Pbr::RGBAColor& color, Pbr::PrimitiveBuilder& builder) {
+        const std::vector<uint32_t>& indices = mesh.Indices;
         const size_t indexCount = indices.size();
         builder.Vertices.clear();
         builder.Indices.clear();
@@ -563,9 +651,9 @@ namespace {
         // Create 3 vertices per triangle where the normal is perpendicular to the surface
         // in order to make the triangle edges sharper.
         for (size_t index = 2; index < indices.size(); index += 3) {
-            auto v0 = xr::math::LoadXrVector3(positions[indices[index - 2]]);
-            auto v1 = xr::math::LoadXrVector3(positions[indices[index - 1]]);
-            auto v2 = xr::math::LoadXrVector3(positions[indices[index]]);
+            auto v0 = XMLoadFloat3(&mesh.Vertices[indices[index - 2]].Position);
+            auto v1 = XMLoadFloat3(&mesh.Vertices[indices[index - 1]].Position);
+            auto v2 = XMLoadFloat3(&mesh.Vertices[indices[index]].Position);
 
             Pbr::Vertex vertex{};
             vertex.Color0 = color;
@@ -578,7 +666,7 @@ namespace {
         }
     }
 
-    std::shared_ptr<engine::PbrModelObject> CreateMeshVisual(const Pbr::Resources& pbrResources,
+    std::shared_ptr<engine::LodModelObject> CreateMeshVisual(const Pbr::Resources& pbrResources,
                                                              const std::shared_ptr<Pbr::Material>& material,
                                                              XrSceneMSFT scene,
                                                              uint64_t meshBufferId,
@@ -590,10 +678,31 @@ namespace {
         if (indexBuffer.empty() || vertexBuffer.empty()) {
             return nullptr;
         }
-        FillMeshPrimitiveBuilder(vertexBuffer, indexBuffer, color, builder);
-        auto model = std::make_shared<Pbr::Model>();
-        model->AddPrimitive(Pbr::Primitive(pbrResources, builder, material));
-        return std::make_shared<engine::PbrModelObject>(std::move(model));
+
+        BoundingSphere bounds;
+        BoundingSphere::CreateFromPoints(bounds, vertexBuffer.size(), &xr::math::cast(vertexBuffer[0]), sizeof(XrVector3f));
+
+        // Scene meshes share vertices between triangles, so each level is simplified before its triangles get their own vertices.
+        Pbr::PrimitiveBuilder mesh;
+        mesh.Vertices.resize(vertexBuffer.size());
+        for (size_t i = 0; i < vertexBuffer.size(); i++) {
+            mesh.Vertices[i].Position = xr::math::cast(vertexBuffer[i]);
+        }
+        mesh.Indices = std::move(indexBuffer);
+
+        Pbr::LodChainOptions options;
+        options.MaxLevelCount = MeshLodLevelCount;
+        options.MinTriangleCount = MeshLodMinTriangleCount;
+        options.MaxError = MeshLodMaxError;
+
+        std::vector<engine::LodModelObject::Level> levels;
+        for (const Pbr::LodLevel& level : Pbr::BuildLodChain(mesh, options)) {
+            FillMeshPrimitiveBuilder(level.Builder, color, builder);
+            auto model = std::make_shared<Pbr::Model>();
+            model->AddPrimitive(Pbr::Primitive(pbrResources, builder, material));
+            levels.push_back({std::move(model), level.Error});
+        }
+        return std::make_shared<engine::LodModelObject>(std::move(levels), bounds.Center, bounds.Radius);
     }
 
     std::shared_ptr<engine::PbrModelObject> CreatePlaneVisual(const Pbr::Resources& pbrResources,
@@ -9,6 +9,7 @@
 #include <SampleShared/FileUtility.h>
 #include <SampleShared/TextureUtility.h>
 #include <XrSceneLib/PbrModelObject.h>
+#include <XrSceneLib/PoseFilter.h>
 #include <XrSceneLib/Scene.h>
 #include <XrSceneLib/SpaceObject.h>
 #include <XrSceneLib/TextTexture.h>
@@ -177,13 +178,14 @@ namespace {
 
                 for (size_t i = 0; i < m_markerIds.size(); ++i) {
                     const XrSceneComponentLocationMSFT& location = m_componentLocations[i];
-                    auto& visualInfo = m_markerVisuals[m_markerIds[i]];
-                    const std::shared_ptr<engine::Object>& object = visualInfo.second;
-                    const auto centerToPose = visualInfo.first;
+                    MarkerVisual& visual = m_markerVisuals[m_markerIds[i]];
                     if (xr::math::Pose::IsPoseValid(location.flags)) {
-                        object->Pose() = xr::math::Pose::Multiply(centerToPose, location.pose);
+                        // Markers are static, so only move the visual when the marker moved more than the tracking noise.
+                        if (visual.DeadBand.Update(xr::math::Pose::Multiply(visual.CenterToPose, location.pose))) {
+                            visual.Object->Pose() = visual.DeadBand.Pose();
+                        }
                     } else {
-                        object->SetVisible(false);
+                        visual.Object->SetVisible(false);
                     }
                 }
             }
@@ -329,7 +331,7 @@ namespace {
 
         void Disable() {
             for (auto& [id, visual] : m_markerVisuals) {
-                RemoveObject(visual.second);
+                RemoveObject(visual.Object);
             }
             m_markerVisuals.clear();
             m_markerIds.clear();
@@ -391,13 +393,21 @@ namespace {
                     XrQuaternionf rotation = xr::math::Quaternion::RotationAxisAngle(XrVector3f{1.0f, 0.0f, 0.0f}, XM_PI);
                     XrVector3f centerOffset{markers[i].center.x, markers[i].center.y, 0.0f};
                     auto centerToPose = xr::math::Pose::MakePose(rotation, centerOffset);
-                    markerVisuals[markerId] = std::make_pair(centerToPose, visual);
+                    MarkerVisual& markerVisual = markerVisuals[markerId];
+                    markerVisual.CenterToPose = centerToPose;
+                    markerVisual.Object = visual;
+                    if (auto existing = m_markerVisuals.find(markerId); existing != m_markerVisuals.end()) {
+                        // Keep the dead band state of the marker, so the new visual stays where the old one was until the
+                        // marker moves past the threshold, instead of snapping to the latest noisy pose.
+                        markerVisual.DeadBand = existing->second.DeadBand;
+                        visual->Pose() = existing->second.Object->Pose();
+                    }
                     AddObject(visual);
                 }
             }
             // Now, remove obsolete visuals
             for (auto& [id, visual] : m_markerVisuals) {
-                RemoveObject(visual.second);
+                RemoveObject(visual.Object);
             }
             m_markerVisuals = std::move(markerVisuals);
 
@@ -442,7 +452,12 @@ namespace {
         xr::UniqueXrHandle<XrSceneMSFT> m_scene;
         std::vector<XrUuidMSFT> m_markerIds;
         std::vector<XrSceneComponentLocationMSFT> m_componentLocations;
-        std::unordered_map<XrUuidMSFT, std::pair<XrPosef, std::shared_ptr<engine::Object>>> m_markerVisuals;
+        struct MarkerVisual {
+            XrPosef CenterToPose;
+            std::shared_ptr<engine::Object> Object;
+            engine::PoseDeadBand DeadBand;
+        };
+        xr::UuidFlatMap<XrUuidMSFT, MarkerVisual> m_markerVisuals;
         XrTime m_lastTimeOfUpdate{};
         XrNewSceneComputeInfoMSFT m_sceneComputeInfo{XR_TYPE_NEW_SCENE_COMPUTE_INFO_MSFT};
         XrSceneSphereBoundMSFT m_sphereBounds{0.0f};
@@ -7,6 +7,7 @@
 #include <pbr/GltfLoader.h>
 #include <pbr/PbrModel.h>
 #include <fstream>
+#include <utility>
 #include <XrUtility/XrString.h>
 #include "Trace.h"
 
@@ -34,6 +35,67 @@ namespace sample {
         }
     }
 
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        winrt::file_handle file{::CreateFile2(path.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr)};
+        if (!file) {
+            throw std::runtime_error(fmt::format("Failed to open file: {}", path.string()));
+        }
+
+        FILE_STANDARD_INFO fileInfo{};
+        if (!::GetFileInformationByHandleEx(file.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo))) {
+            throw std::runtime_error(fmt::format("Failed to read file: {}", path.string()));
+        }
+
+        // An empty file cannot be mapped, leave the view empty instead.
+        if (fileInfo.EndOfFile.QuadPart == 0) {
+            return;
+        }
+
+        m_mapping.attach(::CreateFileMappingFromApp(file.get(), nullptr, PAGE_READONLY, 0, nullptr));
+        if (!m_mapping) {
+            throw std::runtime_error(fmt::format("Failed to map file: {}", path.string()));
+        }
+
+        m_data = static_cast<const uint8_t*>(::MapViewOfFileFromApp(m_mapping.get(), FILE_MAP_READ, 0, 0));
+        if (m_data == nullptr) {
+            throw std::runtime_error(fmt::format("Failed to map file: {}", path.string()));
+        }
+        m_size = static_cast<size_t>(fileInfo.EndOfFile.QuadPart);
+    }
+
+    MappedFile::~MappedFile() {
+        Unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+        , m_mapping(std::move(other.m_mapping)) {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_mapping = std::move(other.m_mapping);
+        }
+        return *this;
+    }
+
+    void MappedFile::Unmap() {
+        if (m_data != nullptr) {
+            ::UnmapViewOfFile(m_data);
+            m_data = nullptr;
+            m_size = 0;
+        }
+        m_mapping.close();
+    }
+
+    MappedFile MapFileBytes(const std::filesystem::path& path) {
+        return MappedFile(path);
+    }
+
     std::filesystem::path GetAppFolder() {
         HMODULE thisModule;
 #ifdef UWP
@@ -64,17 +126,16 @@ namespace sample {
             }
         }
 
-        sample::Trace(fmt::format("File \"{}\" is not found in app folder \"{}\" and search folders{}",
-                                  xr::wide_to_utf8(filename.c_str()),
-                                  xr::wide_to_utf8(appFolder.c_str()),
-                                  [&searchFolders]() -> std::string {
-                                      fmt::memory_buffer buffer;
-                                      for (auto& folder : searchFolders) {
-                                          fmt::format_to(fmt::appender(buffer), " \"{}\"", xr::wide_to_utf8(folder.c_str()));
-                                      }
-                                      return fmt::to_string(buffer);
-                                  }())
-                          .c_str());
+        sample::Trace("File \"{}\" is not found in app folder \"{}\" and search folders{}",
+                      xr::wide_to_utf8(filename.c_str()),
+                      xr::wide_to_utf8(appFolder.c_str()),
+                      [&searchFolders]() -> std::string {
+                          fmt::memory_buffer buffer;
+                          for (auto& folder : searchFolders) {
+                              fmt::format_to(fmt::appender(buffer), " \"{}\"", xr::wide_to_utf8(folder.c_str()));
+                          }
+                          return fmt::to_string(buffer);
+                      }());
 
         assert(false && "The file should be embeded in app folder in debug build.");
         return "";
@@ -87,7 +148,7 @@ namespace sample {
         pbrResources.SetLight({0.0f, 0.7071067811865475f, 0.7071067811865475f}, Pbr::RGB::White);
 
         // Read the BRDF Lookup Table used by the PBR system into a DirectX texture.
-        std::vector<byte> brdfLutFileData = ReadFileBytes(FindFileInAppFolder(L"brdf_lut.png", {"", L"Pbr_uwp"}));
+        const MappedFile brdfLutFileData = MapFileBytes(FindFileInAppFolder(L"brdf_lut.png", {"", L"Pbr_uwp"}));
         winrt::com_ptr<ID3D11ShaderResourceView> brdLutResourceView =
             Pbr::Texture::LoadTextureImage(device, brdfLutFileData.data(), (uint32_t)brdfLutFileData.size());
         pbrResources.SetBrdfLut(brdLutResourceView.get());
@@ -96,14 +157,13 @@ namespace sample {
         winrt::com_ptr<ID3D11ShaderResourceView> specularTextureView;
 
         if (environmentIBL) {
-            CHECK_HRCMD(DirectX::CreateDDSTextureFromFile(device,
-                                                          FindFileInAppFolder(L"Sample_DiffuseHDR.DDS", {"", "SampleShared_uwp"}).c_str(),
-                                                          nullptr,
-                                                          diffuseTextureView.put()));
-            CHECK_HRCMD(DirectX::CreateDDSTextureFromFile(device,
-                                                          FindFileInAppFolder(L"Sample_SpecularHDR.DDS", {"", "SampleShared_uwp"}).c_str(),
-                                                          nullptr,
-                                                          specularTextureView.put()));
+            // Create the textures directly from the mapped files to avoid reading the multi-MB environment maps into heap copies.
+            const MappedFile diffuseFileData = MapFileBytes(FindFileInAppFolder(L"Sample_DiffuseHDR.DDS", {"", "SampleShared_uwp"}));
+            CHECK_HRCMD(DirectX::CreateDDSTextureFromMemory(
+                device, diffuseFileData.data(), diffuseFileData.size(), nullptr, diffuseTextureView.put()));
+            const MappedFile specularFileData = MapFileBytes(FindFileInAppFolder(L"Sample_SpecularHDR.DDS", {"", "SampleShared_uwp"}));
+            CHECK_HRCMD(DirectX::CreateDDSTextureFromMemory(
+                device, specularFileData.data(), specularFileData.size(), nullptr, specularTextureView.put()));
         } else {
             diffuseTextureView = Pbr::Texture::CreateFlatCubeTexture(device, Pbr::RGBA::White);
             specularTextureView = Pbr::Texture::CreateFlatCubeTexture(device, Pbr::RGBA::White);
@@ -3,6 +3,8 @@
 
 #pragma once
 #include <filesystem>
+#include <vector>
+#include <winrt/base.h>
 
 namespace Pbr {
     struct Model;
@@ -12,6 +14,44 @@ namespace Pbr {
 namespace sample {
     std::vector<uint8_t> ReadFileBytes(const std::filesystem::path& path);
 
+    // A read-only view of a file mapped into memory, valid for the lifetime of this object.
+    // It exposes data() and size() so it can be passed to the loaders in place of a std::vector<uint8_t> without a copy.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        explicit MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        const uint8_t* data() const {
+            return m_data;
+        }
+        size_t size() const {
+            return m_size;
+        }
+        const uint8_t* begin() const {
+            return m_data;
+        }
+        const uint8_t* end() const {
+            return m_data + m_size;
+        }
+
+    private:
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        void Unmap();
+
+        const uint8_t* m_data{nullptr};
+        size_t m_size{0};
+        winrt::handle m_mapping;
+    };
+
+    // Map the content of a file into memory instead of reading a copy of it like ReadFileBytes does.
+    MappedFile MapFileBytes(const std::filesystem::path& path);
+
     // Get a path in app folder, the path might not exist
     std::filesystem::path GetPathInAppFolder(const std::filesystem::path& filename);
 
@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace sample {
+    // A lock-free multi-producer single-consumer queue.
+    // Producers push from any thread with a single compare-exchange on the list head, and the consumer takes all pending items
+    // at once with a single exchange, so producers never block the consumer thread.
+    template <typename T>
+    class MpscQueue final {
+    public:
+        MpscQueue() = default;
+        ~MpscQueue() {
+            DeleteList(m_head.exchange(nullptr, std::memory_order_acquire));
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        // Can be called from any thread.
+        void Push(T value) {
+            Node* node = new Node{std::move(value), m_head.load(std::memory_order_relaxed)};
+            while (!m_head.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+
+        bool IsEmpty() const {
+            return m_head.load(std::memory_order_acquire) == nullptr;
+        }
+
+        // Take all pending items and call func on each of them in the order they were pushed.
+        // Must only be called from the single consumer thread.
+        template <typename TFunc>
+        void ConsumeAll(TFunc&& func) {
+            if (IsEmpty()) {
+                return;
+            }
+
+            // The list is built by pushing at the head, so reverse it to restore the push order.
+            Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+            Node* reversed = nullptr;
+            while (node != nullptr) {
+                Node* next = node->Next;
+                node->Next = reversed;
+                reversed = node;
+                node = next;
+            }
+
+            try {
+                while (reversed != nullptr) {
+                    std::unique_ptr<Node> current(reversed);
+                    reversed = reversed->Next;
+                    func(std::move(current->Value));
+                }
+            } catch (...) {
+                DeleteList(reversed);
+                throw;
+            }
+        }
+
+    private:
+        struct Node {
+            T Value;
+            Node* Next;
+        };
+
+        static void DeleteList(Node* node) {
+            while (node != nullptr) {
+                std::unique_ptr<Node> current(node);
+                node = node->Next;
+            }
+        }
+
+        std::atomic<Node*> m_head{nullptr};
+    };
+} // namespace sample
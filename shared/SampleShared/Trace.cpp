@@ -0,0 +1,374 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include "Trace.h"
+
+namespace {
+    using sample::detail::TraceRecord;
+
+    // A single-producer single-consumer ring of trace records owned by one thread.
+    // The owning thread writes records and advances m_write, the trace thread formats them and advances m_read.
+    class TraceRing {
+    public:
+        static constexpr uint32_t Capacity = 256; // Must be a power of two.
+
+        explicit TraceRing(uint32_t threadId)
+            : m_threadId(threadId) {
+        }
+
+        ~TraceRing() {
+            for (uint32_t read = m_read.load(std::memory_order_relaxed); read != m_write.load(std::memory_order_relaxed); read++) {
+                TraceRecord& record = m_records[read % Capacity];
+                record.Destroy(record.Storage);
+            }
+        }
+
+        uint32_t ThreadId() const {
+            return m_threadId;
+        }
+
+        uint32_t PendingCount() const {
+            return m_write.load(std::memory_order_relaxed) - m_read.load(std::memory_order_acquire);
+        }
+
+        // Producer side.
+        TraceRecord& Reserve() {
+            return m_records[m_write.load(std::memory_order_relaxed) % Capacity];
+        }
+        void Commit() {
+            m_write.store(m_write.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Consumer side. Calls func on every committed record and releases them back to the producer.
+        template <typename TFunc>
+        bool ConsumeAll(TFunc&& func) {
+            uint32_t read = m_read.load(std::memory_order_relaxed);
+            const uint32_t write = m_write.load(std::memory_order_acquire);
+            if (read == write) {
+                return false;
+            }
+
+            for (; read != write; read++) {
+                TraceRecord& record = m_records[read % Capacity];
+                func(record);
+                record.Destroy(record.Storage);
+                m_read.store(read + 1, std::memory_order_release);
+            }
+            return true;
+        }
+
+        bool IsClosed() const {
+            return m_closed.load(std::memory_order_acquire);
+        }
+        void Close() {
+            m_closed.store(true, std::memory_order_release);
+        }
+
+    private:
+        const uint32_t m_threadId;
+        std::atomic<bool> m_closed{false};
+        alignas(64) std::atomic<uint32_t> m_write{0};
+        alignas(64) std::atomic<uint32_t> m_read{0};
+        std::array<TraceRecord, Capacity> m_records;
+    };
+
+    class TraceLogger {
+    public:
+        static TraceLogger& Instance() {
+            static TraceLogger logger;
+            return logger;
+        }
+
+        TraceLogger() {
+            m_sinks.push_back(sample::CreateDebugOutputTraceSink());
+            m_thread = std::thread([this] { Run(); });
+        }
+
+        ~TraceLogger() {
+            {
+                std::lock_guard lock(m_mutex);
+                m_stopRequested = true;
+            }
+            m_wake.notify_all();
+            m_thread.join();
+        }
+
+        TraceRing& ThreadRing() {
+            // The ring is closed when its thread exits, and the trace thread releases it once it has been drained.
+            struct ThreadRingOwner {
+                std::shared_ptr<TraceRing> Ring;
+                ~ThreadRingOwner() {
+                    if (Ring) {
+                        Ring->Close();
+                    }
+                }
+            };
+            thread_local ThreadRingOwner owner;
+
+            if (!owner.Ring) {
+                owner.Ring = std::make_shared<TraceRing>(::GetCurrentThreadId());
+                std::lock_guard lock(m_mutex);
+                m_rings.push_back(owner.Ring);
+            }
+            return *owner.Ring;
+        }
+
+        void WaitForRingSpace(TraceRing& ring) {
+            while (ring.PendingCount() == TraceRing::Capacity) {
+                Wake();
+                std::this_thread::yield();
+            }
+        }
+
+        void Wake() {
+            m_wakeRequested.store(true, std::memory_order_release);
+            m_wake.notify_one();
+        }
+
+        void AddSink(std::shared_ptr<sample::TraceSink> sink) {
+            std::lock_guard lock(m_sinkMutex);
+            m_sinks.push_back(std::move(sink));
+        }
+
+        void RemoveSink(const std::shared_ptr<sample::TraceSink>& sink) {
+            std::lock_guard lock(m_sinkMutex);
+            m_sinks.erase(std::remove(m_sinks.begin(), m_sinks.end(), sink), m_sinks.end());
+        }
+
+        void Flush() {
+            std::unique_lock lock(m_mutex);
+            const uint64_t flushTicket = ++m_flushRequested;
+            Wake();
+            m_flushCompleted.wait(lock, [&] { return m_flushCompletedTicket >= flushTicket; });
+        }
+
+    private:
+        void Run() {
+            fmt::memory_buffer buffer;
+            std::vector<std::shared_ptr<TraceRing>> rings;
+            std::unique_lock lock(m_mutex);
+            for (;;) {
+                // Records pushed before a flush request are visible to the drain that starts after it.
+                const uint64_t flushTicket = m_flushRequested;
+                const bool stopRequested = m_stopRequested;
+                m_wakeRequested.store(false, std::memory_order_relaxed);
+                rings.assign(m_rings.begin(), m_rings.end());
+
+                // The rings are drained and the sinks written without m_mutex held, so a slow sink never blocks a thread
+                // registering its ring or requesting a flush.
+                lock.unlock();
+                const bool wroteAny = DrainRings(rings, buffer);
+                const bool flushRequested = flushTicket > m_flushCompletedTicket;
+                if (flushRequested) {
+                    FlushSinks();
+                }
+                lock.lock();
+
+                // DrainRings left only the rings that were closed and fully drained.
+                for (const auto& ring : rings) {
+                    m_rings.erase(std::remove(m_rings.begin(), m_rings.end(), ring), m_rings.end());
+                }
+
+                if (flushRequested) {
+                    m_flushCompletedTicket = flushTicket;
+                    m_flushCompleted.notify_all();
+                }
+
+                if (stopRequested) {
+                    break;
+                }
+
+                if (!wroteAny) {
+                    m_wake.wait_for(lock, std::chrono::milliseconds(10), [&] {
+                        return m_stopRequested || m_flushRequested > m_flushCompletedTicket ||
+                               m_wakeRequested.load(std::memory_order_acquire);
+                    });
+                }
+            }
+
+            lock.unlock();
+            FlushSinks();
+        }
+
+        // Format and write every pending record of the rings, then remove the rings that are still open from the list.
+        bool DrainRings(std::vector<std::shared_ptr<TraceRing>>& rings, fmt::memory_buffer& buffer) {
+            std::lock_guard sinkLock(m_sinkMutex);
+            bool wroteAny = false;
+            for (auto it = rings.begin(); it != rings.end();) {
+                TraceRing& ring = **it;
+                // Check closed before draining, so a record committed just before the thread exited is not lost.
+                const bool closed = ring.IsClosed();
+                wroteAny |= ring.ConsumeAll([&](TraceRecord& record) { WriteRecord(record, ring.ThreadId(), buffer); });
+
+                it = closed ? it + 1 : rings.erase(it);
+            }
+            return wroteAny;
+        }
+
+        // Errors are reported in the trace instead of ending the trace thread, so one bad record or sink does not stop tracing.
+        void WriteRecord(TraceRecord& record, uint32_t threadId, fmt::memory_buffer& buffer) {
+            buffer.clear();
+            FormatHeader(buffer, record.Time, threadId);
+            const size_t headerSize = buffer.size();
+            try {
+                record.Format(record.Storage, buffer);
+            } catch (const std::exception& ex) {
+                buffer.resize(headerSize);
+                fmt::format_to(fmt::appender(buffer), "<trace format error: {}>", ex.what());
+            } catch (...) {
+                buffer.resize(headerSize);
+                fmt::format_to(fmt::appender(buffer), "<trace format error>");
+            }
+            buffer.push_back('\n');
+
+            const std::string_view line(buffer.data(), buffer.size());
+            for (const auto& sink : m_sinks) {
+                try {
+                    sink->Write(line);
+                } catch (...) {
+                    // The line is lost for this sink only.
+                }
+            }
+        }
+
+        void FlushSinks() {
+            std::lock_guard sinkLock(m_sinkMutex);
+            for (const auto& sink : m_sinks) {
+                try {
+                    sink->Flush();
+                } catch (...) {
+                }
+            }
+        }
+
+        static void FormatHeader(fmt::memory_buffer& buffer, std::chrono::system_clock::time_point time, uint32_t threadId) {
+            using namespace std::chrono;
+            const auto posixTime = system_clock::to_time_t(time);
+            const auto remainingTime = time - system_clock::from_time_t(posixTime);
+            const uint64_t remainingMicroseconds = duration_cast<microseconds>(remainingTime).count();
+
+            tm localTime;
+            ::localtime_s(&localTime, &posixTime);
+
+            fmt::format_to(fmt::appender(buffer),
+                           "[{:02d}-{:02d}-{:02d}.{:06d}] (t:{:04x}): ",
+                           localTime.tm_hour,
+                           localTime.tm_min,
+                           localTime.tm_sec,
+                           remainingMicroseconds,
+                           threadId);
+        }
+
+        std::mutex m_mutex;     // Guards the ring list and the flush and stop requests.
+        std::mutex m_sinkMutex; // Guards the sinks, and is held by the trace thread while it writes to them.
+        std::condition_variable m_wake;
+        std::condition_variable m_flushCompleted;
+        std::atomic<bool> m_wakeRequested{false};
+        bool m_stopRequested{false};
+        uint64_t m_flushRequested{0};
+        uint64_t m_flushCompletedTicket{0};
+        std::vector<std::shared_ptr<TraceRing>> m_rings;
+        std::vector<std::shared_ptr<sample::TraceSink>> m_sinks;
+        std::thread m_thread;
+    };
+
+    struct DebugOutputTraceSink : sample::TraceSink {
+        void Write(std::string_view line) override {
+            m_line.assign(line);
+            ::OutputDebugStringA(m_line.c_str());
+        }
+
+    private:
+        std::string m_line; // OutputDebugStringA needs a null terminated string.
+    };
+
+    struct FileTraceSink : sample::TraceSink {
+        explicit FileTraceSink(const std::filesystem::path& path)
+            : m_file(path, std::ios::out | std::ios::app | std::ios::binary) {
+            if (!m_file) {
+                throw std::runtime_error(fmt::format("Unable to open trace file \"{}\"", path.string()));
+            }
+        }
+
+        void Write(std::string_view line) override {
+            m_file.write(line.data(), line.size());
+        }
+
+        void Flush() override {
+            m_file.flush();
+        }
+
+    private:
+        std::ofstream m_file;
+    };
+
+    struct StreamTraceSink : sample::TraceSink {
+        explicit StreamTraceSink(std::ostream& stream)
+            : m_stream(stream) {
+        }
+
+        void Write(std::string_view line) override {
+            m_stream.write(line.data(), line.size());
+        }
+
+        void Flush() override {
+            m_stream.flush();
+        }
+
+    private:
+        std::ostream& m_stream;
+    };
+} // namespace
+
+namespace sample {
+    std::shared_ptr<TraceSink> CreateDebugOutputTraceSink() {
+        return std::make_shared<DebugOutputTraceSink>();
+    }
+
+    std::shared_ptr<TraceSink> CreateFileTraceSink(const std::filesystem::path& path) {
+        return std::make_shared<FileTraceSink>(path);
+    }
+
+    std::shared_ptr<TraceSink> CreateStreamTraceSink(std::ostream& stream) {
+        return std::make_shared<StreamTraceSink>(stream);
+    }
+
+    void AddTraceSink(std::shared_ptr<TraceSink> sink) {
+        TraceLogger::Instance().AddSink(std::move(sink));
+    }
+
+    void RemoveTraceSink(const std::shared_ptr<TraceSink>& sink) {
+        TraceLogger::Instance().RemoveSink(sink);
+    }
+
+    void FlushTrace() {
+        TraceLogger::Instance().Flush();
+    }
+
+    namespace detail {
+        TraceRecord& BeginTraceRecord() {
+            TraceLogger& logger = TraceLogger::Instance();
+            TraceRing& ring = logger.ThreadRing();
+            logger.WaitForRingSpace(ring);
+
+            TraceRecord& record = ring.Reserve();
+            record.Time = std::chrono::system_clock::now();
+            return record;
+        }
+
+        void CommitTraceRecord() {
+            TraceLogger& logger = TraceLogger::Instance();
+            TraceRing& ring = logger.ThreadRing();
+            ring.Commit();
+
+            // Wake the trace thread early when the ring is filling up, rather than waiting for its next poll.
+            if (ring.PendingCount() == TraceRing::Capacity / 2) {
+                logger.Wake();
+            }
+        }
+    } // namespace detail
+} // namespace sample
@@ -7,8 +7,16 @@
 #include <iomanip>
 #include <fstream>
 #include <chrono>
+#include <cstddef>
 #include <thread>
+#include <filesystem>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <processthreadsapi.h>
 
 #define FMT_HEADER_ONLY
@@ -17,28 +25,120 @@
 
 namespace sample {
 
-    inline void FormatHeader(fmt::memory_buffer& buffer, const char* formatStr) {
-        using namespace std::chrono;
-        const auto now = system_clock::now();
-        const auto posixTime = system_clock::to_time_t(now);
-        const auto remainingTime = now - system_clock::from_time_t(posixTime);
-        const uint64_t remainingMicroseconds = duration_cast<microseconds>(remainingTime).count();
-        const uint32_t threadId = ::GetCurrentThreadId();
+    // Receives formatted trace lines. Sinks are only called from the trace thread, one line at a time.
+    struct TraceSink {
+        virtual ~TraceSink() = default;
 
-        tm localTime;
-        ::localtime_s(&localTime, &posixTime);
+        // The line includes the timestamp header and the trailing newline.
+        virtual void Write(std::string_view line) = 0;
+        virtual void Flush() {
+        }
+    };
 
-        fmt::format_to(
-            fmt::appender(buffer), formatStr, localTime.tm_hour, localTime.tm_min, localTime.tm_sec, remainingMicroseconds, threadId);
+    // Writes to the debugger output. This sink is installed by default.
+    std::shared_ptr<TraceSink> CreateDebugOutputTraceSink();
+    // Appends to a file, creating it if needed.
+    std::shared_ptr<TraceSink> CreateFileTraceSink(const std::filesystem::path& path);
+    // Writes to a stream such as std::cerr. The stream must outlive the sink.
+    std::shared_ptr<TraceSink> CreateStreamTraceSink(std::ostream& stream);
+
+    void AddTraceSink(std::shared_ptr<TraceSink> sink);
+    void RemoveTraceSink(const std::shared_ptr<TraceSink>& sink);
+
+    // Block until every trace call made before this call has been written to the sinks, and flush the sinks.
+    // Must not be called from a sink.
+    void FlushTrace();
+
+    namespace detail {
+        // A trace call as stored in a per-thread ring until the trace thread formats it.
+        struct TraceRecord {
+            static constexpr size_t InlineCapacity = 96;
+
+            std::chrono::system_clock::time_point Time;
+            void (*Format)(void* storage, fmt::memory_buffer& buffer);
+            void (*Destroy)(void* storage);
+            alignas(std::max_align_t) std::byte Storage[InlineCapacity];
+        };
+
+        // Reserve the next record in the calling thread's ring, waiting for the trace thread if the ring is full.
+        // The record is published to the trace thread by CommitTraceRecord.
+        TraceRecord& BeginTraceRecord();
+        void CommitTraceRecord();
+
+        // Arguments are copied into the record because they are formatted after the call returns.
+        // Strings are copied by value since the caller's string may not outlive the call.
+        template <typename T>
+        struct TraceArgStorage {
+            using Type = T;
+        };
+        template <>
+        struct TraceArgStorage<const char*> {
+            using Type = std::string;
+        };
+        template <>
+        struct TraceArgStorage<char*> {
+            using Type = std::string;
+        };
+        template <>
+        struct TraceArgStorage<std::string_view> {
+            using Type = std::string;
+        };
+        template <typename T>
+        using TraceArgStorage_t = typename TraceArgStorage<std::decay_t<T>>::Type;
+
+        template <typename TFormat, typename... Args>
+        struct TraceMessage {
+            using ArgumentTuple = std::tuple<Args...>;
+
+            TFormat Format;
+            ArgumentTuple Arguments;
+
+            void FormatTo(fmt::memory_buffer& buffer) const {
+                std::apply(
+                    [&](const auto&... args) {
+                        fmt::vformat_to(fmt::appender(buffer), std::string_view(Format), fmt::make_format_args(args...));
+                    },
+                    Arguments);
+            }
+        };
+
+        template <typename TMessage>
+        void PushTraceMessage(TMessage&& message) {
+            using Message = std::decay_t<TMessage>;
+            TraceRecord& record = BeginTraceRecord();
+
+            // Small messages are stored in the record itself, larger ones are allocated.
+            if constexpr (sizeof(Message) <= TraceRecord::InlineCapacity && alignof(Message) <= alignof(std::max_align_t)) {
+                new (record.Storage) Message(std::forward<TMessage>(message));
+                record.Format = [](void* storage, fmt::memory_buffer& buffer) { static_cast<Message*>(storage)->FormatTo(buffer); };
+                record.Destroy = [](void* storage) { static_cast<Message*>(storage)->~Message(); };
+            } else {
+                new (record.Storage) Message*(new Message(std::forward<TMessage>(message)));
+                record.Format = [](void* storage, fmt::memory_buffer& buffer) { (*static_cast<Message**>(storage))->FormatTo(buffer); };
+                record.Destroy = [](void* storage) { delete *static_cast<Message**>(storage); };
+            }
+
+            CommitTraceRecord();
+        }
+    } // namespace detail
+
+    // Trace calls only copy the arguments into a per-thread ring. Formatting and writing to the sinks happens on a background
+    // trace thread, so tracing does not block the calling thread on string formatting or OutputDebugString.
+    // A format string passed as a constant character array is a string literal with static storage, so only a view of it is
+    // stored. Formats built at runtime go through the std::string_view overload, which copies them.
+    template <size_t N, typename... Args>
+    inline void Trace(const char (&format_str)[N], const Args&... args) {
+        using Message = detail::TraceMessage<std::string_view, detail::TraceArgStorage_t<Args>...>;
+        detail::PushTraceMessage(Message{std::string_view(format_str, N - 1), typename Message::ArgumentTuple(args...)});
     }
 
+    // A writable character array is a buffer that may not outlive the call, not a literal. Trace("{}", buffer) instead.
+    template <size_t N, typename... Args>
+    void Trace(char (&format_str)[N], const Args&... args) = delete;
+
     template <typename... Args>
     inline void Trace(std::string_view format_str, const Args&... args) {
-        fmt::memory_buffer buffer;
-        FormatHeader(buffer, "[{:02d}-{:02d}-{:02d}.{:06d}] (t:{:04x}): ");
-        fmt::format_to(fmt::appender(buffer), format_str, args...);
-        buffer.push_back('\n');
-        buffer.push_back('\0');
-        ::OutputDebugStringA(buffer.data());
+        using Message = detail::TraceMessage<std::string, detail::TraceArgStorage_t<Args>...>;
+        detail::PushTraceMessage(Message{std::string(format_str), typename Message::ArgumentTuple(args...)});
     }
 } // namespace sample
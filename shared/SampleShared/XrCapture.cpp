@@ -0,0 +1,970 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include "FileUtility.h"
+#include "XrCapture.h"
+
+namespace {
+    constexpr uint32_t CaptureMagic = 0x50435258; // "XRCP"
+    constexpr uint32_t CaptureVersion = 1;
+
+    // The functions whose outputs are captured. The values are stored in the capture file, so only append to this list.
+    enum class CapturedFunction : uint8_t {
+        WaitFrame,
+        LocateSpace,
+        LocateViews,
+        GetActionStateBoolean,
+        GetActionStateFloat,
+        GetActionStateVector2f,
+        GetActionStatePose,
+        LocateHandJoints,
+        GetSceneComputeState,
+        GetSceneComponents,
+        LocateSceneComponents,
+        GetSceneMeshBuffers,
+        GetSerializedSceneFragmentData,
+        Count
+    };
+
+#define XR_LIST_CAPTURED_FUNCTIONS(_)                                       \
+    _(xrWaitFrame, WaitFrame)                                               \
+    _(xrLocateSpace, LocateSpace)                                           \
+    _(xrLocateViews, LocateViews)                                           \
+    _(xrGetActionStateBoolean, GetActionStateBoolean)                       \
+    _(xrGetActionStateFloat, GetActionStateFloat)                           \
+    _(xrGetActionStateVector2f, GetActionStateVector2f)                     \
+    _(xrGetActionStatePose, GetActionStatePose)                             \
+    _(xrLocateHandJointsEXT, LocateHandJoints)                              \
+    _(xrGetSceneComputeStateMSFT, GetSceneComputeState)                     \
+    _(xrGetSceneComponentsMSFT, GetSceneComponents)                         \
+    _(xrLocateSceneComponentsMSFT, LocateSceneComponents)                   \
+    _(xrGetSceneMeshBuffersMSFT, GetSceneMeshBuffers)                       \
+    _(xrGetSerializedSceneFragmentDataMSFT, GetSerializedSceneFragmentData)
+
+    // The functions that start a scene compute or create and destroy its results. A replay serves the scenes from the capture,
+    // so when the capture has scene compute results, these functions don't reach the runtime either. Otherwise the runtime would
+    // be asked for the results of computes it never ran, or of computes unrelated to the replayed compute state.
+#define XR_LIST_REPLAYED_SCENE_FUNCTIONS(_)     \
+    _(xrComputeNewSceneMSFT, ComputeNewScene)   \
+    _(xrDeserializeSceneMSFT, DeserializeScene) \
+    _(xrCreateSceneMSFT, CreateScene)           \
+    _(xrDestroySceneMSFT, DestroyScene)
+
+    class ByteWriter {
+    public:
+        template <typename T>
+        void Write(const T& value) {
+            Write(&value, 1);
+        }
+
+        template <typename T>
+        void Write(const T* values, size_t count) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+            m_bytes.insert(m_bytes.end(), bytes, bytes + sizeof(T) * count);
+        }
+
+        // An array returned with the two-call idiom. The count is always written, the items only as many as the app had room for.
+        template <typename T>
+        void WriteArray(uint32_t countOutput, uint32_t capacityInput, const T* items) {
+            const uint32_t itemCount = items != nullptr ? std::min(countOutput, capacityInput) : 0;
+            Write(countOutput);
+            Write(itemCount);
+            Write(items, itemCount);
+        }
+
+        const std::vector<uint8_t>& Bytes() const {
+            return m_bytes;
+        }
+
+    private:
+        std::vector<uint8_t> m_bytes;
+    };
+
+    class ByteReader {
+    public:
+        ByteReader(const uint8_t* data, size_t size)
+            : m_data(data)
+            , m_size(size) {
+        }
+
+        template <typename T>
+        T Read() {
+            T value;
+            Read(&value, 1);
+            return value;
+        }
+
+        template <typename T>
+        void Read(T* values, size_t count) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const uint8_t* bytes = Skip(sizeof(T) * count);
+            if (count > 0) {
+                memcpy(values, bytes, sizeof(T) * count);
+            }
+        }
+
+        // Reads an array written by ByteWriter::WriteArray into the app's array, as far as it has room.
+        template <typename T>
+        void ReadArray(uint32_t capacityInput, uint32_t* countOutput, T* items) {
+            const uint32_t recordedCountOutput = Read<uint32_t>();
+            if (countOutput != nullptr) {
+                *countOutput = recordedCountOutput;
+            }
+            const uint32_t itemCount = Read<uint32_t>();
+            const uint32_t copyCount = items != nullptr ? std::min(itemCount, capacityInput) : 0;
+            Read(items, copyCount);
+            Skip(sizeof(T) * (itemCount - copyCount));
+        }
+
+        const uint8_t* Skip(size_t size) {
+            if (size > m_size - m_offset) {
+                throw std::runtime_error("Capture record is truncated");
+            }
+            const uint8_t* bytes = m_data + m_offset;
+            m_offset += size;
+            return bytes;
+        }
+
+        bool AtEnd() const {
+            return m_offset == m_size;
+        }
+
+    private:
+        const uint8_t* const m_data;
+        const size_t m_size;
+        size_t m_offset{0};
+    };
+
+    template <typename T>
+    T* FindChained(void* next, XrStructureType type) {
+        for (auto* header = static_cast<XrBaseOutStructure*>(next); header != nullptr; header = header->next) {
+            if (header->type == type) {
+                return reinterpret_cast<T*>(header);
+            }
+        }
+        return nullptr;
+    }
+
+    // Outputs of each captured function. Write and Read must stay symmetric.
+
+    void Write(ByteWriter& writer, const XrFrameState& frameState) {
+        writer.Write(frameState.predictedDisplayTime);
+        writer.Write(frameState.predictedDisplayPeriod);
+        writer.Write(frameState.shouldRender);
+    }
+
+    void Read(ByteReader& reader, XrFrameState& frameState) {
+        frameState.predictedDisplayTime = reader.Read<XrTime>();
+        frameState.predictedDisplayPeriod = reader.Read<XrDuration>();
+        frameState.shouldRender = reader.Read<XrBool32>();
+    }
+
+    void Write(ByteWriter& writer, const XrSpaceLocation& location) {
+        writer.Write(location.locationFlags);
+        writer.Write(location.pose);
+
+        const auto* velocity = FindChained<XrSpaceVelocity>(location.next, XR_TYPE_SPACE_VELOCITY);
+        writer.Write<XrBool32>(velocity != nullptr);
+        if (velocity != nullptr) {
+            writer.Write(velocity->velocityFlags);
+            writer.Write(velocity->linearVelocity);
+            writer.Write(velocity->angularVelocity);
+        }
+    }
+
+    void Read(ByteReader& reader, XrSpaceLocation& location) {
+        location.locationFlags = reader.Read<XrSpaceLocationFlags>();
+        location.pose = reader.Read<XrPosef>();
+
+        XrSpaceVelocity recordedVelocity{XR_TYPE_SPACE_VELOCITY};
+        if (reader.Read<XrBool32>()) {
+            recordedVelocity.velocityFlags = reader.Read<XrSpaceVelocityFlags>();
+            recordedVelocity.linearVelocity = reader.Read<XrVector3f>();
+            recordedVelocity.angularVelocity = reader.Read<XrVector3f>();
+        }
+        if (auto* velocity = FindChained<XrSpaceVelocity>(location.next, XR_TYPE_SPACE_VELOCITY)) {
+            velocity->velocityFlags = recordedVelocity.velocityFlags;
+            velocity->linearVelocity = recordedVelocity.linearVelocity;
+            velocity->angularVelocity = recordedVelocity.angularVelocity;
+        }
+    }
+
+    void WriteViews(
+        ByteWriter& writer, const XrViewState& viewState, uint32_t viewCapacityInput, uint32_t viewCountOutput, const XrView* views) {
+        writer.Write(viewState.viewStateFlags);
+        const uint32_t viewCount = views != nullptr ? std::min(viewCountOutput, viewCapacityInput) : 0;
+        writer.Write(viewCountOutput);
+        writer.Write(viewCount);
+        for (uint32_t i = 0; i < viewCount; i++) {
+            writer.Write(views[i].pose);
+            writer.Write(views[i].fov);
+        }
+    }
+
+    void ReadViews(ByteReader& reader, XrViewState& viewState, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrView* views) {
+        viewState.viewStateFlags = reader.Read<XrViewStateFlags>();
+        *viewCountOutput = reader.Read<uint32_t>();
+        const uint32_t viewCount = reader.Read<uint32_t>();
+        for (uint32_t i = 0; i < viewCount; i++) {
+            const XrPosef pose = reader.Read<XrPosef>();
+            const XrFovf fov = reader.Read<XrFovf>();
+            if (views != nullptr && i < viewCapacityInput) {
+                views[i].pose = pose;
+                views[i].fov = fov;
+            }
+        }
+    }
+
+    template <typename TActionState>
+    void Write(ByteWriter& writer, const TActionState& state) {
+        writer.Write(state.currentState);
+        writer.Write(state.changedSinceLastSync);
+        writer.Write(state.lastChangeTime);
+        writer.Write(state.isActive);
+    }
+
+    template <typename TActionState>
+    void Read(ByteReader& reader, TActionState& state) {
+        state.currentState = reader.Read<decltype(state.currentState)>();
+        state.changedSinceLastSync = reader.Read<XrBool32>();
+        state.lastChangeTime = reader.Read<XrTime>();
+        state.isActive = reader.Read<XrBool32>();
+    }
+
+    void Write(ByteWriter& writer, const XrActionStatePose& state) {
+        writer.Write(state.isActive);
+    }
+
+    void Read(ByteReader& reader, XrActionStatePose& state) {
+        state.isActive = reader.Read<XrBool32>();
+    }
+
+    void Write(ByteWriter& writer, const XrHandJointLocationsEXT& locations) {
+        writer.Write(locations.isActive);
+        writer.WriteArray(locations.jointCount, locations.jointCount, locations.jointLocations);
+
+        const auto* velocities = FindChained<XrHandJointVelocitiesEXT>(locations.next, XR_TYPE_HAND_JOINT_VELOCITIES_EXT);
+        writer.Write<XrBool32>(velocities != nullptr);
+        if (velocities != nullptr) {
+            writer.WriteArray(velocities->jointCount, velocities->jointCount, velocities->jointVelocities);
+        }
+    }
+
+    void Read(ByteReader& reader, XrHandJointLocationsEXT& locations) {
+        locations.isActive = reader.Read<XrBool32>();
+        reader.ReadArray(locations.jointCount, nullptr, locations.jointLocations);
+
+        auto* velocities = FindChained<XrHandJointVelocitiesEXT>(locations.next, XR_TYPE_HAND_JOINT_VELOCITIES_EXT);
+        if (reader.Read<XrBool32>()) {
+            reader.ReadArray(velocities ? velocities->jointCount : 0, nullptr, velocities ? velocities->jointVelocities : nullptr);
+        }
+    }
+
+    // The arrays chained to XrSceneComponentsMSFT have one item per component, filled up to the number of components returned.
+    template <typename TChained, typename TItem>
+    void WriteChainedComponentArray(
+        ByteWriter& writer, const TChained& chained, uint32_t count, const TItem* items, uint32_t componentCount) {
+        writer.Write(chained.type);
+        writer.WriteArray(std::min(count, componentCount), count, items);
+    }
+
+    void Write(ByteWriter& writer, const XrSceneComponentsMSFT& components) {
+        writer.WriteArray(components.componentCountOutput, components.componentCapacityInput, components.components);
+        const uint32_t componentCount =
+            components.components != nullptr ? std::min(components.componentCountOutput, components.componentCapacityInput) : 0;
+
+        for (auto* header = static_cast<const XrBaseOutStructure*>(components.next); header != nullptr; header = header->next) {
+            if (header->type == XR_TYPE_SCENE_OBJECTS_MSFT) {
+                const auto& objects = *reinterpret_cast<const XrSceneObjectsMSFT*>(header);
+                WriteChainedComponentArray(writer, objects, objects.sceneObjectCount, objects.sceneObjects, componentCount);
+            } else if (header->type == XR_TYPE_SCENE_PLANES_MSFT) {
+                const auto& planes = *reinterpret_cast<const XrScenePlanesMSFT*>(header);
+                WriteChainedComponentArray(writer, planes, planes.scenePlaneCount, planes.scenePlanes, componentCount);
+            } else if (header->type == XR_TYPE_SCENE_MESHES_MSFT) {
+                const auto& meshes = *reinterpret_cast<const XrSceneMeshesMSFT*>(header);
+                WriteChainedComponentArray(writer, meshes, meshes.sceneMeshCount, meshes.sceneMeshes, componentCount);
+            }
+        }
+        writer.Write(XR_TYPE_UNKNOWN);
+    }
+
+    void Read(ByteReader& reader, XrSceneComponentsMSFT& components) {
+        reader.ReadArray(components.componentCapacityInput, &components.componentCountOutput, components.components);
+
+        for (auto type = reader.Read<XrStructureType>(); type != XR_TYPE_UNKNOWN; type = reader.Read<XrStructureType>()) {
+            if (type == XR_TYPE_SCENE_OBJECTS_MSFT) {
+                auto* objects = FindChained<XrSceneObjectsMSFT>(components.next, type);
+                reader.ReadArray(objects ? objects->sceneObjectCount : 0, nullptr, objects ? objects->sceneObjects : nullptr);
+            } else if (type == XR_TYPE_SCENE_PLANES_MSFT) {
+                auto* planes = FindChained<XrScenePlanesMSFT>(components.next, type);
+                reader.ReadArray(planes ? planes->scenePlaneCount : 0, nullptr, planes ? planes->scenePlanes : nullptr);
+            } else if (type == XR_TYPE_SCENE_MESHES_MSFT) {
+                auto* meshes = FindChained<XrSceneMeshesMSFT>(components.next, type);
+                reader.ReadArray(meshes ? meshes->sceneMeshCount : 0, nullptr, meshes ? meshes->sceneMeshes : nullptr);
+            } else {
+                throw std::runtime_error("Unexpected structure in capture record");
+            }
+        }
+    }
+
+    void Write(ByteWriter& writer, const XrSceneComponentLocationsMSFT& locations) {
+        writer.WriteArray(locations.locationCount, locations.locationCount, locations.locations);
+    }
+
+    void Read(ByteReader& reader, XrSceneComponentLocationsMSFT& locations) {
+        reader.ReadArray(locations.locationCount, nullptr, locations.locations);
+    }
+
+    void Write(ByteWriter& writer, const XrSceneMeshBuffersMSFT& buffers) {
+        for (auto* header = static_cast<const XrBaseOutStructure*>(buffers.next); header != nullptr; header = header->next) {
+            if (header->type == XR_TYPE_SCENE_MESH_VERTEX_BUFFER_MSFT) {
+                const auto& vertices = *reinterpret_cast<const XrSceneMeshVertexBufferMSFT*>(header);
+                writer.Write(header->type);
+                writer.WriteArray(vertices.vertexCountOutput, vertices.vertexCapacityInput, vertices.vertices);
+            } else if (header->type == XR_TYPE_SCENE_MESH_INDICES_UINT32_MSFT) {
+                const auto& indices = *reinterpret_cast<const XrSceneMeshIndicesUint32MSFT*>(header);
+                writer.Write(header->type);
+                writer.WriteArray(indices.indexCountOutput, indices.indexCapacityInput, indices.indices);
+            } else if (header->type == XR_TYPE_SCENE_MESH_INDICES_UINT16_MSFT) {
+                const auto& indices = *reinterpret_cast<const XrSceneMeshIndicesUint16MSFT*>(header);
+                writer.Write(header->type);
+                writer.WriteArray(indices.indexCountOutput, indices.indexCapacityInput, indices.indices);
+            }
+        }
+        writer.Write(XR_TYPE_UNKNOWN);
+    }
+
+    void Read(ByteReader& reader, XrSceneMeshBuffersMSFT& buffers) {
+        for (auto type = reader.Read<XrStructureType>(); type != XR_TYPE_UNKNOWN; type = reader.Read<XrStructureType>()) {
+            if (type == XR_TYPE_SCENE_MESH_VERTEX_BUFFER_MSFT) {
+                auto* vertices = FindChained<XrSceneMeshVertexBufferMSFT>(buffers.next, type);
+                uint32_t ignoredCount;
+                reader.ReadArray(vertices ? vertices->vertexCapacityInput : 0,
+                                 vertices ? &vertices->vertexCountOutput : &ignoredCount,
+                                 vertices ? vertices->vertices : nullptr);
+            } else if (type == XR_TYPE_SCENE_MESH_INDICES_UINT32_MSFT) {
+                auto* indices = FindChained<XrSceneMeshIndicesUint32MSFT>(buffers.next, type);
+                uint32_t ignoredCount;
+                reader.ReadArray(indices ? indices->indexCapacityInput : 0,
+                                 indices ? &indices->indexCountOutput : &ignoredCount,
+                                 indices ? indices->indices : nullptr);
+            } else if (type == XR_TYPE_SCENE_MESH_INDICES_UINT16_MSFT) {
+                auto* indices = FindChained<XrSceneMeshIndicesUint16MSFT>(buffers.next, type);
+                uint32_t ignoredCount;
+                reader.ReadArray(indices ? indices->indexCapacityInput : 0,
+                                 indices ? &indices->indexCountOutput : &ignoredCount,
+                                 indices ? indices->indices : nullptr);
+            } else {
+                throw std::runtime_error("Unexpected structure in capture record");
+            }
+        }
+    }
+
+    class Recorder {
+    public:
+        explicit Recorder(const std::filesystem::path& path)
+            : m_file(path, std::ios::binary | std::ios::trunc) {
+            if (!m_file) {
+                throw std::runtime_error(fmt::format("Failed to create capture file: {}", path.string()));
+            }
+            m_file.write(reinterpret_cast<const char*>(&CaptureMagic), sizeof(CaptureMagic));
+            m_file.write(reinterpret_cast<const char*>(&CaptureVersion), sizeof(CaptureVersion));
+        }
+
+        // Each record is the function, the size of its data, then the result and outputs of the call.
+        void Append(CapturedFunction function, const ByteWriter& writer) {
+            const uint8_t functionId = static_cast<uint8_t>(function);
+            const uint32_t size = static_cast<uint32_t>(writer.Bytes().size());
+
+            std::lock_guard lock(m_mutex);
+            m_file.write(reinterpret_cast<const char*>(&functionId), sizeof(functionId));
+            m_file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            m_file.write(reinterpret_cast<const char*>(writer.Bytes().data()), size);
+        }
+
+        void Flush() {
+            std::lock_guard lock(m_mutex);
+            m_file.flush();
+        }
+
+        void Install(xr::DispatchTable& dispatchTable);
+        void Uninstall();
+
+        xr::DispatchTable Original{};
+
+    private:
+        std::mutex m_mutex;
+        std::ofstream m_file;
+        xr::DispatchTable* m_dispatchTable{nullptr};
+    };
+
+    struct CaptureRecord {
+        const uint8_t* Data;
+        uint32_t Size;
+    };
+
+    // Scenes served by a replay are never created by the runtime. Their handles carry a tag in the bits that are never set in
+    // user mode addresses, so they can't be mistaken for runtime handles, even after the replayer is gone.
+    constexpr uint64_t ReplayedSceneTag = 0xC0DE'0000'0000'0000;
+
+    XrSceneMSFT MakeReplayedScene(uint64_t index) {
+        static_assert(sizeof(XrSceneMSFT) == sizeof(uint64_t));
+        const uint64_t value = ReplayedSceneTag | index;
+        XrSceneMSFT scene;
+        memcpy(&scene, &value, sizeof(scene));
+        return scene;
+    }
+
+    bool IsReplayedScene(XrSceneMSFT scene) {
+        uint64_t value;
+        memcpy(&value, &scene, sizeof(value));
+        return (value & 0xFFFF'0000'0000'0000) == ReplayedSceneTag;
+    }
+
+    // Handles keep the destroy function they were created with, which outlives the replayer for the scenes of the runtime.
+    PFN_xrDestroySceneMSFT g_originalDestroyScene{nullptr};
+
+    class Replayer {
+    public:
+        explicit Replayer(const std::filesystem::path& path)
+            : m_bytes(sample::ReadFileBytes(path)) {
+            ByteReader reader(m_bytes.data(), m_bytes.size());
+            if (m_bytes.size() < sizeof(CaptureMagic) + sizeof(CaptureVersion) || reader.Read<uint32_t>() != CaptureMagic ||
+                reader.Read<uint32_t>() != CaptureVersion) {
+                throw std::runtime_error(fmt::format("Not a supported capture file: {}", path.string()));
+            }
+
+            // Calls made before the first xrWaitFrame go to frame 0. Each xrWaitFrame then starts a new frame.
+            m_frames.emplace_back();
+            while (!reader.AtEnd()) {
+                const uint8_t functionId = reader.Read<uint8_t>();
+                const uint32_t size = reader.Read<uint32_t>();
+                if (functionId >= static_cast<uint8_t>(CapturedFunction::Count)) {
+                    throw std::runtime_error(fmt::format("Unknown function in capture file: {}", path.string()));
+                }
+                const uint8_t* data = reader.Skip(size);
+
+                if (static_cast<CapturedFunction>(functionId) == CapturedFunction::WaitFrame) {
+                    m_frames.emplace_back();
+                }
+                m_frames.back().Calls[functionId].push_back({data, size});
+                m_recordedFunctions[functionId] = true;
+            }
+        }
+
+        bool HasRecords(CapturedFunction function) const {
+            return m_recordedFunctions[static_cast<size_t>(function)];
+        }
+
+        void NextFrame() {
+            std::lock_guard lock(m_mutex);
+            const auto now = std::chrono::steady_clock::now();
+            if (m_lastFrameTime.has_value() && !m_finished) {
+                m_frameTimes.push_back(now - m_lastFrameTime.value());
+            }
+            m_lastFrameTime = now;
+
+            if (m_frameIndex + 1 < m_frames.size()) {
+                m_frameIndex++;
+            } else {
+                m_finished = true;
+            }
+            m_callIndices.fill(0);
+        }
+
+        // The next recorded output of the function in the current frame, or the last one recorded before.
+        std::optional<CaptureRecord> Fetch(CapturedFunction function) {
+            const size_t functionId = static_cast<size_t>(function);
+
+            std::lock_guard lock(m_mutex);
+            const std::vector<CaptureRecord>& calls = m_frames[m_frameIndex].Calls[functionId];
+            const size_t callIndex = m_callIndices[functionId]++;
+            if (callIndex < calls.size()) {
+                m_lastRecords[functionId] = calls[callIndex];
+            }
+            return m_lastRecords[functionId];
+        }
+
+        // The app keeps using the live frame times, the recorded times are shifted by the difference of the predicted display
+        // times of the live and the recorded frame.
+        void SetFrameTimes(XrTime liveDisplayTime, XrTime recordedDisplayTime) {
+            std::lock_guard lock(m_mutex);
+            m_timeOffset = liveDisplayTime - recordedDisplayTime;
+        }
+
+        XrTime ToLiveTime(XrTime recordedTime) const {
+            std::lock_guard lock(m_mutex);
+            return recordedTime != 0 ? recordedTime + m_timeOffset : 0;
+        }
+
+        XrSceneMSFT CreateScene() {
+            std::lock_guard lock(m_mutex);
+            return MakeReplayedScene(++m_sceneCount);
+        }
+
+        bool Finished() const {
+            std::lock_guard lock(m_mutex);
+            return m_finished;
+        }
+
+        sample::FrameTimeStatistics FrameTimes() const {
+            std::vector<std::chrono::duration<float, std::milli>> frameTimes;
+            {
+                std::lock_guard lock(m_mutex);
+                frameTimes = m_frameTimes;
+            }
+
+            sample::FrameTimeStatistics statistics;
+            if (frameTimes.empty()) {
+                return statistics;
+            }
+
+            std::sort(frameTimes.begin(), frameTimes.end());
+            auto percentile = [&frameTimes](float fraction) {
+                const size_t rank = static_cast<size_t>(std::ceil(fraction * frameTimes.size()));
+                return frameTimes[std::clamp<size_t>(rank, 1, frameTimes.size()) - 1];
+            };
+
+            statistics.FrameCount = static_cast<uint32_t>(frameTimes.size());
+            statistics.Mean = std::accumulate(frameTimes.begin(), frameTimes.end(), std::chrono::duration<float, std::milli>{}) /
+                              static_cast<float>(frameTimes.size());
+            statistics.Min = frameTimes.front();
+            statistics.Median = percentile(0.5f);
+            statistics.Percentile95 = percentile(0.95f);
+            statistics.Percentile99 = percentile(0.99f);
+            statistics.Max = frameTimes.back();
+            return statistics;
+        }
+
+        void Install(xr::DispatchTable& dispatchTable);
+        void Uninstall();
+
+        xr::DispatchTable Original{};
+
+    private:
+        struct Frame {
+            std::array<std::vector<CaptureRecord>, static_cast<size_t>(CapturedFunction::Count)> Calls;
+        };
+
+        const std::vector<uint8_t> m_bytes;
+        std::vector<Frame> m_frames;
+        std::array<bool, static_cast<size_t>(CapturedFunction::Count)> m_recordedFunctions{};
+
+        mutable std::mutex m_mutex;
+        size_t m_frameIndex{0};
+        bool m_finished{false};
+        std::array<size_t, static_cast<size_t>(CapturedFunction::Count)> m_callIndices{};
+        std::array<std::optional<CaptureRecord>, static_cast<size_t>(CapturedFunction::Count)> m_lastRecords{};
+        XrDuration m_timeOffset{0};
+        uint64_t m_sceneCount{0};
+
+        std::optional<std::chrono::steady_clock::time_point> m_lastFrameTime;
+        std::vector<std::chrono::duration<float, std::milli>> m_frameTimes;
+
+        xr::DispatchTable* m_dispatchTable{nullptr};
+    };
+
+    Recorder* g_recorder{nullptr};
+    Replayer* g_replayer{nullptr};
+
+    template <typename TOutput>
+    XrResult Record(CapturedFunction function, XrResult result, const TOutput& output) {
+        ByteWriter writer;
+        writer.Write(result);
+        Write(writer, output);
+        g_recorder->Append(function, writer);
+        return result;
+    }
+
+    // Returns the recorded result after reading the recorded outputs into the app's structures,
+    // or calls the original function if the function was never recorded.
+    template <typename TReadOutputs, typename TPassThrough>
+    XrResult Replay(CapturedFunction function, TReadOutputs&& readOutputs, TPassThrough&& passThrough) {
+        const std::optional<CaptureRecord> record = g_replayer->Fetch(function);
+        if (!record.has_value()) {
+            return passThrough();
+        }
+
+        try {
+            ByteReader reader(record->Data, record->Size);
+            const XrResult result = reader.Read<XrResult>();
+            readOutputs(reader);
+            return result;
+        } catch (const std::exception& ex) {
+            sample::Trace("Failed to replay capture record: {}", ex.what());
+            return XR_ERROR_RUNTIME_FAILURE;
+        }
+    }
+
+    // A scene served by the replay is unknown to the runtime, a call the capture has no record of fails like for any invalid handle.
+    template <typename TFunction, typename... TArgs>
+    XrResult PassThroughScene(XrSceneMSFT scene, TFunction function, TArgs... args) {
+        return IsReplayedScene(scene) ? XR_ERROR_HANDLE_INVALID : function(args...);
+    }
+
+    XrResult XRAPI_CALL RecordWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState) {
+        return Record(CapturedFunction::WaitFrame, g_recorder->Original.xrWaitFrame(session, frameWaitInfo, frameState), *frameState);
+    }
+
+    XrResult XRAPI_CALL RecordLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
+        return Record(CapturedFunction::LocateSpace, g_recorder->Original.xrLocateSpace(space, baseSpace, time, location), *location);
+    }
+
+    XrResult XRAPI_CALL RecordLocateViews(XrSession session,
+                                          const XrViewLocateInfo* viewLocateInfo,
+                                          XrViewState* viewState,
+                                          uint32_t viewCapacityInput,
+                                          uint32_t* viewCountOutput,
+                                          XrView* views) {
+        const XrResult result =
+            g_recorder->Original.xrLocateViews(session, viewLocateInfo, viewState, viewCapacityInput, viewCountOutput, views);
+        ByteWriter writer;
+        writer.Write(result);
+        WriteViews(writer, *viewState, viewCapacityInput, *viewCountOutput, views);
+        g_recorder->Append(CapturedFunction::LocateViews, writer);
+        return result;
+    }
+
+    XrResult XRAPI_CALL RecordGetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateBoolean* state) {
+        return Record(
+            CapturedFunction::GetActionStateBoolean, g_recorder->Original.xrGetActionStateBoolean(session, getInfo, state), *state);
+    }
+
+    XrResult XRAPI_CALL RecordGetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state) {
+        return Record(CapturedFunction::GetActionStateFloat, g_recorder->Original.xrGetActionStateFloat(session, getInfo, state), *state);
+    }
+
+    XrResult XRAPI_CALL RecordGetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) {
+        return Record(
+            CapturedFunction::GetActionStateVector2f, g_recorder->Original.xrGetActionStateVector2f(session, getInfo, state), *state);
+    }
+
+    XrResult XRAPI_CALL RecordGetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state) {
+        return Record(CapturedFunction::GetActionStatePose, g_recorder->Original.xrGetActionStatePose(session, getInfo, state), *state);
+    }
+
+    XrResult XRAPI_CALL RecordLocateHandJoints(XrHandTrackerEXT handTracker,
+                                               const XrHandJointsLocateInfoEXT* locateInfo,
+                                               XrHandJointLocationsEXT* locations) {
+        return Record(
+            CapturedFunction::LocateHandJoints, g_recorder->Original.xrLocateHandJointsEXT(handTracker, locateInfo, locations), *locations);
+    }
+
+    XrResult XRAPI_CALL RecordGetSceneComputeState(XrSceneObserverMSFT sceneObserver, XrSceneComputeStateMSFT* state) {
+        const XrResult result = g_recorder->Original.xrGetSceneComputeStateMSFT(sceneObserver, state);
+        ByteWriter writer;
+        writer.Write(result);
+        writer.Write(*state);
+        g_recorder->Append(CapturedFunction::GetSceneComputeState, writer);
+        return result;
+    }
+
+    XrResult XRAPI_CALL RecordGetSceneComponents(XrSceneMSFT scene,
+                                                 const XrSceneComponentsGetInfoMSFT* getInfo,
+                                                 XrSceneComponentsMSFT* components) {
+        return Record(
+            CapturedFunction::GetSceneComponents, g_recorder->Original.xrGetSceneComponentsMSFT(scene, getInfo, components), *components);
+    }
+
+    XrResult XRAPI_CALL RecordLocateSceneComponents(XrSceneMSFT scene,
+                                                    const XrSceneComponentsLocateInfoMSFT* locateInfo,
+                                                    XrSceneComponentLocationsMSFT* locations) {
+        return Record(CapturedFunction::LocateSceneComponents,
+                      g_recorder->Original.xrLocateSceneComponentsMSFT(scene, locateInfo, locations),
+                      *locations);
+    }
+
+    XrResult XRAPI_CALL RecordGetSceneMeshBuffers(XrSceneMSFT scene,
+                                                  const XrSceneMeshBuffersGetInfoMSFT* getInfo,
+                                                  XrSceneMeshBuffersMSFT* buffers) {
+        return Record(
+            CapturedFunction::GetSceneMeshBuffers, g_recorder->Original.xrGetSceneMeshBuffersMSFT(scene, getInfo, buffers), *buffers);
+    }
+
+    XrResult XRAPI_CALL RecordGetSerializedSceneFragmentData(XrSceneMSFT scene,
+                                                             const XrSerializedSceneFragmentDataGetInfoMSFT* getInfo,
+                                                             uint32_t countInput,
+                                                             uint32_t* readOutput,
+                                                             uint8_t* buffer) {
+        const XrResult result = g_recorder->Original.xrGetSerializedSceneFragmentDataMSFT(scene, getInfo, countInput, readOutput, buffer);
+        ByteWriter writer;
+        writer.Write(result);
+        writer.WriteArray(*readOutput, countInput, buffer);
+        g_recorder->Append(CapturedFunction::GetSerializedSceneFragmentData, writer);
+        return result;
+    }
+
+    // The app gets the frame state of the runtime, because it passes the frame times back to the runtime, e.g. to xrEndFrame.
+    // The recorded frame state only maps the times in the recorded outputs onto the live frame times.
+    XrResult XRAPI_CALL ReplayWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState) {
+        const XrResult result = g_replayer->Original.xrWaitFrame(session, frameWaitInfo, frameState);
+        if (XR_FAILED(result)) {
+            return result;
+        }
+
+        g_replayer->NextFrame();
+        XrFrameState recordedFrameState{XR_TYPE_FRAME_STATE};
+        const XrResult recordedResult = Replay(
+            CapturedFunction::WaitFrame,
+            [&](ByteReader& reader) { Read(reader, recordedFrameState); },
+            [] { return XR_ERROR_RUNTIME_FAILURE; });
+        if (XR_SUCCEEDED(recordedResult)) {
+            g_replayer->SetFrameTimes(frameState->predictedDisplayTime, recordedFrameState.predictedDisplayTime);
+        }
+        return result;
+    }
+
+    XrResult XRAPI_CALL ReplayLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
+        return Replay(
+            CapturedFunction::LocateSpace,
+            [&](ByteReader& reader) { Read(reader, *location); },
+            [&] { return g_replayer->Original.xrLocateSpace(space, baseSpace, time, location); });
+    }
+
+    XrResult XRAPI_CALL ReplayLocateViews(XrSession session,
+                                          const XrViewLocateInfo* viewLocateInfo,
+                                          XrViewState* viewState,
+                                          uint32_t viewCapacityInput,
+                                          uint32_t* viewCountOutput,
+                                          XrView* views) {
+        return Replay(
+            CapturedFunction::LocateViews,
+            [&](ByteReader& reader) { ReadViews(reader, *viewState, viewCapacityInput, viewCountOutput, views); },
+            [&] {
+                return g_replayer->Original.xrLocateViews(session, viewLocateInfo, viewState, viewCapacityInput, viewCountOutput, views);
+            });
+    }
+
+    XrResult XRAPI_CALL ReplayGetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateBoolean* state) {
+        return Replay(
+            CapturedFunction::GetActionStateBoolean,
+            [&](ByteReader& reader) {
+                Read(reader, *state);
+                state->lastChangeTime = g_replayer->ToLiveTime(state->lastChangeTime);
+            },
+            [&] { return g_replayer->Original.xrGetActionStateBoolean(session, getInfo, state); });
+    }
+
+    XrResult XRAPI_CALL ReplayGetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state) {
+        return Replay(
+            CapturedFunction::GetActionStateFloat,
+            [&](ByteReader& reader) {
+                Read(reader, *state);
+                state->lastChangeTime = g_replayer->ToLiveTime(state->lastChangeTime);
+            },
+            [&] { return g_replayer->Original.xrGetActionStateFloat(session, getInfo, state); });
+    }
+
+    XrResult XRAPI_CALL ReplayGetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) {
+        return Replay(
+            CapturedFunction::GetActionStateVector2f,
+            [&](ByteReader& reader) {
+                Read(reader, *state);
+                state->lastChangeTime = g_replayer->ToLiveTime(state->lastChangeTime);
+            },
+            [&] { return g_replayer->Original.xrGetActionStateVector2f(session, getInfo, state); });
+    }
+
+    XrResult XRAPI_CALL ReplayGetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state) {
+        return Replay(
+            CapturedFunction::GetActionStatePose,
+            [&](ByteReader& reader) { Read(reader, *state); },
+            [&] { return g_replayer->Original.xrGetActionStatePose(session, getInfo, state); });
+    }
+
+    XrResult XRAPI_CALL ReplayLocateHandJoints(XrHandTrackerEXT handTracker,
+                                               const XrHandJointsLocateInfoEXT* locateInfo,
+                                               XrHandJointLocationsEXT* locations) {
+        return Replay(
+            CapturedFunction::LocateHandJoints,
+            [&](ByteReader& reader) { Read(reader, *locations); },
+            [&] { return g_replayer->Original.xrLocateHandJointsEXT(handTracker, locateInfo, locations); });
+    }
+
+    XrResult XRAPI_CALL ReplayGetSceneComputeState(XrSceneObserverMSFT sceneObserver, XrSceneComputeStateMSFT* state) {
+        return Replay(
+            CapturedFunction::GetSceneComputeState,
+            [&](ByteReader& reader) { *state = reader.Read<XrSceneComputeStateMSFT>(); },
+            [&] { return g_replayer->Original.xrGetSceneComputeStateMSFT(sceneObserver, state); });
+    }
+
+    XrResult XRAPI_CALL ReplayGetSceneComponents(XrSceneMSFT scene,
+                                                 const XrSceneComponentsGetInfoMSFT* getInfo,
+                                                 XrSceneComponentsMSFT* components) {
+        return Replay(
+            CapturedFunction::GetSceneComponents,
+            [&](ByteReader& reader) {
+                Read(reader, *components);
+                const uint32_t componentCount =
+                    components->components != nullptr ? std::min(components->componentCountOutput, components->componentCapacityInput) : 0;
+                for (uint32_t i = 0; i < componentCount; i++) {
+                    components->components[i].updateTime = g_replayer->ToLiveTime(components->components[i].updateTime);
+                }
+            },
+            [&] { return PassThroughScene(scene, g_replayer->Original.xrGetSceneComponentsMSFT, scene, getInfo, components); });
+    }
+
+    XrResult XRAPI_CALL ReplayLocateSceneComponents(XrSceneMSFT scene,
+                                                    const XrSceneComponentsLocateInfoMSFT* locateInfo,
+                                                    XrSceneComponentLocationsMSFT* locations) {
+        return Replay(
+            CapturedFunction::LocateSceneComponents,
+            [&](ByteReader& reader) { Read(reader, *locations); },
+            [&] { return PassThroughScene(scene, g_replayer->Original.xrLocateSceneComponentsMSFT, scene, locateInfo, locations); });
+    }
+
+    XrResult XRAPI_CALL ReplayGetSceneMeshBuffers(XrSceneMSFT scene,
+                                                  const XrSceneMeshBuffersGetInfoMSFT* getInfo,
+                                                  XrSceneMeshBuffersMSFT* buffers) {
+        return Replay(
+            CapturedFunction::GetSceneMeshBuffers,
+            [&](ByteReader& reader) { Read(reader, *buffers); },
+            [&] { return PassThroughScene(scene, g_replayer->Original.xrGetSceneMeshBuffersMSFT, scene, getInfo, buffers); });
+    }
+
+    XrResult XRAPI_CALL ReplayGetSerializedSceneFragmentData(XrSceneMSFT scene,
+                                                             const XrSerializedSceneFragmentDataGetInfoMSFT* getInfo,
+                                                             uint32_t countInput,
+                                                             uint32_t* readOutput,
+                                                             uint8_t* buffer) {
+        return Replay(
+            CapturedFunction::GetSerializedSceneFragmentData,
+            [&](ByteReader& reader) { reader.ReadArray(countInput, readOutput, buffer); },
+            [&] {
+                return PassThroughScene(
+                    scene, g_replayer->Original.xrGetSerializedSceneFragmentDataMSFT, scene, getInfo, countInput, readOutput, buffer);
+            });
+    }
+
+    // The compute state and the scenes are served from the capture, so the runtime never runs a compute during a replay.
+    XrResult XRAPI_CALL ReplayComputeNewScene(XrSceneObserverMSFT, const XrNewSceneComputeInfoMSFT*) {
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL ReplayDeserializeScene(XrSceneObserverMSFT, const XrSceneDeserializeInfoMSFT*) {
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL ReplayCreateScene(XrSceneObserverMSFT, const XrSceneCreateInfoMSFT*, XrSceneMSFT* scene) {
+        *scene = g_replayer->CreateScene();
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL ReplayDestroyScene(XrSceneMSFT scene) {
+        return IsReplayedScene(scene) ? XR_SUCCESS : g_originalDestroyScene(scene);
+    }
+
+    // Functions not provided by the runtime, e.g. of extensions that are not enabled, are left null.
+#define XR_CAPTURE_INSTALL_RECORD(function, name) \
+    if (dispatchTable.function != nullptr) {     \
+        dispatchTable.function = Record##name;   \
+    }
+#define XR_CAPTURE_INSTALL_REPLAY(function, name) \
+    if (dispatchTable.function != nullptr) {     \
+        dispatchTable.function = Replay##name;   \
+    }
+#define XR_CAPTURE_UNINSTALL(function, name) m_dispatchTable->function = Original.function;
+
+    void Recorder::Install(xr::DispatchTable& dispatchTable) {
+        if (g_recorder != nullptr || g_replayer != nullptr) {
+            throw std::logic_error("Another capture recorder or replayer is already installed.");
+        }
+        Original = dispatchTable;
+        m_dispatchTable = &dispatchTable;
+        g_recorder = this;
+        XR_LIST_CAPTURED_FUNCTIONS(XR_CAPTURE_INSTALL_RECORD);
+    }
+
+    void Recorder::Uninstall() {
+        if (m_dispatchTable != nullptr) {
+            XR_LIST_CAPTURED_FUNCTIONS(XR_CAPTURE_UNINSTALL);
+            m_dispatchTable = nullptr;
+            g_recorder = nullptr;
+            Flush();
+        }
+    }
+
+    void Replayer::Install(xr::DispatchTable& dispatchTable) {
+        if (g_recorder != nullptr || g_replayer != nullptr) {
+            throw std::logic_error("Another capture recorder or replayer is already installed.");
+        }
+        Original = dispatchTable;
+        m_dispatchTable = &dispatchTable;
+        g_replayer = this;
+        XR_LIST_CAPTURED_FUNCTIONS(XR_CAPTURE_INSTALL_REPLAY);
+        if (HasRecords(CapturedFunction::GetSceneComputeState)) {
+            g_originalDestroyScene = Original.xrDestroySceneMSFT;
+            XR_LIST_REPLAYED_SCENE_FUNCTIONS(XR_CAPTURE_INSTALL_REPLAY);
+        }
+    }
+
+    void Replayer::Uninstall() {
+        if (m_dispatchTable != nullptr) {
+            XR_LIST_CAPTURED_FUNCTIONS(XR_CAPTURE_UNINSTALL);
+            XR_LIST_REPLAYED_SCENE_FUNCTIONS(XR_CAPTURE_UNINSTALL);
+            m_dispatchTable = nullptr;
+            g_replayer = nullptr;
+        }
+    }
+
+#undef XR_CAPTURE_INSTALL_RECORD
+#undef XR_CAPTURE_INSTALL_REPLAY
+#undef XR_CAPTURE_UNINSTALL
+} // namespace
+
+namespace sample {
+    struct XrCaptureRecorder::Impl : Recorder {
+        using Recorder::Recorder;
+    };
+
+    XrCaptureRecorder::XrCaptureRecorder(const std::filesystem::path& path)
+        : m_impl(std::make_unique<Impl>(path)) {
+    }
+
+    XrCaptureRecorder::~XrCaptureRecorder() {
+        m_impl->Uninstall();
+    }
+
+    void XrCaptureRecorder::Install(xr::DispatchTable& dispatchTable) {
+        m_impl->Install(dispatchTable);
+    }
+
+    void XrCaptureRecorder::Uninstall() {
+        m_impl->Uninstall();
+    }
+
+    struct XrCaptureReplayer::Impl : Replayer {
+        using Replayer::Replayer;
+    };
+
+    XrCaptureReplayer::XrCaptureReplayer(const std::filesystem::path& path)
+        : m_impl(std::make_unique<Impl>(path)) {
+    }
+
+    XrCaptureReplayer::~XrCaptureReplayer() {
+        m_impl->Uninstall();
+    }
+
+    void XrCaptureReplayer::Install(xr::DispatchTable& dispatchTable) {
+        m_impl->Install(dispatchTable);
+    }
+
+    void XrCaptureReplayer::Uninstall() {
+        m_impl->Uninstall();
+    }
+
+    bool XrCaptureReplayer::Finished() const {
+        return m_impl->Finished();
+    }
+
+    FrameTimeStatistics XrCaptureReplayer::FrameTimes() const {
+        return m_impl->FrameTimes();
+    }
+} // namespace sample
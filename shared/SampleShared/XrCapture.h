@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+
+namespace xr {
+    struct DispatchTable;
+}
+
+namespace sample {
+
+    // Frame times of a replay, measured from one xrWaitFrame to the next.
+    struct FrameTimeStatistics {
+        uint32_t FrameCount{0};
+        std::chrono::duration<float, std::milli> Mean{};
+        std::chrono::duration<float, std::milli> Min{};
+        std::chrono::duration<float, std::milli> Median{};
+        std::chrono::duration<float, std::milli> Percentile95{};
+        std::chrono::duration<float, std::milli> Percentile99{};
+        std::chrono::duration<float, std::milli> Max{};
+    };
+
+    // Records what the runtime returns from the functions that feed tracking and input into the app:
+    // xrWaitFrame, xrLocateSpace, xrLocateViews, xrGetActionState*, xrLocateHandJointsEXT and the scene understanding
+    // functions returning compute results or serialized scenes. Install() replaces these functions in a dispatch table with
+    // wrappers that call the original function and append its outputs to a compact binary file.
+    // Only calls made through the dispatch table are recorded, i.e. the app must be compiled with XR_NO_PROTOTYPES.
+    class XrCaptureRecorder {
+    public:
+        explicit XrCaptureRecorder(const std::filesystem::path& path);
+        ~XrCaptureRecorder();
+
+        // Only one recorder or replayer can be installed at a time.
+        void Install(xr::DispatchTable& dispatchTable);
+        void Uninstall();
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+
+    // Serves the outputs recorded by XrCaptureRecorder back to the app, so that a session can be replayed without a headset.
+    // Each xrWaitFrame starts the next recorded frame. Within a frame, the calls to each function return the recorded outputs
+    // in the order they were recorded, regardless of their inputs. The replay is deterministic as long as the app makes the
+    // same calls in each frame as when it was recorded.
+    // A call beyond those recorded in a frame returns the last recorded output of the function, and a function that was
+    // never recorded is passed through to the original function. xrWaitFrame always calls the original function first and
+    // returns the live frame state, so the runtime still sees a balanced frame loop and only gets times of its own. Times in
+    // the recorded outputs, e.g. XrActionStateBoolean::lastChangeTime, are shifted onto the live frame times.
+    // When the capture has scene compute results, scenes are computed and created from the capture only: xrComputeNewSceneMSFT,
+    // xrDeserializeSceneMSFT and xrCreateSceneMSFT don't reach the runtime, and the scene handles are only known to the replay.
+    class XrCaptureReplayer {
+    public:
+        explicit XrCaptureReplayer(const std::filesystem::path& path);
+        ~XrCaptureReplayer();
+
+        void Install(xr::DispatchTable& dispatchTable);
+        void Uninstall();
+
+        // True once xrWaitFrame was called after the last recorded frame. The last frame keeps being served.
+        bool Finished() const;
+
+        FrameTimeStatistics FrameTimes() const;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+} // namespace sample
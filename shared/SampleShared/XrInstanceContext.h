@@ -41,8 +41,9 @@ namespace sample {
         xr::SetEnabledExtensions(instanceCreateInfo, extensions);
         xr::SetApplicationInfo(instanceCreateInfo.applicationInfo, appInfo, engineInfo);
 
+        // The dispatch table is only initialized for the instance once it's created, so look xrDestroyInstance up when it's called.
         xr::InstanceHandle instance;
-        CHECK_XRCMD(xrCreateInstance(&instanceCreateInfo, instance.Put(xrDestroyInstance)));
+        CHECK_XRCMD(xrCreateInstance(&instanceCreateInfo, instance.Put([](XrInstance handle) { return xrDestroyInstance(handle); })));
 
         XrInstanceProperties instanceProperties{XR_TYPE_INSTANCE_PROPERTIES};
         CHECK_XRCMD(xrGetInstanceProperties(instance.Get(), &instanceProperties));
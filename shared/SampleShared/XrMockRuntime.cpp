@@ -0,0 +1,2005 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <XrUtility/XrMath.h>
+#include "XrMockRuntime.h"
+
+namespace {
+    constexpr XrSystemId MockSystemId = 1;
+    constexpr std::chrono::nanoseconds VelocityTimeDelta = std::chrono::milliseconds(1);
+    constexpr XrSpaceLocationFlags TrackedLocationFlags = XR_SPACE_LOCATION_POSITION_VALID_BIT |
+                                                          XR_SPACE_LOCATION_ORIENTATION_VALID_BIT |
+                                                          XR_SPACE_LOCATION_POSITION_TRACKED_BIT |
+                                                          XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
+
+    // Scene component ids encode the component type and the index of its object, so components keep their ids across
+    // scene computes and can be located without a lookup.
+    constexpr uint8_t SceneComponentIdTag[3] = {'M', 'O', 'C'};
+
+    template <typename THandle>
+    THandle ToHandle(uint64_t id) {
+        if constexpr (std::is_pointer_v<THandle>) {
+            return reinterpret_cast<THandle>(static_cast<uintptr_t>(id));
+        } else {
+            return static_cast<THandle>(id);
+        }
+    }
+
+    template <typename THandle>
+    uint64_t ToId(THandle handle) {
+        if constexpr (std::is_pointer_v<THandle>) {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+        } else {
+            return static_cast<uint64_t>(handle);
+        }
+    }
+
+    template <typename T>
+    const T* FindChained(const void* next, XrStructureType type) {
+        for (auto* header = static_cast<const XrBaseInStructure*>(next); header != nullptr; header = header->next) {
+            if (header->type == type) {
+                return reinterpret_cast<const T*>(header);
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    T* FindChained(void* next, XrStructureType type) {
+        for (auto* header = static_cast<XrBaseOutStructure*>(next); header != nullptr; header = header->next) {
+            if (header->type == type) {
+                return reinterpret_cast<T*>(header);
+            }
+        }
+        return nullptr;
+    }
+
+    // Returns an array with the two-call idiom.
+    template <typename T>
+    XrResult CopyArray(uint32_t capacityInput, uint32_t* countOutput, T* items, const T* source, size_t count) {
+        if (countOutput == nullptr) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        *countOutput = static_cast<uint32_t>(count);
+        if (capacityInput == 0) {
+            return XR_SUCCESS;
+        }
+        if (capacityInput < count || items == nullptr) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        std::copy(source, source + count, items);
+        return XR_SUCCESS;
+    }
+
+    XrResult CopyString(uint32_t capacityInput, uint32_t* countOutput, char* buffer, const std::string& string) {
+        return CopyArray(capacityInput, countOutput, buffer, string.c_str(), string.size() + 1);
+    }
+
+    void CopyString(char* buffer, size_t bufferSize, const std::string& string) {
+        const size_t length = std::min(string.size(), bufferSize - 1);
+        std::memcpy(buffer, string.c_str(), length);
+        buffer[length] = '\0';
+    }
+
+    template <typename T>
+    bool Contains(const T* items, uint32_t count, T value) {
+        return std::find(items, items + count, value) != items + count;
+    }
+
+    bool StartsWith(const std::string& string, const std::string& prefix) {
+        return string.size() >= prefix.size() && string.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    XrPosef RotationY(float radians) {
+        return {{0, std::sin(radians / 2), 0, std::cos(radians / 2)}, {0, 0, 0}};
+    }
+
+    XrPosef RotationX(float radians) {
+        return {{std::sin(radians / 2), 0, 0, std::cos(radians / 2)}, {0, 0, 0}};
+    }
+
+    // Pose of a hand joint relative to the grip of the hand. The fingers point forward (-Z), the palm faces the other hand.
+    XrPosef HandJointPoseInGrip(XrHandEXT hand, uint32_t joint) {
+        const float side = hand == XR_HAND_LEFT_EXT ? 1.0f : -1.0f;
+        if (joint == XR_HAND_JOINT_PALM_EXT) {
+            return xr::math::Pose::Translation({0, 0, -0.02f});
+        }
+        if (joint == XR_HAND_JOINT_WRIST_EXT) {
+            return xr::math::Pose::Translation({0, 0, 0.06f});
+        }
+
+        // The thumb has 4 joints starting at XR_HAND_JOINT_THUMB_METACARPAL_EXT, the other fingers 5.
+        const uint32_t finger = joint < XR_HAND_JOINT_INDEX_METACARPAL_EXT ? 0 : 1 + (joint - XR_HAND_JOINT_INDEX_METACARPAL_EXT) / 5;
+        const uint32_t segment =
+            finger == 0 ? joint - XR_HAND_JOINT_THUMB_METACARPAL_EXT + 1 : (joint - XR_HAND_JOINT_INDEX_METACARPAL_EXT) % 5;
+        const float spread = (static_cast<float>(finger) - 2.0f) * 0.02f;
+        const float along = finger == 0 ? 0.03f : 0.05f - 0.025f * segment;
+        return xr::math::Pose::Translation({spread, finger == 0 ? -0.01f * segment * side : 0.0f, along - 0.025f * segment});
+    }
+
+    struct SceneObjectState {
+        XrPosef Pose;
+        XrSceneObjectTypeMSFT Type;
+        XrExtent2Df Size;
+        XrTime UpdateTime;
+    };
+
+    struct Space {
+        XrReferenceSpaceType ReferenceSpaceType{XR_REFERENCE_SPACE_TYPE_LOCAL};
+        uint64_t Action{0}; // Non-zero for action spaces.
+        XrPath SubactionPath{XR_NULL_PATH};
+        XrPosef PoseInSpace{xr::math::Pose::Identity()};
+    };
+
+    struct Action {
+        uint64_t ActionSet;
+        XrActionType Type;
+        std::vector<XrPath> SubactionPaths;
+    };
+
+    struct Swapchain {
+        XrSwapchainCreateInfo CreateInfo;
+        uint32_t NextImage{0};
+        std::deque<uint32_t> AcquiredImages;
+#ifdef XR_USE_GRAPHICS_API_D3D11
+        std::vector<winrt::com_ptr<ID3D11Texture2D>> Textures;
+#endif
+    };
+
+    struct SceneObserver {
+        XrSceneComputeStateMSFT State{XR_SCENE_COMPUTE_STATE_NONE_MSFT};
+        XrTime CompleteTime{0};
+        uint32_t ComputeCount{0};
+        std::vector<XrSceneComputeFeatureMSFT> Features;
+        std::vector<SceneObjectState> Objects;
+    };
+
+    struct Scene {
+        std::vector<XrSceneComputeFeatureMSFT> Features;
+        std::vector<SceneObjectState> Objects;
+
+        bool HasComponents(XrSceneComponentTypeMSFT type) const {
+            switch (type) {
+            case XR_SCENE_COMPONENT_TYPE_OBJECT_MSFT:
+                return true;
+            case XR_SCENE_COMPONENT_TYPE_PLANE_MSFT:
+                return HasFeature(XR_SCENE_COMPUTE_FEATURE_PLANE_MSFT) || HasFeature(XR_SCENE_COMPUTE_FEATURE_PLANE_MESH_MSFT);
+            case XR_SCENE_COMPONENT_TYPE_VISUAL_MESH_MSFT:
+                return HasFeature(XR_SCENE_COMPUTE_FEATURE_VISUAL_MESH_MSFT);
+            case XR_SCENE_COMPONENT_TYPE_COLLIDER_MESH_MSFT:
+                return HasFeature(XR_SCENE_COMPUTE_FEATURE_COLLIDER_MESH_MSFT);
+            default:
+                return false;
+            }
+        }
+
+        bool HasFeature(XrSceneComputeFeatureMSFT feature) const {
+            return std::find(Features.begin(), Features.end(), feature) != Features.end();
+        }
+    };
+
+    XrUuidMSFT SceneComponentId(XrSceneComponentTypeMSFT type, uint32_t objectIndex) {
+        XrUuidMSFT id{};
+        id.bytes[0] = static_cast<uint8_t>(type);
+        std::memcpy(&id.bytes[1], SceneComponentIdTag, sizeof(SceneComponentIdTag));
+        const uint32_t value = objectIndex + 1;
+        std::memcpy(&id.bytes[4], &value, sizeof(value));
+        return id;
+    }
+
+    bool DecodeSceneComponentId(const XrUuidMSFT& id, XrSceneComponentTypeMSFT* type, uint32_t* objectIndex) {
+        uint32_t value;
+        std::memcpy(&value, &id.bytes[4], sizeof(value));
+        if (std::memcmp(&id.bytes[1], SceneComponentIdTag, sizeof(SceneComponentIdTag)) != 0 || value == 0) {
+            return false;
+        }
+        *type = static_cast<XrSceneComponentTypeMSFT>(id.bytes[0]);
+        *objectIndex = value - 1;
+        return true;
+    }
+
+    uint64_t SceneMeshBufferId(XrSceneComponentTypeMSFT type, uint32_t objectIndex) {
+        return (static_cast<uint64_t>(type) << 32) | (static_cast<uint64_t>(objectIndex) + 1);
+    }
+
+    XrScenePlaneAlignmentTypeMSFT PlaneAlignment(XrSceneObjectTypeMSFT objectType) {
+        switch (objectType) {
+        case XR_SCENE_OBJECT_TYPE_FLOOR_MSFT:
+        case XR_SCENE_OBJECT_TYPE_CEILING_MSFT:
+        case XR_SCENE_OBJECT_TYPE_PLATFORM_MSFT:
+            return XR_SCENE_PLANE_ALIGNMENT_TYPE_HORIZONTAL_MSFT;
+        case XR_SCENE_OBJECT_TYPE_WALL_MSFT:
+            return XR_SCENE_PLANE_ALIGNMENT_TYPE_VERTICAL_MSFT;
+        default:
+            return XR_SCENE_PLANE_ALIGNMENT_TYPE_NON_ORTHOGONAL_MSFT;
+        }
+    }
+
+    // Objects are laid out on a grid around the origin. Each object lies in the XY plane of its pose with its normal along +Z,
+    // like scene understanding planes, so the planes of floors face up and walls face the origin.
+    SceneObjectState MakeSceneObject(uint32_t index, uint32_t objectCount, float floorHeight) {
+        constexpr XrSceneObjectTypeMSFT Types[] = {XR_SCENE_OBJECT_TYPE_FLOOR_MSFT,
+                                                   XR_SCENE_OBJECT_TYPE_WALL_MSFT,
+                                                   XR_SCENE_OBJECT_TYPE_PLATFORM_MSFT,
+                                                   XR_SCENE_OBJECT_TYPE_CEILING_MSFT,
+                                                   XR_SCENE_OBJECT_TYPE_BACKGROUND_MSFT};
+        constexpr float Spacing = 1.5f;
+
+        const uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(objectCount))));
+        const float x = (static_cast<float>(index % columns) - (columns - 1) / 2.0f) * Spacing;
+        const float z = (static_cast<float>(index / columns) - (columns - 1) / 2.0f) * Spacing;
+
+        SceneObjectState object{};
+        object.Type = Types[index % std::size(Types)];
+        object.Size = {1.2f, 1.2f};
+        switch (object.Type) {
+        case XR_SCENE_OBJECT_TYPE_FLOOR_MSFT:
+            object.Pose = RotationX(-DirectX::XM_PIDIV2);
+            object.Pose.position = {x, -floorHeight, z};
+            break;
+        case XR_SCENE_OBJECT_TYPE_PLATFORM_MSFT:
+            object.Pose = RotationX(-DirectX::XM_PIDIV2);
+            object.Pose.position = {x, 0.75f - floorHeight, z};
+            break;
+        case XR_SCENE_OBJECT_TYPE_CEILING_MSFT:
+            object.Pose = RotationX(DirectX::XM_PIDIV2);
+            object.Pose.position = {x, 2.5f - floorHeight, z};
+            break;
+        default:
+            object.Pose = RotationY(std::atan2(-x, -z));
+            object.Pose.position = {x, 1.0f - floorHeight, z};
+            object.Size = {1.2f, 2.0f};
+            break;
+        }
+        return object;
+    }
+
+    // A plane is a quad of its size. Meshes are gently curved grids of about the requested number of triangles.
+    void MakeSceneMesh(XrSceneComponentTypeMSFT type,
+                       const SceneObjectState& object,
+                       uint32_t triangleCount,
+                       std::vector<XrVector3f>& vertices,
+                       std::vector<uint32_t>& indices) {
+        const uint32_t cells =
+            type == XR_SCENE_COMPONENT_TYPE_PLANE_MSFT ? 1 : std::max(1u, static_cast<uint32_t>(std::sqrt(triangleCount / 2.0f)));
+        const float bump = type == XR_SCENE_COMPONENT_TYPE_PLANE_MSFT ? 0.0f : 0.02f;
+
+        vertices.clear();
+        for (uint32_t row = 0; row <= cells; row++) {
+            for (uint32_t column = 0; column <= cells; column++) {
+                const float u = static_cast<float>(column) / cells - 0.5f;
+                const float v = static_cast<float>(row) / cells - 0.5f;
+                vertices.push_back({u * object.Size.width, v * object.Size.height, bump * std::sin(u * 7.0f) * std::cos(v * 5.0f)});
+            }
+        }
+
+        indices.clear();
+        for (uint32_t row = 0; row < cells; row++) {
+            for (uint32_t column = 0; column < cells; column++) {
+                const uint32_t i = row * (cells + 1) + column;
+                indices.insert(indices.end(), {i, i + 1, i + cells + 1, i + 1, i + cells + 2, i + cells + 1});
+            }
+        }
+    }
+
+    struct Runtime {
+        explicit Runtime(sample::XrMockRuntime::Options options)
+            : Options(std::move(options))
+            , VirtualTime(std::chrono::nanoseconds(std::chrono::seconds(1)).count()) {
+        }
+
+        const sample::XrMockRuntime::Options Options;
+
+        std::mutex Mutex;
+        std::condition_variable FrameBegun;
+
+        uint64_t NextHandleId{1};
+
+        // The instance
+        uint64_t Instance{0};
+        std::vector<std::string> EnabledExtensions;
+        std::vector<std::string> Paths{""}; // The index of a path string is its XrPath.
+        std::unordered_map<std::string, XrPath> PathIds;
+        std::deque<XrEventDataBuffer> Events;
+
+        // The session
+        uint64_t Session{0};
+        XrSessionState SessionState{XR_SESSION_STATE_UNKNOWN};
+        bool SessionRunning{false};
+        bool ExitRequested{false};
+        uint64_t WaitFrameCount{0};
+        uint64_t BeginFrameCount{0};
+        uint64_t EndFrameCount{0};
+        bool FrameInProgress{false};
+        XrTime VirtualTime;
+        XrTime LastFrameTime{0};
+#ifdef XR_USE_GRAPHICS_API_D3D11
+        winrt::com_ptr<ID3D11Device> Device;
+#endif
+
+        // Actions
+        std::unordered_map<uint64_t, std::string> ActionSets;
+        std::unordered_map<uint64_t, Action> Actions;
+        std::unordered_map<std::string, std::vector<std::pair<uint64_t, std::string>>> SuggestedBindings;
+        std::string InteractionProfile;
+        std::vector<std::pair<uint64_t, std::string>> Bindings;
+        std::unordered_map<std::string, float> Inputs;
+        std::unordered_map<std::string, float> SyncedInputs;
+        std::unordered_map<std::string, XrTime> InputChangeTimes;
+        std::unordered_set<std::string> InputsChangedInLastSync;
+
+        std::unordered_map<uint64_t, Space> Spaces;
+        std::unordered_map<uint64_t, Swapchain> Swapchains;
+        std::unordered_map<uint64_t, XrHandEXT> HandTrackers;
+        std::unordered_map<uint64_t, SceneObserver> SceneObservers;
+        std::unordered_map<uint64_t, Scene> Scenes;
+
+        XrTime Now() const {
+            if (Options.PaceFrames) {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+            return VirtualTime;
+        }
+
+        template <typename THandle>
+        THandle NewHandle() {
+            return ToHandle<THandle>(NextHandleId++);
+        }
+
+        bool IsExtensionEnabled(const char* extension) const {
+            return std::find(EnabledExtensions.begin(), EnabledExtensions.end(), extension) != EnabledExtensions.end();
+        }
+
+        bool IsValidSession(XrSession session) const {
+            return Session != 0 && ToId(session) == Session;
+        }
+
+        bool IsFocused() const {
+            return SessionState == XR_SESSION_STATE_FOCUSED;
+        }
+
+        XrPath StringToPath(const std::string& string) {
+            auto [it, inserted] = PathIds.emplace(string, static_cast<XrPath>(Paths.size()));
+            if (inserted) {
+                Paths.push_back(string);
+            }
+            return it->second;
+        }
+
+        const std::string& PathToString(XrPath path) const {
+            return path < Paths.size() ? Paths[path] : Paths[0];
+        }
+
+        void QueueSessionState(XrSessionState state) {
+            SessionState = state;
+
+            XrEventDataBuffer buffer{XR_TYPE_EVENT_DATA_BUFFER};
+            auto* event = reinterpret_cast<XrEventDataSessionStateChanged*>(&buffer);
+            *event = {XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED, nullptr, ToHandle<XrSession>(Session), state, Now()};
+            Events.push_back(buffer);
+        }
+
+        XrPosef ReferenceSpacePose(XrReferenceSpaceType type, XrTime time) const {
+            switch (type) {
+            case XR_REFERENCE_SPACE_TYPE_VIEW:
+                return Options.HeadPose(time);
+            case XR_REFERENCE_SPACE_TYPE_STAGE:
+                return xr::math::Pose::Translation({0, -Options.FloorHeight, 0});
+            default:
+                return xr::math::Pose::Identity();
+            }
+        }
+
+        XrHandEXT ActionHand(const Space& space) const {
+            std::string path = PathToString(space.SubactionPath);
+            if (path.empty()) {
+                for (const auto& [action, binding] : Bindings) {
+                    if (action == space.Action) {
+                        path = binding;
+                        break;
+                    }
+                }
+            }
+            return StartsWith(path, "/user/hand/left") ? XR_HAND_LEFT_EXT : XR_HAND_RIGHT_EXT;
+        }
+
+        // The input sources bound to an action in the current interaction profile, filtered by the subaction path.
+        std::vector<std::string> BoundInputs(uint64_t action, XrPath subactionPath) const {
+            const std::string subactionPrefix = subactionPath != XR_NULL_PATH ? PathToString(subactionPath) + "/" : std::string();
+            std::vector<std::string> inputs;
+            for (const auto& [boundAction, binding] : Bindings) {
+                if (boundAction == action && StartsWith(binding, subactionPrefix)) {
+                    inputs.push_back(binding);
+                }
+            }
+            return inputs;
+        }
+
+        // Pose of a space in the LOCAL reference space, or nullopt if the space is not tracked.
+        std::optional<XrPosef> SpacePose(const Space& space, XrTime time) const {
+            if (space.Action == 0) {
+                return xr::math::Pose::Multiply(space.PoseInSpace, ReferenceSpacePose(space.ReferenceSpaceType, time));
+            }
+            if (!IsFocused() || BoundInputs(space.Action, space.SubactionPath).empty()) {
+                return std::nullopt;
+            }
+            return xr::math::Pose::Multiply(space.PoseInSpace, Options.HandPose(ActionHand(space), time));
+        }
+
+        float SyncedInput(const std::string& path) const {
+            const auto it = SyncedInputs.find(path);
+            return it != SyncedInputs.end() ? it->second : 0.0f;
+        }
+
+        XrTime InputChangeTime(const std::string& path) const {
+            const auto it = InputChangeTimes.find(path);
+            return it != InputChangeTimes.end() ? it->second : 0;
+        }
+
+        void UpdateSceneObjects(SceneObserver& observer, XrTime time) const {
+            const uint32_t objectCount = Options.SceneObjectCount;
+            if (observer.Objects.size() != objectCount) {
+                observer.Objects.resize(objectCount);
+                for (uint32_t i = 0; i < objectCount; i++) {
+                    observer.Objects[i] = MakeSceneObject(i, objectCount, Options.FloorHeight);
+                    observer.Objects[i].UpdateTime = time;
+                }
+            } else if (objectCount > 0) {
+                // Nudge a window of objects back and forth, as a runtime refines what it has seen.
+                const uint32_t updateCount = std::min(Options.SceneObjectsUpdatedPerCompute, objectCount);
+                const float offset = (observer.ComputeCount % 2 == 0 ? 1.0f : -1.0f) * 0.01f;
+                for (uint32_t i = 0; i < updateCount; i++) {
+                    SceneObjectState& object = observer.Objects[(observer.ComputeCount * updateCount + i) % objectCount];
+                    object.Pose.position.y += offset;
+                    object.UpdateTime = time;
+                }
+            }
+        }
+    };
+
+    Runtime* g_runtime = nullptr;
+
+    // Runs a function of the runtime under its lock.
+    template <typename TFunction>
+    XrResult Call(TFunction&& function) {
+        if (g_runtime == nullptr) {
+            return XR_ERROR_RUNTIME_FAILURE;
+        }
+        try {
+            std::scoped_lock lock(g_runtime->Mutex);
+            return function(*g_runtime);
+        } catch (const std::bad_alloc&) {
+            return XR_ERROR_OUT_OF_MEMORY;
+        } catch (...) {
+            return XR_ERROR_RUNTIME_FAILURE;
+        }
+    }
+
+    XrResult XRAPI_CALL MockGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
+
+    XrResult XRAPI_CALL MockEnumerateApiLayerProperties(uint32_t, uint32_t* propertyCountOutput, XrApiLayerProperties*) {
+        if (propertyCountOutput == nullptr) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        *propertyCountOutput = 0;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL MockEnumerateInstanceExtensionProperties(const char* layerName,
+                                                                 uint32_t propertyCapacityInput,
+                                                                 uint32_t* propertyCountOutput,
+                                                                 XrExtensionProperties* properties) {
+        return Call([&](Runtime& runtime) {
+            if (layerName != nullptr) {
+                return XR_ERROR_API_LAYER_NOT_PRESENT;
+            }
+            std::vector<XrExtensionProperties> extensions;
+            for (const std::string& extension : runtime.Options.Extensions) {
+                XrExtensionProperties& extensionProperties = extensions.emplace_back(XrExtensionProperties{XR_TYPE_EXTENSION_PROPERTIES});
+                CopyString(extensionProperties.extensionName, XR_MAX_EXTENSION_NAME_SIZE, extension);
+                extensionProperties.extensionVersion = 1;
+            }
+            return CopyArray(propertyCapacityInput, propertyCountOutput, properties, extensions.data(), extensions.size());
+        });
+    }
+
+    XrResult XRAPI_CALL MockCreateInstance(const XrInstanceCreateInfo* createInfo, XrInstance* instance) {
+        return Call([&](Runtime& runtime) {
+            if (runtime.Instance != 0) {
+                return XR_ERROR_LIMIT_REACHED;
+            }
+            if (createInfo->enabledApiLayerCount > 0) {
+                return XR_ERROR_API_LAYER_NOT_PRESENT;
+            }
+
+            std::vector<std::string> enabledExtensions;
+            for (uint32_t i = 0; i < createInfo->enabledExtensionCount; i++) {
+                const std::string extension = createInfo->enabledExtensionNames[i];
+                if (std::find(runtime.Options.Extensions.begin(), runtime.Options.Extensions.end(), extension) ==
+                    runtime.Options.Extensions.end()) {
+                    return XR_ERROR_EXTENSION_NOT_PRESENT;
+                }
+                enabledExtensions.push_back(extension);
+            }
+
+            runtime.EnabledExtensions = std::move(enabledExtensions);
+            runtime.Instance = runtime.NextHandleId++;
+            *instance = ToHandle<XrInstance>(runtime.Instance);
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockDestroyInstance(XrInstance instance) {
+        return Call([&](Runtime& runtime) {
+            if (runtime.Instance == 0 || ToId(instance) != runtime.Instance) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            // Destroying the instance destroys all of its child handles.
+            runtime.Instance = 0;
+            runtime.Session = 0;
+            runtime.SessionRunning = false;
+            runtime.EnabledExtensions.clear();
+            runtime.Events.clear();
+            runtime.ActionSets.clear();
+            runtime.Actions.clear();
+            runtime.SuggestedBindings.clear();
+            runtime.Bindings.clear();
+            runtime.InteractionProfile.clear();
+            runtime.Spaces.clear();
+            runtime.Swapchains.clear();
+            runtime.HandTrackers.clear();
+            runtime.SceneObservers.clear();
+            runtime.Scenes.clear();
+#ifdef XR_USE_GRAPHICS_API_D3D11
+            runtime.Device = nullptr;
+#endif
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockGetInstanceProperties(XrInstance, XrInstanceProperties* instanceProperties) {
+        instanceProperties->runtimeVersion = XR_MAKE_VERSION(1, 0, 0);
+        CopyString(instanceProperties->runtimeName, XR_MAX_RUNTIME_NAME_SIZE, "XrMockRuntime");
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL MockPollEvent(XrInstance, XrEventDataBuffer* eventData) {
+        return Call([&](Runtime& runtime) {
+            if (runtime.Events.empty()) {
+                return XR_EVENT_UNAVAILABLE;
+            }
+            *eventData = runtime.Events.front();
+            runtime.Events.pop_front();
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockResultToString(XrInstance, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE]) {
+#define XR_MOCK_ENUM_CASE_STR(name, val) \
+    case name:                           \
+        CopyString(buffer, XR_MAX_RESULT_STRING_SIZE, #name); \
+        return XR_SUCCESS;
+        switch (value) {
+            XR_LIST_ENUM_XrResult(XR_MOCK_ENUM_CASE_STR);
+        default:
+            CopyString(buffer, XR_MAX_RESULT_STRING_SIZE, std::to_string(value));
+            return XR_SUCCESS;
+        }
+#undef XR_MOCK_ENUM_CASE_STR
+    }
+
+    XrResult XRAPI_CALL MockStructureTypeToString(XrInstance, XrStructureType value, char buffer[XR_MAX_STRUCTURE_NAME_SIZE]) {
+#define XR_MOCK_ENUM_CASE_STR(name, val) \
+    case name:                           \
+        CopyString(buffer, XR_MAX_STRUCTURE_NAME_SIZE, #name); \
+        return XR_SUCCESS;
+        switch (value) {
+            XR_LIST_ENUM_XrStructureType(XR_MOCK_ENUM_CASE_STR);
+        default:
+            CopyString(buffer, XR_MAX_STRUCTURE_NAME_SIZE, std::to_string(value));
+            return XR_SUCCESS;
+        }
+#undef XR_MOCK_ENUM_CASE_STR
+    }
+
+    XrResult XRAPI_CALL MockGetSystem(XrInstance, const XrSystemGetInfo* getInfo, XrSystemId* systemId) {
+        if (getInfo->formFactor != XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY) {
+            return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+        }
+        *systemId = MockSystemId;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL MockGetSystemProperties(XrInstance, XrSystemId systemId, XrSystemProperties* properties) {
+        return Call([&](Runtime& runtime) {
+            if (systemId != MockSystemId) {
+                return XR_ERROR_SYSTEM_INVALID;
+            }
+            properties->systemId = MockSystemId;
+            properties->vendorId = 0;
+            CopyString(properties->systemName, XR_MAX_SYSTEM_NAME_SIZE, "Mock head-mounted display");
+            properties->graphicsProperties = {4096, 4096, XR_MIN_COMPOSITION_LAYERS_SUPPORTED};
+            properties->trackingProperties = {XR_TRUE, XR_TRUE};
+
+            if (auto* handTracking = FindChained<XrSystemHandTrackingPropertiesEXT>(properties->next,
+                                                                                    XR_TYPE_SYSTEM_HAND_TRACKING_PROPERTIES_EXT)) {
+                handTracking->supportsHandTracking = runtime.IsExtensionEnabled(XR_EXT_HAND_TRACKING_EXTENSION_NAME);
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockEnumerateEnvironmentBlendModes(XrInstance,
+                                                           XrSystemId,
+                                                           XrViewConfigurationType viewConfigurationType,
+                                                           uint32_t environmentBlendModeCapacityInput,
+                                                           uint32_t* environmentBlendModeCountOutput,
+                                                           XrEnvironmentBlendMode* environmentBlendModes) {
+        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+            return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+        }
+        constexpr XrEnvironmentBlendMode BlendModes[] = {XR_ENVIRONMENT_BLEND_MODE_OPAQUE};
+        return CopyArray(
+            environmentBlendModeCapacityInput, environmentBlendModeCountOutput, environmentBlendModes, BlendModes, std::size(BlendModes));
+    }
+
+    XrResult XRAPI_CALL MockEnumerateViewConfigurations(XrInstance,
+                                                        XrSystemId,
+                                                        uint32_t viewConfigurationTypeCapacityInput,
+                                                        uint32_t* viewConfigurationTypeCountOutput,
+                                                        XrViewConfigurationType* viewConfigurationTypes) {
+        constexpr XrViewConfigurationType Types[] = {XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO};
+        return CopyArray(
+            viewConfigurationTypeCapacityInput, viewConfigurationTypeCountOutput, viewConfigurationTypes, Types, std::size(Types));
+    }
+
+    XrResult XRAPI_CALL MockGetViewConfigurationProperties(XrInstance,
+                                                           XrSystemId,
+                                                           XrViewConfigurationType viewConfigurationType,
+                                                           XrViewConfigurationProperties* configurationProperties) {
+        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+            return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+        }
+        configurationProperties->viewConfigurationType = viewConfigurationType;
+        configurationProperties->fovMutable = XR_TRUE;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL MockEnumerateViewConfigurationViews(XrInstance,
+                                                            XrSystemId,
+                                                            XrViewConfigurationType viewConfigurationType,
+                                                            uint32_t viewCapacityInput,
+                                                            uint32_t* viewCountOutput,
+                                                            XrViewConfigurationView* views) {
+        return Call([&](Runtime& runtime) {
+            if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+                return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+            }
+            const XrExtent2Di size = runtime.Options.RecommendedImageSize;
+            XrViewConfigurationView view{XR_TYPE_VIEW_CONFIGURATION_VIEW};
+            view.recommendedImageRectWidth = static_cast<uint32_t>(size.width);
+            view.recommendedImageRectHeight = static_cast<uint32_t>(size.height);
+            view.maxImageRectWidth = static_cast<uint32_t>(size.width * 2);
+            view.maxImageRectHeight = static_cast<uint32_t>(size.height * 2);
+            view.recommendedSwapchainSampleCount = 1;
+            view.maxSwapchainSampleCount = 4;
+            const XrViewConfigurationView stereoViews[] = {view, view};
+            return CopyArray(viewCapacityInput, viewCountOutput, views, stereoViews, std::size(stereoViews));
+        });
+    }
+
+    XrResult XRAPI_CALL MockCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) {
+        return Call([&](Runtime& runtime) {
+            if (ToId(instance) != runtime.Instance) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (createInfo->systemId != MockSystemId) {
+                return XR_ERROR_SYSTEM_INVALID;
+            }
+            if (runtime.Session != 0) {
+                return XR_ERROR_LIMIT_REACHED;
+            }
+
+#ifdef XR_USE_GRAPHICS_API_D3D11
+            if (auto* binding = FindChained<XrGraphicsBindingD3D11KHR>(createInfo->next, XR_TYPE_GRAPHICS_BINDING_D3D11_KHR)) {
+                runtime.Device.copy_from(binding->device);
+            }
+#endif
+            runtime.Session = runtime.NextHandleId++;
+            runtime.SessionRunning = false;
+            runtime.ExitRequested = false;
+            runtime.WaitFrameCount = runtime.BeginFrameCount = 0;
+            runtime.FrameInProgress = false;
+            runtime.QueueSessionState(XR_SESSION_STATE_IDLE);
+            runtime.QueueSessionState(XR_SESSION_STATE_READY);
+            *session = ToHandle<XrSession>(runtime.Session);
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockDestroySession(XrSession session) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            runtime.Session = 0;
+            runtime.SessionRunning = false;
+            runtime.SessionState = XR_SESSION_STATE_UNKNOWN;
+            runtime.Spaces.clear();
+            runtime.Swapchains.clear();
+            runtime.HandTrackers.clear();
+            runtime.SceneObservers.clear();
+            runtime.Scenes.clear();
+            runtime.FrameBegun.notify_all();
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (beginInfo->primaryViewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+                return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+            }
+            if (runtime.SessionRunning) {
+                return XR_ERROR_SESSION_RUNNING;
+            }
+            if (runtime.SessionState != XR_SESSION_STATE_READY) {
+                return XR_ERROR_SESSION_NOT_READY;
+            }
+            runtime.SessionRunning = true;
+            runtime.QueueSessionState(XR_SESSION_STATE_SYNCHRONIZED);
+            runtime.QueueSessionState(XR_SESSION_STATE_VISIBLE);
+            runtime.QueueSessionState(XR_SESSION_STATE_FOCUSED);
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockRequestExitSession(XrSession session) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (!runtime.SessionRunning) {
+                return XR_ERROR_SESSION_NOT_RUNNING;
+            }
+            if (!runtime.ExitRequested) {
+                runtime.ExitRequested = true;
+                if (runtime.SessionState == XR_SESSION_STATE_FOCUSED) {
+                    runtime.QueueSessionState(XR_SESSION_STATE_VISIBLE);
+                }
+                runtime.QueueSessionState(XR_SESSION_STATE_SYNCHRONIZED);
+                runtime.QueueSessionState(XR_SESSION_STATE_STOPPING);
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockEndSession(XrSession session) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (!runtime.SessionRunning) {
+                return XR_ERROR_SESSION_NOT_RUNNING;
+            }
+            if (runtime.SessionState != XR_SESSION_STATE_STOPPING) {
+                return XR_ERROR_SESSION_NOT_STOPPING;
+            }
+            runtime.SessionRunning = false;
+            runtime.FrameInProgress = false;
+            runtime.WaitFrameCount = runtime.BeginFrameCount = 0;
+            runtime.QueueSessionState(XR_SESSION_STATE_IDLE);
+            if (runtime.ExitRequested) {
+                runtime.QueueSessionState(XR_SESSION_STATE_EXITING);
+            }
+            runtime.FrameBegun.notify_all();
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockWaitFrame(XrSession session, const XrFrameWaitInfo*, XrFrameState* frameState) {
+        if (g_runtime == nullptr) {
+            return XR_ERROR_RUNTIME_FAILURE;
+        }
+        Runtime& runtime = *g_runtime;
+        std::unique_lock lock(runtime.Mutex);
+        if (!runtime.IsValidSession(session)) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        // Like a real runtime, block until the previous frame was begun, so the app cannot run ahead of its rendering.
+        runtime.FrameBegun.wait(lock, [&] {
+            return !runtime.SessionRunning || !runtime.IsValidSession(session) || runtime.WaitFrameCount == runtime.BeginFrameCount;
+        });
+        if (!runtime.IsValidSession(session)) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        if (!runtime.SessionRunning) {
+            return XR_ERROR_SESSION_NOT_RUNNING;
+        }
+
+        const XrDuration period = runtime.Options.FramePeriod.count();
+        XrTime frameTime;
+        if (runtime.Options.PaceFrames) {
+            frameTime = std::max(runtime.Now(), runtime.LastFrameTime + period);
+        } else {
+            frameTime = runtime.VirtualTime += period;
+        }
+        runtime.LastFrameTime = frameTime;
+        runtime.WaitFrameCount++;
+
+        frameState->predictedDisplayTime = frameTime + period;
+        frameState->predictedDisplayPeriod = period;
+        frameState->shouldRender =
+            runtime.SessionState == XR_SESSION_STATE_VISIBLE || runtime.SessionState == XR_SESSION_STATE_FOCUSED;
+
+        if (runtime.Options.PaceFrames) {
+            lock.unlock();
+            std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(frameTime)));
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL MockBeginFrame(XrSession session, const XrFrameBeginInfo*) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (!runtime.SessionRunning) {
+                return XR_ERROR_SESSION_NOT_RUNNING;
+            }
+            if (runtime.BeginFrameCount == runtime.WaitFrameCount) {
+                return XR_ERROR_CALL_ORDER_INVALID;
+            }
+            const bool discarded = runtime.FrameInProgress;
+            runtime.FrameInProgress = true;
+            runtime.BeginFrameCount++;
+            runtime.FrameBegun.notify_all();
+            return discarded ? XR_FRAME_DISCARDED : XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (!runtime.SessionRunning) {
+                return XR_ERROR_SESSION_NOT_RUNNING;
+            }
+            if (!runtime.FrameInProgress) {
+                return XR_ERROR_CALL_ORDER_INVALID;
+            }
+            if (frameEndInfo->layerCount > XR_MIN_COMPOSITION_LAYERS_SUPPORTED) {
+                return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+            }
+            runtime.FrameInProgress = false;
+            runtime.EndFrameCount++;
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockEnumerateReferenceSpaces(XrSession session,
+                                                     uint32_t spaceCapacityInput,
+                                                     uint32_t* spaceCountOutput,
+                                                     XrReferenceSpaceType* spaces) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            std::vector<XrReferenceSpaceType> types = {
+                XR_REFERENCE_SPACE_TYPE_VIEW, XR_REFERENCE_SPACE_TYPE_LOCAL, XR_REFERENCE_SPACE_TYPE_STAGE};
+            if (runtime.IsExtensionEnabled(XR_MSFT_UNBOUNDED_REFERENCE_SPACE_EXTENSION_NAME)) {
+                types.push_back(XR_REFERENCE_SPACE_TYPE_UNBOUNDED_MSFT);
+            }
+            return CopyArray(spaceCapacityInput, spaceCountOutput, spaces, types.data(), types.size());
+        });
+    }
+
+    XrResult XRAPI_CALL MockCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateInfo* createInfo, XrSpace* space) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            switch (createInfo->referenceSpaceType) {
+            case XR_REFERENCE_SPACE_TYPE_VIEW:
+            case XR_REFERENCE_SPACE_TYPE_LOCAL:
+            case XR_REFERENCE_SPACE_TYPE_STAGE:
+                break;
+            case XR_REFERENCE_SPACE_TYPE_UNBOUNDED_MSFT:
+                if (runtime.IsExtensionEnabled(XR_MSFT_UNBOUNDED_REFERENCE_SPACE_EXTENSION_NAME)) {
+                    break;
+                }
+                [[fallthrough]];
+            default:
+                return XR_ERROR_REFERENCE_SPACE_UNSUPPORTED;
+            }
+
+            *space = runtime.NewHandle<XrSpace>();
+            runtime.Spaces[ToId(*space)] = Space{createInfo->referenceSpaceType, 0, XR_NULL_PATH, createInfo->poseInReferenceSpace};
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockGetReferenceSpaceBoundsRect(XrSession session, XrReferenceSpaceType referenceSpaceType, XrExtent2Df* bounds) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (referenceSpaceType == XR_REFERENCE_SPACE_TYPE_STAGE) {
+                *bounds = {3.0f, 3.0f};
+                return XR_SUCCESS;
+            }
+            *bounds = {0, 0};
+            return XR_SPACE_BOUNDS_UNAVAILABLE;
+        });
+    }
+
+    XrResult XRAPI_CALL MockCreateActionSpace(XrSession session, const XrActionSpaceCreateInfo* createInfo, XrSpace* space) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            const auto action = runtime.Actions.find(ToId(createInfo->action));
+            if (action == runtime.Actions.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (action->second.Type != XR_ACTION_TYPE_POSE_INPUT) {
+                return XR_ERROR_ACTION_TYPE_MISMATCH;
+            }
+
+            *space = runtime.NewHandle<XrSpace>();
+            runtime.Spaces[ToId(*space)] =
+                Space{XR_REFERENCE_SPACE_TYPE_LOCAL, action->first, createInfo->subactionPath, createInfo->poseInActionSpace};
+            return XR_SUCCESS;
+        });
+    }
+
+    // Velocity of a pose relative to a base pose by finite differences. Both are functions of time returning an optional pose.
+    template <typename TSpacePose, typename TBasePose>
+    void LocateVelocity(TSpacePose&& spacePoseAt, TBasePose&& basePoseAt, XrTime time, XrSpaceVelocity& velocity) {
+        const XrTime previousTime = time - VelocityTimeDelta.count();
+        const std::optional<XrPosef> spacePose = spacePoseAt(time);
+        const std::optional<XrPosef> previousSpacePose = spacePoseAt(previousTime);
+        const std::optional<XrPosef> basePose = basePoseAt(time);
+        const std::optional<XrPosef> previousBasePose = basePoseAt(previousTime);
+        velocity.velocityFlags = 0;
+        if (!spacePose || !previousSpacePose || !basePose || !previousBasePose) {
+            return;
+        }
+
+        using namespace DirectX;
+        const XrPosef pose = xr::math::Pose::Multiply(*spacePose, xr::math::Pose::Invert(*basePose));
+        const XrPosef previousPose = xr::math::Pose::Multiply(*previousSpacePose, xr::math::Pose::Invert(*previousBasePose));
+        const float deltaSeconds = std::chrono::duration<float>(VelocityTimeDelta).count();
+
+        xr::math::StoreXrVector3(&velocity.linearVelocity,
+                                 (xr::math::LoadXrVector3(pose.position) - xr::math::LoadXrVector3(previousPose.position)) / deltaSeconds);
+
+        const XMVECTOR rotation = XMQuaternionMultiply(XMQuaternionInverse(xr::math::LoadXrQuaternion(previousPose.orientation)),
+                                                       xr::math::LoadXrQuaternion(pose.orientation));
+        XMVECTOR axis;
+        float angle;
+        XMQuaternionToAxisAngle(&axis, &angle, rotation);
+        if (angle > XM_PI) {
+            angle -= XM_2PI;
+        }
+        xr::math::StoreXrVector3(&velocity.angularVelocity,
+                                 angle == 0 ? XMVectorZero() : XMVector3Normalize(axis) * (angle / deltaSeconds));
+        velocity.velocityFlags = XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+    }
+
+    XrResult XRAPI_CALL MockLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.Spaces.find(ToId(space));
+            const auto baseIt = runtime.Spaces.find(ToId(baseSpace));
+            if (it == runtime.Spaces.end() || baseIt == runtime.Spaces.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (time <= 0) {
+                return XR_ERROR_TIME_INVALID;
+            }
+
+            const auto spacePose = runtime.SpacePose(it->second, time);
+            const auto basePose = runtime.SpacePose(baseIt->second, time);
+            if (spacePose && basePose) {
+                location->pose = xr::math::Pose::Multiply(*spacePose, xr::math::Pose::Invert(*basePose));
+                location->locationFlags = TrackedLocationFlags;
+            } else {
+                location->pose = xr::math::Pose::Identity();
+                location->locationFlags = 0;
+            }
+
+            if (auto* velocity = FindChained<XrSpaceVelocity>(location->next, XR_TYPE_SPACE_VELOCITY)) {
+                LocateVelocity([&](XrTime t) { return runtime.SpacePose(it->second, t); },
+                               [&](XrTime t) { return runtime.SpacePose(baseIt->second, t); },
+                               time,
+                               *velocity);
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockDestroySpace(XrSpace space) {
+        return Call([&](Runtime& runtime) { return runtime.Spaces.erase(ToId(space)) > 0 ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID; });
+    }
+
+    XrResult XRAPI_CALL MockLocateViews(XrSession session,
+                                        const XrViewLocateInfo* viewLocateInfo,
+                                        XrViewState* viewState,
+                                        uint32_t viewCapacityInput,
+                                        uint32_t* viewCountOutput,
+                                        XrView* views) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (viewLocateInfo->viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+                return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+            }
+            const auto baseSpace = runtime.Spaces.find(ToId(viewLocateInfo->space));
+            if (baseSpace == runtime.Spaces.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+
+            const XrPosef headPose = runtime.Options.HeadPose(viewLocateInfo->displayTime);
+            const auto basePose = runtime.SpacePose(baseSpace->second, viewLocateInfo->displayTime);
+            const float halfIpd = runtime.Options.InterpupillaryDistance / 2;
+
+            XrView stereoViews[2];
+            for (uint32_t i = 0; i < 2; i++) {
+                const XrPosef eyeInHead = xr::math::Pose::Translation({i == 0 ? -halfIpd : halfIpd, 0, 0});
+                const XrPosef eyePose = xr::math::Pose::Multiply(eyeInHead, headPose);
+                stereoViews[i] = XrView{XR_TYPE_VIEW};
+                stereoViews[i].pose = basePose ? xr::math::Pose::Multiply(eyePose, xr::math::Pose::Invert(*basePose)) : eyePose;
+                stereoViews[i].fov = runtime.Options.Fov;
+            }
+
+            viewState->viewStateFlags = basePose ? XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_VALID_BIT |
+                                                       XR_VIEW_STATE_POSITION_TRACKED_BIT | XR_VIEW_STATE_ORIENTATION_TRACKED_BIT
+                                                 : 0;
+            if (viewCountOutput == nullptr) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+            *viewCountOutput = 2;
+            if (viewCapacityInput == 0) {
+                return XR_SUCCESS;
+            }
+            if (viewCapacityInput < 2) {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+            for (uint32_t i = 0; i < 2; i++) {
+                views[i].pose = stereoViews[i].pose;
+                views[i].fov = stereoViews[i].fov;
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockEnumerateSwapchainFormats(XrSession session,
+                                                      uint32_t formatCapacityInput,
+                                                      uint32_t* formatCountOutput,
+                                                      int64_t* formats) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            const std::vector<int64_t>& supportedFormats = runtime.Options.SwapchainFormats;
+            return CopyArray(formatCapacityInput, formatCountOutput, formats, supportedFormats.data(), supportedFormats.size());
+        });
+    }
+
+#ifdef XR_USE_GRAPHICS_API_D3D11
+    std::vector<winrt::com_ptr<ID3D11Texture2D>> CreateSwapchainTextures(ID3D11Device* device,
+                                                                         const XrSwapchainCreateInfo& createInfo,
+                                                                         uint32_t imageCount) {
+        D3D11_TEXTURE2D_DESC desc{};
+        desc.Width = createInfo.width;
+        desc.Height = createInfo.height;
+        desc.MipLevels = createInfo.mipCount;
+        desc.ArraySize = createInfo.arraySize;
+        desc.Format = static_cast<DXGI_FORMAT>(createInfo.format);
+        desc.SampleDesc.Count = createInfo.sampleCount;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = (createInfo.usageFlags & XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) != 0
+                             ? D3D11_BIND_DEPTH_STENCIL
+                             : D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+        std::vector<winrt::com_ptr<ID3D11Texture2D>> textures(imageCount);
+        for (auto& texture : textures) {
+            CHECK_HRCMD(device->CreateTexture2D(&desc, nullptr, texture.put()));
+        }
+        return textures;
+    }
+#endif
+
+    XrResult XRAPI_CALL MockCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            const std::vector<int64_t>& formats = runtime.Options.SwapchainFormats;
+            if (std::find(formats.begin(), formats.end(), createInfo->format) == formats.end()) {
+                return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+            }
+
+            Swapchain newSwapchain{};
+            newSwapchain.CreateInfo = *createInfo;
+            newSwapchain.CreateInfo.next = nullptr;
+#ifdef XR_USE_GRAPHICS_API_D3D11
+            if (runtime.Device) {
+                newSwapchain.Textures = CreateSwapchainTextures(runtime.Device.get(), *createInfo, runtime.Options.SwapchainImageCount);
+            }
+#endif
+            *swapchain = runtime.NewHandle<XrSwapchain>();
+            runtime.Swapchains.emplace(ToId(*swapchain), std::move(newSwapchain));
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockDestroySwapchain(XrSwapchain swapchain) {
+        return Call([&](Runtime& runtime) { return runtime.Swapchains.erase(ToId(swapchain)) > 0 ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID; });
+    }
+
+    XrResult XRAPI_CALL MockEnumerateSwapchainImages(XrSwapchain swapchain,
+                                                     uint32_t imageCapacityInput,
+                                                     uint32_t* imageCountOutput,
+                                                     XrSwapchainImageBaseHeader* images) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.Swapchains.find(ToId(swapchain));
+            if (it == runtime.Swapchains.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            const uint32_t imageCount = runtime.Options.SwapchainImageCount;
+            *imageCountOutput = imageCount;
+            if (imageCapacityInput == 0) {
+                return XR_SUCCESS;
+            }
+            if (imageCapacityInput < imageCount) {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+
+            // With a null graphics binding, the images are left as the app initialized them.
+#ifdef XR_USE_GRAPHICS_API_D3D11
+            if (images->type == XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR && !it->second.Textures.empty()) {
+                auto* d3d11Images = reinterpret_cast<XrSwapchainImageD3D11KHR*>(images);
+                for (uint32_t i = 0; i < imageCount; i++) {
+                    d3d11Images[i].texture = it->second.Textures[i].get();
+                }
+            }
+#else
+            (void)images;
+#endif
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo*, uint32_t* index) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.Swapchains.find(ToId(swapchain));
+            if (it == runtime.Swapchains.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            Swapchain& acquired = it->second;
+            if (acquired.AcquiredImages.size() >= runtime.Options.SwapchainImageCount) {
+                return XR_ERROR_CALL_ORDER_INVALID;
+            }
+            *index = acquired.NextImage;
+            acquired.AcquiredImages.push_back(acquired.NextImage);
+            acquired.NextImage = (acquired.NextImage + 1) % runtime.Options.SwapchainImageCount;
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo*) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.Swapchains.find(ToId(swapchain));
+            if (it == runtime.Swapchains.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            return it->second.AcquiredImages.empty() ? XR_ERROR_CALL_ORDER_INVALID : XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo*) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.Swapchains.find(ToId(swapchain));
+            if (it == runtime.Swapchains.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (it->second.AcquiredImages.empty()) {
+                return XR_ERROR_CALL_ORDER_INVALID;
+            }
+            it->second.AcquiredImages.pop_front();
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockStringToPath(XrInstance, const char* pathString, XrPath* path) {
+        return Call([&](Runtime& runtime) {
+            if (pathString == nullptr || pathString[0] != '/') {
+                return XR_ERROR_PATH_FORMAT_INVALID;
+            }
+            *path = runtime.StringToPath(pathString);
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL
+    MockPathToString(XrInstance, XrPath path, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer) {
+        return Call([&](Runtime& runtime) {
+            if (path == XR_NULL_PATH || path >= runtime.Paths.size()) {
+                return XR_ERROR_PATH_INVALID;
+            }
+            return CopyString(bufferCapacityInput, bufferCountOutput, buffer, runtime.Paths[path]);
+        });
+    }
+
+    XrResult XRAPI_CALL MockCreateActionSet(XrInstance, const XrActionSetCreateInfo* createInfo, XrActionSet* actionSet) {
+        return Call([&](Runtime& runtime) {
+            *actionSet = runtime.NewHandle<XrActionSet>();
+            runtime.ActionSets[ToId(*actionSet)] = createInfo->actionSetName;
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockDestroyActionSet(XrActionSet actionSet) {
+        return Call([&](Runtime& runtime) {
+            if (runtime.ActionSets.erase(ToId(actionSet)) == 0) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            for (auto it = runtime.Actions.begin(); it != runtime.Actions.end();) {
+                it = it->second.ActionSet == ToId(actionSet) ? runtime.Actions.erase(it) : std::next(it);
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockCreateAction(XrActionSet actionSet, const XrActionCreateInfo* createInfo, XrAction* action) {
+        return Call([&](Runtime& runtime) {
+            if (runtime.ActionSets.count(ToId(actionSet)) == 0) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            *action = runtime.NewHandle<XrAction>();
+            runtime.Actions[ToId(*action)] =
+                Action{ToId(actionSet),
+                       createInfo->actionType,
+                       {createInfo->subactionPaths, createInfo->subactionPaths + createInfo->countSubactionPaths}};
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockDestroyAction(XrAction action) {
+        return Call([&](Runtime& runtime) { return runtime.Actions.erase(ToId(action)) > 0 ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID; });
+    }
+
+    XrResult XRAPI_CALL MockSuggestInteractionProfileBindings(XrInstance, const XrInteractionProfileSuggestedBinding* suggestedBindings) {
+        return Call([&](Runtime& runtime) {
+            std::vector<std::pair<uint64_t, std::string>> bindings;
+            for (uint32_t i = 0; i < suggestedBindings->countSuggestedBindings; i++) {
+                const XrActionSuggestedBinding& binding = suggestedBindings->suggestedBindings[i];
+                if (runtime.Actions.count(ToId(binding.action)) == 0) {
+                    return XR_ERROR_HANDLE_INVALID;
+                }
+                bindings.emplace_back(ToId(binding.action), runtime.PathToString(binding.binding));
+            }
+            runtime.SuggestedBindings[runtime.PathToString(suggestedBindings->interactionProfile)] = std::move(bindings);
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockAttachSessionActionSets(XrSession session, const XrSessionActionSetsAttachInfo*) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (!runtime.InteractionProfile.empty()) {
+                return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
+            }
+
+            auto profile = runtime.SuggestedBindings.find(runtime.Options.InteractionProfile);
+            if (profile == runtime.SuggestedBindings.end()) {
+                profile = runtime.SuggestedBindings.begin();
+            }
+            if (profile != runtime.SuggestedBindings.end()) {
+                runtime.InteractionProfile = profile->first;
+                runtime.Bindings = profile->second;
+
+                XrEventDataBuffer buffer{XR_TYPE_EVENT_DATA_BUFFER};
+                *reinterpret_cast<XrEventDataInteractionProfileChanged*>(&buffer) = {
+                    XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED, nullptr, session};
+                runtime.Events.push_back(buffer);
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockGetCurrentInteractionProfile(XrSession session,
+                                                         XrPath topLevelUserPath,
+                                                         XrInteractionProfileState* interactionProfile) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            const std::string prefix = runtime.PathToString(topLevelUserPath) + "/";
+            const bool bound = std::any_of(
+                runtime.Bindings.begin(), runtime.Bindings.end(), [&](const auto& binding) { return StartsWith(binding.second, prefix); });
+            interactionProfile->interactionProfile = bound ? runtime.StringToPath(runtime.InteractionProfile) : XR_NULL_PATH;
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockSyncActions(XrSession session, const XrActionsSyncInfo*) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (!runtime.IsFocused()) {
+                return XR_SESSION_NOT_FOCUSED;
+            }
+
+            const XrTime now = runtime.Now();
+            runtime.InputsChangedInLastSync.clear();
+            for (const auto& [path, value] : runtime.Inputs) {
+                if (runtime.SyncedInput(path) != value) {
+                    runtime.InputsChangedInLastSync.insert(path);
+                    runtime.InputChangeTimes[path] = now;
+                }
+            }
+            runtime.SyncedInputs = runtime.Inputs;
+            return XR_SUCCESS;
+        });
+    }
+
+    // Reads the state of an action from the inputs bound to it, as of the last xrSyncActions.
+    template <typename TState, typename TReadInput>
+    XrResult GetActionState(
+        XrSession session, const XrActionStateGetInfo* getInfo, XrActionType type, TState* state, TReadInput&& readInput) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            const auto action = runtime.Actions.find(ToId(getInfo->action));
+            if (action == runtime.Actions.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (action->second.Type != type) {
+                return XR_ERROR_ACTION_TYPE_MISMATCH;
+            }
+
+            const std::vector<std::string> inputs = runtime.BoundInputs(action->first, getInfo->subactionPath);
+            state->isActive = runtime.IsFocused() && !inputs.empty();
+            if constexpr (!std::is_same_v<TState, XrActionStatePose>) {
+                state->currentState = {};
+                state->changedSinceLastSync = XR_FALSE;
+                state->lastChangeTime = 0;
+                if (state->isActive) {
+                    for (const std::string& input : inputs) {
+                        readInput(runtime, input, state->currentState);
+                        state->changedSinceLastSync |= runtime.InputsChangedInLastSync.count(input) > 0;
+                        state->lastChangeTime = std::max(state->lastChangeTime, runtime.InputChangeTime(input));
+                    }
+                }
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockGetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateBoolean* state) {
+        return GetActionState(
+            session, getInfo, XR_ACTION_TYPE_BOOLEAN_INPUT, state, [](const Runtime& runtime, const std::string& input, XrBool32& value) {
+                value |= runtime.SyncedInput(input) > 0.5f;
+            });
+    }
+
+    XrResult XRAPI_CALL MockGetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state) {
+        return GetActionState(
+            session, getInfo, XR_ACTION_TYPE_FLOAT_INPUT, state, [](const Runtime& runtime, const std::string& input, float& value) {
+                const float inputValue = runtime.SyncedInput(input);
+                value = std::abs(inputValue) > std::abs(value) ? inputValue : value;
+            });
+    }
+
+    XrResult XRAPI_CALL MockGetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) {
+        const auto readInput = [](const Runtime& runtime, const std::string& input, XrVector2f& value) {
+            const XrVector2f inputValue{runtime.SyncedInput(input + "/x"), runtime.SyncedInput(input + "/y")};
+            if (inputValue.x * inputValue.x + inputValue.y * inputValue.y > value.x * value.x + value.y * value.y) {
+                value = inputValue;
+            }
+        };
+        return GetActionState(session, getInfo, XR_ACTION_TYPE_VECTOR2F_INPUT, state, readInput);
+    }
+
+    XrResult XRAPI_CALL MockGetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state) {
+        return GetActionState(session, getInfo, XR_ACTION_TYPE_POSE_INPUT, state, nullptr);
+    }
+
+    XrResult XRAPI_CALL MockEnumerateBoundSourcesForAction(XrSession session,
+                                                           const XrBoundSourcesForActionEnumerateInfo* enumerateInfo,
+                                                           uint32_t sourceCapacityInput,
+                                                           uint32_t* sourceCountOutput,
+                                                           XrPath* sources) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            std::vector<XrPath> boundSources;
+            for (const std::string& input : runtime.BoundInputs(ToId(enumerateInfo->action), XR_NULL_PATH)) {
+                boundSources.push_back(runtime.StringToPath(input));
+            }
+            return CopyArray(sourceCapacityInput, sourceCountOutput, sources, boundSources.data(), boundSources.size());
+        });
+    }
+
+    XrResult XRAPI_CALL MockGetInputSourceLocalizedName(XrSession session,
+                                                        const XrInputSourceLocalizedNameGetInfo* getInfo,
+                                                        uint32_t bufferCapacityInput,
+                                                        uint32_t* bufferCountOutput,
+                                                        char* buffer) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            return CopyString(bufferCapacityInput, bufferCountOutput, buffer, runtime.PathToString(getInfo->sourcePath));
+        });
+    }
+
+    XrResult XRAPI_CALL MockApplyHapticFeedback(XrSession, const XrHapticActionInfo*, const XrHapticBaseHeader*) {
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL MockStopHapticFeedback(XrSession, const XrHapticActionInfo*) {
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL MockCreateHandTracker(XrSession session,
+                                              const XrHandTrackerCreateInfoEXT* createInfo,
+                                              XrHandTrackerEXT* handTracker) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            *handTracker = runtime.NewHandle<XrHandTrackerEXT>();
+            runtime.HandTrackers[ToId(*handTracker)] = createInfo->hand;
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockDestroyHandTracker(XrHandTrackerEXT handTracker) {
+        return Call(
+            [&](Runtime& runtime) { return runtime.HandTrackers.erase(ToId(handTracker)) > 0 ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID; });
+    }
+
+    XrResult XRAPI_CALL MockLocateHandJoints(XrHandTrackerEXT handTracker,
+                                             const XrHandJointsLocateInfoEXT* locateInfo,
+                                             XrHandJointLocationsEXT* locations) {
+        return Call([&](Runtime& runtime) {
+            const auto tracker = runtime.HandTrackers.find(ToId(handTracker));
+            const auto baseSpace = runtime.Spaces.find(ToId(locateInfo->baseSpace));
+            if (tracker == runtime.HandTrackers.end() || baseSpace == runtime.Spaces.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (locations->jointCount != XR_HAND_JOINT_COUNT_EXT) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            const XrHandEXT hand = tracker->second;
+            const auto basePose = runtime.SpacePose(baseSpace->second, locateInfo->time);
+            locations->isActive = runtime.IsFocused() && basePose.has_value();
+
+            const XrPosef gripInBase =
+                basePose ? xr::math::Pose::Multiply(runtime.Options.HandPose(hand, locateInfo->time), xr::math::Pose::Invert(*basePose))
+                         : xr::math::Pose::Identity();
+            for (uint32_t joint = 0; joint < XR_HAND_JOINT_COUNT_EXT; joint++) {
+                XrHandJointLocationEXT& location = locations->jointLocations[joint];
+                location.pose = xr::math::Pose::Multiply(HandJointPoseInGrip(hand, joint), gripInBase);
+                location.radius = joint == XR_HAND_JOINT_PALM_EXT || joint == XR_HAND_JOINT_WRIST_EXT ? 0.02f : 0.008f;
+                location.locationFlags = locations->isActive ? TrackedLocationFlags : 0;
+            }
+
+            // The joints move rigidly with the grip.
+            if (auto* velocities = FindChained<XrHandJointVelocitiesEXT>(locations->next, XR_TYPE_HAND_JOINT_VELOCITIES_EXT)) {
+                XrSpaceVelocity gripVelocity{XR_TYPE_SPACE_VELOCITY};
+                LocateVelocity([&](XrTime t) { return std::optional<XrPosef>(runtime.Options.HandPose(hand, t)); },
+                               [&](XrTime t) { return runtime.SpacePose(baseSpace->second, t); },
+                               locateInfo->time,
+                               gripVelocity);
+                for (uint32_t joint = 0; joint < velocities->jointCount; joint++) {
+                    velocities->jointVelocities[joint] = {
+                        locations->isActive ? gripVelocity.velocityFlags : 0, gripVelocity.linearVelocity, gripVelocity.angularVelocity};
+                }
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockEnumerateSceneComputeFeatures(XrInstance,
+                                                          XrSystemId,
+                                                          uint32_t featureCapacityInput,
+                                                          uint32_t* featureCountOutput,
+                                                          XrSceneComputeFeatureMSFT* features) {
+        constexpr XrSceneComputeFeatureMSFT Features[] = {XR_SCENE_COMPUTE_FEATURE_PLANE_MSFT,
+                                                          XR_SCENE_COMPUTE_FEATURE_PLANE_MESH_MSFT,
+                                                          XR_SCENE_COMPUTE_FEATURE_VISUAL_MESH_MSFT,
+                                                          XR_SCENE_COMPUTE_FEATURE_COLLIDER_MESH_MSFT};
+        return CopyArray(featureCapacityInput, featureCountOutput, features, Features, std::size(Features));
+    }
+
+    XrResult XRAPI_CALL MockCreateSceneObserver(XrSession session,
+                                                const XrSceneObserverCreateInfoMSFT*,
+                                                XrSceneObserverMSFT* sceneObserver) {
+        return Call([&](Runtime& runtime) {
+            if (!runtime.IsValidSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            *sceneObserver = runtime.NewHandle<XrSceneObserverMSFT>();
+            runtime.SceneObservers[ToId(*sceneObserver)] = SceneObserver{};
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockDestroySceneObserver(XrSceneObserverMSFT sceneObserver) {
+        return Call([&](Runtime& runtime) {
+            return runtime.SceneObservers.erase(ToId(sceneObserver)) > 0 ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
+        });
+    }
+
+    XrResult XRAPI_CALL MockComputeNewScene(XrSceneObserverMSFT sceneObserver, const XrNewSceneComputeInfoMSFT* computeInfo) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.SceneObservers.find(ToId(sceneObserver));
+            if (it == runtime.SceneObservers.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            SceneObserver& observer = it->second;
+            if (observer.State == XR_SCENE_COMPUTE_STATE_UPDATING_MSFT) {
+                return XR_ERROR_COMPUTE_NEW_SCENE_NOT_COMPLETED_MSFT;
+            }
+
+            // The bounds of the compute are ignored, the synthetic scene is always computed as a whole.
+            observer.Features.assign(computeInfo->requestedFeatures, computeInfo->requestedFeatures + computeInfo->requestedFeatureCount);
+            observer.State = XR_SCENE_COMPUTE_STATE_UPDATING_MSFT;
+            observer.CompleteTime = runtime.Now() + runtime.Options.SceneComputeDuration.count();
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockGetSceneComputeState(XrSceneObserverMSFT sceneObserver, XrSceneComputeStateMSFT* state) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.SceneObservers.find(ToId(sceneObserver));
+            if (it == runtime.SceneObservers.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            SceneObserver& observer = it->second;
+            if (observer.State == XR_SCENE_COMPUTE_STATE_UPDATING_MSFT && runtime.Now() >= observer.CompleteTime) {
+                runtime.UpdateSceneObjects(observer, observer.CompleteTime);
+                observer.ComputeCount++;
+                observer.State = XR_SCENE_COMPUTE_STATE_COMPLETED_MSFT;
+            }
+            *state = observer.State;
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockCreateScene(XrSceneObserverMSFT sceneObserver, const XrSceneCreateInfoMSFT*, XrSceneMSFT* scene) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.SceneObservers.find(ToId(sceneObserver));
+            if (it == runtime.SceneObservers.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (it->second.State != XR_SCENE_COMPUTE_STATE_COMPLETED_MSFT) {
+                return XR_ERROR_COMPUTE_NEW_SCENE_NOT_COMPLETED_MSFT;
+            }
+            *scene = runtime.NewHandle<XrSceneMSFT>();
+            runtime.Scenes[ToId(*scene)] = Scene{it->second.Features, it->second.Objects};
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockDestroyScene(XrSceneMSFT scene) {
+        return Call([&](Runtime& runtime) { return runtime.Scenes.erase(ToId(scene)) > 0 ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID; });
+    }
+
+    XrResult XRAPI_CALL MockGetSceneComponents(XrSceneMSFT sceneHandle,
+                                               const XrSceneComponentsGetInfoMSFT* getInfo,
+                                               XrSceneComponentsMSFT* components) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.Scenes.find(ToId(sceneHandle));
+            if (it == runtime.Scenes.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            const Scene& scene = it->second;
+            const XrSceneComponentTypeMSFT type = getInfo->componentType;
+
+            const auto* parentFilter =
+                FindChained<XrSceneComponentParentFilterInfoMSFT>(getInfo->next, XR_TYPE_SCENE_COMPONENT_PARENT_FILTER_INFO_MSFT);
+            const auto* objectTypesFilter =
+                FindChained<XrSceneObjectTypesFilterInfoMSFT>(getInfo->next, XR_TYPE_SCENE_OBJECT_TYPES_FILTER_INFO_MSFT);
+            const auto* alignmentFilter =
+                FindChained<XrScenePlaneAlignmentFilterInfoMSFT>(getInfo->next, XR_TYPE_SCENE_PLANE_ALIGNMENT_FILTER_INFO_MSFT);
+
+            std::optional<uint32_t> parentIndex;
+            if (parentFilter != nullptr) {
+                XrSceneComponentTypeMSFT parentType;
+                uint32_t index;
+                if (!DecodeSceneComponentId(parentFilter->parentId, &parentType, &index) ||
+                    parentType != XR_SCENE_COMPONENT_TYPE_OBJECT_MSFT) {
+                    components->componentCountOutput = 0;
+                    return XR_SUCCESS;
+                }
+                parentIndex = index;
+            }
+
+            std::vector<uint32_t> objectIndices;
+            if (scene.HasComponents(type)) {
+                for (uint32_t i = 0; i < scene.Objects.size(); i++) {
+                    const SceneObjectState& object = scene.Objects[i];
+                    if (parentIndex && *parentIndex != i) {
+                        continue;
+                    }
+                    if (objectTypesFilter != nullptr &&
+                        !Contains(objectTypesFilter->objectTypes, objectTypesFilter->objectTypeCount, object.Type)) {
+                        continue;
+                    }
+                    if (alignmentFilter != nullptr && type == XR_SCENE_COMPONENT_TYPE_PLANE_MSFT &&
+                        !Contains(alignmentFilter->alignments, alignmentFilter->alignmentCount, PlaneAlignment(object.Type))) {
+                        continue;
+                    }
+                    objectIndices.push_back(i);
+                }
+            }
+
+            const uint32_t count = static_cast<uint32_t>(objectIndices.size());
+            components->componentCountOutput = count;
+            if (components->componentCapacityInput == 0) {
+                return XR_SUCCESS;
+            }
+            if (components->componentCapacityInput < count) {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+
+            auto* objects = FindChained<XrSceneObjectsMSFT>(components->next, XR_TYPE_SCENE_OBJECTS_MSFT);
+            auto* planes = FindChained<XrScenePlanesMSFT>(components->next, XR_TYPE_SCENE_PLANES_MSFT);
+            auto* meshes = FindChained<XrSceneMeshesMSFT>(components->next, XR_TYPE_SCENE_MESHES_MSFT);
+            const bool planeMeshes = scene.HasFeature(XR_SCENE_COMPUTE_FEATURE_PLANE_MESH_MSFT);
+            const uint32_t meshVertexCount = [&] {
+                const uint32_t cells = std::max(1u, static_cast<uint32_t>(std::sqrt(runtime.Options.SceneMeshTriangleCount / 2.0f)));
+                return (cells + 1) * (cells + 1);
+            }();
+
+            for (uint32_t i = 0; i < count; i++) {
+                const uint32_t objectIndex = objectIndices[i];
+                const SceneObjectState& object = scene.Objects[objectIndex];
+                components->components[i].componentType = type;
+                components->components[i].id = SceneComponentId(type, objectIndex);
+                components->components[i].parentId =
+                    type == XR_SCENE_COMPONENT_TYPE_OBJECT_MSFT ? XrUuidMSFT{}
+                                                                : SceneComponentId(XR_SCENE_COMPONENT_TYPE_OBJECT_MSFT, objectIndex);
+                components->components[i].updateTime = object.UpdateTime;
+
+                if (objects != nullptr && type == XR_SCENE_COMPONENT_TYPE_OBJECT_MSFT && i < objects->sceneObjectCount) {
+                    objects->sceneObjects[i].objectType = object.Type;
+                }
+                if (planes != nullptr && type == XR_SCENE_COMPONENT_TYPE_PLANE_MSFT && i < planes->scenePlaneCount) {
+                    XrScenePlaneMSFT& plane = planes->scenePlanes[i];
+                    plane.alignment = PlaneAlignment(object.Type);
+                    plane.size = object.Size;
+                    plane.meshBufferId = planeMeshes ? SceneMeshBufferId(type, objectIndex) : 0;
+                    plane.supportsIndicesUint16 = XR_TRUE;
+                }
+                if (meshes != nullptr &&
+                    (type == XR_SCENE_COMPONENT_TYPE_VISUAL_MESH_MSFT || type == XR_SCENE_COMPONENT_TYPE_COLLIDER_MESH_MSFT) &&
+                    i < meshes->sceneMeshCount) {
+                    meshes->sceneMeshes[i].meshBufferId = SceneMeshBufferId(type, objectIndex);
+                    meshes->sceneMeshes[i].supportsIndicesUint16 = meshVertexCount <= 65536;
+                }
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    XrResult XRAPI_CALL MockLocateSceneComponents(XrSceneMSFT sceneHandle,
+                                                  const XrSceneComponentsLocateInfoMSFT* locateInfo,
+                                                  XrSceneComponentLocationsMSFT* locations) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.Scenes.find(ToId(sceneHandle));
+            const auto baseSpace = runtime.Spaces.find(ToId(locateInfo->baseSpace));
+            if (it == runtime.Scenes.end() || baseSpace == runtime.Spaces.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            if (locations->locationCount != locateInfo->componentIdCount) {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+
+            const Scene& scene = it->second;
+            const auto basePose = runtime.SpacePose(baseSpace->second, locateInfo->time);
+            const XrPosef inverseBasePose = basePose ? xr::math::Pose::Invert(*basePose) : xr::math::Pose::Identity();
+            for (uint32_t i = 0; i < locateInfo->componentIdCount; i++) {
+                XrSceneComponentLocationMSFT& location = locations->locations[i];
+                XrSceneComponentTypeMSFT type;
+                uint32_t objectIndex;
+                if (basePose && DecodeSceneComponentId(locateInfo->componentIds[i], &type, &objectIndex) &&
+                    objectIndex < scene.Objects.size() && scene.HasComponents(type)) {
+                    location.pose = xr::math::Pose::Multiply(scene.Objects[objectIndex].Pose, inverseBasePose);
+                    location.flags = TrackedLocationFlags;
+                } else {
+                    location.pose = xr::math::Pose::Identity();
+                    location.flags = 0;
+                }
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+    template <typename TBuffer, typename TIndex>
+    XrResult CopyIndices(TBuffer* buffer, const std::vector<uint32_t>& indices) {
+        buffer->indexCountOutput = static_cast<uint32_t>(indices.size());
+        if (buffer->indexCapacityInput == 0) {
+            return XR_SUCCESS;
+        }
+        if (buffer->indexCapacityInput < indices.size()) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        std::transform(indices.begin(), indices.end(), buffer->indices, [](uint32_t index) { return static_cast<TIndex>(index); });
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL MockGetSceneMeshBuffers(XrSceneMSFT sceneHandle,
+                                                const XrSceneMeshBuffersGetInfoMSFT* getInfo,
+                                                XrSceneMeshBuffersMSFT* buffers) {
+        return Call([&](Runtime& runtime) {
+            const auto it = runtime.Scenes.find(ToId(sceneHandle));
+            if (it == runtime.Scenes.end()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            const Scene& scene = it->second;
+            const auto type = static_cast<XrSceneComponentTypeMSFT>(getInfo->meshBufferId >> 32);
+            const uint64_t objectId = getInfo->meshBufferId & 0xFFFFFFFF;
+            if (objectId == 0 || objectId > scene.Objects.size() || !scene.HasComponents(type) ||
+                (type == XR_SCENE_COMPONENT_TYPE_PLANE_MSFT && !scene.HasFeature(XR_SCENE_COMPUTE_FEATURE_PLANE_MESH_MSFT))) {
+                return XR_ERROR_SCENE_MESH_BUFFER_ID_INVALID_MSFT;
+            }
+
+            // Collider meshes are coarser than visual meshes.
+            const uint32_t triangleCount = type == XR_SCENE_COMPONENT_TYPE_COLLIDER_MESH_MSFT ? runtime.Options.SceneMeshTriangleCount / 4
+                                                                                             : runtime.Options.SceneMeshTriangleCount;
+            std::vector<XrVector3f> vertices;
+            std::vector<uint32_t> indices;
+            MakeSceneMesh(type, scene.Objects[objectId - 1], triangleCount, vertices, indices);
+
+            if (auto* vertexBuffer = FindChained<XrSceneMeshVertexBufferMSFT>(buffers->next, XR_TYPE_SCENE_MESH_VERTEX_BUFFER_MSFT)) {
+                const XrResult result = CopyArray(vertexBuffer->vertexCapacityInput,
+                                                  &vertexBuffer->vertexCountOutput,
+                                                  vertexBuffer->vertices,
+                                                  vertices.data(),
+                                                  vertices.size());
+                if (XR_FAILED(result)) {
+                    return result;
+                }
+            }
+            if (auto* indexBuffer = FindChained<XrSceneMeshIndicesUint32MSFT>(buffers->next, XR_TYPE_SCENE_MESH_INDICES_UINT32_MSFT)) {
+                const XrResult result = CopyIndices<XrSceneMeshIndicesUint32MSFT, uint32_t>(indexBuffer, indices);
+                if (XR_FAILED(result)) {
+                    return result;
+                }
+            }
+            if (auto* indexBuffer = FindChained<XrSceneMeshIndicesUint16MSFT>(buffers->next, XR_TYPE_SCENE_MESH_INDICES_UINT16_MSFT)) {
+                if (vertices.size() > 65536) {
+                    return XR_ERROR_VALIDATION_FAILURE;
+                }
+                const XrResult result = CopyIndices<XrSceneMeshIndicesUint16MSFT, uint16_t>(indexBuffer, indices);
+                if (XR_FAILED(result)) {
+                    return result;
+                }
+            }
+            return XR_SUCCESS;
+        });
+    }
+
+#ifdef XR_USE_GRAPHICS_API_D3D11
+    XrResult XRAPI_CALL MockGetD3D11GraphicsRequirements(XrInstance, XrSystemId systemId, XrGraphicsRequirementsD3D11KHR* requirements) {
+        if (systemId != MockSystemId) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+        // Render on the default adapter.
+        winrt::com_ptr<IDXGIFactory1> dxgiFactory;
+        winrt::com_ptr<IDXGIAdapter1> dxgiAdapter;
+        DXGI_ADAPTER_DESC1 adapterDesc;
+        if (FAILED(CreateDXGIFactory1(winrt::guid_of<IDXGIFactory1>(), dxgiFactory.put_void())) ||
+            FAILED(dxgiFactory->EnumAdapters1(0, dxgiAdapter.put())) || FAILED(dxgiAdapter->GetDesc1(&adapterDesc))) {
+            return XR_ERROR_RUNTIME_FAILURE;
+        }
+        requirements->adapterLuid = adapterDesc.AdapterLuid;
+        requirements->minFeatureLevel = D3D_FEATURE_LEVEL_11_0;
+        return XR_SUCCESS;
+    }
+#endif
+
+    // The functions the runtime provides, and the extension each of them belongs to.
+    // clang-format off
+#define XR_LIST_MOCK_CORE_FUNCTIONS(_)                          \
+    _(xrGetInstanceProcAddr, GetInstanceProcAddr)               \
+    _(xrEnumerateApiLayerProperties, EnumerateApiLayerProperties) \
+    _(xrEnumerateInstanceExtensionProperties, EnumerateInstanceExtensionProperties) \
+    _(xrCreateInstance, CreateInstance)                         \
+    _(xrDestroyInstance, DestroyInstance)                       \
+    _(xrGetInstanceProperties, GetInstanceProperties)           \
+    _(xrPollEvent, PollEvent)                                   \
+    _(xrResultToString, ResultToString)                         \
+    _(xrStructureTypeToString, StructureTypeToString)           \
+    _(xrGetSystem, GetSystem)                                   \
+    _(xrGetSystemProperties, GetSystemProperties)               \
+    _(xrEnumerateEnvironmentBlendModes, EnumerateEnvironmentBlendModes) \
+    _(xrCreateSession, CreateSession)                           \
+    _(xrDestroySession, DestroySession)                         \
+    _(xrEnumerateReferenceSpaces, EnumerateReferenceSpaces)     \
+    _(xrCreateReferenceSpace, CreateReferenceSpace)             \
+    _(xrGetReferenceSpaceBoundsRect, GetReferenceSpaceBoundsRect) \
+    _(xrCreateActionSpace, CreateActionSpace)                   \
+    _(xrLocateSpace, LocateSpace)                               \
+    _(xrDestroySpace, DestroySpace)                             \
+    _(xrEnumerateViewConfigurations, EnumerateViewConfigurations) \
+    _(xrGetViewConfigurationProperties, GetViewConfigurationProperties) \
+    _(xrEnumerateViewConfigurationViews, EnumerateViewConfigurationViews) \
+    _(xrEnumerateSwapchainFormats, EnumerateSwapchainFormats)   \
+    _(xrCreateSwapchain, CreateSwapchain)                       \
+    _(xrDestroySwapchain, DestroySwapchain)                     \
+    _(xrEnumerateSwapchainImages, EnumerateSwapchainImages)     \
+    _(xrAcquireSwapchainImage, AcquireSwapchainImage)           \
+    _(xrWaitSwapchainImage, WaitSwapchainImage)                 \
+    _(xrReleaseSwapchainImage, ReleaseSwapchainImage)           \
+    _(xrBeginSession, BeginSession)                             \
+    _(xrEndSession, EndSession)                                 \
+    _(xrRequestExitSession, RequestExitSession)                 \
+    _(xrWaitFrame, WaitFrame)                                   \
+    _(xrBeginFrame, BeginFrame)                                 \
+    _(xrEndFrame, EndFrame)                                     \
+    _(xrLocateViews, LocateViews)                               \
+    _(xrStringToPath, StringToPath)                             \
+    _(xrPathToString, PathToString)                             \
+    _(xrCreateActionSet, CreateActionSet)                       \
+    _(xrDestroyActionSet, DestroyActionSet)                     \
+    _(xrCreateAction, CreateAction)                             \
+    _(xrDestroyAction, DestroyAction)                           \
+    _(xrSuggestInteractionProfileBindings, SuggestInteractionProfileBindings) \
+    _(xrAttachSessionActionSets, AttachSessionActionSets)       \
+    _(xrGetCurrentInteractionProfile, GetCurrentInteractionProfile) \
+    _(xrGetActionStateBoolean, GetActionStateBoolean)           \
+    _(xrGetActionStateFloat, GetActionStateFloat)               \
+    _(xrGetActionStateVector2f, GetActionStateVector2f)         \
+    _(xrGetActionStatePose, GetActionStatePose)                 \
+    _(xrSyncActions, SyncActions)                               \
+    _(xrEnumerateBoundSourcesForAction, EnumerateBoundSourcesForAction) \
+    _(xrGetInputSourceLocalizedName, GetInputSourceLocalizedName) \
+    _(xrApplyHapticFeedback, ApplyHapticFeedback)               \
+    _(xrStopHapticFeedback, StopHapticFeedback)
+
+#define XR_LIST_MOCK_EXTENSION_FUNCTIONS(_)                                                     \
+    _(xrCreateHandTrackerEXT, CreateHandTracker, XR_EXT_HAND_TRACKING_EXTENSION_NAME)             \
+    _(xrDestroyHandTrackerEXT, DestroyHandTracker, XR_EXT_HAND_TRACKING_EXTENSION_NAME)           \
+    _(xrLocateHandJointsEXT, LocateHandJoints, XR_EXT_HAND_TRACKING_EXTENSION_NAME)               \
+    _(xrEnumerateSceneComputeFeaturesMSFT, EnumerateSceneComputeFeatures, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME) \
+    _(xrCreateSceneObserverMSFT, CreateSceneObserver, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME) \
+    _(xrDestroySceneObserverMSFT, DestroySceneObserver, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME) \
+    _(xrCreateSceneMSFT, CreateScene, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME)                 \
+    _(xrDestroySceneMSFT, DestroyScene, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME)               \
+    _(xrComputeNewSceneMSFT, ComputeNewScene, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME)         \
+    _(xrGetSceneComputeStateMSFT, GetSceneComputeState, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME) \
+    _(xrGetSceneComponentsMSFT, GetSceneComponents, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME)   \
+    _(xrLocateSceneComponentsMSFT, LocateSceneComponents, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME) \
+    _(xrGetSceneMeshBuffersMSFT, GetSceneMeshBuffers, XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME)
+    // clang-format on
+
+    struct MockFunction {
+        const char* Name;
+        PFN_xrVoidFunction Function;
+        const char* Extension; // Null for core functions.
+    };
+
+#define XR_MOCK_CORE_FUNCTION(function, name) {#function, reinterpret_cast<PFN_xrVoidFunction>(Mock##name), nullptr},
+#define XR_MOCK_EXTENSION_FUNCTION(function, name, extension) {#function, reinterpret_cast<PFN_xrVoidFunction>(Mock##name), extension},
+    const MockFunction MockFunctions[] = {
+        XR_LIST_MOCK_CORE_FUNCTIONS(XR_MOCK_CORE_FUNCTION) XR_LIST_MOCK_EXTENSION_FUNCTIONS(XR_MOCK_EXTENSION_FUNCTION)
+#ifdef XR_USE_GRAPHICS_API_D3D11
+            XR_MOCK_EXTENSION_FUNCTION(xrGetD3D11GraphicsRequirementsKHR, GetD3D11GraphicsRequirements, XR_KHR_D3D11_ENABLE_EXTENSION_NAME)
+#endif
+    };
+#undef XR_MOCK_CORE_FUNCTION
+#undef XR_MOCK_EXTENSION_FUNCTION
+
+    XrResult XRAPI_CALL MockGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
+        return Call([&](Runtime& runtime) {
+            *function = nullptr;
+
+            // Without an instance, only the functions needed to create one are available.
+            constexpr std::string_view GlobalFunctions[] = {
+                "xrGetInstanceProcAddr", "xrEnumerateApiLayerProperties", "xrEnumerateInstanceExtensionProperties", "xrCreateInstance"};
+            if (instance == XR_NULL_HANDLE) {
+                if (std::find(std::begin(GlobalFunctions), std::end(GlobalFunctions), name) == std::end(GlobalFunctions)) {
+                    return XR_ERROR_HANDLE_INVALID;
+                }
+            } else if (ToId(instance) != runtime.Instance) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+
+            for (const MockFunction& mockFunction : MockFunctions) {
+                if (std::strcmp(mockFunction.Name, name) == 0) {
+                    if (mockFunction.Extension != nullptr && !runtime.IsExtensionEnabled(mockFunction.Extension)) {
+                        return XR_ERROR_FUNCTION_UNSUPPORTED;
+                    }
+                    *function = mockFunction.Function;
+                    return XR_SUCCESS;
+                }
+            }
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        });
+    }
+} // namespace
+
+namespace sample {
+    XrMockRuntime::Options::Options() {
+        Extensions = {
+#ifdef XR_USE_GRAPHICS_API_D3D11
+            XR_KHR_D3D11_ENABLE_EXTENSION_NAME,
+#endif
+            XR_MND_HEADLESS_EXTENSION_NAME,
+            XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME,
+            XR_MSFT_UNBOUNDED_REFERENCE_SPACE_EXTENSION_NAME,
+            XR_EXT_WIN32_APPCONTAINER_COMPATIBLE_EXTENSION_NAME,
+            XR_EXT_HAND_TRACKING_EXTENSION_NAME,
+            XR_MSFT_SCENE_UNDERSTANDING_EXTENSION_NAME,
+        };
+
+        // DXGI_FORMAT values of the usual color and depth formats:
+        // R8G8B8A8_UNORM_SRGB, B8G8R8A8_UNORM_SRGB, R8G8B8A8_UNORM, B8G8R8A8_UNORM,
+        // D32_FLOAT, D32_FLOAT_S8X24_UINT, D24_UNORM_S8_UINT and D16_UNORM.
+        SwapchainFormats = {29, 91, 28, 87, 40, 20, 45, 55};
+
+        HeadPose = [](XrTime) { return xr::math::Pose::Identity(); };
+        HandPose = [](XrHandEXT hand, XrTime) {
+            return xr::math::Pose::Translation({hand == XR_HAND_LEFT_EXT ? -0.2f : 0.2f, -0.3f, -0.4f});
+        };
+    }
+
+    struct XrMockRuntime::Impl : Runtime {
+        using Runtime::Runtime;
+    };
+
+    XrMockRuntime::XrMockRuntime(Options options) {
+        if (g_runtime != nullptr) {
+            throw std::logic_error("Another mock runtime already exists.");
+        }
+        m_impl = std::make_unique<Impl>(std::move(options));
+        g_runtime = m_impl.get();
+    }
+
+    XrMockRuntime::~XrMockRuntime() {
+        g_runtime = nullptr;
+    }
+
+    PFN_xrGetInstanceProcAddr XrMockRuntime::GetInstanceProcAddr() const {
+        return MockGetInstanceProcAddr;
+    }
+
+    void XrMockRuntime::SetInput(const std::string& path, float value) {
+        std::scoped_lock lock(m_impl->Mutex);
+        m_impl->Inputs[path] = value;
+    }
+
+    uint64_t XrMockRuntime::FrameCount() const {
+        std::scoped_lock lock(m_impl->Mutex);
+        return m_impl->EndFrameCount;
+    }
+} // namespace sample
@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sample {
+
+    // An in-process OpenXR runtime that simulates a head-mounted display, so that an app can run its frame loop without
+    // a headset or an installed runtime, e.g. to benchmark the scene loop. Initialize the dispatch table with
+    // GetInstanceProcAddr() instead of the loader's xrGetInstanceProcAddr, and the app calls this runtime instead.
+    //
+    // The runtime has a single system with a primary stereo view configuration. It implements the core functions needed
+    // for the frame loop, reference and action spaces, actions and swapchains, as well as XR_EXT_hand_tracking and
+    // XR_MSFT_scene_understanding with a synthetic scene of configurable size. The graphics binding of the session is
+    // ignored and swapchain images are left null, unless the runtime is built with D3D11 and the session has a D3D11 binding.
+    // Only one mock runtime can exist at a time.
+    class XrMockRuntime {
+    public:
+        struct Options {
+            Options();
+
+            // The extensions the runtime offers. Functions of extensions that are not enabled are not provided.
+            std::vector<std::string> Extensions;
+
+            // xrWaitFrame returns once per frame period. Without pacing, it returns immediately and the runtime time
+            // advances by one frame period per frame, so that the app sees the same times on every run.
+            std::chrono::nanoseconds FramePeriod{std::chrono::nanoseconds(std::chrono::seconds(1)) / 90};
+            bool PaceFrames{true};
+
+            XrExtent2Di RecommendedImageSize{1440, 936};
+            uint32_t SwapchainImageCount{3};
+            std::vector<int64_t> SwapchainFormats;
+            XrFovf Fov{-0.8f, 0.8f, 0.75f, -0.75f};
+            float InterpupillaryDistance{0.063f};
+            float FloorHeight{1.6f};
+
+            // Poses of the head and of the grip of each hand in the LOCAL reference space at a given time.
+            // Hand joints are laid out around the grip pose. By default, the head is still and holds the hands in front of it.
+            std::function<XrPosef(XrTime)> HeadPose;
+            std::function<XrPosef(XrHandEXT, XrTime)> HandPose;
+
+            // Bindings of the interaction profile are used if the app suggested any, otherwise those of its first suggestion.
+            std::string InteractionProfile{"/interaction_profiles/khr/simple_controller"};
+
+            // The synthetic scene has this many objects laid out on a grid around the LOCAL space origin. Each object has a
+            // plane and a visual and a collider mesh, as far as the scene compute requested them.
+            uint32_t SceneObjectCount{64};
+            uint32_t SceneMeshTriangleCount{128};
+            // Each scene compute updates this many objects, in turn, so that apps can observe updated components.
+            uint32_t SceneObjectsUpdatedPerCompute{0};
+            std::chrono::nanoseconds SceneComputeDuration{std::chrono::milliseconds(100)};
+        };
+
+        explicit XrMockRuntime(Options options = {});
+        ~XrMockRuntime();
+
+        PFN_xrGetInstanceProcAddr GetInstanceProcAddr() const;
+
+        // Sets the value of an input source, e.g. "/user/hand/right/input/select/value", as read by the next xrSyncActions.
+        // Boolean actions are pressed above 0.5. Vector2f actions read the "/x" and "/y" components of their binding.
+        void SetInput(const std::string& path, float value);
+
+        // Number of frames the app ended with xrEndFrame.
+        uint64_t FrameCount() const;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+} // namespace sample
@@ -4,11 +4,14 @@
 #pragma once
 
 #include <pbr/PbrResources.h>
+#include <pbr/PbrRenderQueue.h>
 #include <XrUtility/XrString.h>
 #include <XrUtility/XrExtensionContext.h>
 #include <SampleShared/XrInstanceContext.h>
 #include <SampleShared/XrSystemContext.h>
 #include <SampleShared/XrSessionContext.h>
+#include "ControllerModelCache.h"
+#include "PrimaryEyeLocator.h"
 
 namespace engine {
 
@@ -42,6 +45,15 @@ namespace engine {
         const winrt::com_ptr<ID3D11DeviceContext> DeviceContext;
         const winrt::com_ptr<ID3D11Device> Device;
         Pbr::Resources PbrResources;
+
+        // Objects add their draws here while a scene renders. The projection layer submits them sorted by state after each pass.
+        Pbr::RenderQueue RenderQueue;
+
+        // Controller models loaded in this context, kept across session restarts and shared by all controller objects.
+        ControllerModelCache ControllerModels;
+
+        // The eye positions of the current frame, located for the first object that asks in a frame and shared with the others.
+        PrimaryEyeLocator PrimaryEyes;
     };
 
 } // namespace engine
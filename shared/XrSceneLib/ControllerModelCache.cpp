@@ -0,0 +1,166 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <fstream>
+#include "ControllerModelCache.h"
+
+using engine::ControllerModel;
+using engine::ControllerModelCache;
+
+std::shared_ptr<const ControllerModel> ControllerModelCache::Find(XrControllerModelKeyMSFT key) {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_models.find(key);
+    if (it == m_models.end() || it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return nullptr;
+    }
+
+    m_statistics.Hits++;
+    return it->second.get();
+}
+
+std::shared_ptr<const ControllerModel> ControllerModelCache::GetOrLoad(XrControllerModelKeyMSFT key, const LoadFunction& load) {
+    std::promise<std::shared_ptr<const ControllerModel>> promise;
+    std::optional<ModelFuture> cachedModel;
+    {
+        std::lock_guard lock(m_mutex);
+        const auto it = m_models.find(key);
+        if (it != m_models.end()) {
+            m_statistics.Hits++;
+            cachedModel = it->second;
+        } else {
+            m_statistics.Misses++;
+            m_models.emplace(key, promise.get_future().share());
+        }
+    }
+
+    // A model still being loaded by another caller is waited for outside the lock.
+    if (cachedModel) {
+        return cachedModel->get();
+    }
+
+    // Load without holding the lock, other keys can be looked up and loaded meanwhile.
+    std::shared_ptr<const ControllerModel> model;
+    try {
+        model = load(key);
+    } catch (...) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_models.erase(key);
+            m_statistics.Failures++;
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    if (!model) {
+        std::lock_guard lock(m_mutex);
+        m_models.erase(key);
+        m_statistics.Failures++;
+    }
+    promise.set_value(model);
+    return model;
+}
+
+void ControllerModelCache::SetDiskCacheDirectory(std::filesystem::path directory) {
+    std::lock_guard lock(m_mutex);
+    m_diskCacheDirectory = std::move(directory);
+}
+
+bool ControllerModelCache::LoadGltfBinary(XrControllerModelKeyMSFT key, const LoadGltfFunction& loadGltf, const ParseGltfFunction& parse) {
+    if (const std::optional<std::vector<uint8_t>> cachedData = ReadGltfBinary(key)) {
+        try {
+            parse(*cachedData);
+            return true;
+        } catch (...) {
+            // The file would fail the same way in every later run, so it is replaced with data loaded again.
+            RemoveGltfBinary(key);
+        }
+    }
+
+    const std::vector<uint8_t> data = loadGltf(key);
+    if (data.empty()) {
+        return false;
+    }
+    WriteGltfBinary(key, data.data(), data.size());
+    parse(data);
+    return true;
+}
+
+std::optional<std::vector<uint8_t>> ControllerModelCache::ReadGltfBinary(XrControllerModelKeyMSFT key) {
+    std::filesystem::path path;
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_diskCacheDirectory.empty()) {
+            return std::nullopt;
+        }
+        path = GetDiskCachePath(key);
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    std::optional<std::vector<uint8_t>> data;
+    if (file) {
+        data.emplace(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        if (!file.read(reinterpret_cast<char*>(data->data()), data->size()) || data->empty()) {
+            data.reset();
+        }
+    }
+
+    std::lock_guard lock(m_mutex);
+    (data ? m_statistics.DiskHits : m_statistics.DiskMisses)++;
+    return data;
+}
+
+void ControllerModelCache::WriteGltfBinary(XrControllerModelKeyMSFT key, const uint8_t* data, size_t size) {
+    std::filesystem::path path;
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_diskCacheDirectory.empty()) {
+            return;
+        }
+        path = GetDiskCachePath(key);
+    }
+
+    // Write to a temporary file first, so a file in the cache is always complete even if writing is interrupted.
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    std::filesystem::path temporaryPath = path;
+    temporaryPath += L".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(reinterpret_cast<const char*>(data), size)) {
+            return;
+        }
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+}
+
+void ControllerModelCache::Clear() {
+    std::lock_guard lock(m_mutex);
+    m_models.clear();
+}
+
+ControllerModelCache::Statistics ControllerModelCache::GetStatistics() const {
+    std::lock_guard lock(m_mutex);
+    return m_statistics;
+}
+
+std::filesystem::path ControllerModelCache::GetDiskCachePath(XrControllerModelKeyMSFT key) const {
+    return m_diskCacheDirectory / fmt::format("controller_model_{:016x}.glb", key);
+}
+
+void ControllerModelCache::RemoveGltfBinary(XrControllerModelKeyMSFT key) {
+    std::filesystem::path path;
+    {
+        std::lock_guard lock(m_mutex);
+        m_statistics.DiskFailures++;
+        if (m_diskCacheDirectory.empty()) {
+            return;
+        }
+        path = GetDiskCachePath(key);
+    }
+
+    std::error_code error;
+    std::filesystem::remove(path, error);
+}
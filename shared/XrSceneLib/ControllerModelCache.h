@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <pbr/PbrModel.h>
+
+namespace engine {
+
+    // A loaded controller model. It is shared by every controller showing the model, so it is never changed after loading:
+    // each controller renders and animates its own clone of the PBR model.
+    struct ControllerModel {
+        XrControllerModelKeyMSFT Key{XR_NULL_CONTROLLER_MODEL_KEY_MSFT};
+        std::shared_ptr<const Pbr::Model> PbrModel;
+
+        // The PBR node of each node in the controller model properties, in the same order as the properties and node states.
+        std::vector<Pbr::NodeIndex_t> NodeIndices;
+        std::vector<XrControllerModelNodePropertiesMSFT> NodeProperties;
+    };
+
+    // Keeps loaded controller models by model key, so a controller that reconnects, or another controller of the same model,
+    // does not load and parse the same glTF again or create the same GPU resources. Optionally also keeps the glTF data
+    // of the models on disk, to skip loading it from the runtime in later runs.
+    // All functions can be called from any thread.
+    class ControllerModelCache {
+    public:
+        using LoadFunction = std::function<std::shared_ptr<const ControllerModel>(XrControllerModelKeyMSFT)>;
+        using LoadGltfFunction = std::function<std::vector<uint8_t>(XrControllerModelKeyMSFT)>;
+        using ParseGltfFunction = std::function<void(const std::vector<uint8_t>&)>;
+
+        struct Statistics {
+            uint32_t Hits{0};
+            uint32_t Misses{0};
+            uint32_t Failures{0}; // Loads that threw or returned no model. They are not cached, so the model can be loaded again.
+            uint32_t DiskHits{0};
+            uint32_t DiskMisses{0};
+            uint32_t DiskFailures{0}; // Files in the on-disk cache that failed to parse. They are deleted and loaded again.
+        };
+
+        // Get the model of a key if it is loaded, without waiting for a load in progress.
+        std::shared_ptr<const ControllerModel> Find(XrControllerModelKeyMSFT key);
+
+        // Get the model of a key, calling load on a miss. Concurrent calls for the same key share a single load.
+        // Exceptions thrown by load are passed on to all callers waiting for it.
+        std::shared_ptr<const ControllerModel> GetOrLoad(XrControllerModelKeyMSFT key, const LoadFunction& load);
+
+        // Enable the on-disk cache of glTF data in the given directory, or disable it with an empty path.
+        void SetDiskCacheDirectory(std::filesystem::path directory);
+
+        // Pass the glTF binary data of a model to parse. The data is read from the on-disk cache, or on a miss is loaded with
+        // loadGltf and written to the on-disk cache. When parse throws for data from the on-disk cache, e.g. for a truncated file,
+        // the file is deleted and the data is loaded with loadGltf instead. Exceptions thrown for data from loadGltf are passed on.
+        // Returns false, without calling parse, if loadGltf returns no data.
+        bool LoadGltfBinary(XrControllerModelKeyMSFT key, const LoadGltfFunction& loadGltf, const ParseGltfFunction& parse);
+
+        // Read or write the glTF binary data of a model in the on-disk cache. Failures to read or write are ignored.
+        std::optional<std::vector<uint8_t>> ReadGltfBinary(XrControllerModelKeyMSFT key);
+        void WriteGltfBinary(XrControllerModelKeyMSFT key, const uint8_t* data, size_t size);
+
+        // Drop all loaded models. Controllers keep the models they already have.
+        void Clear();
+
+        Statistics GetStatistics() const;
+
+    private:
+        using ModelFuture = std::shared_future<std::shared_ptr<const ControllerModel>>;
+
+        std::filesystem::path GetDiskCachePath(XrControllerModelKeyMSFT key) const;
+        void RemoveGltfBinary(XrControllerModelKeyMSFT key);
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<XrControllerModelKeyMSFT, ModelFuture> m_models;
+        std::filesystem::path m_diskCacheDirectory;
+        Statistics m_statistics;
+    };
+
+} // namespace engine
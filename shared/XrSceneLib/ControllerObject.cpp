@@ -14,28 +14,30 @@ using namespace std::literals::chrono_literals;
 
 namespace {
 
-    struct ControllerModel {
-        XrControllerModelKeyMSFT Key = 0;
-        std::shared_ptr<Pbr::Model> PbrModel;
-        std::vector<Pbr::NodeIndex_t> NodeIndices;
-        std::vector<XrControllerModelNodePropertiesMSFT> NodeProperties;
-        std::vector<XrControllerModelNodeStateMSFT> NodeStates;
-    };
-
-    std::unique_ptr<ControllerModel> LoadControllerModel(engine::Context& context, XrControllerModelKeyMSFT modelKey) {
-        std::unique_ptr<ControllerModel> model = std::make_unique<ControllerModel>();
+    std::shared_ptr<const engine::ControllerModel> LoadControllerModel(engine::Context& context, XrControllerModelKeyMSFT modelKey) {
+        auto model = std::make_shared<engine::ControllerModel>();
         model->Key = modelKey;
 
-        // Load the controller model as GLTF binary stream using two call idiom
-        uint32_t bufferSize = 0;
-        CHECK_XRCMD(xrLoadControllerModelMSFT(context.Session.Handle, modelKey, 0, &bufferSize, nullptr));
-        if (bufferSize == 0) {
+        // Load the controller model as GLTF binary stream using two call idiom, unless it is in the on-disk cache.
+        std::shared_ptr<Pbr::Model> pbrModel;
+        const bool loaded = context.ControllerModels.LoadGltfBinary(
+            modelKey,
+            [&](XrControllerModelKeyMSFT key) {
+                uint32_t bufferSize = 0;
+                CHECK_XRCMD(xrLoadControllerModelMSFT(context.Session.Handle, key, 0, &bufferSize, nullptr));
+                std::vector<uint8_t> modelBuffer(bufferSize);
+                if (bufferSize > 0) {
+                    CHECK_XRCMD(xrLoadControllerModelMSFT(context.Session.Handle, key, bufferSize, &bufferSize, modelBuffer.data()));
+                }
+                return modelBuffer;
+            },
+            [&](const std::vector<uint8_t>& modelBuffer) {
+                pbrModel = Gltf::FromGltfBinary(context.PbrResources, modelBuffer.data(), (uint32_t)modelBuffer.size());
+            });
+        if (!loaded) {
             return nullptr;
         }
-        auto modelBuffer = std::make_unique<byte[]>(bufferSize);
-        CHECK_XRCMD(
-            xrLoadControllerModelMSFT(context.Session.Handle, modelKey, bufferSize, &bufferSize, modelBuffer.get()));
-        model->PbrModel = Gltf::FromGltfBinary(context.PbrResources, modelBuffer.get(), bufferSize);
+        model->PbrModel = pbrModel;
 
         // Read the controller model properties with two call idiom
         XrControllerModelPropertiesMSFT properties{XR_TYPE_CONTROLLER_MODEL_PROPERTIES_MSFT};
@@ -52,8 +54,8 @@ namespace {
         for (size_t i = 0; i < model->NodeProperties.size(); ++i) {
             const auto& nodeProperty = model->NodeProperties[i];
             const std::string_view parentNodeName = nodeProperty.parentNodeName;
-            if (const auto parentNodeIndex = model->PbrModel->FindFirstNode(parentNodeName)) {
-                if (const auto targetNodeIndex = model->PbrModel->FindFirstNode(nodeProperty.nodeName, *parentNodeIndex)) {
+            if (const auto parentNodeIndex = pbrModel->FindFirstNode(parentNodeName)) {
+                if (const auto targetNodeIndex = pbrModel->FindFirstNode(nodeProperty.nodeName, *parentNodeIndex)) {
                     model->NodeIndices[i] = *targetNodeIndex;
                 }
             }
@@ -62,21 +64,28 @@ namespace {
         return model;
     }
 
+    // A controller's own instance of a cached model, with its own node transforms and node states.
+    struct ControllerModelInstance {
+        std::shared_ptr<const engine::ControllerModel> Model;
+        std::shared_ptr<Pbr::Model> PbrModel;
+        std::vector<XrControllerModelNodeStateMSFT> NodeStates;
+    };
+
     // Update transforms of nodes for the animatable parts in the controller model
-    void UpdateControllerParts(engine::Context& context, ControllerModel& model) {
+    void UpdateControllerParts(engine::Context& context, ControllerModelInstance& model) {
         XrControllerModelStateMSFT modelState{XR_TYPE_CONTROLLER_MODEL_STATE_MSFT};
         modelState.nodeCapacityInput = 0;
-        CHECK_XRCMD(xrGetControllerModelStateMSFT(context.Session.Handle, model.Key, &modelState));
+        CHECK_XRCMD(xrGetControllerModelStateMSFT(context.Session.Handle, model.Model->Key, &modelState));
 
         model.NodeStates.resize(modelState.nodeCountOutput, {XR_TYPE_CONTROLLER_MODEL_STATE_MSFT});
         modelState.nodeCapacityInput = static_cast<uint32_t>(model.NodeStates.size());
         modelState.nodeStates = model.NodeStates.data();
-        CHECK_XRCMD(xrGetControllerModelStateMSFT(context.Session.Handle, model.Key, &modelState));
+        CHECK_XRCMD(xrGetControllerModelStateMSFT(context.Session.Handle, model.Model->Key, &modelState));
 
-        assert(model.NodeStates.size() == model.NodeIndices.size());
-        const size_t end = std::min(model.NodeStates.size(), model.NodeIndices.size());
+        assert(model.NodeStates.size() == model.Model->NodeIndices.size());
+        const size_t end = std::min(model.NodeStates.size(), model.Model->NodeIndices.size());
         for (size_t i = 0; i < end; i++) {
-            const Pbr::NodeIndex_t nodeIndex = model.NodeIndices[i];
+            const Pbr::NodeIndex_t nodeIndex = model.Model->NodeIndices[i];
             if (nodeIndex != Pbr::NodeIndex_npos) {
                 Pbr::Node& node = model.PbrModel->GetNode(nodeIndex);
                 node.SetTransform(xr::math::LoadXrPose(model.NodeStates[i].nodePose));
@@ -94,8 +103,10 @@ namespace {
         const bool m_extensionSupported;
         const XrPath m_controllerUserPath;
 
-        std::unique_ptr<ControllerModel> m_model;
-        std::future<std::unique_ptr<ControllerModel>> m_modelLoadingTask;
+        void SetControllerModel(engine::Context& context, std::shared_ptr<const engine::ControllerModel> model);
+
+        std::optional<ControllerModelInstance> m_model;
+        std::future<std::shared_ptr<const engine::ControllerModel>> m_modelLoadingTask;
     };
 
     ControllerObject::ControllerObject(engine::Context& context, XrPath controllerUserPath)
@@ -120,11 +131,16 @@ namespace {
 
         // If a new valid model key is returned, reload the model into cache asynchronously
         const bool modelKeyValid = controllerModelKeyState.modelKey != XR_NULL_CONTROLLER_MODEL_KEY_MSFT;
-        if (modelKeyValid && (m_model == nullptr || m_model->Key != controllerModelKeyState.modelKey)) {
+        const XrControllerModelKeyMSFT modelKey = controllerModelKeyState.modelKey;
+        if (modelKeyValid && (!m_model || m_model->Model->Key != modelKey)) {
+            // Models already in the cache are used right away, others are loaded in the background.
             // Avoid two background tasks running together. The new one will start in future update after the old one is finished.
-            if (!m_modelLoadingTask.valid()) {
-                m_modelLoadingTask = std::async(std::launch::async, [&, modelKey = controllerModelKeyState.modelKey]() {
-                    return LoadControllerModel(context, modelKey);
+            if (auto cachedModel = context.ControllerModels.Find(modelKey)) {
+                SetControllerModel(context, std::move(cachedModel));
+            } else if (!m_modelLoadingTask.valid()) {
+                m_modelLoadingTask = std::async(std::launch::async, [&, modelKey]() {
+                    return context.ControllerModels.GetOrLoad(
+                        modelKey, [&](XrControllerModelKeyMSFT key) { return LoadControllerModel(context, key); });
                 });
             }
         }
@@ -132,20 +148,36 @@ namespace {
         // If controller model loading task is completed, get the result model and apply it to rendering.
         if (m_modelLoadingTask.valid() && m_modelLoadingTask.wait_for(0s) == std::future_status::ready) {
             try {
-                m_model = m_modelLoadingTask.get(); // future.valid() is reset to false after get()
+                if (auto model = m_modelLoadingTask.get()) { // future.valid() is reset to false after get()
+                    SetControllerModel(context, std::move(model));
+                }
             } catch (...) {
                 sample::Trace("Unexpected failure loading controller model");
             }
-            if (m_model) {
-                SetModel(m_model->PbrModel);
-            }
+
+            const engine::ControllerModelCache::Statistics statistics = context.ControllerModels.GetStatistics();
+            sample::Trace("Controller model cache: {} hits, {} misses, {} failures, {} disk hits, {} disk misses, {} disk failures",
+                          statistics.Hits,
+                          statistics.Misses,
+                          statistics.Failures,
+                          statistics.DiskHits,
+                          statistics.DiskMisses,
+                          statistics.DiskFailures);
         }
 
         // If controller model is already loaded, update all node transforms
-        if (m_model != nullptr) {
+        if (m_model) {
             UpdateControllerParts(context, *m_model);
         }
     }
+
+    void ControllerObject::SetControllerModel(engine::Context& context, std::shared_ptr<const engine::ControllerModel> model) {
+        // The cached model is shared with other controllers, so this controller animates a clone sharing its GPU resources.
+        ControllerModelInstance& instance = m_model.emplace();
+        instance.PbrModel = model->PbrModel->Clone(context.PbrResources);
+        instance.Model = std::move(model);
+        SetModel(instance.PbrModel);
+    }
 } // namespace
 
 namespace engine {
@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <algorithm>
+#include <cmath>
+#include "DynamicResolution.h"
+
+using engine::DynamicResolutionController;
+
+DynamicResolutionController::DynamicResolutionController(DynamicResolutionOptions options)
+    : m_options(std::move(options))
+    , m_scale(m_options.MaxScale) {
+}
+
+namespace {
+    using Duration = DynamicResolutionController::Duration;
+
+    void Smooth(Duration& smoothed, bool& hasValue, Duration value, float smoothing) {
+        smoothed = hasValue ? smoothed + (value - smoothed) * smoothing : value;
+        hasValue = true;
+    }
+} // namespace
+
+float DynamicResolutionController::Update(Duration cpuFrameTime, std::optional<Duration> gpuFrameTime, Duration displayPeriod) {
+    if (displayPeriod.count() <= 0) {
+        return m_scale;
+    }
+    if (cpuFrameTime.count() > 0) {
+        Smooth(m_smoothedCpuFrameTime, m_hasCpuFrameTime, cpuFrameTime, m_options.Smoothing);
+    }
+    if (!gpuFrameTime || gpuFrameTime->count() <= 0) {
+        return m_scale;
+    }
+
+    // The GPU times that arrive while settling were mostly rendered at the previous scale, they would undo the estimate of SetScale.
+    if (m_settleFrames > 0) {
+        m_settleFrames--;
+        return m_scale;
+    }
+    Smooth(m_smoothedGpuFrameTime, m_hasGpuFrameTime, *gpuFrameTime, m_options.Smoothing);
+
+    const Duration target = displayPeriod * m_options.TargetFrameTimeFraction;
+    if (m_smoothedGpuFrameTime > target) {
+        m_underBudgetFrames = 0;
+        if (++m_overBudgetFrames >= m_options.DecreaseDelayFrames) {
+            // Jump to the scale expected to take the middle of the band between the increase threshold and the target, rather than
+            // the target itself, so rounding and small variations of the frame time do not lower it again.
+            const Duration aim = target * (1 + m_options.IncreaseThreshold) / 2;
+            SetScale(m_scale * std::sqrt(aim / m_smoothedGpuFrameTime));
+        }
+    } else if (m_smoothedGpuFrameTime < target * m_options.IncreaseThreshold && m_smoothedCpuFrameTime <= target) {
+        m_overBudgetFrames = 0;
+        if (++m_underBudgetFrames >= m_options.IncreaseDelayFrames) {
+            // Step up carefully towards the scale expected to meet the target, because the cost of more pixels is only an estimate.
+            const float expectedScale = m_scale * std::sqrt(target / m_smoothedGpuFrameTime);
+            SetScale(std::min(expectedScale, m_scale * (1 + m_options.MaxIncreaseStep)));
+        }
+    } else {
+        m_overBudgetFrames = 0;
+        m_underBudgetFrames = 0;
+    }
+
+    return m_scale;
+}
+
+void DynamicResolutionController::Reset() {
+    m_scale = m_options.MaxScale;
+    m_smoothedGpuFrameTime = Duration{0};
+    m_smoothedCpuFrameTime = Duration{0};
+    m_hasGpuFrameTime = false;
+    m_hasCpuFrameTime = false;
+    m_overBudgetFrames = 0;
+    m_underBudgetFrames = 0;
+    m_settleFrames = 0;
+}
+
+void DynamicResolutionController::SetScale(float scale) {
+    const float newScale = std::clamp(scale, m_options.MinScale, m_options.MaxScale);
+    m_overBudgetFrames = 0;
+    m_underBudgetFrames = 0;
+    if (newScale == m_scale) {
+        return;
+    }
+
+    // Until new measurements arrive, expect the GPU time to change with the number of pixels.
+    const float ratio = newScale / m_scale;
+    m_smoothedGpuFrameTime *= ratio * ratio;
+    m_scale = newScale;
+    m_settleFrames = m_options.SettleFrames;
+}
@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+
+namespace engine {
+
+    struct DynamicResolutionOptions {
+        // The frame time to aim for, as a fraction of the display period. Leaves the rest of the period as a safety margin.
+        float TargetFrameTimeFraction = 0.9f;
+        // The resolution only goes up when the frame time is below this fraction of the target, so it does not move back and forth
+        // around the target.
+        float IncreaseThreshold = 0.8f;
+
+        // The range of the viewport scale, applied to both width and height of the viewports.
+        float MinScale = 0.5f;
+        float MaxScale = 1.0f;
+        // The largest relative increase of the scale in one step. Decreases are not limited, to recover quickly from missed frames.
+        float MaxIncreaseStep = 0.05f;
+
+        // How much each frame adds to the smoothed frame times, between 0 and 1.
+        float Smoothing = 0.2f;
+        // Frames the GPU time must stay above the target, or below the increase threshold, before the scale changes.
+        uint32_t DecreaseDelayFrames = 2;
+        uint32_t IncreaseDelayFrames = 30;
+        // Frames to wait after a change, before the measured frame times reflect the new scale. GPU times arrive a few frames late.
+        uint32_t SettleFrames = 4;
+    };
+
+    // Adjusts the resolution of the rendered views to keep the GPU time of a frame within the display period. GPU time is taken to
+    // be proportional to the number of pixels, i.e. to the square of the scale. The CPU time does not drop with the resolution, so it
+    // never lowers the scale, but the scale is not raised while the CPU time is over the target: the frame misses the display period
+    // anyway and the extra GPU work would only add to the latency. The controller only computes the scale, so it can be driven by
+    // recorded or synthetic frame times.
+    class DynamicResolutionController {
+    public:
+        using Duration = std::chrono::duration<float, std::milli>;
+
+        explicit DynamicResolutionController(DynamicResolutionOptions options = {});
+
+        // Report the times of one frame and get the viewport scale to render the next frames with. GPU times arrive a few frames
+        // late, and the scale only changes on frames that report one.
+        float Update(Duration cpuFrameTime, std::optional<Duration> gpuFrameTime, Duration displayPeriod);
+
+        float GetScale() const {
+            return m_scale;
+        }
+
+        Duration GetSmoothedGpuFrameTime() const {
+            return m_smoothedGpuFrameTime;
+        }
+        Duration GetSmoothedCpuFrameTime() const {
+            return m_smoothedCpuFrameTime;
+        }
+
+        // Start over at the maximum scale, e.g. after the session restarted.
+        void Reset();
+
+    private:
+        void SetScale(float scale);
+
+        const DynamicResolutionOptions m_options;
+        float m_scale;
+        Duration m_smoothedGpuFrameTime{0};
+        Duration m_smoothedCpuFrameTime{0};
+        bool m_hasGpuFrameTime{false};
+        bool m_hasCpuFrameTime{false};
+        uint32_t m_overBudgetFrames{0};
+        uint32_t m_underBudgetFrames{0};
+        uint32_t m_settleFrames{0};
+    };
+
+} // namespace engine
@@ -0,0 +1,179 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <algorithm>
+#include "GlyphAtlas.h"
+
+using engine::AtlasGlyph;
+using engine::AtlasRect;
+using engine::GlyphAtlas;
+
+namespace {
+    // Empty pixels between glyphs, so bilinear filtering of one glyph never samples its neighbors.
+    constexpr uint32_t Padding = 1;
+    constexpr uint32_t SolidSize = 4;
+
+    // Shelves are made for glyph heights rounded up to this, so glyphs of similar height share a shelf.
+    constexpr uint32_t ShelfHeightGranularity = 4;
+
+    uint32_t ShelfHeightFor(uint32_t glyphHeight) {
+        return (glyphHeight + ShelfHeightGranularity - 1) / ShelfHeightGranularity * ShelfHeightGranularity;
+    }
+
+    AtlasRect Union(const AtlasRect& a, const AtlasRect& b) {
+        const uint32_t left = std::min(a.X, b.X);
+        const uint32_t top = std::min(a.Y, b.Y);
+        const uint32_t right = std::max(a.X + a.Width, b.X + b.Width);
+        const uint32_t bottom = std::max(a.Y + a.Height, b.Y + b.Height);
+        return AtlasRect{left, top, right - left, bottom - top};
+    }
+} // namespace
+
+GlyphAtlas::GlyphAtlas(std::unique_ptr<GlyphRasterizer> rasterizer, uint32_t width, uint32_t height)
+    : m_rasterizer(std::move(rasterizer))
+    , m_fontMetrics(m_rasterizer->GetFontMetrics())
+    , m_width(width)
+    , m_height(height)
+    , m_pixels((size_t)width * height, 0) {
+    if (width < SolidSize || height < SolidSize) {
+        throw std::invalid_argument("The glyph atlas is too small.");
+    }
+
+    // The solid block sits in the top-left corner, glyph shelves start below it.
+    m_solidRect = AtlasRect{0, 0, SolidSize, SolidSize};
+    for (uint32_t y = 0; y < SolidSize; y++) {
+        std::fill_n(m_pixels.begin() + (size_t)y * m_width, SolidSize, (uint8_t)0xFF);
+    }
+    m_shelvesHeight = SolidSize + Padding;
+    MarkDirty(m_solidRect);
+}
+
+const AtlasGlyph* GlyphAtlas::Acquire(char32_t codepoint) {
+    auto it = m_glyphs.find(codepoint);
+    if (it == m_glyphs.end()) {
+        GlyphBitmap bitmap = m_rasterizer->Rasterize(codepoint);
+
+        Entry entry;
+        entry.Glyph.Left = bitmap.Left;
+        entry.Glyph.Top = bitmap.Top;
+        entry.Glyph.Advance = bitmap.Advance;
+
+        if (bitmap.Width > 0 && bitmap.Height > 0) {
+            const std::optional<size_t> shelfIndex = FindShelf(bitmap.Width, bitmap.Height);
+            if (!shelfIndex) {
+                return nullptr;
+            }
+
+            Shelf& shelf = m_shelves[*shelfIndex];
+            entry.Glyph.Rect = AtlasRect{shelf.Cursor, shelf.Y, bitmap.Width, bitmap.Height};
+            entry.ShelfIndex = shelfIndex;
+            shelf.Cursor += bitmap.Width + Padding;
+            shelf.Glyphs.push_back(codepoint);
+
+            for (uint32_t y = 0; y < bitmap.Height; y++) {
+                std::copy_n(bitmap.Coverage.begin() + (size_t)y * bitmap.Width,
+                            bitmap.Width,
+                            m_pixels.begin() + (size_t)(shelf.Y + y) * m_width + entry.Glyph.Rect.X);
+            }
+            MarkDirty(entry.Glyph.Rect);
+        }
+
+        it = m_glyphs.emplace(codepoint, std::move(entry)).first;
+    }
+
+    Entry& entry = it->second;
+    entry.References++;
+    Touch(entry);
+    return &entry.Glyph;
+}
+
+void GlyphAtlas::Release(char32_t codepoint) {
+    const auto it = m_glyphs.find(codepoint);
+    if (it != m_glyphs.end() && it->second.References > 0) {
+        it->second.References--;
+    }
+}
+
+std::optional<AtlasRect> GlyphAtlas::TakeDirtyRect() {
+    return std::exchange(m_dirtyRect, std::nullopt);
+}
+
+std::optional<size_t> GlyphAtlas::FindShelf(uint32_t width, uint32_t height) {
+    if (width + Padding > m_width) {
+        return std::nullopt;
+    }
+
+    // Use the shortest shelf with room for the glyph, as long as the glyph fills at least two thirds of its height.
+    const uint32_t shelfHeight = ShelfHeightFor(height);
+    std::optional<size_t> bestIndex;
+    for (size_t i = 0; i < m_shelves.size(); i++) {
+        const Shelf& shelf = m_shelves[i];
+        if (shelf.Height < shelfHeight || shelf.Height * 2 > shelfHeight * 3 || shelf.Cursor + width + Padding > m_width) {
+            continue;
+        }
+        if (!bestIndex || shelf.Height < m_shelves[*bestIndex].Height) {
+            bestIndex = i;
+        }
+    }
+    if (bestIndex) {
+        return bestIndex;
+    }
+
+    if (m_shelvesHeight + shelfHeight + Padding <= m_height) {
+        Shelf& shelf = m_shelves.emplace_back();
+        shelf.Y = m_shelvesHeight;
+        shelf.Height = shelfHeight;
+        m_shelvesHeight += shelfHeight + Padding;
+        return m_shelves.size() - 1;
+    }
+
+    return EvictShelf(shelfHeight);
+}
+
+std::optional<size_t> GlyphAtlas::EvictShelf(uint32_t height) {
+    // Reuse the least recently used shelf that is tall enough and has no glyph in use.
+    std::optional<size_t> evictIndex;
+    for (size_t i = 0; i < m_shelves.size(); i++) {
+        const Shelf& shelf = m_shelves[i];
+        if (shelf.Height < height || (evictIndex && m_shelves[*evictIndex].LastUsed <= shelf.LastUsed)) {
+            continue;
+        }
+
+        const bool inUse = std::any_of(
+            shelf.Glyphs.begin(), shelf.Glyphs.end(), [&](char32_t codepoint) { return m_glyphs.at(codepoint).References > 0; });
+        if (!inUse) {
+            evictIndex = i;
+        }
+    }
+
+    if (!evictIndex) {
+        return std::nullopt;
+    }
+
+    Shelf& shelf = m_shelves[*evictIndex];
+    for (char32_t codepoint : shelf.Glyphs) {
+        m_glyphs.erase(codepoint);
+    }
+    shelf.Glyphs.clear();
+    shelf.Cursor = 0;
+
+    const AtlasRect shelfRect{0, shelf.Y, m_width, shelf.Height};
+    for (uint32_t y = 0; y < shelf.Height; y++) {
+        std::fill_n(m_pixels.begin() + (size_t)(shelf.Y + y) * m_width, m_width, (uint8_t)0);
+    }
+    MarkDirty(shelfRect);
+    m_evictedShelfCount++;
+
+    return evictIndex;
+}
+
+void GlyphAtlas::Touch(const Entry& entry) {
+    if (entry.ShelfIndex) {
+        m_shelves[*entry.ShelfIndex].LastUsed = ++m_useCounter;
+    }
+}
+
+void GlyphAtlas::MarkDirty(const AtlasRect& rect) {
+    m_dirtyRect = m_dirtyRect ? Union(*m_dirtyRect, rect) : rect;
+}
@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace engine {
+
+    // Font-wide metrics in pixels.
+    struct FontMetrics {
+        float Ascent{0};  // From the top of a line to the baseline.
+        float Descent{0}; // From the baseline to the bottom of a line.
+        float LineGap{0};
+    };
+
+    // A glyph rasterized to 8-bit coverage. The bitmap is positioned relative to the pen position on the baseline.
+    struct GlyphBitmap {
+        uint32_t Width{0};
+        uint32_t Height{0};
+        int32_t Left{0};  // From the pen position right to the left edge of the bitmap.
+        int32_t Top{0};   // From the baseline up to the top edge of the bitmap.
+        float Advance{0}; // How far the pen moves after the glyph.
+        std::vector<uint8_t> Coverage; // Width * Height values, row by row.
+    };
+
+    // Rasterizes the glyphs of one font at one size. Layout and atlas management only go through this interface,
+    // so they work the same with DirectWrite or with any other font rasterizer.
+    struct GlyphRasterizer {
+        virtual ~GlyphRasterizer() = default;
+        virtual FontMetrics GetFontMetrics() const = 0;
+        virtual GlyphBitmap Rasterize(char32_t codepoint) = 0;
+    };
+
+    struct AtlasRect {
+        uint32_t X{0};
+        uint32_t Y{0};
+        uint32_t Width{0};
+        uint32_t Height{0};
+    };
+
+    // A glyph placed in the atlas.
+    struct AtlasGlyph {
+        AtlasRect Rect; // Empty for glyphs without pixels, such as spaces.
+        int32_t Left{0};
+        int32_t Top{0};
+        float Advance{0};
+    };
+
+    // Caches rasterized glyphs in a single 8-bit coverage image, packed in rows (shelves) of similar height.
+    // Glyphs are reference counted by the text using them. When the atlas is full, the least recently used shelf without
+    // referenced glyphs is cleared and reused, so glyphs only move when no text shows them.
+    class GlyphAtlas {
+    public:
+        GlyphAtlas(std::unique_ptr<GlyphRasterizer> rasterizer, uint32_t width, uint32_t height);
+
+        // Find the glyph of a codepoint, rasterizing and placing it if needed, and add a reference to it.
+        // Returns nullptr if the glyph does not fit in the atlas even after evicting all unreferenced glyphs.
+        const AtlasGlyph* Acquire(char32_t codepoint);
+        void Release(char32_t codepoint);
+
+        // A block of full coverage, for drawing solid quads such as text backgrounds from the same texture.
+        const AtlasRect& GetSolidRect() const {
+            return m_solidRect;
+        }
+
+        const FontMetrics& GetFontMetrics() const {
+            return m_fontMetrics;
+        }
+
+        uint32_t GetWidth() const {
+            return m_width;
+        }
+        uint32_t GetHeight() const {
+            return m_height;
+        }
+        const std::vector<uint8_t>& GetPixels() const {
+            return m_pixels;
+        }
+
+        // The bounds of the pixels changed since the last call, if any, to upload them to a texture.
+        std::optional<AtlasRect> TakeDirtyRect();
+
+        size_t GetGlyphCount() const {
+            return m_glyphs.size();
+        }
+        uint32_t GetEvictedShelfCount() const {
+            return m_evictedShelfCount;
+        }
+
+    private:
+        struct Shelf {
+            uint32_t Y{0};
+            uint32_t Height{0};
+            uint32_t Cursor{0}; // Where the next glyph goes.
+            uint64_t LastUsed{0};
+            std::vector<char32_t> Glyphs;
+        };
+
+        struct Entry {
+            AtlasGlyph Glyph;
+            uint32_t References{0};
+            std::optional<size_t> ShelfIndex;
+        };
+
+        std::optional<size_t> FindShelf(uint32_t width, uint32_t height);
+        std::optional<size_t> EvictShelf(uint32_t height);
+        void Touch(const Entry& entry);
+        void MarkDirty(const AtlasRect& rect);
+
+        const std::unique_ptr<GlyphRasterizer> m_rasterizer;
+        const FontMetrics m_fontMetrics;
+        const uint32_t m_width;
+        const uint32_t m_height;
+        std::vector<uint8_t> m_pixels;
+        std::vector<Shelf> m_shelves;
+        uint32_t m_shelvesHeight{0};
+        std::unordered_map<char32_t, Entry> m_glyphs;
+        AtlasRect m_solidRect;
+        std::optional<AtlasRect> m_dirtyRect;
+        uint64_t m_useCounter{0};
+        uint32_t m_evictedShelfCount{0};
+    };
+
+} // namespace engine
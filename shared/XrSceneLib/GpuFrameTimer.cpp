@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "GpuFrameTimer.h"
+
+using engine::GpuFrameTimer;
+
+GpuFrameTimer::GpuFrameTimer(_In_ ID3D11Device* device) {
+    const CD3D11_QUERY_DESC disjointDesc(D3D11_QUERY_TIMESTAMP_DISJOINT);
+    const CD3D11_QUERY_DESC timestampDesc(D3D11_QUERY_TIMESTAMP);
+    for (FrameQueries& frame : m_frames) {
+        CHECK_HRCMD(device->CreateQuery(&disjointDesc, frame.Disjoint.put()));
+        CHECK_HRCMD(device->CreateQuery(&timestampDesc, frame.Begin.put()));
+        CHECK_HRCMD(device->CreateQuery(&timestampDesc, frame.End.put()));
+    }
+}
+
+void GpuFrameTimer::BeginFrame(_In_ ID3D11DeviceContext* context) {
+    // If the GPU is that far behind, give up on the oldest frame so its queries can be reused.
+    if (m_nextFrame - m_nextFrameToRead >= FrameCount) {
+        m_nextFrameToRead++;
+    }
+
+    const FrameQueries& frame = m_frames[m_nextFrame % FrameCount];
+    context->Begin(frame.Disjoint.get());
+    context->End(frame.Begin.get());
+}
+
+void GpuFrameTimer::EndFrame(_In_ ID3D11DeviceContext* context) {
+    const FrameQueries& frame = m_frames[m_nextFrame % FrameCount];
+    context->End(frame.End.get());
+    context->End(frame.Disjoint.get());
+    m_nextFrame++;
+}
+
+std::optional<std::chrono::duration<float, std::milli>> GpuFrameTimer::TryGetFrameTime(_In_ ID3D11DeviceContext* context) {
+    std::optional<std::chrono::duration<float, std::milli>> frameTime;
+
+    // Frames finish in order, so stop at the first frame that is not finished.
+    while (m_nextFrameToRead < m_nextFrame) {
+        const FrameQueries& frame = m_frames[m_nextFrameToRead % FrameCount];
+
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint{};
+        UINT64 begin = 0;
+        UINT64 end = 0;
+        constexpr UINT flags = D3D11_ASYNC_GETDATA_DONOTFLUSH;
+        if (context->GetData(frame.Disjoint.get(), &disjoint, sizeof(disjoint), flags) != S_OK ||
+            context->GetData(frame.Begin.get(), &begin, sizeof(begin), flags) != S_OK ||
+            context->GetData(frame.End.get(), &end, sizeof(end), flags) != S_OK) {
+            break;
+        }
+
+        // Timestamps of a disjoint interval are unreliable, e.g. because the GPU clock changed, so the frame is skipped.
+        if (!disjoint.Disjoint && disjoint.Frequency > 0 && end >= begin) {
+            frameTime = std::chrono::duration<float, std::milli>((end - begin) * 1000.0f / disjoint.Frequency);
+        }
+        m_nextFrameToRead++;
+    }
+
+    return frameTime;
+}
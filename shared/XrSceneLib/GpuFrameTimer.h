@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <d3d11.h>
+#include <winrt/base.h>
+
+namespace engine {
+
+    // Measures the GPU time of frames with timestamp queries. Results are read a few frames later without waiting for the GPU,
+    // so the latest available time is always from an earlier frame.
+    class GpuFrameTimer {
+    public:
+        explicit GpuFrameTimer(_In_ ID3D11Device* device);
+
+        void BeginFrame(_In_ ID3D11DeviceContext* context);
+        void EndFrame(_In_ ID3D11DeviceContext* context);
+
+        // The GPU time of the most recent frame whose queries finished, if any finished since the last call.
+        std::optional<std::chrono::duration<float, std::milli>> TryGetFrameTime(_In_ ID3D11DeviceContext* context);
+
+    private:
+        struct FrameQueries {
+            winrt::com_ptr<ID3D11Query> Disjoint;
+            winrt::com_ptr<ID3D11Query> Begin;
+            winrt::com_ptr<ID3D11Query> End;
+        };
+
+        // Enough frames in flight that the queries of a frame are usually finished before they are reused.
+        static constexpr size_t FrameCount = 4;
+        std::array<FrameQueries, FrameCount> m_frames;
+        uint64_t m_nextFrame{0};       // The frame the next BeginFrame starts.
+        uint64_t m_nextFrameToRead{0}; // The oldest frame whose time was not read yet.
+    };
+
+} // namespace engine
@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "HandMeshObject.h"
+
+using namespace DirectX;
+
+namespace engine {
+    HandMeshObject::HandMeshObject(const Pbr::Resources& pbrResources,
+                                   const XrSystemHandTrackingMeshPropertiesMSFT& handMeshProperties,
+                                   std::shared_ptr<Pbr::Material> material)
+        : m_indices(handMeshProperties.maxHandMeshIndexCount)
+        , m_vertices(handMeshProperties.maxHandMeshVertexCount)
+        , m_vertexColors(handMeshProperties.maxHandMeshVertexCount, XMFLOAT4{1, 1, 1, 1})
+        , m_pbrVertices(handMeshProperties.maxHandMeshVertexCount) {
+        m_handMesh.indexBuffer.indexCapacityInput = handMeshProperties.maxHandMeshIndexCount;
+        m_handMesh.indexBuffer.indices = m_indices.data();
+        m_handMesh.vertexBuffer.vertexCapacityInput = handMeshProperties.maxHandMeshVertexCount;
+        m_handMesh.vertexBuffer.vertices = m_vertices.data();
+
+        auto model = std::make_shared<Pbr::Model>();
+        model->AddPrimitive(Pbr::Primitive(
+            pbrResources, handMeshProperties.maxHandMeshVertexCount, handMeshProperties.maxHandMeshIndexCount, std::move(material)));
+        SetModel(std::move(model));
+    }
+
+    bool HandMeshObject::UpdateHandMesh(XrHandTrackerEXT handTracker, XrTime time, XrHandPoseTypeMSFT handPoseType) {
+        XrHandMeshUpdateInfoMSFT meshUpdateInfo{XR_TYPE_HAND_MESH_UPDATE_INFO_MSFT};
+        meshUpdateInfo.time = time;
+        meshUpdateInfo.handPoseType = handPoseType;
+        CHECK_XRCMD(xrUpdateHandMeshMSFT(handTracker, &meshUpdateInfo, &m_handMesh));
+
+        if (!m_handMesh.isActive) {
+            return false;
+        }
+
+        // The changed flags are relative to the previous update, so they accumulate until the changes are uploaded.
+        m_indicesChanged |= static_cast<bool>(m_handMesh.indexBufferChanged);
+        m_verticesChanged |= static_cast<bool>(m_handMesh.vertexBufferChanged);
+        return true;
+    }
+
+    void HandMeshObject::UploadChanges(Context& context) {
+        Pbr::Primitive& primitive = GetModel()->GetPrimitive(0);
+
+        if (m_verticesChanged) {
+            const uint32_t vertexCount = m_handMesh.vertexBuffer.vertexCountOutput;
+            ConvertHandMeshVertices(m_vertices.data(), m_vertexColors.data(), vertexCount, m_pbrVertices.data());
+            primitive.UpdateVertexBuffer(context.Device.get(), context.DeviceContext.get(), m_pbrVertices.data(), vertexCount);
+            m_verticesChanged = false;
+        }
+
+        if (m_indicesChanged) {
+            primitive.UpdateIndexBuffer(
+                context.Device.get(), context.DeviceContext.get(), m_indices.data(), m_handMesh.indexBuffer.indexCountOutput);
+            m_indicesChanged = false;
+        }
+    }
+
+    void ConvertHandMeshVertices(const XrHandMeshVertexMSFT* vertices,
+                                 const XMFLOAT4* vertexColors,
+                                 uint32_t vertexCount,
+                                 Pbr::Vertex* pbrVertices) {
+        // The tangent is cross(normal, Y) when the normal is closer to the X axis than the Y axis, otherwise cross(normal, X).
+        // Both cross products with a basis vector reduce to a swizzle and a sign flip, so the choice is a branchless select.
+        static const XMVECTORF32 crossYSign = {{{-1, 1, 1, 1}}};
+        static const XMVECTORF32 crossXSign = {{{1, 1, -1, 1}}};
+        static const XMVECTORF32 white = {{{1, 1, 1, 1}}};
+
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            const XrHandMeshVertexMSFT& vertex = vertices[i];
+            Pbr::Vertex& pbrVertex = pbrVertices[i];
+
+            const XMVECTOR normal = xr::math::LoadXrVector3(vertex.normal);
+            const XMVECTOR crossY = XMVectorMultiply(XMVectorSwizzle<2, 3, 0, 3>(normal), crossYSign); // (-nz, 0, nx, 0)
+            const XMVECTOR crossX = XMVectorMultiply(XMVectorSwizzle<3, 2, 1, 3>(normal), crossXSign); // (0, nz, -ny, 0)
+            const XMVECTOR absNormal = XMVectorAbs(normal);
+            const XMVECTOR xDominant = XMVectorGreater(XMVectorSplatX(absNormal), XMVectorSplatY(absNormal));
+
+            XMStoreFloat3(&pbrVertex.Position, xr::math::LoadXrVector3(vertex.position));
+            XMStoreFloat3(&pbrVertex.Normal, normal);
+            XMStoreFloat4(&pbrVertex.Tangent, XMVectorSelect(crossX, crossY, xDominant));
+            XMStoreFloat4(&pbrVertex.Color0, vertexColors != nullptr ? XMLoadFloat4(&vertexColors[i]) : white.v);
+            pbrVertex.TexCoord0 = {0, 0};
+            pbrVertex.ModelTransformIndex = Pbr::RootNodeIndex;
+        }
+    }
+} // namespace engine
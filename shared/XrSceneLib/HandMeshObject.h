@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <pbr/PbrModel.h>
+#include <pbr/PbrMaterial.h>
+#include "PbrModelObject.h"
+
+namespace engine {
+
+    // Displays a hand mesh from XR_MSFT_hand_tracking_mesh.
+    // All buffers are sized for the largest hand mesh the system supports when the object is created,
+    // so updating the mesh every frame writes into existing CPU and GPU buffers without allocating.
+    class HandMeshObject : public PbrModelObject {
+    public:
+        HandMeshObject(const Pbr::Resources& pbrResources,
+                       const XrSystemHandTrackingMeshPropertiesMSFT& handMeshProperties,
+                       std::shared_ptr<Pbr::Material> material);
+
+        // Get the latest hand mesh from the runtime. Returns false if the hand mesh is not active.
+        bool UpdateHandMesh(XrHandTrackerEXT handTracker, XrTime time, XrHandPoseTypeMSFT handPoseType = XR_HAND_POSE_TYPE_TRACKED_MSFT);
+
+        // The hand mesh from the last UpdateHandMesh call.
+        const XrHandMeshMSFT& GetHandMesh() const {
+            return m_handMesh;
+        }
+
+        // Per-vertex colors of the hand mesh, one for each vertex of the current hand mesh. White by default.
+        // Getting mutable colors causes the vertices to be uploaded again on the next UploadChanges.
+        DirectX::XMFLOAT4* GetVertexColors() {
+            m_verticesChanged = true;
+            return m_vertexColors.data();
+        }
+
+        // Upload the vertices and indices that changed since the last upload to the GPU.
+        // The index buffer is only written when the runtime reported that the indices changed.
+        void UploadChanges(Context& context);
+
+    private:
+        XrHandMeshMSFT m_handMesh{XR_TYPE_HAND_MESH_MSFT};
+        std::vector<uint32_t> m_indices;
+        std::vector<XrHandMeshVertexMSFT> m_vertices;
+        std::vector<DirectX::XMFLOAT4> m_vertexColors;
+        std::vector<Pbr::Vertex> m_pbrVertices;
+
+        bool m_indicesChanged{false};
+        bool m_verticesChanged{false};
+    };
+
+    // Convert hand mesh vertices to PBR vertices, computing a tangent perpendicular to each normal.
+    // vertexColors can be null, in which case the vertices are white.
+    void ConvertHandMeshVertices(const XrHandMeshVertexMSFT* vertices,
+                                 const DirectX::XMFLOAT4* vertexColors,
+                                 uint32_t vertexCount,
+                                 Pbr::Vertex* pbrVertices);
+} // namespace engine
@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "LodModelObject.h"
+
+using namespace DirectX;
+using engine::LodModelObject;
+
+LodModelObject::LodModelObject(
+    std::vector<Level> levels, DirectX::XMFLOAT3 boundsCenter, float boundsRadius, Pbr::ShadingMode shadingMode, Pbr::FillMode fillMode)
+    : m_boundsCenter(boundsCenter)
+    , m_boundsRadius(boundsRadius)
+    , m_shadingMode(shadingMode)
+    , m_fillMode(fillMode) {
+    for (Level& level : levels) {
+        m_levels.push_back(std::move(level.Model));
+        m_levelErrors.push_back(level.Error);
+    }
+}
+
+void LodModelObject::SetMaxScreenError(float pixels, float pixelsPerRadian) {
+    m_maxScreenError = pixels;
+    m_pixelsPerRadian = pixelsPerRadian;
+}
+
+void LodModelObject::Update(Context& context, const FrameTime& frameTime) {
+    if (m_levels.empty()) {
+        return;
+    }
+
+    const std::vector<XrVector3f>& eyePositions = context.PrimaryEyes.Locate(
+        context.Session.Handle, context.Session.PrimaryViewConfigurationType, context.AppSpace, frameTime.PredictedDisplayTime);
+    if (eyePositions.empty()) {
+        return; // Keep the level of the last frame until the eyes are located again.
+    }
+
+    // Measure the distance in model units, so it can be compared to the errors of the levels.
+    const XMMATRIX worldTransform = WorldTransform();
+    const float scale = std::max({XMVectorGetX(XMVector3Length(worldTransform.r[0])),
+                                  XMVectorGetX(XMVector3Length(worldTransform.r[1])),
+                                  XMVectorGetX(XMVector3Length(worldTransform.r[2]))});
+    const XMVECTOR center = XMVector3Transform(XMLoadFloat3(&m_boundsCenter), worldTransform);
+
+    // All views are drawn with the same level, so the nearest eye decides.
+    float distance = std::numeric_limits<float>::max();
+    for (const XrVector3f& eyePosition : eyePositions) {
+        distance = std::min(distance, XMVectorGetX(XMVector3Length(XMVectorSubtract(xr::math::LoadXrVector3(eyePosition), center))));
+    }
+    distance = scale > 0 ? (distance / scale - m_boundsRadius) : 0;
+
+    m_selectedLevel = Pbr::SelectLodLevel(m_levelErrors.data(), m_levelErrors.size(), distance, m_maxScreenError, m_pixelsPerRadian);
+}
+
+void LodModelObject::Render(Context& context) const {
+    if (!IsVisible() || m_levels.empty()) {
+        return;
+    }
+
+    context.RenderQueue.Add(
+        context.PbrResources, context.DeviceContext.get(), *m_levels[m_selectedLevel], WorldTransform(), m_shadingMode, m_fillMode);
+}
@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <pbr/PbrModel.h>
+#include <pbr/PbrMaterial.h>
+#include <pbr/PbrMeshSimplifier.h>
+#include "Object.h"
+
+namespace engine {
+
+    // Renders one of several levels of detail of a model, picked once per frame from the distance to the nearest eye of the primary
+    // views, so the simplification error covers at most a given number of pixels. Every view and pass of a frame renders the same
+    // level, so the eyes never see different geometry. The eyes are located once per frame for all objects, see Context::PrimaryEyes.
+    class LodModelObject : public Object {
+    public:
+        struct Level {
+            std::shared_ptr<Pbr::Model> Model;
+            float Error; // In model units.
+        };
+
+        // The levels are ordered from the most to the least detailed. The bounding sphere is in model space.
+        LodModelObject(std::vector<Level> levels,
+                       DirectX::XMFLOAT3 boundsCenter,
+                       float boundsRadius,
+                       Pbr::ShadingMode shadingMode = Pbr::ShadingMode::Regular,
+                       Pbr::FillMode fillMode = Pbr::FillMode::Solid);
+
+        void SetMaxScreenError(float pixels, float pixelsPerRadian = Pbr::DefaultPixelsPerRadian);
+
+        // The level picked for the current frame, e.g. for statistics.
+        size_t GetSelectedLevel() const {
+            return m_selectedLevel;
+        }
+
+        size_t GetLevelCount() const {
+            return m_levels.size();
+        }
+
+        void Update(Context& context, const FrameTime& frameTime) override;
+        void Render(Context& context) const override;
+
+    private:
+        std::vector<std::shared_ptr<Pbr::Model>> m_levels;
+        std::vector<float> m_levelErrors;
+        DirectX::XMFLOAT3 m_boundsCenter;
+        float m_boundsRadius;
+        Pbr::ShadingMode m_shadingMode;
+        Pbr::FillMode m_fillMode;
+        float m_maxScreenError{1.0f};
+        float m_pixelsPerRadian{Pbr::DefaultPixelsPerRadian};
+        size_t m_selectedLevel{0};
+    };
+
+} // namespace engine
@@ -0,0 +1,303 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <algorithm>
+#include <cstring>
+#include "MotionSystem.h"
+
+using namespace DirectX;
+using engine::MotionSystem;
+using xr::math::detail::LaneOf;
+
+namespace {
+    inline XMVECTOR XM_CALLCONV Dot3(FXMVECTOR ax, FXMVECTOR ay, FXMVECTOR az, const XMFLOAT3& b) {
+        XMVECTOR dot = XMVectorScale(ax, b.x);
+        dot = XMVectorMultiplyAdd(ay, XMVectorReplicate(b.y), dot);
+        return XMVectorMultiplyAdd(az, XMVectorReplicate(b.z), dot);
+    }
+} // namespace
+
+MotionSystem::MotionSystem(std::chrono::duration<float> timeStep, uint32_t maxStepsPerUpdate)
+    : m_timeStep(timeStep.count())
+    , m_maxStepsPerUpdate(maxStepsPerUpdate) {
+}
+
+void MotionSystem::Add(Object& object) {
+    Motion& motion = object.Motion;
+    motion.m_system = this;
+    motion.m_object = &object;
+    Track(object);
+}
+
+void MotionSystem::Remove(Object& object) {
+    Motion& motion = object.Motion;
+    if (motion.m_system != this) {
+        return;
+    }
+
+    Untrack(object);
+    if (motion.m_enabledChanged) {
+        m_changedObjects.erase(std::find(m_changedObjects.begin(), m_changedObjects.end(), &object));
+        motion.m_enabledChanged = false;
+    }
+    motion.m_system = nullptr;
+    motion.m_object = nullptr;
+}
+
+void MotionSystem::Track(Object& object) {
+    Motion& motion = object.Motion;
+    const bool tracked = motion.m_bodyIndex < m_objects.size() && m_objects[motion.m_bodyIndex] == &object;
+
+    if (!motion.m_enabled) {
+        if (tracked) {
+            Untrack(object);
+        }
+        return;
+    }
+
+    const XrPosef& pose = std::as_const(object).Pose();
+    if (!tracked) {
+        motion.m_bodyIndex = AddBody(pose, motion);
+        m_objects[motion.m_bodyIndex] = &object;
+        return;
+    }
+
+    SetBodyMotion(motion.m_bodyIndex, motion);
+    if (std::memcmp(&pose, &m_writtenPoses[motion.m_bodyIndex], sizeof(XrPosef)) != 0) {
+        TeleportBody(motion.m_bodyIndex, pose);
+    }
+}
+
+void MotionSystem::Untrack(Object& object) {
+    const size_t index = object.Motion.m_bodyIndex;
+    if (index < m_objects.size() && m_objects[index] == &object) {
+        RemoveBody(index);
+    }
+    object.Motion.m_bodyIndex = Motion::NoBody;
+}
+
+size_t MotionSystem::AddBody(const XrPosef& pose, const Motion& motion) {
+    const size_t index = BodyCount();
+    Resize(index + 1);
+    SetBodyMotion(index, motion);
+    TeleportBody(index, pose);
+    return index;
+}
+
+void MotionSystem::RemoveBody(size_t index) {
+    // Move the last body into the removed slot, so the bodies stay packed.
+    const size_t last = BodyCount() - 1;
+    if (index != last) {
+        m_previous.Set(index, m_previous.Get(last));
+        m_current.Set(index, m_current.Get(last));
+        m_interpolated.Set(index, m_interpolated.Get(last));
+
+        const MotionBlock& from = m_motion[last / xr::math::PoseArray::BlockSize];
+        MotionBlock& to = m_motion[index / xr::math::PoseArray::BlockSize];
+        const XMVECTOR* source = reinterpret_cast<const XMVECTOR*>(&from);
+        XMVECTOR* destination = reinterpret_cast<XMVECTOR*>(&to);
+        for (size_t i = 0; i < sizeof(MotionBlock) / sizeof(XMVECTOR); i++) {
+            LaneOf(destination[i], index % xr::math::PoseArray::BlockSize) = LaneOf(source[i], last % xr::math::PoseArray::BlockSize);
+        }
+
+        m_objects[index] = m_objects[last];
+        m_writtenPoses[index] = m_writtenPoses[last];
+        if (m_objects[index]) {
+            m_objects[index]->Motion.m_bodyIndex = index;
+        }
+    }
+    Resize(last);
+}
+
+void MotionSystem::Resize(size_t count) {
+    m_previous.Resize(count);
+    m_current.Resize(count);
+    m_interpolated.Resize(count);
+    m_motion.resize(m_current.BlockCount());
+    m_objects.resize(count);
+    m_writtenPoses.resize(count);
+
+    // Unused lanes have no motion and no collision, so the kernels leave their identity poses unchanged.
+    for (size_t index = count; index < m_motion.size() * xr::math::PoseArray::BlockSize; index++) {
+        XMVECTOR* components = reinterpret_cast<XMVECTOR*>(&m_motion[index / xr::math::PoseArray::BlockSize]);
+        for (size_t i = 0; i < sizeof(MotionBlock) / sizeof(XMVECTOR); i++) {
+            LaneOf(components[i], index % xr::math::PoseArray::BlockSize) = 0;
+        }
+    }
+}
+
+void MotionSystem::SetBodyMotion(size_t index, const Motion& motion) {
+    MotionBlock& block = m_motion[index / xr::math::PoseArray::BlockSize];
+    const size_t lane = index % xr::math::PoseArray::BlockSize;
+    LaneOf(block.LinearVelocityX, lane) = motion.LinearVelocity.x;
+    LaneOf(block.LinearVelocityY, lane) = motion.LinearVelocity.y;
+    LaneOf(block.LinearVelocityZ, lane) = motion.LinearVelocity.z;
+    LaneOf(block.AngularVelocityX, lane) = motion.AngularVelocity.x;
+    LaneOf(block.AngularVelocityY, lane) = motion.AngularVelocity.y;
+    LaneOf(block.AngularVelocityZ, lane) = motion.AngularVelocity.z;
+    LaneOf(block.LinearAccelerationX, lane) = motion.LinearAcceleration.x;
+    LaneOf(block.LinearAccelerationY, lane) = motion.LinearAcceleration.y;
+    LaneOf(block.LinearAccelerationZ, lane) = motion.LinearAcceleration.z;
+    LaneOf(block.AngularAccelerationX, lane) = motion.AngularAcceleration.x;
+    LaneOf(block.AngularAccelerationY, lane) = motion.AngularAcceleration.y;
+    LaneOf(block.AngularAccelerationZ, lane) = motion.AngularAcceleration.z;
+    LaneOf(block.CollisionRadius, lane) = motion.CollisionRadius;
+    LaneOf(block.Restitution, lane) = motion.Restitution;
+}
+
+void MotionSystem::GetBodyMotion(size_t index, Motion& motion) const {
+    const MotionBlock& block = m_motion[index / xr::math::PoseArray::BlockSize];
+    const size_t lane = index % xr::math::PoseArray::BlockSize;
+    motion.LinearVelocity = {LaneOf(block.LinearVelocityX, lane), LaneOf(block.LinearVelocityY, lane), LaneOf(block.LinearVelocityZ, lane)};
+    motion.AngularVelocity = {
+        LaneOf(block.AngularVelocityX, lane), LaneOf(block.AngularVelocityY, lane), LaneOf(block.AngularVelocityZ, lane)};
+}
+
+void MotionSystem::TeleportBody(size_t index, const XrPosef& pose) {
+    m_previous.Set(index, pose);
+    m_current.Set(index, pose);
+    m_interpolated.Set(index, pose);
+    m_writtenPoses[index] = pose;
+}
+
+void MotionSystem::SetCollisionPlanes(const CollisionPlane* planes, size_t count) {
+    m_planes.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const XMVECTOR orientation = xr::math::LoadXrQuaternion(planes[i].Pose.orientation);
+        PlaneBasis& basis = m_planes[i];
+        basis.Origin = xr::math::cast(planes[i].Pose.position);
+        XMStoreFloat3(&basis.Normal, XMVector3Rotate(g_XMIdentityR2, orientation));
+        XMStoreFloat3(&basis.AxisX, XMVector3Rotate(g_XMIdentityR0, orientation));
+        XMStoreFloat3(&basis.AxisY, XMVector3Rotate(g_XMIdentityR1, orientation));
+        basis.HalfWidth = planes[i].Size.width / 2;
+        basis.HalfHeight = planes[i].Size.height / 2;
+    }
+}
+
+void MotionSystem::Update(std::chrono::duration<float> elapsed) {
+    for (Object* object : m_changedObjects) {
+        object->Motion.m_enabledChanged = false;
+        Track(*object);
+    }
+    m_changedObjects.clear();
+
+    // Go backwards, since untracking moves the last body into the removed slot.
+    for (size_t index = m_objects.size(); index-- > 0;) {
+        if (Object* object = m_objects[index]) {
+            Track(*object);
+        }
+    }
+
+    m_accumulatedTime += elapsed.count();
+
+    uint32_t steps = 0;
+    for (; m_accumulatedTime >= m_timeStep && steps < m_maxStepsPerUpdate; steps++) {
+        Step();
+        m_accumulatedTime -= m_timeStep;
+    }
+    if (steps == m_maxStepsPerUpdate) {
+        m_accumulatedTime = std::fmod(m_accumulatedTime, m_timeStep);
+    }
+
+    xr::math::SlerpPoses(m_previous, m_current, m_accumulatedTime / m_timeStep, m_interpolated);
+
+    for (size_t index = 0; index < m_objects.size(); index++) {
+        if (Object* object = m_objects[index]) {
+            const XrPosef pose = m_interpolated.Get(index);
+            object->Pose() = pose;
+            m_writtenPoses[index] = pose;
+            GetBodyMotion(index, object->Motion);
+        }
+    }
+}
+
+void MotionSystem::Step() {
+    const XMVECTOR dt = XMVectorReplicate(m_timeStep);
+    const XMVECTOR halfDt = XMVectorReplicate(m_timeStep / 2);
+
+    m_previous = m_current;
+    xr::math::PoseArray::Block* poses = m_current.Blocks();
+    for (size_t i = 0; i < m_current.BlockCount(); i++) {
+        xr::math::PoseArray::Block& pose = poses[i];
+        MotionBlock& motion = m_motion[i];
+
+        // Semi-implicit Euler: the new velocity moves the body, which keeps bouncing bodies from gaining energy.
+        motion.LinearVelocityX = XMVectorMultiplyAdd(motion.LinearAccelerationX, dt, motion.LinearVelocityX);
+        motion.LinearVelocityY = XMVectorMultiplyAdd(motion.LinearAccelerationY, dt, motion.LinearVelocityY);
+        motion.LinearVelocityZ = XMVectorMultiplyAdd(motion.LinearAccelerationZ, dt, motion.LinearVelocityZ);
+        motion.AngularVelocityX = XMVectorMultiplyAdd(motion.AngularAccelerationX, dt, motion.AngularVelocityX);
+        motion.AngularVelocityY = XMVectorMultiplyAdd(motion.AngularAccelerationY, dt, motion.AngularVelocityY);
+        motion.AngularVelocityZ = XMVectorMultiplyAdd(motion.AngularAccelerationZ, dt, motion.AngularVelocityZ);
+
+        pose.PositionX = XMVectorMultiplyAdd(motion.LinearVelocityX, dt, pose.PositionX);
+        pose.PositionY = XMVectorMultiplyAdd(motion.LinearVelocityY, dt, pose.PositionY);
+        pose.PositionZ = XMVectorMultiplyAdd(motion.LinearVelocityZ, dt, pose.PositionZ);
+
+        // Rotate by the world space angular velocity: q' = exp(w * dt / 2) * q.
+        // sin(|w| * dt / 2) / |w| tends to dt / 2 for small velocities, which also covers bodies that do not rotate.
+        XMVECTOR speedSq = XMVectorMultiply(motion.AngularVelocityX, motion.AngularVelocityX);
+        speedSq = XMVectorMultiplyAdd(motion.AngularVelocityY, motion.AngularVelocityY, speedSq);
+        speedSq = XMVectorMultiplyAdd(motion.AngularVelocityZ, motion.AngularVelocityZ, speedSq);
+        const XMVECTOR speed = XMVectorSqrt(speedSq);
+        XMVECTOR sinHalfAngle, cosHalfAngle;
+        XMVectorSinCos(&sinHalfAngle, &cosHalfAngle, XMVectorMultiply(speed, halfDt));
+        const XMVECTOR rotating = XMVectorGreater(speed, XMVectorReplicate(1e-6f));
+        const XMVECTOR axisScale = XMVectorSelect(halfDt, XMVectorDivide(sinHalfAngle, speed), rotating);
+
+        xr::math::detail::MultiplyQuaternions(XMVectorMultiply(motion.AngularVelocityX, axisScale),
+                                              XMVectorMultiply(motion.AngularVelocityY, axisScale),
+                                              XMVectorMultiply(motion.AngularVelocityZ, axisScale),
+                                              cosHalfAngle,
+                                              pose.OrientationX,
+                                              pose.OrientationY,
+                                              pose.OrientationZ,
+                                              pose.OrientationW,
+                                              pose);
+
+        // Renormalize so rounding errors do not accumulate over many steps.
+        XMVECTOR lengthSq = XMVectorMultiply(pose.OrientationX, pose.OrientationX);
+        lengthSq = XMVectorMultiplyAdd(pose.OrientationY, pose.OrientationY, lengthSq);
+        lengthSq = XMVectorMultiplyAdd(pose.OrientationZ, pose.OrientationZ, lengthSq);
+        lengthSq = XMVectorMultiplyAdd(pose.OrientationW, pose.OrientationW, lengthSq);
+        const XMVECTOR inverseLength = XMVectorReciprocalSqrt(lengthSq);
+        pose.OrientationX = XMVectorMultiply(pose.OrientationX, inverseLength);
+        pose.OrientationY = XMVectorMultiply(pose.OrientationY, inverseLength);
+        pose.OrientationZ = XMVectorMultiply(pose.OrientationZ, inverseLength);
+        pose.OrientationW = XMVectorMultiply(pose.OrientationW, inverseLength);
+
+        for (const PlaneBasis& plane : m_planes) {
+            Collide(pose, motion, plane);
+        }
+    }
+}
+
+void MotionSystem::Collide(xr::math::PoseArray::Block& pose, MotionBlock& motion, const PlaneBasis& plane) const {
+    const XMVECTOR relativeX = XMVectorSubtract(pose.PositionX, XMVectorReplicate(plane.Origin.x));
+    const XMVECTOR relativeY = XMVectorSubtract(pose.PositionY, XMVectorReplicate(plane.Origin.y));
+    const XMVECTOR relativeZ = XMVectorSubtract(pose.PositionZ, XMVectorReplicate(plane.Origin.z));
+
+    // A sphere touches the plane when its center is within the plane bounds and closer to the plane than its radius.
+    const XMVECTOR distance = Dot3(relativeX, relativeY, relativeZ, plane.Normal);
+    const XMVECTOR u = Dot3(relativeX, relativeY, relativeZ, plane.AxisX);
+    const XMVECTOR v = Dot3(relativeX, relativeY, relativeZ, plane.AxisY);
+    XMVECTOR contact = XMVectorInBounds(distance, motion.CollisionRadius);
+    contact = XMVectorAndInt(contact, XMVectorLessOrEqual(XMVectorAbs(u), XMVectorReplicate(plane.HalfWidth)));
+    contact = XMVectorAndInt(contact, XMVectorLessOrEqual(XMVectorAbs(v), XMVectorReplicate(plane.HalfHeight)));
+    contact = XMVectorAndInt(contact, XMVectorGreater(motion.CollisionRadius, g_XMZero));
+
+    // Push the sphere out to the front of the plane.
+    const XMVECTOR push = XMVectorSelect(g_XMZero, XMVectorSubtract(motion.CollisionRadius, distance), contact);
+    pose.PositionX = XMVectorMultiplyAdd(push, XMVectorReplicate(plane.Normal.x), pose.PositionX);
+    pose.PositionY = XMVectorMultiplyAdd(push, XMVectorReplicate(plane.Normal.y), pose.PositionY);
+    pose.PositionZ = XMVectorMultiplyAdd(push, XMVectorReplicate(plane.Normal.z), pose.PositionZ);
+
+    // Reflect the velocity towards the plane, scaled by the restitution.
+    const XMVECTOR normalVelocity = Dot3(motion.LinearVelocityX, motion.LinearVelocityY, motion.LinearVelocityZ, plane.Normal);
+    const XMVECTOR bounce = XMVectorAndInt(contact, XMVectorLess(normalVelocity, g_XMZero));
+    const XMVECTOR impulse =
+        XMVectorSelect(g_XMZero, XMVectorNegate(XMVectorMultiplyAdd(normalVelocity, motion.Restitution, normalVelocity)), bounce);
+    motion.LinearVelocityX = XMVectorMultiplyAdd(impulse, XMVectorReplicate(plane.Normal.x), motion.LinearVelocityX);
+    motion.LinearVelocityY = XMVectorMultiplyAdd(impulse, XMVectorReplicate(plane.Normal.y), motion.LinearVelocityY);
+    motion.LinearVelocityZ = XMVectorMultiplyAdd(impulse, XMVectorReplicate(plane.Normal.z), motion.LinearVelocityZ);
+}
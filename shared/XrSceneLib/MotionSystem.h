@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <XrUtility/XrMathBatch.h>
+#include "Object.h"
+
+namespace engine {
+
+    // A bounded plane that bodies with a collision radius bounce off. The plane lies in the XY plane of its pose
+    // with its normal along +Z, the same convention as scene understanding planes.
+    struct CollisionPlane {
+        XrPosef Pose;
+        XrExtent2Df Size;
+    };
+
+    // Integrates the Motion of the enabled objects of a scene at a fixed time step.
+    // The motion state of the bodies is kept in blocks of 4 (structure of arrays) and integrated with DirectXMath,
+    // so each step processes 4 bodies per instruction. Object poses are interpolated between the last two steps,
+    // so motion is smooth regardless of the frame rate and the result only depends on the time step.
+    class MotionSystem {
+    public:
+        static constexpr std::chrono::duration<float> DefaultTimeStep{1.0f / 120.0f};
+        static constexpr uint32_t DefaultMaxStepsPerUpdate = 8;
+
+        explicit MotionSystem(std::chrono::duration<float> timeStep = DefaultTimeStep,
+                              uint32_t maxStepsPerUpdate = DefaultMaxStepsPerUpdate);
+
+        // Simulate the object whenever its Motion is enabled, until it is removed. The scene adds and removes its objects.
+        void Add(Object& object);
+        void Remove(Object& object);
+
+        // Start or stop simulating the objects whose Motion was enabled or disabled since the last update, and take the latest
+        // Motion and pose of every simulated object. If the pose of an object was changed since the last update, its body is
+        // moved there without interpolation.
+        // Then run as many fixed steps as fit in the elapsed time plus the time left over from the previous update,
+        // and write the interpolated poses and the new velocities back to the simulated objects.
+        // At most maxStepsPerUpdate steps are run, so a long hitch slows the simulation down instead of stalling it.
+        void Update(std::chrono::duration<float> elapsed);
+
+        void SetCollisionPlanes(const CollisionPlane* planes, size_t count);
+        void ClearCollisionPlanes() {
+            m_planes.clear();
+        }
+
+        // Bodies can also be simulated without objects, e.g. to replay a recorded simulation.
+        size_t AddBody(const XrPosef& pose, const Motion& motion);
+        void RemoveBody(size_t index);
+        void SetBodyMotion(size_t index, const Motion& motion);
+        void GetBodyMotion(size_t index, Motion& motion) const;
+        void TeleportBody(size_t index, const XrPosef& pose);
+
+        size_t BodyCount() const {
+            return m_current.Size();
+        }
+        XrPosef BodyPose(size_t index) const {
+            return m_current.Get(index);
+        }
+        // The pose between the last two steps as of the last Update.
+        XrPosef InterpolatedBodyPose(size_t index) const {
+            return m_interpolated.Get(index);
+        }
+
+        // Advance all bodies by one time step.
+        void Step();
+
+    private:
+        friend struct Motion;
+
+        struct MotionBlock {
+            DirectX::XMVECTOR LinearVelocityX, LinearVelocityY, LinearVelocityZ;
+            DirectX::XMVECTOR AngularVelocityX, AngularVelocityY, AngularVelocityZ;
+            DirectX::XMVECTOR LinearAccelerationX, LinearAccelerationY, LinearAccelerationZ;
+            DirectX::XMVECTOR AngularAccelerationX, AngularAccelerationY, AngularAccelerationZ;
+            DirectX::XMVECTOR CollisionRadius, Restitution;
+        };
+
+        struct PlaneBasis {
+            DirectX::XMFLOAT3 Origin, Normal, AxisX, AxisY;
+            float HalfWidth, HalfHeight;
+        };
+
+        // Start or stop simulating an object according to its Motion, and take the latest values of its Motion and pose.
+        void Track(Object& object);
+        void Untrack(Object& object);
+
+        void Resize(size_t count);
+        void Collide(xr::math::PoseArray::Block& pose, MotionBlock& motion, const PlaneBasis& plane) const;
+
+        const float m_timeStep;
+        const uint32_t m_maxStepsPerUpdate;
+        float m_accumulatedTime{0};
+
+        xr::math::PoseArray m_previous;
+        xr::math::PoseArray m_current;
+        xr::math::PoseArray m_interpolated;
+        std::vector<MotionBlock> m_motion;
+
+        // The tracked object of each body, or null for bodies added with AddBody, and the pose last written to it.
+        std::vector<Object*> m_objects;
+        std::vector<XrPosef> m_writtenPoses;
+
+        // Objects whose Motion was enabled or disabled since the last update.
+        std::vector<Object*> m_changedObjects;
+
+        std::vector<PlaneBasis> m_planes;
+    };
+} // namespace engine
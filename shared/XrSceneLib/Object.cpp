@@ -16,8 +16,13 @@ bool Object::IsVisibleForViewIndex(uint32_t viewIndex) const {
     return (m_visibleViewIndexMask.m_mask & (1 << viewIndex)) > 0;
 }
 
-void Object::Update(engine::Context& /*context*/, const FrameTime& frameTime) {
-    Motion.UpdateMotionAndPose(Pose(), frameTime.Elapsed);
+bool Object::IsVisibleForAllViews(uint32_t viewCount) const {
+    assert(viewCount < m_visibleViewIndexMask.MaxViewCount);
+    const uint32_t viewsMask = (1 << viewCount) - 1;
+    return (m_visibleViewIndexMask.m_mask & viewsMask) == viewsMask;
+}
+
+void Object::Update(engine::Context& /*context*/, const FrameTime& /*frameTime*/) {
 }
 
 void Object::Render(Context& context) const {
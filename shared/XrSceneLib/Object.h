@@ -15,7 +15,7 @@ namespace engine {
     public:
         virtual ~Object() = default;
         ObjectState State;
-        Motion Motion;
+        engine::Motion Motion;
 
     public:
         void SetParent(std::shared_ptr<engine::Object> parent) {
@@ -31,6 +31,7 @@ namespace engine {
 
         void SetOnlyVisibleForViewIndex(uint32_t viewIndex);
         bool IsVisibleForViewIndex(uint32_t viewIndex) const;
+        bool IsVisibleForAllViews(uint32_t viewCount) const;
 
         const XrPosef& Pose() const {
             return m_pose;
@@ -55,6 +56,12 @@ namespace engine {
         virtual void Render(Context& context) const;
 
     private:
+        friend struct Scene;
+
+        // Position of this object in the object list of the scene it was added to, so it can be removed without a search.
+        static constexpr size_t NotInScene = static_cast<size_t>(-1);
+        size_t m_sceneIndex{NotInScene};
+
         bool m_isVisible{true};
 
         XrPosef m_pose = xr::math::Pose::Identity();
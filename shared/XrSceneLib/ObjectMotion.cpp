@@ -2,10 +2,22 @@
 // Licensed under the MIT License.
 
 #include "pch.h"
-#include "ObjectMotion.h"
+#include "MotionSystem.h"
 
 using engine::Motion;
 
+void Motion::SetEnabled(bool enabled) {
+    if (m_enabled == enabled) {
+        return;
+    }
+
+    m_enabled = enabled;
+    if (m_system && !m_enabledChanged) {
+        m_enabledChanged = true;
+        m_system->m_changedObjects.push_back(m_object);
+    }
+}
+
 void Motion::SetGravity(float gravitationalAcceleration) {
     LinearAcceleration = {0, -gravitationalAcceleration, 0};
 }
@@ -20,34 +32,3 @@ void Motion::SetVelocity(const XrSpaceVelocity& velocity) {
     AngularVelocity = (velocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) ? xr::math::cast(velocity.angularVelocity)
                                                                                      : DirectX::XMFLOAT3{0, 0, 0};
 }
-
-void Motion::UpdateMotionAndPose(XrPosef& pose, std::chrono::duration<float> durationInSeconds) {
-    using namespace DirectX;
-
-    if (!Enabled) {
-        return;
-    }
-
-    const float dt = durationInSeconds.count();
-
-    const auto position = xr::math::LoadXrVector3(pose.position);
-    const auto orientation = xr::math::LoadXrQuaternion(pose.orientation);
-    const auto linearVelocity = XMLoadFloat3(&LinearVelocity);
-    const auto angularVelocity = XMLoadFloat3(&AngularVelocity);
-    const auto linearAcceleration = XMLoadFloat3(&LinearAcceleration);
-    const auto angularAcceleration = XMLoadFloat3(&AngularAcceleration);
-
-    XMStoreFloat3(&LinearVelocity, linearVelocity + XMVectorScale(linearAcceleration, dt));
-    XMStoreFloat3(&AngularVelocity, angularVelocity + XMVectorScale(angularAcceleration, dt));
-
-    xr::math::StoreXrVector3(&pose.position, position + XMVectorScale(linearVelocity, dt));
-
-    // Convert angularVelocity from object space to world space
-    auto angularVelocityInWorld = XMVector3Rotate(angularVelocity, XMQuaternionInverse(orientation));
-
-    auto angle = XMVectorGetX(XMVector3Length(angularVelocityInWorld));
-    if (angle > 0.0f) {
-        xr::math::StoreXrQuaternion(&pose.orientation,
-                                    XMQuaternionMultiply(XMQuaternionRotationAxis(angularVelocityInWorld, angle * dt), orientation));
-    }
-}
@@ -4,17 +4,40 @@
 #pragma once
 
 namespace engine {
+    class MotionSystem;
+    class Object;
 
+    // Motion of an object, integrated by the MotionSystem of the scene the object is added to.
+    // AngularVelocity and AngularAcceleration are in world space, in radians per second.
     struct Motion {
-        bool Enabled{false};
         DirectX::XMFLOAT3 LinearVelocity{};
         DirectX::XMFLOAT3 LinearAcceleration{};
         DirectX::XMFLOAT3 AngularVelocity{};
         DirectX::XMFLOAT3 AngularAcceleration{};
 
+        // A sphere of this radius around the object position bounces off the scene collision planes. 0 disables collision.
+        float CollisionRadius{0};
+        // Fraction of the velocity towards a plane that is kept after bouncing off it.
+        float Restitution{0.5f};
+
+        // An object in a scene starts or stops being simulated at the next update of the scene's MotionSystem.
+        void SetEnabled(bool enabled);
+        bool IsEnabled() const {
+            return m_enabled;
+        }
+
         void SetGravity(float gravitationalAcceleration = 9.8f);
         void SetVelocity(const XrSpaceVelocity& velocity);
         void SetRotation(const XrVector3f& axis, float radiansPerSecond);
-        void UpdateMotionAndPose(XrPosef& pose, std::chrono::duration<float> durationInSeconds);
+
+    private:
+        friend class MotionSystem;
+        static constexpr size_t NoBody = static_cast<size_t>(-1);
+        bool m_enabled{false};
+        bool m_enabledChanged{false}; // Queued in m_system to be tracked or untracked at its next update.
+        // The motion system of the scene the object is in, and the object that owns this Motion, while it is in a scene.
+        MotionSystem* m_system{nullptr};
+        Object* m_object{nullptr};
+        size_t m_bodyIndex{NoBody};
     };
 } // namespace engine
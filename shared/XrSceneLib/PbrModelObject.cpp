@@ -29,11 +29,8 @@ void PbrModelObject::Render(Context& context) const {
         return;
     }
 
-    context.PbrResources.SetShadingMode(m_shadingMode);
-    context.PbrResources.SetFillMode(m_fillMode);
-    context.PbrResources.SetModelToWorld(WorldTransform(), context.DeviceContext.get());
-    context.PbrResources.Bind(context.DeviceContext.get());
-    m_pbrModel->Render(context.PbrResources, context.DeviceContext.get());
+    context.RenderQueue.Add(
+        context.PbrResources, context.DeviceContext.get(), *m_pbrModel, WorldTransform(), m_shadingMode, m_fillMode);
 }
 
 void PbrModelObject::SetShadingMode(const Pbr::ShadingMode& shadingMode) {
@@ -55,7 +52,7 @@ using engine::PbrModelLoadOperation;
 
 /* static */ PbrModelLoadOperation PbrModelLoadOperation::LoadGltfBinaryAsync(Pbr::Resources& pbrResources, std::wstring filename) {
     return PbrModelLoadOperation(std::async(std::launch::async, [&pbrResources, filename = std::move(filename)]() {
-        const std::vector<uint8_t> glbData = sample::ReadFileBytes(sample::FindFileInAppFolder(filename.c_str()));
+        const sample::MappedFile glbData = sample::MapFileBytes(sample::FindFileInAppFolder(filename.c_str()));
         return Gltf::FromGltfBinary(pbrResources, glbData);
     }));
 }
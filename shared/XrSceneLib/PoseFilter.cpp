@@ -0,0 +1,266 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "PoseFilter.h"
+
+using namespace DirectX;
+
+namespace {
+    // Smoothing factor of an exponential low pass filter with the given cutoff frequency: tau = 1 / (2 * pi * cutoff),
+    // alpha = 1 / (1 + tau / dt) = (2 * pi * cutoff * dt) / (2 * pi * cutoff * dt + 1).
+    XMVECTOR XM_CALLCONV SmoothingFactor(FXMVECTOR cutoff, FXMVECTOR twoPiDeltaSeconds) {
+        const XMVECTOR r = XMVectorMultiply(cutoff, twoPiDeltaSeconds);
+        return XMVectorDivide(r, XMVectorAdd(r, g_XMOne));
+    }
+
+    // Low pass filter the speed, then use it to pick the cutoff frequency of the value filter, as in the One-Euro filter.
+    XMVECTOR XM_CALLCONV FilterSpeedAndGetAlpha(XMVECTOR& filteredSpeed,
+                                                FXMVECTOR speed,
+                                                FXMVECTOR twoPiDeltaSeconds,
+                                                const engine::OneEuroFilterParameters& parameters) {
+        const XMVECTOR derivativeAlpha = SmoothingFactor(XMVectorReplicate(parameters.DerivativeCutoff), twoPiDeltaSeconds);
+        filteredSpeed = XMVectorMultiplyAdd(derivativeAlpha, XMVectorSubtract(speed, filteredSpeed), filteredSpeed);
+
+        const XMVECTOR cutoff =
+            XMVectorMultiplyAdd(XMVectorReplicate(parameters.Beta), filteredSpeed, XMVectorReplicate(parameters.MinCutoff));
+        return SmoothingFactor(cutoff, twoPiDeltaSeconds);
+    }
+} // namespace
+
+namespace engine {
+    XrPosef ExtrapolatePose(const XrPosef& pose, const XrSpaceVelocity& velocity, float seconds) {
+        XrPosef result = pose;
+
+        if (velocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) {
+            const XMVECTOR position = xr::math::LoadXrVector3(pose.position);
+            const XMVECTOR linearVelocity = xr::math::LoadXrVector3(velocity.linearVelocity);
+            xr::math::StoreXrVector3(&result.position, XMVectorMultiplyAdd(linearVelocity, XMVectorReplicate(seconds), position));
+        }
+
+        if (velocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) {
+            // The angular velocity is expressed in the base space, so the rotation over the interval is applied after the pose.
+            const XMVECTOR angularVelocity = xr::math::LoadXrVector3(velocity.angularVelocity);
+            const float angularSpeed = XMVectorGetX(XMVector3Length(angularVelocity));
+            if (angularSpeed > 0) {
+                const XMVECTOR axis = XMVectorScale(angularVelocity, 1 / angularSpeed);
+                const XMVECTOR rotation = XMQuaternionRotationNormal(axis, angularSpeed * seconds);
+                xr::math::StoreXrQuaternion(&result.orientation,
+                                            XMQuaternionMultiply(xr::math::LoadXrQuaternion(pose.orientation), rotation));
+            }
+        }
+
+        return result;
+    }
+
+    PoseDeadBand::PoseDeadBand(float positionThreshold, float angleThreshold)
+        : m_positionThreshold(positionThreshold)
+        , m_cosHalfAngleThreshold(std::cos(angleThreshold / 2)) {
+    }
+
+    bool PoseDeadBand::Update(const XrPosef& pose) {
+        if (m_hasPose) {
+            const XMVECTOR delta = XMVectorSubtract(xr::math::LoadXrVector3(pose.position), xr::math::LoadXrVector3(m_pose.position));
+            const bool positionChanged = XMVectorGetX(XMVector3LengthSq(delta)) > m_positionThreshold * m_positionThreshold;
+
+            // The angle between two orientations is 2 * acos(|q1 . q2|), compared without the acos.
+            const float dot = std::abs(XMVectorGetX(
+                XMVector4Dot(xr::math::LoadXrQuaternion(pose.orientation), xr::math::LoadXrQuaternion(m_pose.orientation))));
+            const bool orientationChanged = dot < m_cosHalfAngleThreshold;
+
+            if (!positionChanged && !orientationChanged) {
+                return false;
+            }
+        }
+
+        m_pose = pose;
+        m_hasPose = true;
+        return true;
+    }
+
+    OneEuroPoseFilters::OneEuroPoseFilters(size_t count,
+                                           const OneEuroFilterParameters& positionParameters,
+                                           const OneEuroFilterParameters& orientationParameters)
+        : m_positionParameters(positionParameters)
+        , m_orientationParameters(orientationParameters)
+        , m_filtered(count)
+        , m_positionSpeed(m_filtered.BlockCount(), g_XMZero)
+        , m_orientationSpeed(m_filtered.BlockCount(), g_XMZero)
+        , m_needsReset(count, true) {
+    }
+
+    void OneEuroPoseFilters::Reset(size_t index) {
+        m_needsReset[index] = true;
+        m_anyNeedsReset = true;
+    }
+
+    void OneEuroPoseFilters::Reset() {
+        std::fill(m_needsReset.begin(), m_needsReset.end(), true);
+        m_anyNeedsReset = true;
+    }
+
+    void OneEuroPoseFilters::Update(const xr::math::PoseArray& poses, float deltaSeconds) {
+        if (poses.Size() != m_filtered.Size()) {
+            throw std::invalid_argument("Pose count does not match the filter count");
+        }
+
+        if (deltaSeconds > 0) {
+            const XMVECTOR inverseDeltaSeconds = XMVectorReplicate(1 / deltaSeconds);
+            const XMVECTOR twoPiDeltaSeconds = XMVectorReplicate(XM_2PI * deltaSeconds);
+
+            const xr::math::PoseArray::Block* in = poses.Blocks();
+            xr::math::PoseArray::Block* out = m_filtered.Blocks();
+            for (size_t i = 0; i < m_filtered.BlockCount(); i++) {
+                const xr::math::PoseArray::Block& sample = in[i];
+                xr::math::PoseArray::Block& filtered = out[i];
+
+                // Position: speed is the distance moved since the last filtered position.
+                const XMVECTOR dx = XMVectorSubtract(sample.PositionX, filtered.PositionX);
+                const XMVECTOR dy = XMVectorSubtract(sample.PositionY, filtered.PositionY);
+                const XMVECTOR dz = XMVectorSubtract(sample.PositionZ, filtered.PositionZ);
+                const XMVECTOR distanceSquared = XMVectorMultiplyAdd(dz, dz, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dx, dx)));
+                const XMVECTOR positionSpeed = XMVectorMultiply(XMVectorSqrt(distanceSquared), inverseDeltaSeconds);
+                const XMVECTOR positionAlpha =
+                    FilterSpeedAndGetAlpha(m_positionSpeed[i], positionSpeed, twoPiDeltaSeconds, m_positionParameters);
+
+                filtered.PositionX = XMVectorMultiplyAdd(positionAlpha, dx, filtered.PositionX);
+                filtered.PositionY = XMVectorMultiplyAdd(positionAlpha, dy, filtered.PositionY);
+                filtered.PositionZ = XMVectorMultiplyAdd(positionAlpha, dz, filtered.PositionZ);
+
+                // Orientation: speed is the angle rotated since the last filtered orientation. The sample is flipped to the
+                // same hemisphere as the filtered orientation, then blended with a normalized lerp, which is accurate for the
+                // small angles between consecutive samples.
+                XMVECTOR dot = XMVectorMultiply(sample.OrientationX, filtered.OrientationX);
+                dot = XMVectorMultiplyAdd(sample.OrientationY, filtered.OrientationY, dot);
+                dot = XMVectorMultiplyAdd(sample.OrientationZ, filtered.OrientationZ, dot);
+                dot = XMVectorMultiplyAdd(sample.OrientationW, filtered.OrientationW, dot);
+                const XMVECTOR sign = XMVectorSelect(g_XMOne, g_XMNegativeOne, XMVectorLess(dot, g_XMZero));
+                const XMVECTOR angle = XMVectorScale(XMVectorACos(XMVectorMin(XMVectorAbs(dot), g_XMOne)), 2);
+                const XMVECTOR orientationSpeed = XMVectorMultiply(angle, inverseDeltaSeconds);
+                const XMVECTOR orientationAlpha =
+                    FilterSpeedAndGetAlpha(m_orientationSpeed[i], orientationSpeed, twoPiDeltaSeconds, m_orientationParameters);
+
+                const XMVECTOR qx = XMVectorLerpV(filtered.OrientationX, XMVectorMultiply(sample.OrientationX, sign), orientationAlpha);
+                const XMVECTOR qy = XMVectorLerpV(filtered.OrientationY, XMVectorMultiply(sample.OrientationY, sign), orientationAlpha);
+                const XMVECTOR qz = XMVectorLerpV(filtered.OrientationZ, XMVectorMultiply(sample.OrientationZ, sign), orientationAlpha);
+                const XMVECTOR qw = XMVectorLerpV(filtered.OrientationW, XMVectorMultiply(sample.OrientationW, sign), orientationAlpha);
+                XMVECTOR lengthSquared = XMVectorMultiply(qx, qx);
+                lengthSquared = XMVectorMultiplyAdd(qy, qy, lengthSquared);
+                lengthSquared = XMVectorMultiplyAdd(qz, qz, lengthSquared);
+                lengthSquared = XMVectorMultiplyAdd(qw, qw, lengthSquared);
+                const XMVECTOR inverseLength = XMVectorReciprocalSqrt(lengthSquared);
+
+                filtered.OrientationX = XMVectorMultiply(qx, inverseLength);
+                filtered.OrientationY = XMVectorMultiply(qy, inverseLength);
+                filtered.OrientationZ = XMVectorMultiply(qz, inverseLength);
+                filtered.OrientationW = XMVectorMultiply(qw, inverseLength);
+            }
+        }
+
+        // Poses that were reset start from the sample, with zero speed.
+        if (m_anyNeedsReset) {
+            for (size_t index = 0; index < m_filtered.Size(); index++) {
+                if (m_needsReset[index]) {
+                    m_filtered.Set(index, poses.Get(index));
+
+                    const size_t block = index / xr::math::PoseArray::BlockSize;
+                    const size_t lane = index % xr::math::PoseArray::BlockSize;
+                    m_positionSpeed[block] = XMVectorSetByIndex(m_positionSpeed[block], 0, lane);
+                    m_orientationSpeed[block] = XMVectorSetByIndex(m_orientationSpeed[block], 0, lane);
+                    m_needsReset[index] = false;
+                }
+            }
+            m_anyNeedsReset = false;
+        }
+    }
+
+    void HandJointsFilter::Update(XrHandJointLocationEXT* jointLocations, uint32_t jointCount, float deltaSeconds) {
+        if (jointCount != m_filters.Size()) {
+            throw std::invalid_argument("Unexpected hand joint count");
+        }
+
+        m_input.Load(&jointLocations[0].pose, jointCount, sizeof(XrHandJointLocationEXT));
+        for (uint32_t k = 0; k < jointCount; k++) {
+            if (!xr::math::Pose::IsPoseValid(jointLocations[k])) {
+                m_filters.Reset(k);
+            }
+        }
+
+        m_filters.Update(m_input, deltaSeconds);
+
+        for (uint32_t k = 0; k < jointCount; k++) {
+            if (xr::math::Pose::IsPoseValid(jointLocations[k])) {
+                jointLocations[k].pose = m_filters.Poses().Get(k);
+            }
+        }
+    }
+
+    KalmanPoseFilter::KalmanPoseFilter(float processNoise, float measurementNoise)
+        : m_processNoise(processNoise)
+        , m_measurementNoise(measurementNoise) {
+    }
+
+    void KalmanPoseFilter::ConstantVelocityState::Initialize(float value) {
+        Value = value;
+        Velocity = 0;
+        P00 = 1;
+        P01 = 0;
+        P11 = 1;
+    }
+
+    float KalmanPoseFilter::ConstantVelocityState::Update(float measurement, float dt, float processNoise, float measurementNoise) {
+        // Predict with x' = x + v * dt, and process noise from a white noise acceleration.
+        Value += Velocity * dt;
+        const float dt2 = dt * dt;
+        const float p00 = P00 + dt * (2 * P01 + dt * P11) + processNoise * dt2 * dt2 / 4;
+        const float p01 = P01 + dt * P11 + processNoise * dt2 * dt / 2;
+        const float p11 = P11 + processNoise * dt2;
+
+        // Correct with the measured value.
+        const float innovation = measurement - Value;
+        const float s = p00 + measurementNoise;
+        const float k0 = p00 / s;
+        const float k1 = p01 / s;
+        Value += k0 * innovation;
+        Velocity += k1 * innovation;
+        P00 = (1 - k0) * p00;
+        P01 = (1 - k0) * p01;
+        P11 = p11 - k1 * p01;
+        return Value;
+    }
+
+    XrPosef KalmanPoseFilter::Update(const XrPosef& pose, float deltaSeconds) {
+        const float measurements[7] = {pose.position.x,
+                                       pose.position.y,
+                                       pose.position.z,
+                                       pose.orientation.x,
+                                       pose.orientation.y,
+                                       pose.orientation.z,
+                                       pose.orientation.w};
+
+        if (!m_hasState) {
+            for (size_t i = 0; i < m_state.size(); i++) {
+                m_state[i].Initialize(measurements[i]);
+            }
+            m_hasState = true;
+            return pose;
+        }
+
+        // q and -q are the same orientation, so measure the one closest to the filtered orientation.
+        const float dot = measurements[3] * m_state[3].Value + measurements[4] * m_state[4].Value + measurements[5] * m_state[5].Value +
+                          measurements[6] * m_state[6].Value;
+        const float sign = dot < 0 ? -1.0f : 1.0f;
+
+        float filtered[7];
+        for (size_t i = 0; i < m_state.size(); i++) {
+            const float measurement = i < 3 ? measurements[i] : measurements[i] * sign;
+            filtered[i] = m_state[i].Update(measurement, deltaSeconds, m_processNoise, m_measurementNoise);
+        }
+
+        XrPosef result;
+        result.position = {filtered[0], filtered[1], filtered[2]};
+        const XMVECTOR orientation = XMVectorSet(filtered[3], filtered[4], filtered[5], filtered[6]);
+        xr::math::StoreXrQuaternion(&result.orientation, XMQuaternionNormalize(orientation));
+        return result;
+    }
+} // namespace engine
@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <XrUtility/XrMathBatch.h>
+
+namespace engine {
+
+    // Predict a pose forward in time using the velocity reported with it, e.g. from xrLocateSpace with XrSpaceVelocity chained.
+    // Velocity components that are not flagged valid are treated as zero.
+    XrPosef ExtrapolatePose(const XrPosef& pose, const XrSpaceVelocity& velocity, float seconds);
+
+    // Ignores pose changes smaller than a threshold, so an object that is effectively static does not get its
+    // transform dirtied by tracking noise every frame.
+    class PoseDeadBand {
+    public:
+        PoseDeadBand() = default;
+        PoseDeadBand(float positionThreshold, float angleThreshold);
+
+        // Returns true and updates Pose() if the input moved past the threshold from the current pose.
+        bool Update(const XrPosef& pose);
+
+        const XrPosef& Pose() const {
+            return m_pose;
+        }
+
+        void Reset() {
+            m_hasPose = false;
+        }
+
+    private:
+        float m_positionThreshold{0.001f};          // 1 mm
+        float m_cosHalfAngleThreshold{0.99999762f}; // cos(0.25 degrees / 2)
+        bool m_hasPose{false};
+        XrPosef m_pose{xr::math::Pose::Identity()};
+    };
+
+    struct OneEuroFilterParameters {
+        float MinCutoff;        // Cutoff frequency in Hz when not moving. Lower values remove more jitter.
+        float Beta;             // How fast the cutoff frequency rises with speed. Higher values reduce lag when moving.
+        float DerivativeCutoff; // Cutoff frequency in Hz used to smooth the speed estimate.
+    };
+
+    // One-Euro filters (Casiez et al. 2012) for many poses at once, e.g. all joints of a hand.
+    // The filtered speed of each pose adapts its cutoff frequency, so slow motion is smoothed and fast motion has little lag.
+    // Poses are filtered in blocks of 4 with DirectXMath, using the same layout as xr::math::PoseArray.
+    class OneEuroPoseFilters {
+    public:
+        static constexpr OneEuroFilterParameters DefaultPositionParameters{1.0f, 5.0f, 1.0f};
+        static constexpr OneEuroFilterParameters DefaultOrientationParameters{1.0f, 0.5f, 1.0f};
+
+        explicit OneEuroPoseFilters(size_t count,
+                                    const OneEuroFilterParameters& positionParameters = DefaultPositionParameters,
+                                    const OneEuroFilterParameters& orientationParameters = DefaultOrientationParameters);
+
+        size_t Size() const {
+            return m_filtered.Size();
+        }
+
+        // Filter the next sample of every pose. deltaSeconds is the time since the previous sample.
+        // A pose that was reset takes its next sample unfiltered.
+        void Update(const xr::math::PoseArray& poses, float deltaSeconds);
+
+        // Restart filtering of a pose, e.g. when it lost tracking.
+        void Reset(size_t index);
+        void Reset();
+
+        const xr::math::PoseArray& Poses() const {
+            return m_filtered;
+        }
+
+    private:
+        OneEuroFilterParameters m_positionParameters;
+        OneEuroFilterParameters m_orientationParameters;
+        xr::math::PoseArray m_filtered;
+        std::vector<DirectX::XMVECTOR> m_positionSpeed;    // Filtered speed in meters per second, one lane per pose.
+        std::vector<DirectX::XMVECTOR> m_orientationSpeed; // Filtered speed in radians per second, one lane per pose.
+        std::vector<bool> m_needsReset;
+        bool m_anyNeedsReset{true};
+    };
+
+    // A single One-Euro filtered pose.
+    class OneEuroPoseFilter {
+    public:
+        explicit OneEuroPoseFilter(const OneEuroFilterParameters& positionParameters = OneEuroPoseFilters::DefaultPositionParameters,
+                                   const OneEuroFilterParameters& orientationParameters = OneEuroPoseFilters::DefaultOrientationParameters)
+            : m_filters(1, positionParameters, orientationParameters)
+            , m_input(1) {
+        }
+
+        XrPosef Update(const XrPosef& pose, float deltaSeconds) {
+            m_input.Set(0, pose);
+            m_filters.Update(m_input, deltaSeconds);
+            return m_filters.Poses().Get(0);
+        }
+
+        void Reset() {
+            m_filters.Reset();
+        }
+
+    private:
+        OneEuroPoseFilters m_filters;
+        xr::math::PoseArray m_input;
+    };
+
+    // Smooths hand joint locations in place. Joints without a valid pose are passed through and restart filtering.
+    class HandJointsFilter {
+    public:
+        explicit HandJointsFilter(const OneEuroFilterParameters& positionParameters = OneEuroPoseFilters::DefaultPositionParameters,
+                                  const OneEuroFilterParameters& orientationParameters = OneEuroPoseFilters::DefaultOrientationParameters)
+            : m_filters(XR_HAND_JOINT_COUNT_EXT, positionParameters, orientationParameters) {
+        }
+
+        void Update(XrHandJointLocationEXT* jointLocations, uint32_t jointCount, float deltaSeconds);
+
+    private:
+        OneEuroPoseFilters m_filters;
+        xr::math::PoseArray m_input;
+    };
+
+    // A constant velocity Kalman filter for a pose. Each position component and each quaternion component is filtered
+    // independently, and the orientation is normalized after each update.
+    class KalmanPoseFilter {
+    public:
+        // processNoise is the variance of the unmodeled acceleration, measurementNoise the variance of the tracking noise.
+        explicit KalmanPoseFilter(float processNoise = 1.0f, float measurementNoise = 1e-5f);
+
+        XrPosef Update(const XrPosef& pose, float deltaSeconds);
+
+        void Reset() {
+            m_hasState = false;
+        }
+
+    private:
+        struct ConstantVelocityState {
+            float Value, Velocity;
+            float P00, P01, P11; // Covariance of value and velocity.
+
+            void Initialize(float value);
+            float Update(float measurement, float deltaSeconds, float processNoise, float measurementNoise);
+        };
+
+        float m_processNoise;
+        float m_measurementNoise;
+        bool m_hasState{false};
+        std::array<ConstantVelocityState, 7> m_state{}; // Position xyz, then orientation xyzw.
+    };
+} // namespace engine
@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "PrimaryEyeLocator.h"
+
+using engine::PrimaryEyeLocator;
+
+const std::vector<XrVector3f>& PrimaryEyeLocator::Locate(XrSession session,
+                                                         XrViewConfigurationType viewConfigurationType,
+                                                         XrSpace space,
+                                                         XrTime displayTime) {
+    if (displayTime == m_displayTime && space == m_space) {
+        return m_eyePositions;
+    }
+    m_displayTime = displayTime;
+    m_space = space;
+    m_eyePositions.clear();
+
+    XrViewLocateInfo viewLocateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+    viewLocateInfo.viewConfigurationType = viewConfigurationType;
+    viewLocateInfo.displayTime = displayTime;
+    viewLocateInfo.space = space;
+
+    XrViewState viewState{XR_TYPE_VIEW_STATE};
+    uint32_t viewCount = 0;
+    if (m_views.empty()) {
+        CHECK_XRCMD(xrLocateViews(session, &viewLocateInfo, &viewState, 0, &viewCount, nullptr));
+        m_views.resize(viewCount, {XR_TYPE_VIEW});
+    }
+    CHECK_XRCMD(xrLocateViews(session, &viewLocateInfo, &viewState, static_cast<uint32_t>(m_views.size()), &viewCount, m_views.data()));
+    if ((viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) == 0) {
+        return m_eyePositions;
+    }
+
+    for (uint32_t viewIndex = 0; viewIndex < viewCount; viewIndex++) {
+        m_eyePositions.push_back(m_views[viewIndex].pose.position);
+    }
+    return m_eyePositions;
+}
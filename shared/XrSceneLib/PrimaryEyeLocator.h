@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+namespace engine {
+
+    // Locates the eyes of the primary views once per frame, so the objects that depend on the distance to the viewer share one call
+    // to xrLocateViews instead of each making their own.
+    class PrimaryEyeLocator {
+    public:
+        // The eye positions in the given space at the display time, empty while they are not tracked. Only the first call for a
+        // display time locates the views, later calls return the same positions.
+        const std::vector<XrVector3f>& Locate(XrSession session,
+                                              XrViewConfigurationType viewConfigurationType,
+                                              XrSpace space,
+                                              XrTime displayTime);
+
+    private:
+        XrTime m_displayTime{0};
+        XrSpace m_space{XR_NULL_HANDLE};
+        std::vector<XrView> m_views;
+        std::vector<XrVector3f> m_eyePositions;
+    };
+
+} // namespace engine
@@ -15,6 +15,54 @@
 
 using namespace DirectX;
 
+namespace {
+    // Create views into the swapchain images, each covering viewArraySize slices of the image array, so that
+    // views[imageIndex * (arrayLength / viewArraySize) + firstArraySlice / viewArraySize] covers firstArraySlice.
+    std::vector<winrt::com_ptr<ID3D11RenderTargetView>> CreateRenderTargetViews(ID3D11Device* device,
+                                                                                const sample::dx::SwapchainD3D11& swapchain,
+                                                                                uint32_t arrayLength,
+                                                                                uint32_t viewArraySize,
+                                                                                uint32_t sampleCount) {
+        const uint32_t viewsPerImage = arrayLength / viewArraySize;
+        std::vector<winrt::com_ptr<ID3D11RenderTargetView>> views(swapchain.Images.size() * viewsPerImage);
+        for (size_t imageIndex = 0; imageIndex < swapchain.Images.size(); imageIndex++) {
+            for (uint32_t viewIndex = 0; viewIndex < viewsPerImage; viewIndex++) {
+                const CD3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc(
+                    sampleCount > 1 ? D3D11_RTV_DIMENSION_TEXTURE2DMSARRAY : D3D11_RTV_DIMENSION_TEXTURE2DARRAY,
+                    swapchain.Format,
+                    0 /* mipSlice */,
+                    viewIndex * viewArraySize,
+                    viewArraySize);
+                CHECK_HRCMD(device->CreateRenderTargetView(
+                    swapchain.Images[imageIndex].texture, &renderTargetViewDesc, views[imageIndex * viewsPerImage + viewIndex].put()));
+            }
+        }
+        return views;
+    }
+
+    std::vector<winrt::com_ptr<ID3D11DepthStencilView>> CreateDepthStencilViews(ID3D11Device* device,
+                                                                                const sample::dx::SwapchainD3D11& swapchain,
+                                                                                uint32_t arrayLength,
+                                                                                uint32_t viewArraySize,
+                                                                                uint32_t sampleCount) {
+        const uint32_t viewsPerImage = arrayLength / viewArraySize;
+        std::vector<winrt::com_ptr<ID3D11DepthStencilView>> views(swapchain.Images.size() * viewsPerImage);
+        for (size_t imageIndex = 0; imageIndex < swapchain.Images.size(); imageIndex++) {
+            for (uint32_t viewIndex = 0; viewIndex < viewsPerImage; viewIndex++) {
+                const CD3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc(
+                    sampleCount > 1 ? D3D11_DSV_DIMENSION_TEXTURE2DMSARRAY : D3D11_DSV_DIMENSION_TEXTURE2DARRAY,
+                    swapchain.Format,
+                    0 /* mipSlice */,
+                    viewIndex * viewArraySize,
+                    viewArraySize);
+                CHECK_HRCMD(device->CreateDepthStencilView(
+                    swapchain.Images[imageIndex].texture, &depthStencilViewDesc, views[imageIndex * viewsPerImage + viewIndex].put()));
+            }
+        }
+        return views;
+    }
+} // namespace
+
 engine::ProjectionLayer::ProjectionLayer(const sample::SessionContext& sessionContext) {
     auto primaryViewConfiguraionType = sessionContext.PrimaryViewConfigurationType;
     auto colorSwapchainFormat = sessionContext.SupportedColorSwapchainFormats[0];
@@ -36,6 +84,12 @@ engine::ProjectionLayer::ProjectionLayer(const sample::SessionContext& sessionCo
 
 void engine::ProjectionLayer::DestroySwapchains() {
     for (auto& viewConfigComponent : m_viewConfigComponents) {
+        // The views hold references to the swapchain images, so release them first.
+        viewConfigComponent.second.RenderTargetViews.clear();
+        viewConfigComponent.second.DepthStencilViews.clear();
+        viewConfigComponent.second.RenderTargetArrayViews.clear();
+        viewConfigComponent.second.DepthStencilArrayViews.clear();
+        viewConfigComponent.second.SwapchainArrayLength = 0;
         viewConfigComponent.second.ColorSwapchain = {};
         viewConfigComponent.second.DepthSwapchain = {};
     }
@@ -99,21 +153,26 @@ void engine::ProjectionLayer::PrepareRendering(const Context& context,
                                               : layerCurrentConfig.SwapchainSampleCount;
 
     viewConfigComponent.Viewports.resize(viewConfigViews.size());
+    viewConfigComponent.FrameViewports.resize(viewConfigViews.size());
 
-    for (uint32_t viewIndex = 0; viewIndex < (uint32_t)viewConfigViews.size(); viewIndex++) {
-        viewConfigComponent.Viewports[viewIndex] = CD3D11_VIEWPORT(
-            layerCurrentConfig.DoubleWideMode ? static_cast<float>(swapchainImageWidth * viewIndex + layerCurrentConfig.ViewportOffset.x)
-                                              : static_cast<float>(layerCurrentConfig.ViewportOffset.x),
-            static_cast<float>(layerCurrentConfig.ViewportOffset.y),
-            static_cast<float>(swapchainImageWidth * layerCurrentConfig.ViewportSizeScale.width),
-            static_cast<float>(swapchainImageHeight * layerCurrentConfig.ViewportSizeScale.height));
+    // The viewports may only cover part of the swapchain images, e.g. with dynamic resolution. Only the rendered part is submitted,
+    // so the compositor scales it up to the full view.
+    const int32_t viewportWidth = static_cast<int32_t>(std::ceil(swapchainImageWidth * layerCurrentConfig.ViewportSizeScale.width));
+    const int32_t viewportHeight = static_cast<int32_t>(std::ceil(swapchainImageHeight * layerCurrentConfig.ViewportSizeScale.height));
 
+    for (uint32_t viewIndex = 0; viewIndex < (uint32_t)viewConfigViews.size(); viewIndex++) {
         const int32_t doubleWideOffsetX = static_cast<int32_t>(swapchainImageWidth * viewIndex);
-        viewConfigComponent.LayerDepthImageRect[viewIndex] =
-            viewConfigComponent.LayerColorImageRect[viewIndex] = {layerCurrentConfig.DoubleWideMode ? doubleWideOffsetX : 0,
-                                                                  0,
-                                                                  static_cast<int32_t>(std::ceil(swapchainImageWidth)),
-                                                                  static_cast<int32_t>(std::ceil(swapchainImageHeight))};
+        const XrOffset2Di viewportOffset = {layerCurrentConfig.DoubleWideMode ? doubleWideOffsetX + layerCurrentConfig.ViewportOffset.x
+                                                                              : layerCurrentConfig.ViewportOffset.x,
+                                            layerCurrentConfig.ViewportOffset.y};
+
+        viewConfigComponent.Viewports[viewIndex] = CD3D11_VIEWPORT(static_cast<float>(viewportOffset.x),
+                                                                   static_cast<float>(viewportOffset.y),
+                                                                   static_cast<float>(viewportWidth),
+                                                                   static_cast<float>(viewportHeight));
+
+        viewConfigComponent.LayerDepthImageRect[viewIndex] = viewConfigComponent.LayerColorImageRect[viewIndex] = {
+            viewportOffset, {viewportWidth, viewportHeight}};
     }
 
     if (!shouldResetSwapchain) {
@@ -126,6 +185,11 @@ void engine::ProjectionLayer::PrepareRendering(const Context& context,
     const std::optional<XrViewConfigurationType> viewConfigurationForSwapchain =
         context.Extensions.SupportsSecondaryViewConfiguration ? std::optional{viewConfigType} : std::nullopt;
 
+    viewConfigComponent.RenderTargetViews.clear();
+    viewConfigComponent.DepthStencilViews.clear();
+    viewConfigComponent.RenderTargetArrayViews.clear();
+    viewConfigComponent.DepthStencilArrayViews.clear();
+
     // Create color swapchain with recommended properties.
     viewConfigComponent.ColorSwapchain =
         sample::dx::CreateSwapchainD3D11(context.Session.Handle,
@@ -150,6 +214,20 @@ void engine::ProjectionLayer::PrepareRendering(const Context& context,
                                          XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
                                          viewConfigurationForSwapchain);
 
+    // The swapchain images do not change until the swapchains are recreated, so create their views once here
+    // rather than for every view of every frame.
+    viewConfigComponent.SwapchainArrayLength = arrayLength;
+    viewConfigComponent.RenderTargetViews =
+        CreateRenderTargetViews(context.Device.get(), viewConfigComponent.ColorSwapchain, arrayLength, 1, swapchainSampleCount);
+    viewConfigComponent.DepthStencilViews =
+        CreateDepthStencilViews(context.Device.get(), viewConfigComponent.DepthSwapchain, arrayLength, 1, swapchainSampleCount);
+    if (arrayLength > 1) {
+        viewConfigComponent.RenderTargetArrayViews = CreateRenderTargetViews(
+            context.Device.get(), viewConfigComponent.ColorSwapchain, arrayLength, arrayLength, swapchainSampleCount);
+        viewConfigComponent.DepthStencilArrayViews = CreateDepthStencilViews(
+            context.Device.get(), viewConfigComponent.DepthSwapchain, arrayLength, arrayLength, swapchainSampleCount);
+    }
+
     {
         CD3D11_DEPTH_STENCIL_DESC depthStencilDesc(CD3D11_DEFAULT{});
         depthStencilDesc.StencilEnable = false;
@@ -176,7 +254,9 @@ bool engine::ProjectionLayer::Render(Context& context,
     const sample::dx::SwapchainD3D11& depthSwapchain = viewConfigComponent.DepthSwapchain;
     std::vector<XrCompositionLayerProjectionView>& projectionViews = viewConfigComponent.ProjectionViews;
     std::vector<XrCompositionLayerDepthInfoKHR>& depthInfo = viewConfigComponent.DepthInfo;
-    std::vector<D3D11_VIEWPORT>& viewports = viewConfigComponent.Viewports;
+    // The depth range is set on a copy of the configured viewports, which stay as configured.
+    std::vector<D3D11_VIEWPORT>& viewports = viewConfigComponent.FrameViewports;
+    viewports.assign(viewConfigComponent.Viewports.begin(), viewConfigComponent.Viewports.end());
     const ProjectionLayerConfig& currentConfig = viewConfigComponent.CurrentConfig;
 
     bool submitProjectionLayer = false;
@@ -216,11 +296,10 @@ bool engine::ProjectionLayer::Render(Context& context,
             projectionViews[viewIndex].subImage.imageArrayIndex = colorImageArrayIndex;
             projectionViews[viewIndex].subImage.imageRect = viewConfigComponent.LayerColorImageRect[viewIndex];
 
-            D3D11_VIEWPORT viewport = viewports[viewIndex];
             if (currentConfig.SubmitDepthInfo && context.Extensions.SupportsDepthInfo) {
                 depthInfo[viewIndex] = {XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR};
-                depthInfo[viewIndex].minDepth = viewport.MinDepth = normalizedViewportMinDepth;
-                depthInfo[viewIndex].maxDepth = viewport.MaxDepth = normalizedViewportMaxDepth;
+                depthInfo[viewIndex].minDepth = viewports[viewIndex].MinDepth = normalizedViewportMinDepth;
+                depthInfo[viewIndex].maxDepth = viewports[viewIndex].MaxDepth = normalizedViewportMaxDepth;
                 depthInfo[viewIndex].nearZ = currentConfig.NearFar.Near;
                 depthInfo[viewIndex].farZ = currentConfig.NearFar.Far;
                 depthInfo[viewIndex].subImage.swapchain = depthSwapchain.Handle.Get();
@@ -231,71 +310,95 @@ bool engine::ProjectionLayer::Render(Context& context,
             } else {
                 projectionViews[viewIndex].next = nullptr;
             }
+        }
 
-            // Render for this view pose.
-            {
-                // Set the Viewport.
-                context.DeviceContext->RSSetViewports(1, &viewport);
-
-                const uint32_t firstArraySliceForColor = projectionViews[viewIndex].subImage.imageArrayIndex;
+        const bool reversedZ = (currentConfig.NearFar.Near > currentConfig.NearFar.Far);
+        const float clearDepthValue = reversedZ ? 0.f : 1.f;
+        if (reversedZ) {
+            context.DeviceContext->OMSetDepthStencilState(m_reversedZDepthNoStencilTest.get(), 0);
+        } else {
+            context.DeviceContext->OMSetDepthStencilState(nullptr, 0);
+        }
+        context.PbrResources.SetDepthFuncReversed(reversedZ);
 
-                // Create a render target view into the appropriate slice of the color texture from this swapchain image.
-                // This is a lightweight operation which can be done for each viewport projection.
-                winrt::com_ptr<ID3D11RenderTargetView> renderTargetView;
-                const CD3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc(
-                    currentConfig.SwapchainSampleCount > 1 ? D3D11_RTV_DIMENSION_TEXTURE2DMSARRAY : D3D11_RTV_DIMENSION_TEXTURE2DARRAY,
-                    currentConfig.ColorSwapchainFormat,
-                    0 /* mipSlice */,
-                    firstArraySliceForColor,
-                    1 /* arraySize */);
-                CHECK_HRCMD(context.Device->CreateRenderTargetView(
-                    colorSwapchain.Images[colorSwapchainImageIndex].texture, &renderTargetViewDesc, renderTargetView.put()));
-
-                const uint32_t firstArraySliceForDepth = depthImageArrayIndex;
-
-                // Create a depth stencil view into the slice of the depth stencil texture array for this swapchain image.
-                // This is a lightweight operation which can be done for each viewport projection.
-                winrt::com_ptr<ID3D11DepthStencilView> depthStencilView;
-                CD3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc(
-                    currentConfig.SwapchainSampleCount > 1 ? D3D11_DSV_DIMENSION_TEXTURE2DMSARRAY : D3D11_DSV_DIMENSION_TEXTURE2DARRAY,
-                    currentConfig.DepthSwapchainFormat,
-                    0 /* mipSlice */,
-                    firstArraySliceForDepth,
-                    1 /* arraySize */);
-                CHECK_HRCMD(context.Device->CreateDepthStencilView(
-                    depthSwapchain.Images[depthSwapchainImageIndex].texture, &depthStencilViewDesc, depthStencilView.put()));
+        const uint32_t arrayLength = viewConfigComponent.SwapchainArrayLength;
 
-                const bool reversedZ = (currentConfig.NearFar.Near > currentConfig.NearFar.Far);
+        // Render all views into the slices of the swapchain image array at once when the device can route each
+        // instance to its own slice. Otherwise, or in double wide mode, render each view separately.
+        const bool singlePass = currentConfig.SinglePassStereo && !currentConfig.DoubleWideMode && viewCount > 1 &&
+                                viewCount <= Pbr::Resources::MaxViewInstanceCount && arrayLength == viewCount &&
+                                context.PbrResources.SupportsViewInstancing();
 
-                // Clear and render to the render target.
-                ID3D11RenderTargetView* const renderTargets[] = {renderTargetView.get()};
-                context.DeviceContext->OMSetRenderTargets(1, renderTargets, depthStencilView.get());
+        // Set the viewport, render targets and view projection for a single view.
+        auto setViewTarget = [&](uint32_t viewIndex, bool clear) {
+            const uint32_t colorImageArrayIndex = currentConfig.DoubleWideMode ? 0 : viewIndex;
+            const uint32_t depthImageArrayIndex = currentConfig.DoubleWideMode ? 0 : viewIndex;
 
-                // In double wide mode, the first projection clears the whole RTV and DSV.
-                if ((viewIndex == 0) || !currentConfig.DoubleWideMode) {
-                    context.DeviceContext->ClearRenderTargetView(renderTargets[0], reinterpret_cast<const float*>(&Config().ClearColor));
+            context.DeviceContext->RSSetViewports(1, &viewports[viewIndex]);
 
-                    const float clearDepthValue = reversedZ ? 0.f : 1.f;
-                    context.DeviceContext->ClearDepthStencilView(
-                        depthStencilView.get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, clearDepthValue, 0);
-                }
+            // Use the views into the slices of this frame's color and depth swapchain images created with the swapchains.
+            ID3D11RenderTargetView* const renderTargets[] = {
+                viewConfigComponent.RenderTargetViews[colorSwapchainImageIndex * arrayLength + colorImageArrayIndex].get()};
+            ID3D11DepthStencilView* const depthStencilView =
+                viewConfigComponent.DepthStencilViews[depthSwapchainImageIndex * arrayLength + depthImageArrayIndex].get();
+            context.DeviceContext->OMSetRenderTargets(1, renderTargets, depthStencilView);
 
-                const DirectX::XMMATRIX projectionMatrix = xr::math::ComposeProjectionMatrix(fov, currentConfig.NearFar);
+            if (clear) {
+                context.DeviceContext->ClearRenderTargetView(renderTargets[0], reinterpret_cast<const float*>(&Config().ClearColor));
+                context.DeviceContext->ClearDepthStencilView(depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, clearDepthValue, 0);
+            }
 
-                if (reversedZ) {
-                    context.DeviceContext->OMSetDepthStencilState(m_reversedZDepthNoStencilTest.get(), 0);
-                } else {
-                    context.DeviceContext->OMSetDepthStencilState(nullptr, 0);
+            // Set state for any objects which use PBR rendering.
+            // PBR library expects traditional view transform (world to view).
+            const DirectX::XMMATRIX projectionMatrix = xr::math::ComposeProjectionMatrix(views[viewIndex].fov, currentConfig.NearFar);
+            const DirectX::XMMATRIX worldToViewMatrix = xr::math::LoadInvertedXrPose(projectionViews[viewIndex].pose);
+            context.PbrResources.SetViewProjection(worldToViewMatrix, projectionMatrix);
+            context.PbrResources.Bind(context.DeviceContext.get());
+        };
+
+        if (singlePass) {
+            // Clear and bind all slices of the swapchain images. All views share the size of the first viewport.
+            context.DeviceContext->RSSetViewports(1, &viewports[0]);
+
+            ID3D11RenderTargetView* const renderTargets[] = {viewConfigComponent.RenderTargetArrayViews[colorSwapchainImageIndex].get()};
+            ID3D11DepthStencilView* const depthStencilView = viewConfigComponent.DepthStencilArrayViews[depthSwapchainImageIndex].get();
+            context.DeviceContext->OMSetRenderTargets(1, renderTargets, depthStencilView);
+            context.DeviceContext->ClearRenderTargetView(renderTargets[0], reinterpret_cast<const float*>(&Config().ClearColor));
+            context.DeviceContext->ClearDepthStencilView(depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, clearDepthValue, 0);
+
+            std::array<DirectX::XMMATRIX, Pbr::Resources::MaxViewInstanceCount> worldToViewMatrices;
+            std::array<DirectX::XMMATRIX, Pbr::Resources::MaxViewInstanceCount> projectionMatrices;
+            for (uint32_t viewIndex = 0; viewIndex < viewCount; viewIndex++) {
+                worldToViewMatrices[viewIndex] = xr::math::LoadInvertedXrPose(projectionViews[viewIndex].pose);
+                projectionMatrices[viewIndex] = xr::math::ComposeProjectionMatrix(views[viewIndex].fov, currentConfig.NearFar);
+            }
+            context.PbrResources.SetViewProjections(worldToViewMatrices.data(), projectionMatrices.data(), viewCount);
+            context.PbrResources.Bind(context.DeviceContext.get());
+
+            // Render the objects visible in all views once, instanced across the views.
+            bool anyPartiallyVisible = false;
+            for (const std::unique_ptr<Scene>& scene : activeScenes) {
+                if (scene->IsActive() && !std::empty(scene->GetObjects())) {
+                    submitProjectionLayer = true;
+                    anyPartiallyVisible |= scene->RenderAllViews(frameTime, viewCount);
                 }
+            }
+            context.RenderQueue.Submit(context.PbrResources, context.DeviceContext.get());
 
-                // Set state for any objects which use PBR rendering.
-                // PBR library expects traditional view transform (world to view).
-                DirectX::XMMATRIX worldToViewMatrix = xr::math::LoadInvertedXrPose(projectionViews[viewIndex].pose);
-
-
-                context.PbrResources.SetViewProjection(worldToViewMatrix, projectionMatrix);
-                context.PbrResources.Bind(context.DeviceContext.get());
-                context.PbrResources.SetDepthFuncReversed(reversedZ);
+            // Objects restricted to some of the views are rendered to each of those views separately.
+            for (uint32_t viewIndex = 0; anyPartiallyVisible && viewIndex < viewCount; viewIndex++) {
+                setViewTarget(viewIndex, false /* clear */);
+                for (const std::unique_ptr<Scene>& scene : activeScenes) {
+                    if (scene->IsActive() && !std::empty(scene->GetObjects())) {
+                        scene->RenderPartiallyVisible(frameTime, viewIndex, viewCount);
+                    }
+                }
+                context.RenderQueue.Submit(context.PbrResources, context.DeviceContext.get());
+            }
+        } else {
+            for (uint32_t viewIndex = 0; viewIndex < viewCount; viewIndex++) {
+                // In double wide mode, the first projection clears the whole RTV and DSV.
+                setViewTarget(viewIndex, (viewIndex == 0) || !currentConfig.DoubleWideMode);
 
                 // Render all active scenes.
                 for (const std::unique_ptr<Scene>& scene : activeScenes) {
@@ -304,6 +407,9 @@ bool engine::ProjectionLayer::Render(Context& context,
                         scene->Render(frameTime, viewIndex);
                     }
                 }
+
+                // The draws of all scenes are submitted together, sorted to share state between consecutive draws.
+                context.RenderQueue.Submit(context.PbrResources, context.DeviceContext.get());
             }
         }
     }
@@ -24,6 +24,7 @@ namespace engine {
         XrOffset2Di ViewportOffset = {0, 0};     // ViewportOffset is relative to (0, 0) of the swapchain
         uint32_t SwapchainSampleCount = 1;
         bool DoubleWideMode = false;
+        bool SinglePassStereo = true; // Render all views with one draw call per primitive when the device supports view instancing
         bool SubmitDepthInfo = true;
         bool ContentProtected = false;
         bool ForceReset = false;
@@ -79,12 +80,22 @@ namespace engine {
             std::vector<XrCompositionLayerProjectionView> ProjectionViews; // Pre-allocated and reused for each frame.
             std::vector<XrCompositionLayerDepthInfoKHR> DepthInfo;         // Pre-allocated and reused for each frame.
             std::vector<D3D11_VIEWPORT> Viewports;
+            std::vector<D3D11_VIEWPORT> FrameViewports; // Viewports with this frame's depth range. Reused for each frame.
 
             XrRect2Di LayerColorImageRect[xr::StereoView::Count];
             XrRect2Di LayerDepthImageRect[xr::StereoView::Count];
 
             sample::dx::SwapchainD3D11 ColorSwapchain;
             sample::dx::SwapchainD3D11 DepthSwapchain;
+
+            // Views of each array slice of each swapchain image, created with the swapchains and released with them.
+            // Indexed by imageIndex * SwapchainArrayLength + arraySlice.
+            uint32_t SwapchainArrayLength{0};
+            std::vector<winrt::com_ptr<ID3D11RenderTargetView>> RenderTargetViews;
+            std::vector<winrt::com_ptr<ID3D11DepthStencilView>> DepthStencilViews;
+            // Views of all array slices of each swapchain image, for rendering all views at once. Indexed by imageIndex.
+            std::vector<winrt::com_ptr<ID3D11RenderTargetView>> RenderTargetArrayViews;
+            std::vector<winrt::com_ptr<ID3D11DepthStencilView>> DepthStencilArrayViews;
         };
         std::unordered_map<XrViewConfigurationType, ViewConfigComponent> m_viewConfigComponents;
         XrViewConfigurationType m_defaultViewConfigurationType;
@@ -0,0 +1,290 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "RayTargets.h"
+
+using namespace DirectX;
+
+namespace {
+    // Number of rays tested together against each block of 4 targets. Gaze, aim and hand rays for both hands fit in one chunk.
+    constexpr uint32_t MaxRaysPerChunk = 8;
+
+    const XMVECTORF32 LaneIndex = {{{0.0f, 1.0f, 2.0f, 3.0f}}};
+
+    // Load 4 consecutive values starting at index, filling lanes past the end of the array with zero.
+    XMVECTOR XM_CALLCONV LoadLanes(const std::vector<float>& values, size_t index) {
+        if (index + 4 <= values.size()) {
+            return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[index]));
+        }
+
+        XMFLOAT4 lanes{0, 0, 0, 0};
+        float* dest = &lanes.x;
+        for (size_t i = index; i < values.size(); i++) {
+            *dest++ = values[i];
+        }
+        return XMLoadFloat4(&lanes);
+    }
+
+    // Returns a mask of the lanes that hold a target in a block starting at index.
+    XMVECTOR XM_CALLCONV ValidLanes(size_t index, size_t count) {
+        const size_t remaining = count - index;
+        return remaining >= 4 ? XMVectorTrueInt() : XMVectorLess(LaneIndex, XMVectorReplicate(static_cast<float>(remaining)));
+    }
+
+    struct SplatRay {
+        XMVECTOR OriginX, OriginY, OriginZ;
+        XMVECTOR DirectionX, DirectionY, DirectionZ;
+
+        void Set(const engine::Ray& ray) {
+            OriginX = XMVectorReplicate(ray.Origin.x);
+            OriginY = XMVectorReplicate(ray.Origin.y);
+            OriginZ = XMVectorReplicate(ray.Origin.z);
+            DirectionX = XMVectorReplicate(ray.Direction.x);
+            DirectionY = XMVectorReplicate(ray.Direction.y);
+            DirectionZ = XMVectorReplicate(ray.Direction.z);
+        }
+    };
+
+    // Per-lane nearest hit for one ray, reduced to a single RayHit once all targets are tested.
+    struct LaneHits {
+        XMVECTOR Distance = XMVectorSplatInfinity();
+        XMVECTOR Index = XMVectorZero(); // Index into the shape arrays, stored as float.
+
+        void XM_CALLCONV Update(FXMVECTOR hitMask, FXMVECTOR distance, FXMVECTOR blockIndex) {
+            const XMVECTOR closer = XMVectorAndInt(hitMask, XMVectorLess(distance, Distance));
+            Distance = XMVectorSelect(Distance, distance, closer);
+            Index = XMVectorSelect(Index, blockIndex, closer);
+        }
+
+        void MergeInto(engine::RayHit& hit, const std::vector<uint32_t>& targetIndices) const {
+            XMFLOAT4 distances, indices;
+            XMStoreFloat4(&distances, Distance);
+            XMStoreFloat4(&indices, Index);
+            const float* laneDistance = &distances.x;
+            const float* laneIndex = &indices.x;
+            for (int lane = 0; lane < 4; lane++) {
+                if (laneDistance[lane] < hit.Distance) {
+                    hit.Distance = laneDistance[lane];
+                    hit.TargetIndex = targetIndices[static_cast<size_t>(laneIndex[lane])];
+                }
+            }
+        }
+    };
+
+    template <typename TFunc>
+    void ForEachRayChunk(const engine::Ray* rays, uint32_t rayCount, engine::RayHit* hits, TFunc&& func) {
+        for (uint32_t first = 0; first < rayCount; first += MaxRaysPerChunk) {
+            func(rays + first, std::min(MaxRaysPerChunk, rayCount - first), hits + first);
+        }
+    }
+} // namespace
+
+namespace engine {
+    Ray MakeRayFromPose(const XrPosef& pose) {
+        Ray ray;
+        ray.Origin = pose.position;
+        xr::math::StoreXrVector3(&ray.Direction,
+                                 XMVector3Rotate(XMVectorSet(0, 0, -1, 0), xr::math::LoadXrQuaternion(pose.orientation)));
+        return ray;
+    }
+
+    uint32_t RayTargets::AddSphere(const XrVector3f& center, float radius) {
+        const uint32_t targetIndex = GetTargetCount();
+        m_targets.push_back({true, static_cast<uint32_t>(m_spheres.TargetIndex.size())});
+        m_spheres.CenterX.push_back(0);
+        m_spheres.CenterY.push_back(0);
+        m_spheres.CenterZ.push_back(0);
+        m_spheres.RadiusSquared.push_back(0);
+        m_spheres.TargetIndex.push_back(targetIndex);
+        UpdateSphere(targetIndex, center, radius);
+        return targetIndex;
+    }
+
+    uint32_t RayTargets::AddAxisAlignedBox(const XrVector3f& center, const XrVector3f& halfExtents) {
+        return AddOrientedBox(xr::math::Pose::Translation(center), halfExtents);
+    }
+
+    uint32_t RayTargets::AddOrientedBox(const XrPosef& pose, const XrVector3f& halfExtents) {
+        const uint32_t targetIndex = GetTargetCount();
+        m_targets.push_back({false, static_cast<uint32_t>(m_boxes.TargetIndex.size())});
+        for (auto* values : {&m_boxes.CenterX,
+                             &m_boxes.CenterY,
+                             &m_boxes.CenterZ,
+                             &m_boxes.AxisXx,
+                             &m_boxes.AxisXy,
+                             &m_boxes.AxisXz,
+                             &m_boxes.AxisYx,
+                             &m_boxes.AxisYy,
+                             &m_boxes.AxisYz,
+                             &m_boxes.AxisZx,
+                             &m_boxes.AxisZy,
+                             &m_boxes.AxisZz,
+                             &m_boxes.HalfExtentX,
+                             &m_boxes.HalfExtentY,
+                             &m_boxes.HalfExtentZ}) {
+            values->push_back(0);
+        }
+        m_boxes.TargetIndex.push_back(targetIndex);
+        UpdateBox(targetIndex, pose, halfExtents);
+        return targetIndex;
+    }
+
+    void RayTargets::UpdateSphere(uint32_t targetIndex, const XrVector3f& center, float radius) {
+        assert(m_targets[targetIndex].IsSphere);
+        const uint32_t i = m_targets[targetIndex].Index;
+        m_spheres.CenterX[i] = center.x;
+        m_spheres.CenterY[i] = center.y;
+        m_spheres.CenterZ[i] = center.z;
+        m_spheres.RadiusSquared[i] = radius * radius;
+    }
+
+    void RayTargets::UpdateBox(uint32_t targetIndex, const XrPosef& pose, const XrVector3f& halfExtents) {
+        assert(!m_targets[targetIndex].IsSphere);
+        const uint32_t i = m_targets[targetIndex].Index;
+        m_boxes.CenterX[i] = pose.position.x;
+        m_boxes.CenterY[i] = pose.position.y;
+        m_boxes.CenterZ[i] = pose.position.z;
+
+        // The rows of the rotation matrix are the box axes in app space.
+        XMFLOAT3X3 axes;
+        XMStoreFloat3x3(&axes, XMMatrixRotationQuaternion(xr::math::LoadXrQuaternion(pose.orientation)));
+        m_boxes.AxisXx[i] = axes._11;
+        m_boxes.AxisXy[i] = axes._12;
+        m_boxes.AxisXz[i] = axes._13;
+        m_boxes.AxisYx[i] = axes._21;
+        m_boxes.AxisYy[i] = axes._22;
+        m_boxes.AxisYz[i] = axes._23;
+        m_boxes.AxisZx[i] = axes._31;
+        m_boxes.AxisZy[i] = axes._32;
+        m_boxes.AxisZz[i] = axes._33;
+
+        m_boxes.HalfExtentX[i] = halfExtents.x;
+        m_boxes.HalfExtentY[i] = halfExtents.y;
+        m_boxes.HalfExtentZ[i] = halfExtents.z;
+    }
+
+    void RayTargets::Clear() {
+        m_targets.clear();
+        m_spheres = {};
+        m_boxes = {};
+    }
+
+    void RayTargets::CastRays(const Ray* rays, uint32_t rayCount, RayHit* hits) const {
+        std::fill(hits, hits + rayCount, RayHit{});
+        if (!m_spheres.TargetIndex.empty()) {
+            CastRaysAgainstSpheres(rays, rayCount, hits);
+        }
+        if (!m_boxes.TargetIndex.empty()) {
+            CastRaysAgainstBoxes(rays, rayCount, hits);
+        }
+    }
+
+    void RayTargets::CastRaysAgainstSpheres(const Ray* rays, uint32_t rayCount, RayHit* hits) const {
+        const size_t count = m_spheres.TargetIndex.size();
+        ForEachRayChunk(rays, rayCount, hits, [&](const Ray* chunkRays, uint32_t chunkSize, RayHit* chunkHits) {
+            LaneHits laneHits[MaxRaysPerChunk];
+            SplatRay splatRays[MaxRaysPerChunk];
+            for (uint32_t r = 0; r < chunkSize; r++) {
+                splatRays[r].Set(chunkRays[r]);
+            }
+
+            for (size_t i = 0; i < count; i += 4) {
+                const XMVECTOR centerX = LoadLanes(m_spheres.CenterX, i);
+                const XMVECTOR centerY = LoadLanes(m_spheres.CenterY, i);
+                const XMVECTOR centerZ = LoadLanes(m_spheres.CenterZ, i);
+                const XMVECTOR radiusSquared = LoadLanes(m_spheres.RadiusSquared, i);
+                const XMVECTOR validLanes = ValidLanes(i, count);
+                const XMVECTOR blockIndex = XMVectorAdd(LaneIndex, XMVectorReplicate(static_cast<float>(i)));
+
+                for (uint32_t r = 0; r < chunkSize; r++) {
+                    const SplatRay& ray = splatRays[r];
+                    const XMVECTOR toCenterX = XMVectorSubtract(centerX, ray.OriginX);
+                    const XMVECTOR toCenterY = XMVectorSubtract(centerY, ray.OriginY);
+                    const XMVECTOR toCenterZ = XMVectorSubtract(centerZ, ray.OriginZ);
+
+                    // Distance along the ray to the point closest to the center, and squared distance of that point to the center.
+                    XMVECTOR along = XMVectorMultiply(toCenterX, ray.DirectionX);
+                    along = XMVectorMultiplyAdd(toCenterY, ray.DirectionY, along);
+                    along = XMVectorMultiplyAdd(toCenterZ, ray.DirectionZ, along);
+                    XMVECTOR toCenterSquared = XMVectorMultiply(toCenterX, toCenterX);
+                    toCenterSquared = XMVectorMultiplyAdd(toCenterY, toCenterY, toCenterSquared);
+                    toCenterSquared = XMVectorMultiplyAdd(toCenterZ, toCenterZ, toCenterSquared);
+                    const XMVECTOR halfChordSquared =
+                        XMVectorSubtract(radiusSquared, XMVectorNegativeMultiplySubtract(along, along, toCenterSquared));
+
+                    const XMVECTOR halfChord = XMVectorSqrt(XMVectorMax(halfChordSquared, XMVectorZero()));
+                    const XMVECTOR nearDistance = XMVectorSubtract(along, halfChord);
+                    const XMVECTOR farDistance = XMVectorAdd(along, halfChord);
+
+                    // The ray misses when it passes outside the sphere or the sphere is entirely behind the origin.
+                    XMVECTOR hitMask = XMVectorAndInt(validLanes, XMVectorGreaterOrEqual(halfChordSquared, XMVectorZero()));
+                    hitMask = XMVectorAndInt(hitMask, XMVectorGreaterOrEqual(farDistance, XMVectorZero()));
+                    laneHits[r].Update(hitMask, XMVectorMax(nearDistance, XMVectorZero()), blockIndex);
+                }
+            }
+
+            for (uint32_t r = 0; r < chunkSize; r++) {
+                laneHits[r].MergeInto(chunkHits[r], m_spheres.TargetIndex);
+            }
+        });
+    }
+
+    void RayTargets::CastRaysAgainstBoxes(const Ray* rays, uint32_t rayCount, RayHit* hits) const {
+        const size_t count = m_boxes.TargetIndex.size();
+        ForEachRayChunk(rays, rayCount, hits, [&](const Ray* chunkRays, uint32_t chunkSize, RayHit* chunkHits) {
+            LaneHits laneHits[MaxRaysPerChunk];
+            SplatRay splatRays[MaxRaysPerChunk];
+            for (uint32_t r = 0; r < chunkSize; r++) {
+                splatRays[r].Set(chunkRays[r]);
+            }
+
+            for (size_t i = 0; i < count; i += 4) {
+                const XMVECTOR centerX = LoadLanes(m_boxes.CenterX, i);
+                const XMVECTOR centerY = LoadLanes(m_boxes.CenterY, i);
+                const XMVECTOR centerZ = LoadLanes(m_boxes.CenterZ, i);
+                const XMVECTOR axes[3][3] = {
+                    {LoadLanes(m_boxes.AxisXx, i), LoadLanes(m_boxes.AxisXy, i), LoadLanes(m_boxes.AxisXz, i)},
+                    {LoadLanes(m_boxes.AxisYx, i), LoadLanes(m_boxes.AxisYy, i), LoadLanes(m_boxes.AxisYz, i)},
+                    {LoadLanes(m_boxes.AxisZx, i), LoadLanes(m_boxes.AxisZy, i), LoadLanes(m_boxes.AxisZz, i)},
+                };
+                const XMVECTOR halfExtents[3] = {
+                    LoadLanes(m_boxes.HalfExtentX, i), LoadLanes(m_boxes.HalfExtentY, i), LoadLanes(m_boxes.HalfExtentZ, i)};
+                const XMVECTOR validLanes = ValidLanes(i, count);
+                const XMVECTOR blockIndex = XMVectorAdd(LaneIndex, XMVectorReplicate(static_cast<float>(i)));
+
+                for (uint32_t r = 0; r < chunkSize; r++) {
+                    const SplatRay& ray = splatRays[r];
+                    const XMVECTOR relativeX = XMVectorSubtract(ray.OriginX, centerX);
+                    const XMVECTOR relativeY = XMVectorSubtract(ray.OriginY, centerY);
+                    const XMVECTOR relativeZ = XMVectorSubtract(ray.OriginZ, centerZ);
+
+                    // Slab test in box space: intersect the ray with the pair of planes on each box axis.
+                    XMVECTOR entry = XMVectorZero();
+                    XMVECTOR exit = XMVectorSplatInfinity();
+                    for (int axis = 0; axis < 3; axis++) {
+                        XMVECTOR origin = XMVectorMultiply(relativeX, axes[axis][0]);
+                        origin = XMVectorMultiplyAdd(relativeY, axes[axis][1], origin);
+                        origin = XMVectorMultiplyAdd(relativeZ, axes[axis][2], origin);
+                        XMVECTOR direction = XMVectorMultiply(ray.DirectionX, axes[axis][0]);
+                        direction = XMVectorMultiplyAdd(ray.DirectionY, axes[axis][1], direction);
+                        direction = XMVectorMultiplyAdd(ray.DirectionZ, axes[axis][2], direction);
+
+                        const XMVECTOR inverseDirection = XMVectorReciprocal(direction);
+                        const XMVECTOR t0 = XMVectorMultiply(XMVectorSubtract(XMVectorNegate(halfExtents[axis]), origin), inverseDirection);
+                        const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(halfExtents[axis], origin), inverseDirection);
+                        entry = XMVectorMax(entry, XMVectorMin(t0, t1));
+                        exit = XMVectorMin(exit, XMVectorMax(t0, t1));
+                    }
+
+                    const XMVECTOR hitMask = XMVectorAndInt(validLanes, XMVectorLessOrEqual(entry, exit));
+                    laneHits[r].Update(hitMask, entry, blockIndex);
+                }
+            }
+
+            for (uint32_t r = 0; r < chunkSize; r++) {
+                laneHits[r].MergeInto(chunkHits[r], m_boxes.TargetIndex);
+            }
+        });
+    }
+} // namespace engine
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <XrUtility/XrMath.h>
+
+namespace engine {
+
+    // A ray in app space, such as eye gaze, controller aim or hand ray. Direction must be normalized.
+    struct Ray {
+        XrVector3f Origin;
+        XrVector3f Direction;
+    };
+
+    // Create a ray along the forward (-Z) direction of a pose.
+    Ray MakeRayFromPose(const XrPosef& pose);
+
+    struct RayHit {
+        static constexpr uint32_t NoTarget = static_cast<uint32_t>(-1);
+
+        uint32_t TargetIndex{NoTarget};
+        float Distance{std::numeric_limits<float>::infinity()};
+
+        bool IsHit() const {
+            return TargetIndex != NoTarget;
+        }
+    };
+
+    // A set of hit-test targets (spheres and boxes) stored as structure of arrays,
+    // so that many targets can be tested against a few rays with 4-wide SIMD in one pass.
+    // Each target is identified by the index returned when it is added, in the order targets were added.
+    class RayTargets {
+    public:
+        uint32_t AddSphere(const XrVector3f& center, float radius);
+        uint32_t AddAxisAlignedBox(const XrVector3f& center, const XrVector3f& halfExtents);
+        uint32_t AddOrientedBox(const XrPosef& pose, const XrVector3f& halfExtents);
+
+        // Update an existing target, e.g. after the object it represents moved. The shape of the target cannot change.
+        void UpdateSphere(uint32_t targetIndex, const XrVector3f& center, float radius);
+        void UpdateBox(uint32_t targetIndex, const XrPosef& pose, const XrVector3f& halfExtents);
+
+        uint32_t GetTargetCount() const {
+            return static_cast<uint32_t>(m_targets.size());
+        }
+
+        void Clear();
+
+        // Find the nearest target hit by each ray. hits must hold rayCount elements.
+        void CastRays(const Ray* rays, uint32_t rayCount, RayHit* hits) const;
+
+        RayHit CastRay(const Ray& ray) const {
+            RayHit hit;
+            CastRays(&ray, 1, &hit);
+            return hit;
+        }
+
+    private:
+        void CastRaysAgainstSpheres(const Ray* rays, uint32_t rayCount, RayHit* hits) const;
+        void CastRaysAgainstBoxes(const Ray* rays, uint32_t rayCount, RayHit* hits) const;
+
+        struct TargetSlot {
+            bool IsSphere;
+            uint32_t Index; // Index into the sphere or box arrays.
+        };
+        std::vector<TargetSlot> m_targets;
+
+        struct Spheres {
+            std::vector<float> CenterX, CenterY, CenterZ, RadiusSquared;
+            std::vector<uint32_t> TargetIndex;
+        } m_spheres;
+
+        // Boxes store the box axes in app space, so a ray is brought into box space with three dot products per axis.
+        struct Boxes {
+            std::vector<float> CenterX, CenterY, CenterZ;
+            std::vector<float> AxisXx, AxisXy, AxisXz;
+            std::vector<float> AxisYx, AxisYy, AxisYz;
+            std::vector<float> AxisZx, AxisZy, AxisZz;
+            std::vector<float> HalfExtentX, HalfExtentY, HalfExtentZ;
+            std::vector<uint32_t> TargetIndex;
+        } m_boxes;
+    };
+} // namespace engine
@@ -7,24 +7,6 @@
 using namespace DirectX;
 
 namespace {
-    template <typename T>
-    void AddPendingObjects(std::vector<std::shared_ptr<T>>* objects, std::vector<std::shared_ptr<T>>&& uninitializedObjects) {
-        for (auto& object : uninitializedObjects) {
-            if (object->State == engine::ObjectState::InitializePending) {
-                object->State = engine::ObjectState::Initialized;
-                objects->push_back(std::move(object));
-            }
-        }
-    }
-
-    template <typename T>
-    void RemoveDestroyedObjects(std::vector<std::shared_ptr<T>>* objects) {
-        auto newEnd = std::remove_if(
-            objects->begin(), objects->end(), [](auto&& object) { return object->State == engine::ObjectState::RemovePending; });
-
-        objects->erase(newEnd, objects->end());
-    }
-
     template <typename T>
     void UpdateObjects(std::vector<std::shared_ptr<T>> const& objects, engine::Context& context, engine::FrameTime const& frameTime) {
         for (const auto& object : objects) {
@@ -32,10 +14,10 @@ namespace {
         }
     }
 
-    template <typename T>
-    void RenderObjects(std::vector<std::shared_ptr<T>> const& objects, engine::Context& context, uint32_t viewIndex) {
+    template <typename T, typename TFilter>
+    void RenderObjects(std::vector<std::shared_ptr<T>> const& objects, engine::Context& context, TFilter&& filter) {
         for (const auto& object : objects) {
-            if (object->IsVisibleForViewIndex(viewIndex)) {
+            if (filter(*object)) {
                 object->Render(context);
             }
         }
@@ -47,17 +29,58 @@ engine::Scene::Scene(engine::Context& context)
     , m_actionContext(context.Instance.Handle) {
 }
 
+template <typename T>
+void engine::Scene::AddPendingObjects(std::vector<std::shared_ptr<T>>* objects, sample::MpscQueue<std::shared_ptr<T>>* pendingObjects) {
+    pendingObjects->ConsumeAll([this, objects](std::shared_ptr<T>&& object) {
+        // Objects removed before they were initialized are dropped.
+        if (object->State != engine::ObjectState::InitializePending) {
+            return;
+        }
+        object->State = engine::ObjectState::Initialized;
+
+        // An object removed and added again before this update is still in the list.
+        const size_t index = object->m_sceneIndex;
+        if (index < objects->size() && (*objects)[index] == object) {
+            return;
+        }
+
+        object->m_sceneIndex = objects->size();
+        m_motionSystem.Add(*object);
+        objects->push_back(std::move(object));
+    });
+}
+
+template <typename T>
+bool engine::Scene::TryRemoveObject(std::vector<std::shared_ptr<T>>* objects, engine::Object& object) {
+    const size_t index = object.m_sceneIndex;
+    if (index >= objects->size() || (*objects)[index].get() != &object) {
+        return false;
+    }
+
+    // Swap with the last object and pop, so removal costs the same regardless of the number of objects.
+    if (index != objects->size() - 1) {
+        (*objects)[index] = std::move(objects->back());
+        (*objects)[index]->m_sceneIndex = index;
+    }
+    objects->pop_back();
+    object.m_sceneIndex = engine::Object::NotInScene;
+    return true;
+}
+
 void engine::Scene::Update(const engine::FrameTime& frameTime) {
-    std::unique_lock lk(m_uninitializedMutex);
-    std::vector uninitializedObjects = std::move(m_uninitializedObjects);
-    std::vector uninitializedQuadLayerObjects = std::move(m_uninitializedQuadLayerObjects);
-    lk.unlock();
+    AddPendingObjects(&m_objects, &m_pendingObjects);
+    AddPendingObjects(&m_quadLayerObjects, &m_pendingQuadLayerObjects);
 
-    AddPendingObjects(&m_objects, std::move(uninitializedObjects));
-    AddPendingObjects(&m_quadLayerObjects, std::move(uninitializedQuadLayerObjects));
+    m_removedObjects.ConsumeAll([this](std::shared_ptr<Object>&& object) {
+        // Skip objects that were added again after being removed.
+        if (object->State == ObjectState::RemovePending) {
+            if (TryRemoveObject(&m_objects, *object) || TryRemoveObject(&m_quadLayerObjects, *object)) {
+                m_motionSystem.Remove(*object);
+            }
+        }
+    });
 
-    RemoveDestroyedObjects(&m_objects);
-    RemoveDestroyedObjects(&m_quadLayerObjects);
+    m_motionSystem.Update(frameTime.Elapsed);
 
     UpdateObjects(m_objects, m_context, frameTime);
     UpdateObjects(m_quadLayerObjects, m_context, frameTime);
@@ -70,6 +93,29 @@ void engine::Scene::BeforeRender(const FrameTime& frameTime) {
 }
 
 void engine::Scene::Render(const FrameTime& frameTime, uint32_t viewIndex) {
-    RenderObjects(m_objects, m_context, viewIndex);
-    RenderObjects(m_quadLayerObjects, m_context, viewIndex);
+    const auto filter = [viewIndex](const Object& object) { return object.IsVisibleForViewIndex(viewIndex); };
+    RenderObjects(m_objects, m_context, filter);
+    RenderObjects(m_quadLayerObjects, m_context, filter);
+}
+
+bool engine::Scene::RenderAllViews(const FrameTime& frameTime, uint32_t viewCount) {
+    bool anyPartiallyVisible = false;
+    const auto filter = [viewCount, &anyPartiallyVisible](const Object& object) {
+        if (object.IsVisibleForAllViews(viewCount)) {
+            return true;
+        }
+        anyPartiallyVisible |= object.IsVisible();
+        return false;
+    };
+    RenderObjects(m_objects, m_context, filter);
+    RenderObjects(m_quadLayerObjects, m_context, filter);
+    return anyPartiallyVisible;
+}
+
+void engine::Scene::RenderPartiallyVisible(const FrameTime& frameTime, uint32_t viewIndex, uint32_t viewCount) {
+    const auto filter = [viewIndex, viewCount](const Object& object) {
+        return object.IsVisibleForViewIndex(viewIndex) && !object.IsVisibleForAllViews(viewCount);
+    };
+    RenderObjects(m_objects, m_context, filter);
+    RenderObjects(m_quadLayerObjects, m_context, filter);
 }
@@ -4,11 +4,13 @@
 #pragma once
 
 #include <mutex>
+#include <SampleShared/MpscQueue.h>
 #include <SampleShared/XrActionContext.h>
 
 #include "FrameTime.h"
 #include "Context.h"
 #include "Object.h"
+#include "MotionSystem.h"
 #include "QuadLayerObject.h"
 
 namespace engine {
@@ -25,6 +27,12 @@ namespace engine {
         void BeforeRender(const FrameTime& frameTime);
         void Render(const FrameTime& frameTime, uint32_t viewIndex);
 
+        // With view instancing, the objects visible in all views are rendered once for all views by RenderAllViews,
+        // and the objects only visible in some views are rendered for each view by RenderPartiallyVisible.
+        // RenderAllViews returns whether there are any such objects, so the per-view pass can be skipped when there are none.
+        bool RenderAllViews(const FrameTime& frameTime, uint32_t viewCount);
+        void RenderPartiallyVisible(const FrameTime& frameTime, uint32_t viewIndex, uint32_t viewCount);
+
         // Active is true when the scene participates update and render loop.
         bool IsActive() const {
             return m_isActive;
@@ -44,11 +52,11 @@ namespace engine {
         }
 
 #pragma region Scene objects will be rendered into projection layers
+        // Objects can be added and removed from any thread. They join or leave the scene on the next Update.
         template <typename T>
         std::shared_ptr<T> AddObject(const std::shared_ptr<T>& object) {
             object->State = ObjectState::InitializePending;
-            std::lock_guard guard(m_uninitializedMutex);
-            m_uninitializedObjects.push_back(object);
+            m_pendingObjects.Push(object);
             return object;
         }
 
@@ -56,6 +64,7 @@ namespace engine {
         void RemoveObject(const std::shared_ptr<T>& object) {
             if (object) {
                 object->State = ObjectState::RemovePending;
+                m_removedObjects.Push(object);
             }
         }
 
@@ -68,8 +77,7 @@ namespace engine {
 #pragma region Quad layer objects will be rendered into quad layers, and will not affect projection layers
         std::shared_ptr<QuadLayerObject> AddQuadLayerObject(const std::shared_ptr<QuadLayerObject>& object) {
             object->State = ObjectState::InitializePending;
-            std::lock_guard guard(m_uninitializedMutex);
-            m_uninitializedQuadLayerObjects.push_back(object);
+            m_pendingQuadLayerObjects.Push(object);
             return object;
         }
 
@@ -82,6 +90,12 @@ namespace engine {
             return m_actionContext;
         }
 
+        // Integrates the Motion of the scene objects before they are updated. Changes to the Motion of the objects, including
+        // enabling or disabling it, are picked up on every update.
+        engine::MotionSystem& MotionSystem() {
+            return m_motionSystem;
+        }
+
     protected:
         engine::Context& m_context;
 
@@ -95,16 +109,22 @@ namespace engine {
         }
 
     private:
+        template <typename T>
+        void AddPendingObjects(std::vector<std::shared_ptr<T>>* objects, sample::MpscQueue<std::shared_ptr<T>>* pendingObjects);
+        template <typename T>
+        static bool TryRemoveObject(std::vector<std::shared_ptr<T>>* objects, Object& object);
+
         sample::ActionContext m_actionContext;
+        engine::MotionSystem m_motionSystem;
 
         std::atomic<bool> m_isActive{true};
 
         std::vector<std::shared_ptr<Object>> m_objects;
         std::vector<std::shared_ptr<QuadLayerObject>> m_quadLayerObjects;
 
-        mutable std::mutex m_uninitializedMutex;
-        std::vector<std::shared_ptr<Object>> m_uninitializedObjects;
-        std::vector<std::shared_ptr<QuadLayerObject>> m_uninitializedQuadLayerObjects;
+        sample::MpscQueue<std::shared_ptr<Object>> m_pendingObjects;
+        sample::MpscQueue<std::shared_ptr<QuadLayerObject>> m_pendingQuadLayerObjects;
+        sample::MpscQueue<std::shared_ptr<Object>> m_removedObjects;
     };
 
 } // namespace engine
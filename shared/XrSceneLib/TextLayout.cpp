@@ -0,0 +1,230 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <cmath>
+#include "TextLayout.h"
+
+using engine::GlyphQuad;
+using engine::TextLayout;
+
+namespace {
+    constexpr char32_t ReplacementCharacter = U'\xFFFD';
+
+    struct Line {
+        size_t Begin;
+        size_t End;
+    };
+
+    float Advance(const engine::AtlasGlyph* glyph) {
+        return glyph != nullptr ? glyph->Advance : 0;
+    }
+
+    // The width of a line without its trailing spaces.
+    float MeasureLine(const std::u32string& codepoints, const std::vector<const engine::AtlasGlyph*>& glyphs, const Line& line) {
+        size_t end = line.End;
+        while (end > line.Begin && codepoints[end - 1] == U' ') {
+            end--;
+        }
+
+        float width = 0;
+        for (size_t i = line.Begin; i < end; i++) {
+            width += Advance(glyphs[i]);
+        }
+        return width;
+    }
+
+    // Break the text into lines at '\n', and wrap lines longer than maxWidth at the last space or, without one, before the glyph
+    // that does not fit. A wrapped line leaves out the space it wraps at.
+    std::vector<Line> BreakLines(const std::u32string& codepoints, const std::vector<const engine::AtlasGlyph*>& glyphs, float maxWidth) {
+        std::vector<Line> lines;
+        size_t lineBegin = 0;
+        size_t lastSpace = std::u32string::npos;
+        float pen = 0;
+
+        for (size_t i = 0; i < codepoints.size(); i++) {
+            const char32_t codepoint = codepoints[i];
+            if (codepoint == U'\n') {
+                lines.push_back(Line{lineBegin, i});
+                lineBegin = i + 1;
+                lastSpace = std::u32string::npos;
+                pen = 0;
+                continue;
+            }
+
+            const float advance = Advance(glyphs[i]);
+            if (codepoint == U' ') {
+                lastSpace = i;
+            } else if (pen + advance > maxWidth && i > lineBegin) {
+                if (lastSpace != std::u32string::npos) {
+                    lines.push_back(Line{lineBegin, lastSpace});
+                    lineBegin = lastSpace + 1;
+                } else {
+                    lines.push_back(Line{lineBegin, i});
+                    lineBegin = i;
+                }
+                lastSpace = std::u32string::npos;
+
+                pen = 0;
+                for (size_t j = lineBegin; j < i; j++) {
+                    pen += Advance(glyphs[j]);
+                }
+            }
+            pen += advance;
+        }
+
+        lines.push_back(Line{lineBegin, codepoints.size()});
+        return lines;
+    }
+
+    // Where content of the given size starts in the available space.
+    float Align(engine::TextAlignment alignment, float available, float size) {
+        switch (alignment) {
+        case engine::TextAlignment::Center:
+            return (available - size) / 2;
+        case engine::TextAlignment::Trailing:
+            return available - size;
+        default:
+            return 0;
+        }
+    }
+
+    float Align(engine::ParagraphAlignment alignment, float available, float size) {
+        switch (alignment) {
+        case engine::ParagraphAlignment::Center:
+            return (available - size) / 2;
+        case engine::ParagraphAlignment::Far:
+            return available - size;
+        default:
+            return 0;
+        }
+    }
+} // namespace
+
+std::u32string engine::DecodeUtf8(std::string_view text) {
+    std::u32string codepoints;
+    codepoints.reserve(text.size());
+
+    for (size_t i = 0; i < text.size();) {
+        const uint8_t lead = (uint8_t)text[i];
+        const size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+        if (length == 0 || i + length > text.size()) {
+            codepoints.push_back(ReplacementCharacter);
+            i++;
+            continue;
+        }
+
+        char32_t codepoint = length == 1 ? lead : lead & (0x7F >> length);
+        bool valid = true;
+        for (size_t j = 1; j < length; j++) {
+            const uint8_t continuation = (uint8_t)text[i + j];
+            valid = valid && (continuation & 0xC0) == 0x80;
+            codepoint = (codepoint << 6) | (continuation & 0x3F);
+        }
+
+        // Reject overlong encodings, surrogates and values beyond the Unicode range.
+        constexpr char32_t MinCodepoint[] = {0, 0, 0x80, 0x800, 0x10000};
+        valid = valid && codepoint >= MinCodepoint[length] && codepoint <= 0x10FFFF && (codepoint < 0xD800 || codepoint > 0xDFFF);
+        if (!valid) {
+            codepoints.push_back(ReplacementCharacter);
+            i++;
+            continue;
+        }
+
+        codepoints.push_back(codepoint);
+        i += length;
+    }
+
+    return codepoints;
+}
+
+TextLayout::TextLayout(GlyphAtlas& atlas, TextLayoutOptions options)
+    : m_atlas(atlas)
+    , m_options(std::move(options)) {
+}
+
+TextLayout::~TextLayout() {
+    ReleaseGlyphs(m_codepoints, m_acquired);
+}
+
+bool TextLayout::SetText(std::string_view text) {
+    if (text == m_text) {
+        return false;
+    }
+    m_text = text;
+
+    // Acquire the glyphs of the new text before releasing the old ones, so glyphs in both stay in the atlas.
+    std::u32string codepoints = DecodeUtf8(text);
+    std::vector<const AtlasGlyph*> glyphs(codepoints.size(), nullptr);
+    std::vector<bool> acquired(codepoints.size(), false);
+    for (size_t i = 0; i < codepoints.size(); i++) {
+        if (codepoints[i] != U'\n') {
+            glyphs[i] = m_atlas.Acquire(codepoints[i]);
+            acquired[i] = glyphs[i] != nullptr;
+        }
+    }
+    ReleaseGlyphs(m_codepoints, m_acquired);
+
+    // Glyphs that did not fit may fit now, in the place of glyphs only the old text used.
+    for (size_t i = 0; i < codepoints.size(); i++) {
+        if (codepoints[i] != U'\n' && !acquired[i]) {
+            glyphs[i] = m_atlas.Acquire(codepoints[i]);
+            acquired[i] = glyphs[i] != nullptr;
+        }
+    }
+    m_codepoints = std::move(codepoints);
+    m_acquired = std::move(acquired);
+
+    const float margin = m_options.Margin;
+    const float availableWidth = m_options.Width - margin * 2;
+    const float availableHeight = m_options.Height - margin * 2;
+    const std::vector<Line> lines = BreakLines(m_codepoints, glyphs, availableWidth);
+
+    const FontMetrics& metrics = m_atlas.GetFontMetrics();
+    const float lineHeight = metrics.Ascent + metrics.Descent + metrics.LineGap;
+    const float top = margin + Align(m_options.ParagraphAlignment, availableHeight, lineHeight * lines.size());
+
+    std::vector<GlyphQuad> quads;
+    quads.reserve(m_codepoints.size());
+    for (size_t lineIndex = 0; lineIndex < lines.size(); lineIndex++) {
+        const Line& line = lines[lineIndex];
+        const float baseline = top + lineHeight * lineIndex + metrics.Ascent;
+        float pen = margin + Align(m_options.TextAlignment, availableWidth, MeasureLine(m_codepoints, glyphs, line));
+
+        for (size_t i = line.Begin; i < line.End; i++) {
+            const AtlasGlyph* glyph = glyphs[i];
+            if (glyph == nullptr) {
+                continue;
+            }
+
+            // Glyphs are placed on whole pixels so their atlas pixels map one to one to the box.
+            const AtlasRect& rect = glyph->Rect;
+            const int32_t left = (int32_t)std::lround(pen + glyph->Left);
+            const int32_t glyphTop = (int32_t)std::lround(baseline - glyph->Top);
+            const bool inside = left >= 0 && glyphTop >= 0 && left + (float)rect.Width <= m_options.Width &&
+                                glyphTop + (float)rect.Height <= m_options.Height;
+            if (rect.Width > 0 && rect.Height > 0 && inside) {
+                quads.push_back(GlyphQuad{left, glyphTop, rect});
+            }
+            pen += glyph->Advance;
+        }
+    }
+
+    m_changedQuads.clear();
+    for (size_t i = 0; i < quads.size(); i++) {
+        if (i >= m_quads.size() || quads[i] != m_quads[i]) {
+            m_changedQuads.push_back(i);
+        }
+    }
+    m_previousQuadCount = m_quads.size();
+    m_quads = std::move(quads);
+    return true;
+}
+
+void TextLayout::ReleaseGlyphs(const std::u32string& codepoints, const std::vector<bool>& acquired) {
+    for (size_t i = 0; i < codepoints.size(); i++) {
+        if (acquired[i]) {
+            m_atlas.Release(codepoints[i]);
+        }
+    }
+}
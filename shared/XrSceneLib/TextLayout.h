@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "GlyphAtlas.h"
+
+namespace engine {
+
+    enum class TextAlignment {
+        Leading,
+        Center,
+        Trailing,
+    };
+
+    enum class ParagraphAlignment {
+        Near,
+        Center,
+        Far,
+    };
+
+    // The box text is laid out in, in pixels.
+    struct TextLayoutOptions {
+        float Width{0};
+        float Height{0};
+        float Margin{0};
+        engine::TextAlignment TextAlignment{engine::TextAlignment::Center};
+        engine::ParagraphAlignment ParagraphAlignment{engine::ParagraphAlignment::Center};
+    };
+
+    // A glyph placed in the layout box, in whole pixels from the top-left corner of the box.
+    struct GlyphQuad {
+        int32_t Left{0};
+        int32_t Top{0};
+        AtlasRect Rect; // The glyph's pixels in the atlas, also giving the size of the quad.
+
+        bool operator==(const GlyphQuad& other) const {
+            return Left == other.Left && Top == other.Top && Rect.X == other.Rect.X && Rect.Y == other.Rect.Y &&
+                   Rect.Width == other.Rect.Width && Rect.Height == other.Rect.Height;
+        }
+        bool operator!=(const GlyphQuad& other) const {
+            return !(*this == other);
+        }
+    };
+
+    // Decode UTF-8 to codepoints. Invalid sequences decode to U+FFFD.
+    std::u32string DecodeUtf8(std::string_view text);
+
+    // Lays out text as quads of atlas glyphs: lines break at '\n' and wrap at spaces, or within a word longer than a line.
+    // Glyphs that do not fit in the box are left out. The layout holds a reference to the atlas glyphs of its text.
+    class TextLayout {
+    public:
+        TextLayout(GlyphAtlas& atlas, TextLayoutOptions options);
+        ~TextLayout();
+
+        TextLayout(const TextLayout&) = delete;
+        TextLayout& operator=(const TextLayout&) = delete;
+
+        // Lay out new text. Returns false, leaving the quads as they are, if the text did not change.
+        bool SetText(std::string_view text);
+
+        const std::vector<GlyphQuad>& GetQuads() const {
+            return m_quads;
+        }
+
+        // The indices of the quads that differ from the previous layout, including quads added at the end.
+        const std::vector<size_t>& GetChangedQuads() const {
+            return m_changedQuads;
+        }
+
+        // The number of quads in the previous layout, to find the quads that were removed from the end.
+        size_t GetPreviousQuadCount() const {
+            return m_previousQuadCount;
+        }
+
+    private:
+        void ReleaseGlyphs(const std::u32string& codepoints, const std::vector<bool>& acquired);
+
+        GlyphAtlas& m_atlas;
+        const TextLayoutOptions m_options;
+        std::string m_text;
+        std::u32string m_codepoints;
+        std::vector<bool> m_acquired; // Which codepoints hold a reference to an atlas glyph.
+        std::vector<GlyphQuad> m_quads;
+        std::vector<size_t> m_changedQuads;
+        size_t m_previousQuadCount{0};
+    };
+
+} // namespace engine
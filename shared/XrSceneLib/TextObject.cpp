@@ -0,0 +1,290 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <pbr/PbrModel.h>
+#include "TextObject.h"
+
+using namespace DirectX;
+using engine::TextAtlas;
+using engine::TextObject;
+
+namespace {
+    constexpr uint32_t VerticesPerQuad = 4;
+    constexpr uint32_t IndicesPerQuad = 6;
+
+    // Rasterizes glyphs of a system font with DirectWrite, in grayscale at one pixel per DIP.
+    class DWriteGlyphRasterizer : public engine::GlyphRasterizer {
+    public:
+        DWriteGlyphRasterizer(const wchar_t* fontName, float fontSize)
+            : m_fontSize(fontSize) {
+            CHECK_HRCMD(DWriteCreateFactory(
+                DWRITE_FACTORY_TYPE_SHARED, winrt::guid_of<IDWriteFactory2>(), reinterpret_cast<IUnknown**>(m_dwriteFactory.put_void())));
+
+            winrt::com_ptr<IDWriteFontCollection> fontCollection;
+            CHECK_HRCMD(m_dwriteFactory->GetSystemFontCollection(fontCollection.put()));
+
+            UINT32 familyIndex = 0;
+            BOOL exists = FALSE;
+            CHECK_HRCMD(fontCollection->FindFamilyName(fontName, &familyIndex, &exists));
+            if (!exists) {
+                familyIndex = 0;
+            }
+
+            winrt::com_ptr<IDWriteFontFamily> fontFamily;
+            CHECK_HRCMD(fontCollection->GetFontFamily(familyIndex, fontFamily.put()));
+            winrt::com_ptr<IDWriteFont> font;
+            CHECK_HRCMD(fontFamily->GetFirstMatchingFont(
+                DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STRETCH_NORMAL, DWRITE_FONT_STYLE_NORMAL, font.put()));
+            CHECK_HRCMD(font->CreateFontFace(m_fontFace.put()));
+
+            m_fontFace->GetMetrics(&m_designMetrics);
+            m_designUnitsToPixels = m_fontSize / m_designMetrics.designUnitsPerEm;
+        }
+
+        engine::FontMetrics GetFontMetrics() const override {
+            return engine::FontMetrics{m_designMetrics.ascent * m_designUnitsToPixels,
+                                       m_designMetrics.descent * m_designUnitsToPixels,
+                                       m_designMetrics.lineGap * m_designUnitsToPixels};
+        }
+
+        engine::GlyphBitmap Rasterize(char32_t codepoint) override {
+            const UINT32 codepoints[] = {(UINT32)codepoint};
+            UINT16 glyphIndex = 0;
+            CHECK_HRCMD(m_fontFace->GetGlyphIndices(codepoints, 1, &glyphIndex));
+
+            DWRITE_GLYPH_METRICS glyphMetrics{};
+            CHECK_HRCMD(m_fontFace->GetDesignGlyphMetrics(&glyphIndex, 1, &glyphMetrics, FALSE));
+
+            engine::GlyphBitmap bitmap;
+            bitmap.Advance = glyphMetrics.advanceWidth * m_designUnitsToPixels;
+
+            const FLOAT glyphAdvance = 0;
+            const DWRITE_GLYPH_OFFSET glyphOffset{};
+            DWRITE_GLYPH_RUN glyphRun{};
+            glyphRun.fontFace = m_fontFace.get();
+            glyphRun.fontEmSize = m_fontSize;
+            glyphRun.glyphCount = 1;
+            glyphRun.glyphIndices = &glyphIndex;
+            glyphRun.glyphAdvances = &glyphAdvance;
+            glyphRun.glyphOffsets = &glyphOffset;
+
+            winrt::com_ptr<IDWriteGlyphRunAnalysis> analysis;
+            CHECK_HRCMD(m_dwriteFactory->CreateGlyphRunAnalysis(&glyphRun,
+                                                                nullptr,
+                                                                DWRITE_RENDERING_MODE_NATURAL_SYMMETRIC,
+                                                                DWRITE_MEASURING_MODE_NATURAL,
+                                                                DWRITE_GRID_FIT_MODE_DEFAULT,
+                                                                DWRITE_TEXT_ANTIALIAS_MODE_GRAYSCALE,
+                                                                0,
+                                                                0,
+                                                                analysis.put()));
+
+            // With grayscale antialiasing the aliased texture type holds one coverage byte per pixel.
+            RECT bounds{};
+            CHECK_HRCMD(analysis->GetAlphaTextureBounds(DWRITE_TEXTURE_ALIASED_1x1, &bounds));
+            if (bounds.right <= bounds.left || bounds.bottom <= bounds.top) {
+                return bitmap; // Whitespace
+            }
+
+            bitmap.Width = bounds.right - bounds.left;
+            bitmap.Height = bounds.bottom - bounds.top;
+            bitmap.Left = bounds.left;
+            bitmap.Top = -bounds.top;
+            bitmap.Coverage.resize((size_t)bitmap.Width * bitmap.Height);
+            CHECK_HRCMD(analysis->CreateAlphaTexture(
+                DWRITE_TEXTURE_ALIASED_1x1, &bounds, bitmap.Coverage.data(), (UINT32)bitmap.Coverage.size()));
+            return bitmap;
+        }
+
+    private:
+        const float m_fontSize;
+        winrt::com_ptr<IDWriteFactory2> m_dwriteFactory;
+        winrt::com_ptr<IDWriteFontFace> m_fontFace;
+        DWRITE_FONT_METRICS m_designMetrics{};
+        float m_designUnitsToPixels{1};
+    };
+
+    engine::TextAlignment ToTextAlignment(DWRITE_TEXT_ALIGNMENT alignment) {
+        switch (alignment) {
+        case DWRITE_TEXT_ALIGNMENT_TRAILING:
+            return engine::TextAlignment::Trailing;
+        case DWRITE_TEXT_ALIGNMENT_CENTER:
+            return engine::TextAlignment::Center;
+        default:
+            return engine::TextAlignment::Leading;
+        }
+    }
+
+    engine::ParagraphAlignment ToParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT alignment) {
+        switch (alignment) {
+        case DWRITE_PARAGRAPH_ALIGNMENT_FAR:
+            return engine::ParagraphAlignment::Far;
+        case DWRITE_PARAGRAPH_ALIGNMENT_CENTER:
+            return engine::ParagraphAlignment::Center;
+        default:
+            return engine::ParagraphAlignment::Near;
+        }
+    }
+
+    engine::TextLayoutOptions GetLayoutOptions(const engine::TextTextureInfo& textInfo) {
+        engine::TextLayoutOptions options;
+        options.Width = (float)textInfo.Width;
+        options.Height = (float)textInfo.Height;
+        options.Margin = textInfo.Margin;
+        options.TextAlignment = ToTextAlignment(textInfo.TextAlignment);
+        options.ParagraphAlignment = ToParagraphAlignment(textInfo.ParagraphAlignment);
+        return options;
+    }
+} // namespace
+
+TextAtlas::TextAtlas(Context& context, const wchar_t* fontName, float fontSize, uint32_t size)
+    : m_glyphs(std::make_unique<DWriteGlyphRasterizer>(fontName, fontSize), size, size) {
+    // The coverage goes to alpha, so the material's base color and the vertex colors decide the color of the text.
+    const auto textureDesc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R8G8B8A8_UNORM, size, size, 1, 1, D3D11_BIND_SHADER_RESOURCE);
+    CHECK_HRCMD(context.Device->CreateTexture2D(&textureDesc, nullptr, m_texture.put()));
+
+    winrt::com_ptr<ID3D11ShaderResourceView> textureView;
+    CHECK_HRCMD(context.Device->CreateShaderResourceView(m_texture.get(), nullptr, textureView.put()));
+
+    m_material = Pbr::Material::CreateFlat(context.PbrResources, Pbr::RGBA::White);
+    m_material->SetTexture(Pbr::ShaderSlots::BaseColor, textureView.get());
+    m_material->SetAlphaBlended(true);
+
+    Upload(context.DeviceContext.get());
+}
+
+void TextAtlas::Upload(_In_ ID3D11DeviceContext* context) {
+    const std::optional<AtlasRect> dirtyRect = m_glyphs.TakeDirtyRect();
+    if (!dirtyRect) {
+        return;
+    }
+
+    const AtlasRect& rect = *dirtyRect;
+    const std::vector<uint8_t>& coverage = m_glyphs.GetPixels();
+    m_uploadPixels.resize((size_t)rect.Width * rect.Height);
+    for (uint32_t y = 0; y < rect.Height; y++) {
+        const uint8_t* source = coverage.data() + (size_t)(rect.Y + y) * m_glyphs.GetWidth() + rect.X;
+        uint32_t* destination = m_uploadPixels.data() + (size_t)y * rect.Width;
+        for (uint32_t x = 0; x < rect.Width; x++) {
+            destination[x] = ((uint32_t)source[x] << 24) | 0x00FFFFFF;
+        }
+    }
+
+    const D3D11_BOX box{rect.X, rect.Y, 0, rect.X + rect.Width, rect.Y + rect.Height, 1};
+    context->UpdateSubresource(m_texture.get(), 0, &box, m_uploadPixels.data(), rect.Width * sizeof(uint32_t), 0);
+}
+
+TextObject::TextObject(Context& context,
+                       std::shared_ptr<TextAtlas> atlas,
+                       const TextTextureInfo& textInfo,
+                       DirectX::XMFLOAT2 sideLengths)
+    : m_context(context)
+    , m_atlas(std::move(atlas))
+    , m_textInfo(textInfo)
+    , m_sideLengths(sideLengths)
+    , m_layout(m_atlas->Glyphs(), GetLayoutOptions(textInfo)) {
+    // The first quad is the background, drawn with the solid block of the atlas.
+    m_vertices.resize(VerticesPerQuad);
+    WriteQuad(0, m_atlas->Glyphs().GetSolidRect(), 0, 0, m_textInfo.Background);
+    m_indices = {0, 1, 2, 0, 2, 3};
+
+    Pbr::PrimitiveBuilder builder;
+    builder.Vertices = m_vertices;
+    builder.Indices = m_indices;
+    m_uploadedVertexCount = m_vertices.size();
+
+    auto model = std::make_shared<Pbr::Model>();
+    model->AddPrimitive(Pbr::Primitive(context.PbrResources, builder, m_atlas->Material()));
+    SetModel(std::move(model));
+}
+
+void TextObject::SetText(std::string_view text) {
+    if (!m_layout.SetText(text)) {
+        return;
+    }
+
+    // Only the vertices of changed glyphs are written, the other glyphs kept their place and atlas pixels.
+    const std::vector<GlyphQuad>& quads = m_layout.GetQuads();
+    const size_t quadCount = quads.size() + 1;
+    m_vertices.resize(quadCount * VerticesPerQuad);
+    size_t firstChangedQuad = quadCount, lastChangedQuad = 0;
+    for (size_t quadIndex : m_layout.GetChangedQuads()) {
+        const GlyphQuad& quad = quads[quadIndex];
+        WriteQuad(quadIndex + 1, quad.Rect, quad.Left, quad.Top, m_textInfo.Foreground);
+        firstChangedQuad = std::min(firstChangedQuad, quadIndex + 1);
+        lastChangedQuad = std::max(lastChangedQuad, quadIndex + 1);
+    }
+
+    // Upload the range of changed quads, unless the text grew past the vertices uploaded so far.
+    Pbr::Primitive& primitive = GetModel()->GetPrimitive(0);
+    if (m_vertices.size() > m_uploadedVertexCount) {
+        primitive.UpdateVertexBuffer(m_context.Device.get(), m_context.DeviceContext.get(), m_vertices.data(), (uint32_t)m_vertices.size());
+        m_uploadedVertexCount = m_vertices.size();
+    } else if (firstChangedQuad <= lastChangedQuad) {
+        const size_t firstVertex = firstChangedQuad * VerticesPerQuad;
+        const size_t vertexCount = (lastChangedQuad - firstChangedQuad + 1) * VerticesPerQuad;
+        primitive.UpdateVertexBufferRange(m_context.Device.get(),
+                                          m_context.DeviceContext.get(),
+                                          m_vertices.data() + firstVertex,
+                                          (uint32_t)firstVertex,
+                                          (uint32_t)vertexCount);
+    }
+
+    // The indices only depend on the number of quads.
+    if (m_indices.size() != quadCount * IndicesPerQuad) {
+        m_indices.resize(quadCount * IndicesPerQuad);
+        for (uint32_t quadIndex = 0; quadIndex < quadCount; quadIndex++) {
+            const uint32_t base = quadIndex * VerticesPerQuad;
+            uint32_t* indices = m_indices.data() + (size_t)quadIndex * IndicesPerQuad;
+            indices[0] = base + 0;
+            indices[1] = base + 1;
+            indices[2] = base + 2;
+            indices[3] = base + 0;
+            indices[4] = base + 2;
+            indices[5] = base + 3;
+        }
+        primitive.UpdateIndexBuffer(m_context.Device.get(), m_context.DeviceContext.get(), m_indices.data(), (uint32_t)m_indices.size());
+    }
+}
+
+void TextObject::Render(Context& context) const {
+    m_atlas->Upload(context.DeviceContext.get());
+    PbrModelObject::Render(context);
+}
+
+void TextObject::WriteQuad(size_t quadIndex, const AtlasRect& rect, int32_t left, int32_t top, Pbr::RGBAColor color) {
+    const float atlasWidth = (float)m_atlas->Glyphs().GetWidth();
+    const float atlasHeight = (float)m_atlas->Glyphs().GetHeight();
+
+    float x0, y0, x1, y1;
+    XMFLOAT2 uv0, uv1;
+    if (quadIndex == 0) {
+        // The background covers the whole object and samples the middle of the solid block.
+        x0 = 0, y0 = 0;
+        x1 = (float)m_textInfo.Width, y1 = (float)m_textInfo.Height;
+        uv0 = uv1 = XMFLOAT2{(rect.X + rect.Width / 2.0f) / atlasWidth, (rect.Y + rect.Height / 2.0f) / atlasHeight};
+    } else {
+        x0 = (float)left, y0 = (float)top;
+        x1 = x0 + rect.Width, y1 = y0 + rect.Height;
+        uv0 = {rect.X / atlasWidth, rect.Y / atlasHeight};
+        uv1 = {(rect.X + rect.Width) / atlasWidth, (rect.Y + rect.Height) / atlasHeight};
+    }
+
+    // Pixels go right and down from the top-left corner, the object is centered on its origin with y up.
+    const auto toObject = [&](float x, float y) {
+        return XMFLOAT3{(x / m_textInfo.Width - 0.5f) * m_sideLengths.x, (0.5f - y / m_textInfo.Height) * m_sideLengths.y, 0};
+    };
+    const XMFLOAT3 positions[VerticesPerQuad] = {toObject(x0, y1), toObject(x0, y0), toObject(x1, y0), toObject(x1, y1)}; // LB, LT, RT, RB
+    const XMFLOAT2 uvs[VerticesPerQuad] = {{uv0.x, uv1.y}, uv0, {uv1.x, uv0.y}, uv1};
+
+    Pbr::Vertex* vertices = m_vertices.data() + quadIndex * VerticesPerQuad;
+    for (uint32_t i = 0; i < VerticesPerQuad; i++) {
+        vertices[i].Position = positions[i];
+        vertices[i].Normal = {0, 0, 1};
+        vertices[i].Tangent = {1, 0, 0, 0};
+        vertices[i].Color0 = color;
+        vertices[i].TexCoord0 = uvs[i];
+        vertices[i].ModelTransformIndex = Pbr::RootNodeIndex;
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <dwrite_2.h>
+
+#include <pbr/PbrMaterial.h>
+#include "GlyphAtlas.h"
+#include "TextLayout.h"
+#include "TextTexture.h"
+#include "PbrModelObject.h"
+#include "Context.h"
+
+namespace engine {
+
+    // A glyph atlas of one font at one size, rasterized with DirectWrite into a texture shared by all text objects using it.
+    class TextAtlas {
+    public:
+        TextAtlas(Context& context, const wchar_t* fontName, float fontSize, uint32_t size = 1024);
+
+        GlyphAtlas& Glyphs() {
+            return m_glyphs;
+        }
+
+        // An alpha blended material drawing the atlas coverage tinted by the vertex color.
+        const std::shared_ptr<Pbr::Material>& Material() const {
+            return m_material;
+        }
+
+        // Copy the glyphs added since the last upload to the texture.
+        void Upload(_In_ ID3D11DeviceContext* context);
+
+    private:
+        GlyphAtlas m_glyphs;
+        winrt::com_ptr<ID3D11Texture2D> m_texture;
+        std::shared_ptr<Pbr::Material> m_material;
+        std::vector<uint32_t> m_uploadPixels;
+    };
+
+    // Text drawn as one quad per glyph from a text atlas, on a background quad. Changing the text only rewrites and uploads the range of
+    // vertices from the first to the last glyph that moved or changed, instead of redrawing a texture, and all text objects of an
+    // atlas share one material.
+    // Uses the size, margin, colors and alignment of the text info; the font comes from the atlas.
+    class TextObject : public PbrModelObject {
+    public:
+        TextObject(Context& context, std::shared_ptr<TextAtlas> atlas, const TextTextureInfo& textInfo, DirectX::XMFLOAT2 sideLengths);
+
+        void SetText(std::string_view text);
+
+        void Render(Context& context) const override;
+
+    private:
+        void WriteQuad(size_t quadIndex, const AtlasRect& rect, int32_t left, int32_t top, Pbr::RGBAColor color);
+
+        Context& m_context;
+        const std::shared_ptr<TextAtlas> m_atlas;
+        const TextTextureInfo m_textInfo;
+        const DirectX::XMFLOAT2 m_sideLengths;
+        TextLayout m_layout;
+        std::vector<Pbr::Vertex> m_vertices;
+        size_t m_uploadedVertexCount{0}; // The vertex count of the last full upload, which ranges can be uploaded within.
+        std::vector<uint32_t> m_indices;
+    };
+
+} // namespace engine
@@ -11,14 +11,20 @@
 #include <SampleShared/DxUtility.h>
 #include <SampleShared/Trace.h>
 #include <SampleShared/ScopeGuard.h>
+#include <SampleShared/XrCapture.h>
 
 #include "CompositionLayers.h"
 #include "Context.h"
+#include "GpuFrameTimer.h"
 #include "XrApp.h"
 
 using namespace DirectX;
 using namespace std::chrono_literals;
 
+// XrSceneLib is compiled with XR_NO_PROTOTYPES, so all xr functions are called through xr::g_dispatchTable
+// and can be intercepted, e.g. by XrCaptureRecorder. Only the entry point of the loader is linked statically.
+extern "C" XRAPI_ATTR XrResult XRAPI_CALL xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
+
 namespace {
     const std::vector<DXGI_FORMAT> SupportedColorSwapchainFormats = {
         DXGI_FORMAT_R8G8B8A8_UNORM,
@@ -101,6 +107,7 @@ namespace {
     private:
 
         const engine::XrAppConfiguration m_appConfiguration;
+        const bool m_renderSynchronously;
 
         std::unique_ptr<engine::Context> m_context;
         xr::SpaceHandle m_viewSpace;
@@ -128,6 +135,14 @@ namespace {
         bool m_frameReadyToRender{false};
         engine::FrameTime m_currentFrameTime{};
 
+        std::optional<engine::DynamicResolutionController> m_dynamicResolution;
+        std::unique_ptr<engine::GpuFrameTimer> m_gpuFrameTimer;
+
+        // Declared last so the original functions are restored before anything else is destroyed.
+        std::unique_ptr<sample::XrCaptureRecorder> m_captureRecorder;
+        std::unique_ptr<sample::XrCaptureReplayer> m_captureReplayer;
+        bool m_replayFinished{false};
+
     private:
         bool ProcessEvents();
         void StartRenderThreadIfNotRunning();
@@ -148,7 +163,14 @@ namespace {
     };
 
     ImplementXrApp::ImplementXrApp(engine::XrAppConfiguration appConfiguration)
-        : m_appConfiguration(std::move(appConfiguration)) {
+        : m_appConfiguration(std::move(appConfiguration))
+        , m_renderSynchronously(m_appConfiguration.RenderSynchronously || m_appConfiguration.CaptureRecordPath.has_value() ||
+                                m_appConfiguration.CaptureReplayPath.has_value()) {
+        const PFN_xrGetInstanceProcAddr getInstanceProcAddr =
+            m_appConfiguration.GetInstanceProcAddr != nullptr ? m_appConfiguration.GetInstanceProcAddr : xrGetInstanceProcAddr;
+
+        // Load the global functions needed to create the instance.
+        xr::g_dispatchTable.Initialize(XR_NULL_HANDLE, getInstanceProcAddr);
 
         // Create an instance using combined extensions of XrSceneLib and the application.
         // The extension context record those supported by the runtime and enabled by the instance.
@@ -173,7 +195,15 @@ namespace {
         sample::InstanceContext instance =
             sample::CreateInstanceContext(m_appConfiguration.AppInfo, {"XrSceneLib", 1}, extensions.EnabledExtensions);
 
-        xr::g_dispatchTable.Initialize(instance.Handle, xrGetInstanceProcAddr);
+        xr::g_dispatchTable.Initialize(instance.Handle, getInstanceProcAddr);
+
+        if (m_appConfiguration.CaptureRecordPath.has_value()) {
+            m_captureRecorder = std::make_unique<sample::XrCaptureRecorder>(m_appConfiguration.CaptureRecordPath.value());
+            m_captureRecorder->Install(xr::g_dispatchTable);
+        } else if (m_appConfiguration.CaptureReplayPath.has_value()) {
+            m_captureReplayer = std::make_unique<sample::XrCaptureReplayer>(m_appConfiguration.CaptureReplayPath.value());
+            m_captureReplayer->Install(xr::g_dispatchTable);
+        }
 
         // Then get the active system with required form factor.
         // If no system is plugged in, wait until the device is plugged in.
@@ -247,6 +277,11 @@ namespace {
                                                       deviceContext);
 
         m_projectionLayers.Resize(1, Context(), true /*forceReset*/);
+
+        if (m_appConfiguration.DynamicResolution) {
+            m_dynamicResolution.emplace(*m_appConfiguration.DynamicResolution);
+            m_gpuFrameTimer = std::make_unique<engine::GpuFrameTimer>(Context().Device.get());
+        }
     }
 
     ImplementXrApp::~ImplementXrApp() {
@@ -256,6 +291,24 @@ namespace {
             std::scoped_lock lock(m_sceneMutex);
             m_scenes.clear();
         }
+
+        if (m_captureRecorder) {
+            m_captureRecorder->Uninstall();
+        }
+        if (m_captureReplayer) {
+            m_captureReplayer->Uninstall();
+
+            const sample::FrameTimeStatistics frameTimes = m_captureReplayer->FrameTimes();
+            sample::Trace("Replayed {} frames: mean {:.2f} ms, min {:.2f} ms, median {:.2f} ms, "
+                          "p95 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms",
+                          frameTimes.FrameCount,
+                          frameTimes.Mean.count(),
+                          frameTimes.Min.count(),
+                          frameTimes.Median.count(),
+                          frameTimes.Percentile95.count(),
+                          frameTimes.Percentile99.count(),
+                          frameTimes.Max.count());
+        }
     }
 
     void ImplementXrApp::AddScene(std::unique_ptr<engine::Scene> scene) {
@@ -290,8 +343,13 @@ namespace {
             m_actionBindingsFinalized = true;
         }
 
+        if (m_captureReplayer && !m_replayFinished && m_captureReplayer->Finished()) {
+            m_replayFinished = true;
+            Stop(); // Exit the session once all recorded frames were replayed.
+        }
+
         if (m_sessionRunning) {
-            if (m_appConfiguration.RenderSynchronously) {
+            if (m_renderSynchronously) {
                 UpdateFrame();
                 RenderFrame();
             } else {
@@ -451,6 +509,11 @@ namespace {
         }
 
         CHECK_XRCMD(xrBeginSession(Context().Session.Handle, &sessionBeginInfo));
+
+        // The frame times of a previous session don't apply to the new one, e.g. after the app was in the background.
+        if (m_dynamicResolution) {
+            m_dynamicResolution->Reset();
+        }
         m_sessionRunning = true;
     }
 
@@ -537,6 +600,11 @@ namespace {
         }
 
         m_projectionLayers.ForEachLayerWithLock([this](auto&& layer) {
+            if (m_dynamicResolution) {
+                const float scale = m_dynamicResolution->GetScale();
+                layer.Config(PrimaryViewConfigurationType).ViewportSizeScale = {scale, scale};
+            }
+
             for (auto& [viewConfigType, state] : m_viewConfigStates) {
                 if (xr::IsPrimaryViewConfigurationType(viewConfigType) || state.Active) {
                     layer.PrepareRendering(Context(), viewConfigType, state.ViewConfigViews);
@@ -579,6 +647,13 @@ namespace {
 
         if (renderFrameTime.ShouldRender) {
             std::scoped_lock sceneLock(m_sceneMutex);
+            // The CPU time of rendering starts once the scenes are locked, so waiting for an update to finish does not count.
+            const engine::FrameTime::clock::time_point renderStartTime = engine::FrameTime::clock::now();
+
+            Context().PbrResources.BeginFrame(Context().DeviceContext.get());
+            if (m_gpuFrameTimer) {
+                m_gpuFrameTimer->BeginFrame(Context().DeviceContext.get());
+            }
 
             for (const std::unique_ptr<engine::Scene>& scene : m_scenes) {
                 if (scene->IsActive()) {
@@ -602,6 +677,14 @@ namespace {
                     secondaryViewConfigLayerInfo.layers = secondaryViewConfigLayers.LayerData();
                 }
             }
+
+            if (m_dynamicResolution) {
+                m_gpuFrameTimer->EndFrame(Context().DeviceContext.get());
+                const engine::FrameTime::clock::duration cpuFrameTime = engine::FrameTime::clock::now() - renderStartTime;
+                m_dynamicResolution->Update(cpuFrameTime,
+                                            m_gpuFrameTimer->TryGetFrameTime(Context().DeviceContext.get()),
+                                            std::chrono::nanoseconds(renderFrameTime.PredictedDisplayPeriod));
+            }
         }
 
         CHECK_XRCMD(xrEndFrame(Context().Session.Handle, &endFrameInfo));
@@ -3,9 +3,11 @@
 
 #pragma once
 
+#include <filesystem>
 #include "Scene.h"
 #include "Context.h"
 #include "ProjectionLayer.h"
+#include "DynamicResolution.h"
 
 namespace engine {
     class XrApp {
@@ -36,6 +38,20 @@ namespace engine {
         bool SingleThreadedD3D11Device{false};
         bool RenderSynchronously{false};
         std::optional<XrHolographicWindowAttachmentMSFT> HolographicWindowAttachment{std::nullopt};
+
+        // Record the tracking and input the runtime reports into a file, or replay a recorded file instead.
+        // Frames are rendered synchronously while recording or replaying, so the app makes the same calls in each frame.
+        std::optional<std::filesystem::path> CaptureRecordPath{std::nullopt};
+        std::optional<std::filesystem::path> CaptureReplayPath{std::nullopt};
+
+        // The runtime entry point, e.g. of a sample::XrMockRuntime to run the app without a headset.
+        // If null, the app uses the runtime of the OpenXR loader.
+        PFN_xrGetInstanceProcAddr GetInstanceProcAddr{nullptr};
+
+        // Adjust the viewport scale of the primary views of all projection layers to keep the measured GPU frame time within the
+        // display period. The CPU time of rendering only holds back increases, because it does not shrink with the resolution.
+        // Only the rendered part of the swapchain images changes, the swapchains keep their size.
+        std::optional<DynamicResolutionOptions> DynamicResolution{std::nullopt};
     };
 
     std::unique_ptr<XrApp> CreateXrApp(XrAppConfiguration appConfiguration);
@@ -52,7 +52,7 @@ namespace xr::math {
     struct ViewProjection {
         XrPosef Pose;
         XrFovf Fov;
-        NearFar NearFar;
+        xr::math::NearFar NearFar;
     };
 
     // Type conversion between math types.
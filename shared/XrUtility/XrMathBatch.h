@@ -0,0 +1,368 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "XrMath.h"
+
+namespace xr::math {
+
+    // An array of poses stored as blocks of 4 poses, each component in its own vector (structure of arrays),
+    // so the batch operations below process 4 poses per instruction. The last block is padded with identity poses.
+    // The kernels are written with DirectXMath, so they use SSE4, AVX2 and FMA3 when DirectXMath is compiled for them,
+    // NEON on ARM, and scalar code when _XM_NO_INTRINSICS_ is defined.
+    class PoseArray {
+    public:
+        static constexpr size_t BlockSize = 4;
+
+        struct Block {
+            DirectX::XMVECTOR OrientationX, OrientationY, OrientationZ, OrientationW;
+            DirectX::XMVECTOR PositionX, PositionY, PositionZ;
+        };
+
+        PoseArray() = default;
+        explicit PoseArray(size_t count) {
+            Resize(count);
+        }
+
+        size_t Size() const {
+            return m_count;
+        }
+
+        void Resize(size_t count);
+
+        XrPosef Get(size_t index) const;
+        void Set(size_t index, const XrPosef& pose);
+
+        // Load or store poses in an array of structures. The stride allows reading poses embedded in other structures,
+        // e.g. Load(&jointLocations[0].pose, jointCount, sizeof(XrHandJointLocationEXT)).
+        void Load(const XrPosef* poses, size_t count, size_t stride = sizeof(XrPosef));
+        void Store(XrPosef* poses, size_t stride = sizeof(XrPosef)) const;
+
+        size_t BlockCount() const {
+            return m_blocks.size();
+        }
+        Block* Blocks() {
+            return m_blocks.data();
+        }
+        const Block* Blocks() const {
+            return m_blocks.data();
+        }
+
+    private:
+        std::vector<Block> m_blocks;
+        size_t m_count{0};
+    };
+
+    // The batch operations resize the result to the size of the input. The result can be the same array as an input.
+
+    // result[i] = poses[i] * pose, e.g. to bring poses located in a space into the parent space of that space.
+    void MultiplyPoses(const PoseArray& poses, const XrPosef& pose, PoseArray& result);
+    // result[i] = pose * poses[i]
+    void MultiplyPoses(const XrPosef& pose, const PoseArray& poses, PoseArray& result);
+    void InvertPoses(const PoseArray& poses, PoseArray& result);
+    // Same as Pose::Slerp for each pair of poses.
+    void SlerpPoses(const PoseArray& a, const PoseArray& b, float alpha, PoseArray& result);
+    // Same as LoadXrPose for each pose. matrices must hold poses.Size() elements.
+    void StorePoseMatrices(const PoseArray& poses, DirectX::XMFLOAT4X4* matrices);
+} // namespace xr::math
+
+#pragma region Implementation
+
+namespace xr::math {
+    namespace detail {
+        using PoseBlock = PoseArray::Block;
+
+        inline float& LaneOf(DirectX::XMVECTOR& vector, size_t lane) {
+            return reinterpret_cast<float*>(&vector)[lane];
+        }
+        inline float LaneOf(const DirectX::XMVECTOR& vector, size_t lane) {
+            return reinterpret_cast<const float*>(&vector)[lane];
+        }
+
+        // Hamilton product a * b for 4 quaternions at a time. Note that XMQuaternionMultiply(q1, q2) computes q2 * q1.
+        inline void XM_CALLCONV MultiplyQuaternions(DirectX::FXMVECTOR ax,
+                                                    DirectX::FXMVECTOR ay,
+                                                    DirectX::FXMVECTOR az,
+                                                    DirectX::GXMVECTOR aw,
+                                                    DirectX::HXMVECTOR bx,
+                                                    DirectX::HXMVECTOR by,
+                                                    DirectX::CXMVECTOR bz,
+                                                    DirectX::CXMVECTOR bw,
+                                                    PoseBlock& out) {
+            using namespace DirectX;
+            XMVECTOR x = XMVectorMultiply(aw, bx);
+            x = XMVectorMultiplyAdd(ax, bw, x);
+            x = XMVectorMultiplyAdd(ay, bz, x);
+            x = XMVectorNegativeMultiplySubtract(az, by, x);
+
+            XMVECTOR y = XMVectorMultiply(aw, by);
+            y = XMVectorNegativeMultiplySubtract(ax, bz, y);
+            y = XMVectorMultiplyAdd(ay, bw, y);
+            y = XMVectorMultiplyAdd(az, bx, y);
+
+            XMVECTOR z = XMVectorMultiply(aw, bz);
+            z = XMVectorMultiplyAdd(ax, by, z);
+            z = XMVectorNegativeMultiplySubtract(ay, bx, z);
+            z = XMVectorMultiplyAdd(az, bw, z);
+
+            XMVECTOR w = XMVectorMultiply(aw, bw);
+            w = XMVectorNegativeMultiplySubtract(ax, bx, w);
+            w = XMVectorNegativeMultiplySubtract(ay, by, w);
+            w = XMVectorNegativeMultiplySubtract(az, bz, w);
+
+            out.OrientationX = x;
+            out.OrientationY = y;
+            out.OrientationZ = z;
+            out.OrientationW = w;
+        }
+
+        // Rotate 4 vectors by 4 unit quaternions: v' = v + w * t + q.xyz x t, where t = 2 * (q.xyz x v).
+        inline void XM_CALLCONV RotateVectors(DirectX::FXMVECTOR qx,
+                                              DirectX::FXMVECTOR qy,
+                                              DirectX::FXMVECTOR qz,
+                                              DirectX::GXMVECTOR qw,
+                                              DirectX::XMVECTOR& vx,
+                                              DirectX::XMVECTOR& vy,
+                                              DirectX::XMVECTOR& vz) {
+            using namespace DirectX;
+            XMVECTOR tx = XMVectorNegativeMultiplySubtract(qz, vy, XMVectorMultiply(qy, vz));
+            XMVECTOR ty = XMVectorNegativeMultiplySubtract(qx, vz, XMVectorMultiply(qz, vx));
+            XMVECTOR tz = XMVectorNegativeMultiplySubtract(qy, vx, XMVectorMultiply(qx, vy));
+            tx = XMVectorAdd(tx, tx);
+            ty = XMVectorAdd(ty, ty);
+            tz = XMVectorAdd(tz, tz);
+
+            const XMVECTOR cx = XMVectorNegativeMultiplySubtract(qz, ty, XMVectorMultiply(qy, tz));
+            const XMVECTOR cy = XMVectorNegativeMultiplySubtract(qx, tz, XMVectorMultiply(qz, tx));
+            const XMVECTOR cz = XMVectorNegativeMultiplySubtract(qy, tx, XMVectorMultiply(qx, ty));
+
+            vx = XMVectorAdd(XMVectorMultiplyAdd(qw, tx, vx), cx);
+            vy = XMVectorAdd(XMVectorMultiplyAdd(qw, ty, vy), cy);
+            vz = XMVectorAdd(XMVectorMultiplyAdd(qw, tz, vz), cz);
+        }
+
+        struct SplatPose {
+            DirectX::XMVECTOR OrientationX, OrientationY, OrientationZ, OrientationW;
+            DirectX::XMVECTOR PositionX, PositionY, PositionZ;
+
+            explicit SplatPose(const XrPosef& pose)
+                : OrientationX(DirectX::XMVectorReplicate(pose.orientation.x))
+                , OrientationY(DirectX::XMVectorReplicate(pose.orientation.y))
+                , OrientationZ(DirectX::XMVectorReplicate(pose.orientation.z))
+                , OrientationW(DirectX::XMVectorReplicate(pose.orientation.w))
+                , PositionX(DirectX::XMVectorReplicate(pose.position.x))
+                , PositionY(DirectX::XMVectorReplicate(pose.position.y))
+                , PositionZ(DirectX::XMVectorReplicate(pose.position.z)) {
+            }
+        };
+    } // namespace detail
+
+    inline void PoseArray::Resize(size_t count) {
+        const size_t blockCount = (count + BlockSize - 1) / BlockSize;
+        m_blocks.resize(blockCount);
+        m_count = count;
+
+        // Pad the unused lanes with identity poses, so the kernels never operate on garbage.
+        for (size_t index = count; index < blockCount * BlockSize; index++) {
+            Set(index, Pose::Identity());
+        }
+    }
+
+    inline XrPosef PoseArray::Get(size_t index) const {
+        const Block& block = m_blocks[index / BlockSize];
+        const size_t lane = index % BlockSize;
+        return {{detail::LaneOf(block.OrientationX, lane),
+                 detail::LaneOf(block.OrientationY, lane),
+                 detail::LaneOf(block.OrientationZ, lane),
+                 detail::LaneOf(block.OrientationW, lane)},
+                {detail::LaneOf(block.PositionX, lane), detail::LaneOf(block.PositionY, lane), detail::LaneOf(block.PositionZ, lane)}};
+    }
+
+    inline void PoseArray::Set(size_t index, const XrPosef& pose) {
+        Block& block = m_blocks[index / BlockSize];
+        const size_t lane = index % BlockSize;
+        detail::LaneOf(block.OrientationX, lane) = pose.orientation.x;
+        detail::LaneOf(block.OrientationY, lane) = pose.orientation.y;
+        detail::LaneOf(block.OrientationZ, lane) = pose.orientation.z;
+        detail::LaneOf(block.OrientationW, lane) = pose.orientation.w;
+        detail::LaneOf(block.PositionX, lane) = pose.position.x;
+        detail::LaneOf(block.PositionY, lane) = pose.position.y;
+        detail::LaneOf(block.PositionZ, lane) = pose.position.z;
+    }
+
+    inline void PoseArray::Load(const XrPosef* poses, size_t count, size_t stride) {
+        Resize(count);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(poses);
+        for (size_t i = 0; i < count; i++) {
+            Set(i, *reinterpret_cast<const XrPosef*>(bytes + i * stride));
+        }
+    }
+
+    inline void PoseArray::Store(XrPosef* poses, size_t stride) const {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(poses);
+        for (size_t i = 0; i < m_count; i++) {
+            *reinterpret_cast<XrPosef*>(bytes + i * stride) = Get(i);
+        }
+    }
+
+    inline void MultiplyPoses(const PoseArray& poses, const XrPosef& pose, PoseArray& result) {
+        // Same as Pose::Multiply: Qc = Qb * Qa, Pc = rotate(Pa, Qb) + Pb
+        result.Resize(poses.Size());
+        const detail::SplatPose b(pose);
+        const detail::PoseBlock* in = poses.Blocks();
+        detail::PoseBlock* out = result.Blocks();
+        for (size_t i = 0; i < poses.BlockCount(); i++) {
+            DirectX::XMVECTOR px = in[i].PositionX, py = in[i].PositionY, pz = in[i].PositionZ;
+            detail::RotateVectors(b.OrientationX, b.OrientationY, b.OrientationZ, b.OrientationW, px, py, pz);
+
+            detail::MultiplyQuaternions(b.OrientationX,
+                                        b.OrientationY,
+                                        b.OrientationZ,
+                                        b.OrientationW,
+                                        in[i].OrientationX,
+                                        in[i].OrientationY,
+                                        in[i].OrientationZ,
+                                        in[i].OrientationW,
+                                        out[i]);
+            out[i].PositionX = DirectX::XMVectorAdd(px, b.PositionX);
+            out[i].PositionY = DirectX::XMVectorAdd(py, b.PositionY);
+            out[i].PositionZ = DirectX::XMVectorAdd(pz, b.PositionZ);
+        }
+    }
+
+    inline void MultiplyPoses(const XrPosef& pose, const PoseArray& poses, PoseArray& result) {
+        result.Resize(poses.Size());
+        const detail::SplatPose a(pose);
+        const detail::PoseBlock* in = poses.Blocks();
+        detail::PoseBlock* out = result.Blocks();
+        for (size_t i = 0; i < poses.BlockCount(); i++) {
+            const DirectX::XMVECTOR bx = in[i].OrientationX, by = in[i].OrientationY, bz = in[i].OrientationZ, bw = in[i].OrientationW;
+            DirectX::XMVECTOR px = a.PositionX, py = a.PositionY, pz = a.PositionZ;
+            detail::RotateVectors(bx, by, bz, bw, px, py, pz);
+
+            const DirectX::XMVECTOR pbx = in[i].PositionX, pby = in[i].PositionY, pbz = in[i].PositionZ;
+            detail::MultiplyQuaternions(bx, by, bz, bw, a.OrientationX, a.OrientationY, a.OrientationZ, a.OrientationW, out[i]);
+            out[i].PositionX = DirectX::XMVectorAdd(px, pbx);
+            out[i].PositionY = DirectX::XMVectorAdd(py, pby);
+            out[i].PositionZ = DirectX::XMVectorAdd(pz, pbz);
+        }
+    }
+
+    inline void InvertPoses(const PoseArray& poses, PoseArray& result) {
+        // Same as Pose::Invert: Q' = conjugate(Q), P' = rotate(-P, Q')
+        result.Resize(poses.Size());
+        const detail::PoseBlock* in = poses.Blocks();
+        detail::PoseBlock* out = result.Blocks();
+        for (size_t i = 0; i < poses.BlockCount(); i++) {
+            const DirectX::XMVECTOR qx = DirectX::XMVectorNegate(in[i].OrientationX);
+            const DirectX::XMVECTOR qy = DirectX::XMVectorNegate(in[i].OrientationY);
+            const DirectX::XMVECTOR qz = DirectX::XMVectorNegate(in[i].OrientationZ);
+            const DirectX::XMVECTOR qw = in[i].OrientationW;
+            DirectX::XMVECTOR px = DirectX::XMVectorNegate(in[i].PositionX);
+            DirectX::XMVECTOR py = DirectX::XMVectorNegate(in[i].PositionY);
+            DirectX::XMVECTOR pz = DirectX::XMVectorNegate(in[i].PositionZ);
+            detail::RotateVectors(qx, qy, qz, qw, px, py, pz);
+
+            out[i] = {qx, qy, qz, qw, px, py, pz};
+        }
+    }
+
+    inline void SlerpPoses(const PoseArray& a, const PoseArray& b, float alpha, PoseArray& result) {
+        // Same as XMQuaternionSlerp: the shorter arc is taken, and nearly equal quaternions are linearly interpolated.
+        using namespace DirectX;
+        if (a.Size() != b.Size()) {
+            throw std::invalid_argument("Pose arrays must have the same size");
+        }
+
+        result.Resize(a.Size());
+        const XMVECTOR oneMinusEpsilon = XMVectorReplicate(1.0f - 0.00001f);
+        const XMVECTOR t = XMVectorReplicate(alpha);
+        const XMVECTOR oneMinusT = XMVectorReplicate(1.0f - alpha);
+
+        const detail::PoseBlock* inA = a.Blocks();
+        const detail::PoseBlock* inB = b.Blocks();
+        detail::PoseBlock* out = result.Blocks();
+        for (size_t i = 0; i < a.BlockCount(); i++) {
+            const detail::PoseBlock& qa = inA[i];
+            const detail::PoseBlock& qb = inB[i];
+
+            XMVECTOR cosOmega = XMVectorMultiply(qa.OrientationX, qb.OrientationX);
+            cosOmega = XMVectorMultiplyAdd(qa.OrientationY, qb.OrientationY, cosOmega);
+            cosOmega = XMVectorMultiplyAdd(qa.OrientationZ, qb.OrientationZ, cosOmega);
+            cosOmega = XMVectorMultiplyAdd(qa.OrientationW, qb.OrientationW, cosOmega);
+
+            const XMVECTOR negative = XMVectorLess(cosOmega, g_XMZero);
+            const XMVECTOR sign = XMVectorSelect(g_XMOne, g_XMNegativeOne, negative);
+            cosOmega = XMVectorAbs(cosOmega);
+
+            const XMVECTOR sinOmega = XMVectorSqrt(XMVectorNegativeMultiplySubtract(cosOmega, cosOmega, g_XMOne));
+            const XMVECTOR omega = XMVectorATan2(sinOmega, cosOmega);
+            const XMVECTOR invSinOmega = XMVectorReciprocal(sinOmega);
+
+            const XMVECTOR useSlerp = XMVectorLess(cosOmega, oneMinusEpsilon);
+            const XMVECTOR slerp0 = XMVectorMultiply(XMVectorSin(XMVectorMultiply(oneMinusT, omega)), invSinOmega);
+            const XMVECTOR slerp1 = XMVectorMultiply(XMVectorSin(XMVectorMultiply(t, omega)), invSinOmega);
+            const XMVECTOR s0 = XMVectorSelect(oneMinusT, slerp0, useSlerp);
+            XMVECTOR s1 = XMVectorSelect(t, slerp1, useSlerp);
+            s1 = XMVectorMultiply(s1, sign);
+
+            const XMVECTOR ox = XMVectorMultiplyAdd(qa.OrientationX, s0, XMVectorMultiply(qb.OrientationX, s1));
+            const XMVECTOR oy = XMVectorMultiplyAdd(qa.OrientationY, s0, XMVectorMultiply(qb.OrientationY, s1));
+            const XMVECTOR oz = XMVectorMultiplyAdd(qa.OrientationZ, s0, XMVectorMultiply(qb.OrientationZ, s1));
+            const XMVECTOR ow = XMVectorMultiplyAdd(qa.OrientationW, s0, XMVectorMultiply(qb.OrientationW, s1));
+
+            const XMVECTOR positionX = XMVectorLerpV(qa.PositionX, qb.PositionX, t);
+            const XMVECTOR positionY = XMVectorLerpV(qa.PositionY, qb.PositionY, t);
+            const XMVECTOR positionZ = XMVectorLerpV(qa.PositionZ, qb.PositionZ, t);
+
+            out[i] = {ox, oy, oz, ow, positionX, positionY, positionZ};
+        }
+    }
+
+    inline void StorePoseMatrices(const PoseArray& poses, DirectX::XMFLOAT4X4* matrices) {
+        // Same rows as XMMatrixRotationQuaternion, with the position in the last row. Each group of 4 rows is computed
+        // for 4 poses at once, then transposed so that each vector holds one row of one matrix.
+        using namespace DirectX;
+        const detail::PoseBlock* in = poses.Blocks();
+        for (size_t i = 0; i < poses.BlockCount(); i++) {
+            const detail::PoseBlock& pose = in[i];
+            const XMVECTOR x2 = XMVectorAdd(pose.OrientationX, pose.OrientationX);
+            const XMVECTOR y2 = XMVectorAdd(pose.OrientationY, pose.OrientationY);
+            const XMVECTOR z2 = XMVectorAdd(pose.OrientationZ, pose.OrientationZ);
+            const XMVECTOR xx = XMVectorMultiply(pose.OrientationX, x2);
+            const XMVECTOR yy = XMVectorMultiply(pose.OrientationY, y2);
+            const XMVECTOR zz = XMVectorMultiply(pose.OrientationZ, z2);
+            const XMVECTOR xy = XMVectorMultiply(pose.OrientationX, y2);
+            const XMVECTOR xz = XMVectorMultiply(pose.OrientationX, z2);
+            const XMVECTOR yz = XMVectorMultiply(pose.OrientationY, z2);
+            const XMVECTOR wx = XMVectorMultiply(pose.OrientationW, x2);
+            const XMVECTOR wy = XMVectorMultiply(pose.OrientationW, y2);
+            const XMVECTOR wz = XMVectorMultiply(pose.OrientationW, z2);
+
+            const XMMATRIX row0 = XMMatrixTranspose(XMMATRIX(XMVectorSubtract(g_XMOne, XMVectorAdd(yy, zz)),
+                                                             XMVectorAdd(xy, wz),
+                                                             XMVectorSubtract(xz, wy),
+                                                             g_XMZero));
+            const XMMATRIX row1 = XMMatrixTranspose(XMMATRIX(XMVectorSubtract(xy, wz),
+                                                             XMVectorSubtract(g_XMOne, XMVectorAdd(xx, zz)),
+                                                             XMVectorAdd(yz, wx),
+                                                             g_XMZero));
+            const XMMATRIX row2 = XMMatrixTranspose(XMMATRIX(XMVectorAdd(xz, wy),
+                                                             XMVectorSubtract(yz, wx),
+                                                             XMVectorSubtract(g_XMOne, XMVectorAdd(xx, yy)),
+                                                             g_XMZero));
+            const XMMATRIX row3 = XMMatrixTranspose(XMMATRIX(pose.PositionX, pose.PositionY, pose.PositionZ, g_XMOne));
+
+            const size_t laneCount = std::min(PoseArray::BlockSize, poses.Size() - i * PoseArray::BlockSize);
+            for (size_t lane = 0; lane < laneCount; lane++) {
+                const XMMATRIX matrix(row0.r[lane], row1.r[lane], row2.r[lane], row3.r[lane]);
+                XMStoreFloat4x4(&matrices[i * PoseArray::BlockSize + lane], matrix);
+            }
+        }
+    }
+} // namespace xr::math
+
+#pragma endregion
@@ -0,0 +1,342 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include "XrMath.h"
+
+namespace xr::su {
+    struct SceneComputeSchedulerOptions {
+        // A new scene is computed when the head moved this far, or turned this much, since the last compute started.
+        float TranslationThreshold = 1.0f; // meters
+        float RotationThreshold = 0.8f;    // radians
+        // A new scene is computed when less than this fraction of the current view lies within the bounds of the current scene.
+        // The view is sampled up to CoverageDistance in a cone of FrustumHalfAngle around the view direction.
+        float MinFrustumCoverage = 0.75f;
+        float CoverageDistance = 2.0f;  // meters
+        float FrustumHalfAngle = 0.6f;  // radians
+        // A static user still gets a new scene after this long, to pick up changes in the room.
+        std::chrono::nanoseconds MaxInterval = std::chrono::seconds(30);
+        // Computes start no sooner than this after the previous one started, and the time spent computing is kept below the
+        // given fraction of the elapsed time. While computes keep failing, the interval doubles with every further failure, up to
+        // MaxInterval.
+        std::chrono::nanoseconds MinInterval = std::chrono::seconds(1);
+        float MaxComputeDutyCycle = 0.25f;
+
+        // The radius of the bounding sphere around the head. It shrinks when computes take longer than the target duration,
+        // assuming the compute time grows with the volume of the bounds.
+        float MinRadius = 2.0f; // meters
+        float MaxRadius = 4.8f; // meters
+        std::chrono::nanoseconds TargetComputeDuration = std::chrono::seconds(1);
+        // The visual mesh level of detail when the head is still and computes are fast. It is lowered by one when computes take
+        // longer than the target duration, and is coarse while the head moves faster than FastMotionSpeed.
+        XrMeshComputeLodMSFT MaxLevelOfDetail = XR_MESH_COMPUTE_LOD_MEDIUM_MSFT;
+        float FastMotionSpeed = 0.8f; // meters per second
+
+        // How much each new measurement adds to the smoothed compute duration and head speed, between 0 and 1.
+        float Smoothing = 0.3f;
+    };
+
+    enum class SceneComputeReason : uint32_t {
+        None = 0,
+        Initial = 1 << 0,     // No scene was computed yet.
+        Translation = 1 << 1, // The head moved away from where it was when the last successful compute started.
+        Rotation = 1 << 2,    // The head turned towards a part of the room outside the current scene.
+        Coverage = 1 << 3,    // The current view is not covered by the bounds of the current scene.
+        Stale = 1 << 4,       // The current scene is older than MaxInterval.
+        Requested = 1 << 5,   // The application requested the region.
+        Retry = 1 << 6,       // The previous compute failed.
+    };
+
+    constexpr SceneComputeReason operator|(SceneComputeReason a, SceneComputeReason b) {
+        return static_cast<SceneComputeReason>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+    }
+
+    constexpr bool HasReason(SceneComputeReason reasons, SceneComputeReason reason) {
+        return (static_cast<uint32_t>(reasons) & static_cast<uint32_t>(reason)) != 0;
+    }
+
+    struct SceneComputeRequest {
+        XrVector3f Center;
+        float Radius;
+        XrMeshComputeLodMSFT LevelOfDetail;
+        SceneComputeReason Reasons;
+    };
+
+    // Decides when to compute a new scene, and with which bounds and level of detail, from the head poses and the durations of
+    // previous computes. The scheduler does not call OpenXR, so the policy can be driven by recorded pose traces.
+    // Reasons found while a compute is running are merged into one pending compute, which is dropped if the running compute
+    // already covers the view. Regions requested by the application are merged with the head bounds when they overlap.
+    // Example:
+    //      if (auto request = scheduler.Update(frameTime.PredictedDisplayTime, viewInLocal.pose)) {
+    //          bounds.sphereBounds = {{request->Center, request->Radius}};
+    //          sceneObserver->ComputeNewScene(features, bounds, consistency, request->LevelOfDetail);
+    //      }
+    //      ...
+    //      scheduler.OnComputeCompleted(frameTime.PredictedDisplayTime, state == XR_SCENE_COMPUTE_STATE_COMPLETED_MSFT);
+    class SceneComputeScheduler {
+    public:
+        using Duration = std::chrono::duration<float>;
+
+        explicit SceneComputeScheduler(SceneComputeSchedulerOptions options = {})
+            : m_options(std::move(options))
+            , m_radius(m_options.MaxRadius) {
+        }
+
+        // Report the head pose of a frame. Returns the compute to start now, if one is due.
+        std::optional<SceneComputeRequest> Update(XrTime time, const XrPosef& headPose) {
+            UpdateHeadSpeed(time, headPose.position);
+
+            const SceneComputeReason reasons = GetReasons(time, headPose);
+            if (m_computing) {
+                // Keep one pending compute for the reasons found meanwhile, unless the running compute covers the view.
+                if (reasons != SceneComputeReason::None && GetCoverage(headPose, *m_computing) < m_options.MinFrustumCoverage) {
+                    m_pendingReasons = m_pendingReasons | reasons;
+                }
+                return std::nullopt;
+            }
+
+            const SceneComputeReason headReasons = reasons | m_pendingReasons;
+            if ((headReasons == SceneComputeReason::None && !m_requestedRegion) || !CanStart(time)) {
+                return std::nullopt;
+            }
+
+            // A new scene replaces the current one, so a requested region is computed together with the head bounds when possible.
+            SceneComputeRequest request{headPose.position, m_radius, GetLevelOfDetail(), headReasons};
+            if (m_requestedRegion) {
+                if (MergeRegion(request, *m_requestedRegion)) {
+                    request.Reasons = request.Reasons | SceneComputeReason::Requested;
+                    m_requestedRegion.reset();
+                } else if (headReasons == SceneComputeReason::None) {
+                    request = *m_requestedRegion;
+                    m_requestedRegion.reset();
+                }
+            }
+
+            m_pendingReasons = SceneComputeReason::None;
+            m_computing = request;
+            m_computeStartTime = time;
+            m_computeStartPose = headPose;
+            return request;
+        }
+
+        // Ask for a region to be computed, e.g. where the user is about to place content. It is merged with the head bounds of
+        // the next compute when they overlap, otherwise it is computed on its own afterwards.
+        void RequestRegion(const XrVector3f& center, float radius) {
+            SceneComputeRequest region{center, radius, m_options.MaxLevelOfDetail, SceneComputeReason::Requested};
+            if (!m_requestedRegion || !MergeRegion(*m_requestedRegion, region)) {
+                m_requestedRegion = region;
+            }
+        }
+
+        // Report that the compute returned by Update finished, including the time to process its results.
+        void OnComputeCompleted(XrTime time, bool succeeded) {
+            if (!m_computing) {
+                return;
+            }
+
+            const Duration duration = std::chrono::nanoseconds(time - m_computeStartTime);
+            m_computeDuration = m_computeDuration ? *m_computeDuration + (duration - *m_computeDuration) * m_options.Smoothing : duration;
+            if (m_computeDuration->count() > 0) {
+                const float volumeRatio = Duration(m_options.TargetComputeDuration) / *m_computeDuration;
+                m_radius = std::clamp(m_radius * std::cbrt(volumeRatio), m_options.MinRadius, m_options.MaxRadius);
+            }
+
+            if (succeeded) {
+                m_scene = m_computing;
+                m_sceneStartTime = m_computeStartTime;
+                m_sceneHeadPose = m_computeStartPose;
+                m_failureCount = 0;
+            } else {
+                m_pendingReasons = m_pendingReasons | SceneComputeReason::Retry;
+                m_failureCount++;
+            }
+            m_computing.reset();
+        }
+
+        // Forget the current scene and any running or pending compute, e.g. after the scene observer was recreated.
+        void Reset() {
+            m_radius = m_options.MaxRadius;
+            m_scene.reset();
+            m_computing.reset();
+            m_computeDuration.reset();
+            m_failureCount = 0;
+            m_pendingReasons = SceneComputeReason::None;
+            m_requestedRegion.reset();
+            m_lastHeadTime.reset();
+            m_headSpeed = 0;
+        }
+
+        bool IsComputing() const {
+            return m_computing.has_value();
+        }
+
+        // The smoothed duration of previous computes, if any completed.
+        std::optional<Duration> GetComputeDuration() const {
+            return m_computeDuration;
+        }
+
+        // The fraction of the view from the given head pose that lies within the bounds of the current scene.
+        float GetCoverage(const XrPosef& headPose) const {
+            return m_scene ? GetCoverage(headPose, *m_scene) : 0.0f;
+        }
+
+    private:
+        SceneComputeReason GetReasons(XrTime time, const XrPosef& headPose) const {
+            if (!m_scene) {
+                return m_computing ? SceneComputeReason::None : SceneComputeReason::Initial;
+            }
+
+            SceneComputeReason reasons = SceneComputeReason::None;
+            const float coverage = GetCoverage(headPose, *m_scene);
+            // The bounds may be centered elsewhere, e.g. when they were merged with a requested region.
+            if (GetDistance(headPose.position, m_sceneHeadPose.position) > m_options.TranslationThreshold) {
+                reasons = reasons | SceneComputeReason::Translation;
+            }
+            if (coverage < 1.0f && GetRotationAngle(headPose.orientation, m_sceneHeadPose.orientation) > m_options.RotationThreshold) {
+                reasons = reasons | SceneComputeReason::Rotation;
+            }
+            if (coverage < m_options.MinFrustumCoverage) {
+                reasons = reasons | SceneComputeReason::Coverage;
+            }
+            if (std::chrono::nanoseconds(time - m_sceneStartTime) > m_options.MaxInterval) {
+                reasons = reasons | SceneComputeReason::Stale;
+            }
+            return reasons;
+        }
+
+        // Only the first compute starts right away, later ones wait for the interval, including retries of a failed first compute.
+        bool CanStart(XrTime time) const {
+            if (!m_computeDuration) {
+                return true;
+            }
+
+            // Starting computes at least duration / dutyCycle apart keeps the time spent computing within the duty cycle.
+            const float dutyCycle = std::clamp(m_options.MaxComputeDutyCycle, 0.01f, 1.0f);
+            const Duration dutyCycleInterval = *m_computeDuration / dutyCycle;
+            Duration interval = std::max(Duration(m_options.MinInterval), dutyCycleInterval);
+            for (uint32_t i = 1; i < m_failureCount && interval < m_options.MaxInterval; i++) {
+                interval = std::min(interval * 2, Duration(m_options.MaxInterval));
+            }
+            const Duration sinceLastStart = std::chrono::nanoseconds(time - m_computeStartTime);
+            return sinceLastStart >= interval;
+        }
+
+        XrMeshComputeLodMSFT GetLevelOfDetail() const {
+            if (m_headSpeed > m_options.FastMotionSpeed) {
+                return XR_MESH_COMPUTE_LOD_COARSE_MSFT;
+            }
+            if (m_computeDuration && *m_computeDuration > m_options.TargetComputeDuration &&
+                m_options.MaxLevelOfDetail > XR_MESH_COMPUTE_LOD_COARSE_MSFT) {
+                return static_cast<XrMeshComputeLodMSFT>(m_options.MaxLevelOfDetail - 1);
+            }
+            return m_options.MaxLevelOfDetail;
+        }
+
+        // Grows the bounds to enclose the region when they overlap and the enclosing sphere is not larger than MaxRadius.
+        bool MergeRegion(SceneComputeRequest& bounds, const SceneComputeRequest& region) const {
+            const float distance = GetDistance(region.Center, bounds.Center);
+            if (distance > bounds.Radius + region.Radius) {
+                return false;
+            }
+            if (distance + region.Radius <= bounds.Radius) {
+                return true;
+            }
+            if (distance + bounds.Radius <= region.Radius) {
+                bounds.Center = region.Center;
+                bounds.Radius = region.Radius;
+                return true;
+            }
+
+            const float radius = (distance + bounds.Radius + region.Radius) / 2;
+            if (radius > std::max(m_options.MaxRadius, region.Radius)) {
+                return false;
+            }
+            const DirectX::XMVECTOR boundsCenter = xr::math::LoadXrVector3(bounds.Center);
+            const DirectX::XMVECTOR offset = DirectX::XMVectorSubtract(xr::math::LoadXrVector3(region.Center), boundsCenter);
+            const DirectX::XMVECTOR shift = DirectX::XMVectorReplicate((radius - bounds.Radius) / distance);
+            xr::math::StoreXrVector3(&bounds.Center, DirectX::XMVectorMultiplyAdd(offset, shift, boundsCenter));
+            bounds.Radius = radius;
+            bounds.LevelOfDetail = std::max(bounds.LevelOfDetail, region.LevelOfDetail);
+            return true;
+        }
+
+        // Samples points in a cone around the view direction, and counts the ones within the bounds.
+        float GetCoverage(const XrPosef& headPose, const SceneComputeRequest& bounds) const {
+            constexpr size_t RingCount = 8;
+            constexpr std::array<float, 3> Distances{1.0f / 3, 2.0f / 3, 1.0f};
+            const DirectX::XMVECTOR orientation = xr::math::LoadXrQuaternion(headPose.orientation);
+            const DirectX::XMVECTOR head = xr::math::LoadXrVector3(headPose.position);
+            const DirectX::XMVECTOR center = xr::math::LoadXrVector3(bounds.Center);
+            const float sinHalfAngle = std::sin(m_options.FrustumHalfAngle);
+            const float cosHalfAngle = std::cos(m_options.FrustumHalfAngle);
+
+            size_t covered = 0, total = 0;
+            for (size_t i = 0; i <= RingCount; i++) {
+                // The view direction is -Z, followed by directions on the cone around it.
+                DirectX::XMVECTOR direction = DirectX::g_XMNegIdentityR2;
+                if (i > 0) {
+                    const float angle = DirectX::XM_2PI * (i - 1) / RingCount;
+                    direction = DirectX::XMVectorSet(sinHalfAngle * std::cos(angle), sinHalfAngle * std::sin(angle), -cosHalfAngle, 0);
+                }
+                direction = DirectX::XMVector3Rotate(direction, orientation);
+
+                for (const float distance : Distances) {
+                    const DirectX::XMVECTOR scale = DirectX::XMVectorReplicate(distance * m_options.CoverageDistance);
+                    const DirectX::XMVECTOR point = DirectX::XMVectorMultiplyAdd(direction, scale, head);
+                    const DirectX::XMVECTOR distanceSquared = DirectX::XMVector3LengthSq(DirectX::XMVectorSubtract(point, center));
+                    if (DirectX::XMVectorGetX(distanceSquared) <= bounds.Radius * bounds.Radius) {
+                        covered++;
+                    }
+                    total++;
+                }
+            }
+            return static_cast<float>(covered) / total;
+        }
+
+        static float GetDistance(const XrVector3f& a, const XrVector3f& b) {
+            const DirectX::XMVECTOR offset = DirectX::XMVectorSubtract(xr::math::LoadXrVector3(a), xr::math::LoadXrVector3(b));
+            return DirectX::XMVectorGetX(DirectX::XMVector3Length(offset));
+        }
+
+        static float GetRotationAngle(const XrQuaternionf& a, const XrQuaternionf& b) {
+            const float dot = std::abs(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+            return 2 * std::acos(std::min(dot, 1.0f));
+        }
+
+        void UpdateHeadSpeed(XrTime time, const XrVector3f& position) {
+            if (m_lastHeadTime && time > *m_lastHeadTime) {
+                const float seconds = std::chrono::duration<float>(std::chrono::nanoseconds(time - *m_lastHeadTime)).count();
+                const float speed = GetDistance(position, m_lastHeadPosition) / seconds;
+                m_headSpeed += (speed - m_headSpeed) * m_options.Smoothing;
+            }
+            m_lastHeadTime = time;
+            m_lastHeadPosition = position;
+        }
+
+        const SceneComputeSchedulerOptions m_options;
+        float m_radius;
+
+        std::optional<SceneComputeRequest> m_scene; // The bounds of the last successful compute.
+        XrTime m_sceneStartTime{0};
+        XrPosef m_sceneHeadPose{xr::math::Pose::Identity()}; // The head pose when the last successful compute started.
+
+        std::optional<SceneComputeRequest> m_computing; // The bounds of the running compute.
+        XrTime m_computeStartTime{0};
+        XrPosef m_computeStartPose{xr::math::Pose::Identity()};
+        std::optional<Duration> m_computeDuration;
+        uint32_t m_failureCount{0}; // The computes that failed since the last successful one.
+
+        SceneComputeReason m_pendingReasons{SceneComputeReason::None};
+        std::optional<SceneComputeRequest> m_requestedRegion;
+
+        std::optional<XrTime> m_lastHeadTime;
+        XrVector3f m_lastHeadPosition{};
+        float m_headSpeed{0};
+    };
+} // namespace xr::su
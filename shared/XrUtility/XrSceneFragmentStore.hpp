@@ -0,0 +1,345 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include "XrSceneUnderstandingSerialization.hpp"
+#include "XrUuidFlatMap.h"
+
+namespace xr::su {
+    // Keeps the serialized fragments of a scene, so a scene of a known room can be deserialized at startup instead of computed again.
+    // The store is persisted as an append-only log: each update appends the fragments whose updateTime advanced, followed by the
+    // list of fragments in the scene. Replaced and removed fragments stay in the log until it is compacted.
+    // The store only works on byte buffers, reading and writing files and calling OpenXR is left to the functions below.
+    // Example:
+    //      xr::su::SceneFragmentStore store = xr::su::LoadSceneFragmentStore(path);
+    //      if (!store.empty() && XR_FAILED(xr::su::DeserializeScene(sceneObserver, store))) { store = {}; ... }
+    //      ...
+    //      xr::su::UpdateSceneFragmentStore(store, scene);
+    //      xr::su::SaveSceneFragmentStore(store, path);
+    class SceneFragmentStore {
+    public:
+        using ReadFragmentData = std::function<std::vector<uint8_t>(const SceneFragment::Id&)>;
+
+        // Rebuild the store from a log. A log with an unknown header is ignored, and reading stops at the first incomplete or
+        // invalid record, e.g. when the application exited while appending. Such a log is rewritten at the next compaction.
+        static SceneFragmentStore FromLog(const uint8_t* data, size_t size) {
+            SceneFragmentStore store;
+            LogReader reader{data, size};
+            uint32_t magic = 0, version = 0;
+            if (!reader.Read(magic) || !reader.Read(version) || magic != LogMagic || version != LogVersion) {
+                return store;
+            }
+
+            FragmentMap fragments;
+            std::vector<SceneFragment::Id> order;
+            size_t end = reader.Offset;
+            for (uint8_t recordType = 0; reader.Read(recordType);) {
+                if (recordType == FragmentRecord) {
+                    SceneFragment::Id id;
+                    XrTime updateTime = 0;
+                    uint32_t dataSize = 0;
+                    if (!reader.Read(id) || !reader.Read(updateTime) || !reader.Read(dataSize) || !reader.CanRead(dataSize)) {
+                        break;
+                    }
+                    Fragment& fragment = fragments[id];
+                    fragment.UpdateTime = updateTime;
+                    fragment.Data.assign(data + reader.Offset, data + reader.Offset + dataSize);
+                    reader.Offset += dataSize;
+                } else if (recordType == SceneRecord) {
+                    uint32_t count = 0;
+                    if (!reader.Read(count) || !reader.CanRead(static_cast<size_t>(count) * sizeof(SceneFragment::Id))) {
+                        break;
+                    }
+                    order.resize(count);
+                    for (SceneFragment::Id& id : order) {
+                        reader.Read(id);
+                    }
+                } else {
+                    break;
+                }
+                end = reader.Offset;
+            }
+
+            // Only the fragments listed by the last scene record are part of the scene, fragments without data are dropped.
+            for (const SceneFragment::Id& id : order) {
+                const auto it = fragments.find(id);
+                if (it != fragments.end() && !store.m_fragments.contains(id)) {
+                    store.m_liveSize += RecordSize(it->second);
+                    store.m_fragments.try_emplace(id, std::move(it->second));
+                    store.m_order.push_back(id);
+                }
+            }
+            store.m_logSize = end;
+            store.m_needsRewrite = end != size || store.m_order.size() != order.size();
+            return store;
+        }
+
+        // The fragments that are new or whose updateTime advanced since they were stored.
+        std::vector<SceneFragment> GetChangedFragments(const std::vector<SceneFragment>& fragments) const {
+            std::vector<SceneFragment> changed;
+            for (const SceneFragment& fragment : fragments) {
+                const auto it = m_fragments.find(fragment.id);
+                if (it == m_fragments.end() || it->second.UpdateTime < fragment.updateTime) {
+                    changed.push_back(fragment);
+                }
+            }
+            return changed;
+        }
+
+        // Make the store match the given fragments of a scene, reading the data of changed fragments only.
+        // Returns the number of fragments that were read.
+        size_t Update(const std::vector<SceneFragment>& fragments, const ReadFragmentData& readData) {
+            const std::vector<SceneFragment> changed = GetChangedFragments(fragments);
+            for (const SceneFragment& fragment : changed) {
+                std::vector<uint8_t> data = readData(fragment.id);
+                const auto [it, added] = m_fragments.try_emplace(fragment.id);
+                Fragment& stored = it->second;
+                if (!added) {
+                    m_liveSize -= RecordSize(stored);
+                }
+                stored.UpdateTime = fragment.updateTime;
+                stored.Data = std::move(data);
+                m_liveSize += RecordSize(stored);
+                AppendFragment(m_pendingLog, fragment.id, stored);
+            }
+
+            std::vector<SceneFragment::Id> order;
+            order.reserve(fragments.size());
+            for (const SceneFragment& fragment : fragments) {
+                order.push_back(fragment.id);
+            }
+            if (changed.empty() && order == m_order) {
+                return 0;
+            }
+
+            // Forget the fragments that are no longer part of the scene.
+            FragmentMap current;
+            current.reserve(order.size());
+            for (const SceneFragment::Id& id : order) {
+                const auto it = m_fragments.find(id);
+                current.try_emplace(id, std::move(it->second));
+            }
+            for (const auto& [id, fragment] : m_fragments) {
+                if (!current.contains(id)) {
+                    m_liveSize -= RecordSize(fragment);
+                }
+            }
+            m_fragments = std::move(current);
+            m_order = std::move(order);
+            AppendScene(m_pendingLog, m_order);
+            return changed.size();
+        }
+
+        // The records to append to the log since the last call to TakePendingLog or Compact.
+        std::vector<uint8_t> TakePendingLog() {
+            std::vector<uint8_t> log = std::move(m_pendingLog);
+            m_pendingLog.clear();
+            m_logSize += log.size();
+            return log;
+        }
+
+        // True when the log must be rewritten with Compact, because it is invalid or mostly holds replaced and removed fragments.
+        bool NeedsCompaction() const {
+            return m_needsRewrite || (m_logSize > CompactionMinSize && m_logSize > m_liveSize * CompactionRatio);
+        }
+
+        // A new log holding only the current fragments, to replace the whole log.
+        std::vector<uint8_t> Compact() {
+            std::vector<uint8_t> log;
+            log.reserve(m_liveSize + HeaderSize + SceneRecordSize(m_order.size()));
+            AppendHeader(log);
+            for (const SceneFragment::Id& id : m_order) {
+                AppendFragment(log, id, m_fragments.find(id)->second);
+            }
+            AppendScene(log, m_order);
+
+            m_pendingLog.clear();
+            m_logSize = log.size();
+            m_needsRewrite = false;
+            return log;
+        }
+
+        // The fragments in the order of the scene they were read from, referencing data owned by the store.
+        std::vector<XrDeserializeSceneFragmentMSFT> GetDeserializeFragments() const {
+            std::vector<XrDeserializeSceneFragmentMSFT> result;
+            result.reserve(m_order.size());
+            for (const SceneFragment::Id& id : m_order) {
+                const std::vector<uint8_t>& data = m_fragments.find(id)->second.Data;
+                result.push_back({static_cast<uint32_t>(data.size()), data.data()});
+            }
+            return result;
+        }
+
+        size_t size() const {
+            return m_order.size();
+        }
+        bool empty() const {
+            return m_order.empty();
+        }
+
+        // Mark the whole log to be rewritten, e.g. after appending to it failed.
+        void InvalidateLog() {
+            m_needsRewrite = true;
+        }
+
+    private:
+        struct Fragment {
+            XrTime UpdateTime{0};
+            std::vector<uint8_t> Data;
+        };
+        using FragmentMap = xr::UuidFlatMap<SceneFragment::Id, Fragment>;
+
+        // Reads trivially copyable values from a byte buffer without requiring alignment.
+        struct LogReader {
+            const uint8_t* Data;
+            size_t Size;
+            size_t Offset{0};
+
+            bool CanRead(size_t count) const {
+                return count <= Size - Offset;
+            }
+
+            template <typename T>
+            bool Read(T& value) {
+                if (!CanRead(sizeof(T))) {
+                    return false;
+                }
+                std::memcpy(&value, Data + Offset, sizeof(T));
+                Offset += sizeof(T);
+                return true;
+            }
+        };
+
+        static constexpr uint32_t LogMagic = 0x46535258; // "XRSF"
+        static constexpr uint32_t LogVersion = 1;
+        static constexpr uint8_t FragmentRecord = 1;
+        static constexpr uint8_t SceneRecord = 2;
+        static constexpr size_t HeaderSize = sizeof(LogMagic) + sizeof(LogVersion);
+        static constexpr size_t FragmentRecordHeaderSize = sizeof(uint8_t) + sizeof(SceneFragment::Id) + sizeof(XrTime) + sizeof(uint32_t);
+        static constexpr size_t CompactionMinSize = 1024 * 1024;
+        static constexpr size_t CompactionRatio = 2;
+
+        static size_t RecordSize(const Fragment& fragment) {
+            return FragmentRecordHeaderSize + fragment.Data.size();
+        }
+
+        static size_t SceneRecordSize(size_t count) {
+            return sizeof(uint8_t) + sizeof(uint32_t) + count * sizeof(SceneFragment::Id);
+        }
+
+        template <typename T>
+        static void Append(std::vector<uint8_t>& log, const T& value) {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+            log.insert(log.end(), bytes, bytes + sizeof(T));
+        }
+
+        static void AppendHeader(std::vector<uint8_t>& log) {
+            Append(log, LogMagic);
+            Append(log, LogVersion);
+        }
+
+        static void AppendFragment(std::vector<uint8_t>& log, const SceneFragment::Id& id, const Fragment& fragment) {
+            Append(log, FragmentRecord);
+            Append(log, id);
+            Append(log, fragment.UpdateTime);
+            Append(log, static_cast<uint32_t>(fragment.Data.size()));
+            log.insert(log.end(), fragment.Data.begin(), fragment.Data.end());
+        }
+
+        static void AppendScene(std::vector<uint8_t>& log, const std::vector<SceneFragment::Id>& order) {
+            Append(log, SceneRecord);
+            Append(log, static_cast<uint32_t>(order.size()));
+            for (const SceneFragment::Id& id : order) {
+                Append(log, id);
+            }
+        }
+
+        FragmentMap m_fragments;
+        std::vector<SceneFragment::Id> m_order;
+        std::vector<uint8_t> m_pendingLog;
+        size_t m_logSize{0};  // The size of the log written so far, not including the pending records.
+        size_t m_liveSize{0}; // The size of the fragment records a compacted log would hold.
+        bool m_needsRewrite{true};
+    };
+
+    // Read the fragments of the scene whose updateTime advanced into the store.
+    inline size_t UpdateSceneFragmentStore(SceneFragmentStore& store, XrSceneMSFT scene) {
+        return store.Update(GetSerializedSceneFragments(scene),
+                            [scene](const SceneFragment::Id& id) { return ReadSceneFragmentData(scene, id); });
+    }
+
+    // Load the store from the log file. A missing or unreadable file gives an empty store.
+    inline SceneFragmentStore LoadSceneFragmentStore(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return {};
+        }
+        std::vector<uint8_t> log(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        if (!file.read(reinterpret_cast<char*>(log.data()), log.size())) {
+            return {};
+        }
+        return SceneFragmentStore::FromLog(log.data(), log.size());
+    }
+
+    // Append the changes of the store to the log file, or replace the file with a compacted log when needed.
+    // Returns false if the file could not be written, the changes are then written by the next successful save.
+    inline bool SaveSceneFragmentStore(SceneFragmentStore& store, const std::filesystem::path& path) {
+        if (!store.NeedsCompaction()) {
+            const std::vector<uint8_t> log = store.TakePendingLog();
+            if (log.empty()) {
+                return true;
+            }
+            std::ofstream file(path, std::ios::binary | std::ios::app);
+            if (file && file.write(reinterpret_cast<const char*>(log.data()), log.size()) && file.flush()) {
+                return true;
+            }
+            store.InvalidateLog();
+            return false;
+        }
+
+        // Write to a temporary file first, so the log on disk is always complete even if writing is interrupted.
+        const std::vector<uint8_t> log = store.Compact();
+        std::filesystem::path temporaryPath = path;
+        temporaryPath += L".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file || !file.write(reinterpret_cast<const char*>(log.data()), log.size())) {
+                store.InvalidateLog();
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error) {
+            store.InvalidateLog();
+            return false;
+        }
+        return true;
+    }
+
+    // Remove the log file, e.g. after the runtime rejected the stored fragments. Returns false if the file could not be removed.
+    inline bool DeleteSceneFragmentStore(const std::filesystem::path& path) {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        return !error;
+    }
+
+    // Restore the stored scene, the result is retrieved like a computed scene with xrGetSceneComputeStateMSFT and xrCreateSceneMSFT.
+    // The runtime may reject fragments it cannot read, e.g. fragments stored by another device or runtime version, so the result
+    // is returned rather than thrown. The store should then be discarded.
+    inline XrResult DeserializeScene(XrSceneObserverMSFT sceneObserver, const SceneFragmentStore& store) {
+        const std::vector<XrDeserializeSceneFragmentMSFT> fragments = store.GetDeserializeFragments();
+        XrSceneDeserializeInfoMSFT deserializeInfo{XR_TYPE_SCENE_DESERIALIZE_INFO_MSFT};
+        deserializeInfo.fragmentCount = static_cast<uint32_t>(fragments.size());
+        deserializeInfo.fragments = fragments.data();
+        return xrDeserializeSceneMSFT(sceneObserver, &deserializeInfo);
+    }
+
+} // namespace xr::su
@@ -3,19 +3,76 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <openxr/openxr.h>
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define XR_UUID_USE_SSE2
+#endif
+
+namespace xr::detail {
+    static_assert(sizeof(XrUuidMSFT) == sizeof(uint64_t) * 2);
+
+    // Load the UUID as two 64-bit words without violating strict aliasing.
+    inline void LoadUuidWords(const XrUuidMSFT& uuid, uint64_t& low, uint64_t& high) noexcept {
+        std::memcpy(&low, uuid.bytes, sizeof(uint64_t));
+        std::memcpy(&high, uuid.bytes + sizeof(uint64_t), sizeof(uint64_t));
+    }
+
+    inline uint64_t ByteSwap64(uint64_t value) noexcept {
+#ifdef _MSC_VER
+        return _byteswap_uint64(value);
+#else
+        return __builtin_bswap64(value);
+#endif
+    }
+
+    // Mix all 128 bits of the UUID into a 64-bit hash (the Hash128to64 finalizer from CityHash).
+    // Sequential UUIDs differ only in a few bytes, so every input bit must affect every output bit.
+    inline uint64_t HashUuid(const XrUuidMSFT& uuid) noexcept {
+        uint64_t low, high;
+        LoadUuidWords(uuid, low, high);
+        constexpr uint64_t kMul = 0x9ddfea08eb382d69ULL;
+        uint64_t a = (low ^ high) * kMul;
+        a ^= (a >> 47);
+        uint64_t b = (high ^ a) * kMul;
+        b ^= (b >> 47);
+        b *= kMul;
+        return b;
+    }
+} // namespace xr::detail
+
 inline bool operator==(const XrUuidMSFT& lh, const XrUuidMSFT& rh) noexcept {
-    return memcmp(&rh, &lh, sizeof(XrUuidMSFT)) == 0;
+#ifdef XR_UUID_USE_SSE2
+    const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lh.bytes));
+    const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rh.bytes));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) == 0xFFFF;
+#else
+    uint64_t lLow, lHigh, rLow, rHigh;
+    xr::detail::LoadUuidWords(lh, lLow, lHigh);
+    xr::detail::LoadUuidWords(rh, rLow, rHigh);
+    return ((lLow ^ rLow) | (lHigh ^ rHigh)) == 0;
+#endif
 }
 
 inline bool operator!=(const XrUuidMSFT& lh, const XrUuidMSFT& rh) noexcept {
     return !(lh == rh);
 }
 
+// Orders UUIDs the same way as memcmp, i.e. lexicographically by byte.
 inline bool operator<(const XrUuidMSFT& lh, const XrUuidMSFT& rh) noexcept {
-    return memcmp(&lh, &rh, sizeof(XrUuidMSFT)) < 0;
+    uint64_t lLow, lHigh, rLow, rHigh;
+    xr::detail::LoadUuidWords(lh, lLow, lHigh);
+    xr::detail::LoadUuidWords(rh, rLow, rHigh);
+    if (lLow != rLow) {
+        // The words are loaded little-endian, so byte swap them to compare the first byte as most significant.
+        return xr::detail::ByteSwap64(lLow) < xr::detail::ByteSwap64(rLow);
+    }
+    return xr::detail::ByteSwap64(lHigh) < xr::detail::ByteSwap64(rHigh);
 }
 
 namespace xr {
@@ -72,9 +129,7 @@ namespace std {
     template <>
     struct hash<XrUuidMSFT> {
         std::size_t operator()(const XrUuidMSFT& uuid) const noexcept {
-            static_assert(sizeof(XrUuidMSFT) == sizeof(uint64_t) * 2);
-            const uint64_t* v = reinterpret_cast<const uint64_t*>(uuid.bytes);
-            return std::hash<uint64_t>{}(v[0]) ^ (std::hash<uint64_t>{}(v[1]) << 1);
+            return static_cast<std::size_t>(xr::detail::HashUuid(uuid));
         }
     };
 
@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "XrUuid.h"
+
+namespace xr {
+    // An open-addressing hash map for XrUuidMSFT or TypedUuid keys, intended for scene understanding results with many components.
+    // Entries are stored densely so iteration is a linear walk, and a power-of-two table of entry indices is probed linearly.
+    // Erasing moves the last entry into the erased position, so the iteration order is not stable.
+    // Like std::vector, inserting or erasing an entry invalidates iterators and references to entries.
+    // Example:
+    //      xr::UuidFlatMap<xr::su::ScenePlane::Id, std::shared_ptr<engine::Object>> planeVisuals;
+    //      planeVisuals[plane.id] = visual;
+    //      for (auto& [id, visual] : planeVisuals) {}
+    template <typename TKey, typename TValue>
+    class UuidFlatMap {
+    public:
+        using key_type = TKey;
+        using mapped_type = TValue;
+        using value_type = std::pair<TKey, TValue>;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+        iterator begin() noexcept {
+            return m_entries.begin();
+        }
+        iterator end() noexcept {
+            return m_entries.end();
+        }
+        const_iterator begin() const noexcept {
+            return m_entries.begin();
+        }
+        const_iterator end() const noexcept {
+            return m_entries.end();
+        }
+
+        size_t size() const noexcept {
+            return m_entries.size();
+        }
+        bool empty() const noexcept {
+            return m_entries.empty();
+        }
+
+        void clear() noexcept {
+            m_entries.clear();
+            std::fill(m_slots.begin(), m_slots.end(), EmptySlot);
+        }
+
+        void reserve(size_t count) {
+            m_entries.reserve(count);
+            const size_t slotCount = SlotCountFor(count);
+            if (slotCount > m_slots.size()) {
+                Rehash(slotCount);
+            }
+        }
+
+        iterator find(const TKey& key) {
+            const uint32_t entryIndex = FindEntry(key);
+            return entryIndex == EmptySlot ? m_entries.end() : m_entries.begin() + entryIndex;
+        }
+        const_iterator find(const TKey& key) const {
+            const uint32_t entryIndex = FindEntry(key);
+            return entryIndex == EmptySlot ? m_entries.end() : m_entries.begin() + entryIndex;
+        }
+
+        bool contains(const TKey& key) const {
+            return FindEntry(key) != EmptySlot;
+        }
+
+        template <typename... TArgs>
+        std::pair<iterator, bool> try_emplace(const TKey& key, TArgs&&... args) {
+            if (SlotCountFor(m_entries.size() + 1) > m_slots.size()) {
+                Rehash(SlotCountFor(m_entries.size() + 1));
+            }
+
+            const size_t slot = FindSlot(key);
+            if (m_slots[slot] != EmptySlot) {
+                return {m_entries.begin() + m_slots[slot], false};
+            }
+
+            m_slots[slot] = static_cast<uint32_t>(m_entries.size());
+            m_entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<TArgs>(args)...));
+            return {std::prev(m_entries.end()), true};
+        }
+
+        template <typename TArg>
+        std::pair<iterator, bool> insert_or_assign(const TKey& key, TArg&& value) {
+            auto result = try_emplace(key, std::forward<TArg>(value));
+            if (!result.second) {
+                result.first->second = std::forward<TArg>(value);
+            }
+            return result;
+        }
+
+        TValue& operator[](const TKey& key) {
+            return try_emplace(key).first->second;
+        }
+
+        size_t erase(const TKey& key) {
+            if (m_entries.empty()) {
+                return 0;
+            }
+
+            const size_t slot = FindSlot(key);
+            const uint32_t entryIndex = m_slots[slot];
+            if (entryIndex == EmptySlot) {
+                return 0;
+            }
+            RemoveSlot(slot);
+
+            // Keep the entries dense by moving the last entry into the erased position.
+            const uint32_t lastIndex = static_cast<uint32_t>(m_entries.size() - 1);
+            if (entryIndex != lastIndex) {
+                m_slots[FindSlot(m_entries[lastIndex].first)] = entryIndex;
+                m_entries[entryIndex] = std::move(m_entries[lastIndex]);
+            }
+            m_entries.pop_back();
+            return 1;
+        }
+
+    private:
+        static constexpr uint32_t EmptySlot = UINT32_MAX;
+
+        // Keep the load factor at or below 50% so that linear probe sequences stay short.
+        static size_t SlotCountFor(size_t entryCount) noexcept {
+            size_t slotCount = 16;
+            while (slotCount < entryCount * 2) {
+                slotCount *= 2;
+            }
+            return slotCount;
+        }
+
+        size_t HomeSlot(const TKey& key) const noexcept {
+            return static_cast<size_t>(xr::detail::HashUuid(static_cast<XrUuidMSFT>(key))) & (m_slots.size() - 1);
+        }
+
+        // Returns the slot holding the key, or the empty slot where it would be inserted.
+        size_t FindSlot(const TKey& key) const noexcept {
+            const size_t mask = m_slots.size() - 1;
+            size_t slot = HomeSlot(key);
+            while (m_slots[slot] != EmptySlot && !(m_entries[m_slots[slot]].first == key)) {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        uint32_t FindEntry(const TKey& key) const noexcept {
+            return m_entries.empty() ? EmptySlot : m_slots[FindSlot(key)];
+        }
+
+        // Empty a slot and shift the following entries of the probe sequence back, so that lookups need no tombstones.
+        void RemoveSlot(size_t hole) noexcept {
+            const size_t mask = m_slots.size() - 1;
+            for (size_t next = (hole + 1) & mask; m_slots[next] != EmptySlot; next = (next + 1) & mask) {
+                const size_t home = HomeSlot(m_entries[m_slots[next]].first);
+                // The entry can fill the hole if the hole lies (cyclically) between its home slot and its current slot.
+                if (((next - home) & mask) >= ((next - hole) & mask)) {
+                    m_slots[hole] = m_slots[next];
+                    hole = next;
+                }
+            }
+            m_slots[hole] = EmptySlot;
+        }
+
+        void Rehash(size_t slotCount) {
+            m_slots.assign(slotCount, EmptySlot);
+            const size_t mask = slotCount - 1;
+            for (uint32_t i = 0; i < static_cast<uint32_t>(m_entries.size()); ++i) {
+                size_t slot = HomeSlot(m_entries[i].first);
+                while (m_slots[slot] != EmptySlot) {
+                    slot = (slot + 1) & mask;
+                }
+                m_slots[slot] = i;
+            }
+        }
+
+        std::vector<value_type> m_entries;
+        std::vector<uint32_t> m_slots;
+    };
+} // namespace xr
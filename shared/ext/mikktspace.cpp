@@ -30,6 +30,92 @@
 
 #include "mikktspace.h"
 
+// Altered for the Mixed Reality samples: the temporary buffers of genTangSpace() are carved out of a
+// per-thread scratch arena that is kept between calls, instead of each being allocated from the heap.
+// ScratchFree() is a no-op and the whole arena is recycled when genTangSpace() returns, so generating
+// tangents for many primitives, possibly on several threads at once, does not contend on the heap.
+// genTangSpaceReleaseScratch() frees the arena of the calling thread once it is done with a batch.
+// The generated tangent spaces are unchanged.
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace
+{
+	class ScratchArena
+	{
+	public:
+		void * Allocate(size_t size)
+		{
+			size = (size + Alignment - 1) & ~(Alignment - 1);
+			if (m_blocks.empty() || m_offset + size > m_blocks.back().size)
+			{
+				const size_t lastSize = m_blocks.empty() ? 0 : m_blocks.back().size;
+				const size_t blockSize = size > lastSize * 2 ? (size > MinBlockSize ? size : MinBlockSize) : lastSize * 2;
+				m_blocks.push_back({std::unique_ptr<unsigned char[]>(new (std::nothrow) unsigned char[blockSize]), blockSize});
+				if (!m_blocks.back().data)
+				{
+					m_blocks.pop_back();
+					return NULL;
+				}
+				m_offset = 0;
+			}
+			void * ptr = m_blocks.back().data.get() + m_offset;
+			m_offset += size;
+			return ptr;
+		}
+
+		// Release all allocations. If the last call needed several blocks, they are merged into one
+		// so the next call of the same size is served from a single block.
+		void Reset()
+		{
+			size_t totalSize = 0;
+			for (const Block & block : m_blocks) totalSize += block.size;
+			if (m_blocks.size() > 1 || totalSize > MaxRetainedSize)
+			{
+				m_blocks.clear();
+				if (totalSize <= MaxRetainedSize)
+				{
+					Allocate(totalSize);
+				}
+			}
+			m_offset = 0;
+		}
+
+		// Free all blocks.
+		void Release()
+		{
+			m_blocks.clear();
+			m_offset = 0;
+		}
+
+	private:
+		static const size_t Alignment = 16;
+		static const size_t MinBlockSize = 64 * 1024;
+		static const size_t MaxRetainedSize = 64 * 1024 * 1024;
+
+		struct Block
+		{
+			std::unique_ptr<unsigned char[]> data;
+			size_t size;
+		};
+		std::vector<Block> m_blocks;
+		size_t m_offset = 0;
+	};
+
+	thread_local ScratchArena g_scratchArena;
+
+	void * ScratchAlloc(size_t size)
+	{
+		return g_scratchArena.Allocate(size);
+	}
+
+	void ScratchFree(void * ptr)
+	{
+		(void)ptr;
+	}
+}
+
 #define TFALSE		0
 #define TTRUE		1
 
@@ -226,7 +312,21 @@ tbool genTangSpaceDefault(const SMikkTSpaceContext * pContext)
 	return genTangSpace(pContext, 180.0f);
 }
 
+static tbool genTangSpaceScratch(const SMikkTSpaceContext * pContext, const float fAngularThreshold);
+
 tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThreshold)
+{
+	const tbool bRes = genTangSpaceScratch(pContext, fAngularThreshold);
+	g_scratchArena.Reset();
+	return bRes;
+}
+
+void genTangSpaceReleaseScratch(void)
+{
+	g_scratchArena.Release();
+}
+
+static tbool genTangSpaceScratch(const SMikkTSpaceContext * pContext, const float fAngularThreshold)
 {
 	// count nr_triangles
 	int * piTriListIn = NULL, * piGroupTrianglesBuffer = NULL;
@@ -258,12 +358,12 @@ tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThre
 	if (iNrTrianglesIn<=0) return TFALSE;
 
 	// allocate memory for an index list
-	piTriListIn = (int *) malloc(sizeof(int)*3*iNrTrianglesIn);
-	pTriInfos = (STriInfo *) malloc(sizeof(STriInfo)*iNrTrianglesIn);
+	piTriListIn = (int *) ScratchAlloc(sizeof(int)*3*iNrTrianglesIn);
+	pTriInfos = (STriInfo *) ScratchAlloc(sizeof(STriInfo)*iNrTrianglesIn);
 	if (piTriListIn==NULL || pTriInfos==NULL)
 	{
-		if (piTriListIn!=NULL) free(piTriListIn);
-		if (pTriInfos!=NULL) free(pTriInfos);
+		if (piTriListIn!=NULL) ScratchFree(piTriListIn);
+		if (pTriInfos!=NULL) ScratchFree(pTriInfos);
 		return TFALSE;
 	}
 
@@ -310,14 +410,14 @@ tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThre
 	
 	// based on the 4 rules, identify groups based on connectivity
 	iNrMaxGroups = iNrTrianglesIn*3;
-	pGroups = (SGroup *) malloc(sizeof(SGroup)*iNrMaxGroups);
-	piGroupTrianglesBuffer = (int *) malloc(sizeof(int)*iNrTrianglesIn*3);
+	pGroups = (SGroup *) ScratchAlloc(sizeof(SGroup)*iNrMaxGroups);
+	piGroupTrianglesBuffer = (int *) ScratchAlloc(sizeof(int)*iNrTrianglesIn*3);
 	if (pGroups==NULL || piGroupTrianglesBuffer==NULL)
 	{
-		if (pGroups!=NULL) free(pGroups);
-		if (piGroupTrianglesBuffer!=NULL) free(piGroupTrianglesBuffer);
-		free(piTriListIn);
-		free(pTriInfos);
+		if (pGroups!=NULL) ScratchFree(pGroups);
+		if (piGroupTrianglesBuffer!=NULL) ScratchFree(piGroupTrianglesBuffer);
+		ScratchFree(piTriListIn);
+		ScratchFree(pTriInfos);
 		return TFALSE;
 	}
 	//printf("gen 4rule groups begin\n");
@@ -327,13 +427,13 @@ tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThre
 
 	//
 
-	psTspace = (STSpace *) malloc(sizeof(STSpace)*iNrTSPaces);
+	psTspace = (STSpace *) ScratchAlloc(sizeof(STSpace)*iNrTSPaces);
 	if (psTspace==NULL)
 	{
-		free(piTriListIn);
-		free(pTriInfos);
-		free(pGroups);
-		free(piGroupTrianglesBuffer);
+		ScratchFree(piTriListIn);
+		ScratchFree(pTriInfos);
+		ScratchFree(pGroups);
+		ScratchFree(piGroupTrianglesBuffer);
 		return TFALSE;
 	}
 	memset(psTspace, 0, sizeof(STSpace)*iNrTSPaces);
@@ -354,13 +454,13 @@ tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThre
 	//printf("gen tspaces end\n");
 	
 	// clean up
-	free(pGroups);
-	free(piGroupTrianglesBuffer);
+	ScratchFree(pGroups);
+	ScratchFree(piGroupTrianglesBuffer);
 
 	if (!bRes)	// if an allocation in GenerateTSpaces() failed
 	{
 		// clean up and return false
-		free(pTriInfos); free(piTriListIn); free(psTspace);
+		ScratchFree(pTriInfos); ScratchFree(piTriListIn); ScratchFree(psTspace);
 		return TFALSE;
 	}
 
@@ -371,7 +471,7 @@ tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThre
 	// with the same welded index in piTriListIn[].
 	DegenEpilogue(psTspace, pTriInfos, piTriListIn, pContext, iNrTrianglesIn, iTotTris);
 
-	free(pTriInfos); free(piTriListIn);
+	ScratchFree(pTriInfos); ScratchFree(piTriListIn);
 
 	index = 0;
 	for (f=0; f<iNrFaces; f++)
@@ -416,7 +516,7 @@ tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThre
 		}
 	}
 
-	free(psTspace);
+	ScratchFree(psTspace);
 
 	
 	return TTRUE;
@@ -489,17 +589,17 @@ static void GenerateSharedVerticesIndexList(int piTriList_in_and_out[], const SM
 	}
 
 	// make allocations
-	piHashTable = (int *) malloc(sizeof(int)*iNrTrianglesIn*3);
-	piHashCount = (int *) malloc(sizeof(int)*g_iCells);
-	piHashOffsets = (int *) malloc(sizeof(int)*g_iCells);
-	piHashCount2 = (int *) malloc(sizeof(int)*g_iCells);
+	piHashTable = (int *) ScratchAlloc(sizeof(int)*iNrTrianglesIn*3);
+	piHashCount = (int *) ScratchAlloc(sizeof(int)*g_iCells);
+	piHashOffsets = (int *) ScratchAlloc(sizeof(int)*g_iCells);
+	piHashCount2 = (int *) ScratchAlloc(sizeof(int)*g_iCells);
 
 	if (piHashTable==NULL || piHashCount==NULL || piHashOffsets==NULL || piHashCount2==NULL)
 	{
-		if (piHashTable!=NULL) free(piHashTable);
-		if (piHashCount!=NULL) free(piHashCount);
-		if (piHashOffsets!=NULL) free(piHashOffsets);
-		if (piHashCount2!=NULL) free(piHashCount2);
+		if (piHashTable!=NULL) ScratchFree(piHashTable);
+		if (piHashCount!=NULL) ScratchFree(piHashCount);
+		if (piHashOffsets!=NULL) ScratchFree(piHashOffsets);
+		if (piHashCount2!=NULL) ScratchFree(piHashCount2);
 		GenerateSharedVerticesIndexListSlow(piTriList_in_and_out, pContext, iNrTrianglesIn);
 		return;
 	}
@@ -537,14 +637,14 @@ static void GenerateSharedVerticesIndexList(int piTriList_in_and_out[], const SM
 	}
 	for (k=0; k<g_iCells; k++)
 		assert(piHashCount2[k] == piHashCount[k]);	// verify the count
-	free(piHashCount2);
+	ScratchFree(piHashCount2);
 
 	// find maximum amount of entries in any hash entry
 	iMaxCount = piHashCount[0];
 	for (k=1; k<g_iCells; k++)
 		if (iMaxCount<piHashCount[k])
 			iMaxCount=piHashCount[k];
-	pTmpVert = (STmpVert *) malloc(sizeof(STmpVert)*iMaxCount);
+	pTmpVert = (STmpVert *) ScratchAlloc(sizeof(STmpVert)*iMaxCount);
 	
 
 	// complete the merge
@@ -571,10 +671,10 @@ static void GenerateSharedVerticesIndexList(int piTriList_in_and_out[], const SM
 			MergeVertsSlow(piTriList_in_and_out, pContext, pTable, iEntries);
 	}
 
-	if (pTmpVert!=NULL) { free(pTmpVert); }
-	free(piHashTable);
-	free(piHashCount);
-	free(piHashOffsets);
+	if (pTmpVert!=NULL) { ScratchFree(pTmpVert); }
+	ScratchFree(piHashTable);
+	ScratchFree(piHashCount);
+	ScratchFree(piHashOffsets);
 }
 
 static void MergeVertsFast(int piTriList_in_and_out[], STmpVert pTmpVert[], const SMikkTSpaceContext * pContext, const int iL_in, const int iR_in)
@@ -1044,14 +1144,14 @@ static void InitTriInfo(STriInfo pTriInfos[], const int piTriListIn[], const SMi
 	
 	// match up edge pairs
 	{
-		SEdge * pEdges = (SEdge *) malloc(sizeof(SEdge)*iNrTrianglesIn*3);
+		SEdge * pEdges = (SEdge *) ScratchAlloc(sizeof(SEdge)*iNrTrianglesIn*3);
 		if (pEdges==NULL)
 			BuildNeighborsSlow(pTriInfos, piTriListIn, iNrTrianglesIn);
 		else
 		{
 			BuildNeighborsFast(pTriInfos, pEdges, piTriListIn, iNrTrianglesIn);
 	
-			free(pEdges);
+			ScratchFree(pEdges);
 		}
 	}
 }
@@ -1207,14 +1307,14 @@ static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], con
 	if (iMaxNrFaces == 0) return TTRUE;
 
 	// make initial allocations
-	pSubGroupTspace = (STSpace *) malloc(sizeof(STSpace)*iMaxNrFaces);
-	pUniSubGroups = (SSubGroup *) malloc(sizeof(SSubGroup)*iMaxNrFaces);
-	pTmpMembers = (int *) malloc(sizeof(int)*iMaxNrFaces);
+	pSubGroupTspace = (STSpace *) ScratchAlloc(sizeof(STSpace)*iMaxNrFaces);
+	pUniSubGroups = (SSubGroup *) ScratchAlloc(sizeof(SSubGroup)*iMaxNrFaces);
+	pTmpMembers = (int *) ScratchAlloc(sizeof(int)*iMaxNrFaces);
 	if (pSubGroupTspace==NULL || pUniSubGroups==NULL || pTmpMembers==NULL)
 	{
-		if (pSubGroupTspace!=NULL) free(pSubGroupTspace);
-		if (pUniSubGroups!=NULL) free(pUniSubGroups);
-		if (pTmpMembers!=NULL) free(pTmpMembers);
+		if (pSubGroupTspace!=NULL) ScratchFree(pSubGroupTspace);
+		if (pUniSubGroups!=NULL) ScratchFree(pUniSubGroups);
+		if (pTmpMembers!=NULL) ScratchFree(pTmpMembers);
 		return TFALSE;
 	}
 
@@ -1305,15 +1405,15 @@ static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], con
 			if (!bFound)
 			{
 				// insert new subgroup
-				int * pIndices = (int *) malloc(sizeof(int)*iMembers);
+				int * pIndices = (int *) ScratchAlloc(sizeof(int)*iMembers);
 				if (pIndices==NULL)
 				{
 					// clean up and return false
 					for (int s=0; s<iUniqueSubGroups; s++)
-						free(pUniSubGroups[s].pTriMembers);
-					free(pUniSubGroups);
-					free(pTmpMembers);
-					free(pSubGroupTspace);
+						ScratchFree(pUniSubGroups[s].pTriMembers);
+					ScratchFree(pUniSubGroups);
+					ScratchFree(pTmpMembers);
+					ScratchFree(pSubGroupTspace);
 					return TFALSE;
 				}
 				pUniSubGroups[iUniqueSubGroups].iNrFaces = iMembers;
@@ -1349,14 +1449,14 @@ static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], con
 
 		// clean up and offset iUniqueTspaces
 		for (int s=0; s<iUniqueSubGroups; s++)
-			free(pUniSubGroups[s].pTriMembers);
+			ScratchFree(pUniSubGroups[s].pTriMembers);
 		iUniqueTspaces += iUniqueSubGroups;
 	}
 
 	// clean up
-	free(pUniSubGroups);
-	free(pTmpMembers);
-	free(pSubGroupTspace);
+	ScratchFree(pUniSubGroups);
+	ScratchFree(pTmpMembers);
+	ScratchFree(pSubGroupTspace);
 
 	return TTRUE;
 }
@@ -113,6 +113,10 @@ struct SMikkTSpaceContext
 tbool genTangSpaceDefault(const SMikkTSpaceContext * pContext);	// Default (recommended) fAngularThreshold is 180 degrees (which means threshold disabled)
 tbool genTangSpace(const SMikkTSpaceContext * pContext, const float fAngularThreshold);
 
+// Altered for the Mixed Reality samples: genTangSpace() keeps its scratch memory per thread between calls.
+// Free the scratch memory of the calling thread, e.g. when a pool thread is done generating tangents for a model.
+void genTangSpaceReleaseScratch(void);
+
 
 // To avoid visual errors (distortions/unwanted hard edges in lighting), when using sampled normal maps, the
 // normal map sampler must use the exact inverse of the pixel shader transformation.
@@ -3,6 +3,10 @@
 // Licensed under the MIT License. See License.txt in the project root for license information.
 #include "pch.h"
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
 // Enable iterative parsing to avoid possible stack overflow
 #define RAPIDJSON_PARSE_DEFAULT_FLAGS kParseIterativeFlag
 #define TINYGLTF_USE_RAPIDJSON
@@ -68,6 +72,22 @@ namespace
         }
     }
 
+    // Generates a tangent for each vertex which is perpendicular to its normal and as close as possible to the +X axis,
+    // falling back to the +Y axis for normals close to X. This is much cheaper than MikkTSpace and is sufficient when
+    // the material has no normal map, because the tangent frame then does not affect shading. It only needs to be valid.
+    void ComputePerVertexTangents(GltfHelper::Primitive& primitive)
+    {
+        for (GltfHelper::Vertex& vertex : primitive.Vertices)
+        {
+            const XMVECTOR normal = XMLoadFloat3(&vertex.Normal);
+            const XMVECTOR axis = fabsf(vertex.Normal.x) < 0.9f ? g_XMIdentityR0 : g_XMIdentityR1;
+
+            // Gram-Schmidt: remove the component of the axis along the normal.
+            const XMVECTOR tangent = XMVector3Normalize(XMVectorSubtract(axis, XMVectorMultiply(normal, XMVector3Dot(axis, normal))));
+            XMStoreFloat4(&vertex.Tangent, XMVectorSetW(tangent, 1.0f));
+        }
+    }
+
     // Generates normals for the trianges in the GltfHelper Primitive object.
     void ComputeTriangleNormals(GltfHelper::Primitive& primitive)
     {
@@ -481,7 +501,7 @@ namespace GltfHelper
         }
     }
 
-    Primitive ReadPrimitive(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive)
+    Primitive ReadPrimitive(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive, TangentGeneration tangentGeneration)
     {
         if (gltfPrimitive.mode != TINYGLTF_MODE_TRIANGLES)
         {
@@ -527,7 +547,14 @@ namespace GltfHelper
         // If tangents are missing, compute tangents.
         if (gltfPrimitive.attributes.find("TANGENT") == std::end(gltfPrimitive.attributes))
         {
-            ComputeTriangleTangents(primitive);
+            if (tangentGeneration == TangentGeneration::PerVertex)
+            {
+                ComputePerVertexTangents(primitive);
+            }
+            else
+            {
+                ComputeTriangleTangents(primitive);
+            }
         }
 
         // If colors are missing, set to default.
@@ -542,6 +569,71 @@ namespace GltfHelper
         return primitive;
     }
 
+    TangentGeneration ChooseTangentGeneration(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive)
+    {
+        if (gltfPrimitive.material != -1)
+        {
+            const tinygltf::Material& gltfMaterial = gltfModel.materials.at(gltfPrimitive.material);
+            if (gltfMaterial.additionalValues.find("normalTexture") != std::end(gltfMaterial.additionalValues))
+            {
+                return TangentGeneration::MikkTSpace;
+            }
+        }
+
+        return TangentGeneration::PerVertex;
+    }
+
+    std::vector<Primitive> ReadPrimitives(const tinygltf::Model& gltfModel, const std::vector<const tinygltf::Primitive*>& gltfPrimitives)
+    {
+        std::vector<Primitive> primitives(gltfPrimitives.size());
+
+        // Each thread takes the next unread primitive until all are read, so a few large primitives don't hold up the rest.
+        // Tangent generation reuses a per-thread scratch arena in MikkTSpace, so the threads don't contend on the heap.
+        // The arena is freed when a thread is done, so the pool threads of std::async don't keep it after the load.
+        std::atomic<size_t> nextPrimitive{0};
+        std::atomic<bool> failed{false};
+        auto readPrimitives = [&]()
+        {
+            struct ScratchRelease
+            {
+                ~ScratchRelease()
+                {
+                    genTangSpaceReleaseScratch();
+                }
+            } scratchRelease;
+
+            for (size_t i = nextPrimitive++; i < gltfPrimitives.size() && !failed; i = nextPrimitive++)
+            {
+                try
+                {
+                    const tinygltf::Primitive& gltfPrimitive = *gltfPrimitives[i];
+                    primitives[i] = ReadPrimitive(gltfModel, gltfPrimitive, ChooseTangentGeneration(gltfModel, gltfPrimitive));
+                }
+                catch (...)
+                {
+                    failed = true;
+                    throw;
+                }
+            }
+        };
+
+        const size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), gltfPrimitives.size());
+        std::vector<std::future<void>> workers;
+        for (size_t i = 1; i < threadCount; i++)
+        {
+            workers.push_back(std::async(std::launch::async, readPrimitives));
+        }
+
+        // The calling thread reads primitives too. If it fails, the futures wait for the workers on destruction.
+        readPrimitives();
+        for (std::future<void>& worker : workers)
+        {
+            worker.get(); // Rethrows any exception from the worker.
+        }
+
+        return primitives;
+    }
+
     Material ReadMaterial(const tinygltf::Model& gltfModel, const tinygltf::Material& gltfMaterial)
     {
         // Read an optional VEC4 parameter if available, otherwise use the default.
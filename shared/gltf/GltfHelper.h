@@ -44,6 +44,13 @@ namespace GltfHelper
 
     enum class AlphaMode { Opaque, Mask, Blend };
 
+    // How tangents are generated for primitives which have none.
+    enum class TangentGeneration
+    {
+        MikkTSpace, // The algorithm recommended by the glTF specification. Required for correct normal mapping.
+        PerVertex,  // Any unit vector perpendicular to the normal. Much faster, but only valid without a normal map.
+    };
+
     // Metallic-roughness material definition.
     struct Material
     {
@@ -76,7 +83,17 @@ namespace GltfHelper
     DirectX::XMMATRIX XM_CALLCONV ReadNodeLocalTransform(const tinygltf::Node& gltfNode);
 
     // Parses the primitive attributes and indices from the glTF accessors/bufferviews/buffers into a common simplified data structure, the Primitive.
-    Primitive ReadPrimitive(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive);
+    // MikkTSpace keeps its scratch memory on the calling thread, genTangSpaceReleaseScratch() frees it.
+    Primitive ReadPrimitive(const tinygltf::Model& gltfModel,
+                            const tinygltf::Primitive& gltfPrimitive,
+                            TangentGeneration tangentGeneration = TangentGeneration::MikkTSpace);
+
+    // Returns PerVertex if the material of the primitive has no normal texture, since tangents then have no effect on shading.
+    TangentGeneration ChooseTangentGeneration(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive);
+
+    // Reads many primitives on multiple threads, choosing the tangent generation of each with ChooseTangentGeneration.
+    // The primitives are returned in the same order.
+    std::vector<Primitive> ReadPrimitives(const tinygltf::Model& gltfModel, const std::vector<const tinygltf::Primitive*>& gltfPrimitives);
 
     // Parses the material values into a simplified data structure, the Material.
     Material ReadMaterial(const tinygltf::Model& gltfModel, const tinygltf::Material& gltfMaterial);
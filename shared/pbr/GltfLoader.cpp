@@ -2,6 +2,7 @@
 // Copyright (C) Microsoft Corporation.  All Rights Reserved
 // Licensed under the MIT License. See License.txt in the project root for license information.
 #include "pch.h"
+#include <algorithm>
 // Enable iterative parsing to avoid possible stack overflow
 #define RAPIDJSON_PARSE_DEFAULT_FLAGS kParseIterativeFlag
 #define TINYGLTF_USE_RAPIDJSON
@@ -94,12 +95,18 @@ namespace {
     // which node it corresponds to any appropriate node transformation be happen in the shader.
     using PrimitiveBuilderMap = std::map<int, Pbr::PrimitiveBuilder>;
 
-    // Load a glTF node from the tinygltf object model. This will process the node's mesh (if specified) and then recursively load the child
-    // nodes too.
+    // A glTF primitive to be loaded, and the node it belongs to.
+    struct PrimitiveToLoad {
+        const tinygltf::Primitive* GltfPrimitive;
+        Pbr::NodeIndex_t TransformIndex;
+    };
+
+    // Load a glTF node from the tinygltf object model. This will collect the primitives of the node's mesh (if specified) and then
+    // recursively load the child nodes too. The primitives are read afterwards, all at once, so they can be read in parallel.
     void XM_CALLCONV LoadNode(Pbr::NodeIndex_t parentNodeIndex,
                               const tinygltf::Model& gltfModel,
                               int nodeId,
-                              PrimitiveBuilderMap& primitiveBuilderMap,
+                              std::vector<PrimitiveToLoad>& primitivesToLoad,
                               Pbr::Model& model) {
         const tinygltf::Node& gltfNode = gltfModel.nodes.at(nodeId);
 
@@ -112,47 +119,72 @@ namespace {
             // A glTF mesh is composed of primitives.
             const tinygltf::Mesh& gltfMesh = gltfModel.meshes.at(gltfNode.mesh);
             for (const tinygltf::Primitive& gltfPrimitive : gltfMesh.primitives) {
-                // Read the primitive data from the glTF buffers.
-                const GltfHelper::Primitive primitive = GltfHelper::ReadPrimitive(gltfModel, gltfPrimitive);
-
-                // Insert or append the primitive into the PBR primitive builder. Primitives which use the same
-                // material are appended to reduce the number of draw calls.
-                Pbr::PrimitiveBuilder& primitiveBuilder = primitiveBuilderMap[gltfPrimitive.material];
-
-                // Use the starting offset for vertices and indices since multiple glTF primitives can
-                // be put into the same primitive builder.
-                const uint32_t startVertex = (uint32_t)primitiveBuilder.Vertices.size();
-                const uint32_t startIndex = (uint32_t)primitiveBuilder.Indices.size();
-
-                // Convert the GltfHelper vertices into the PBR vertex format.
-                primitiveBuilder.Vertices.resize(startVertex + primitive.Vertices.size());
-                for (size_t i = 0; i < primitive.Vertices.size(); i++) {
-                    const GltfHelper::Vertex& vertex = primitive.Vertices[i];
-                    Pbr::Vertex pbrVertex;
-                    pbrVertex.Position = vertex.Position;
-                    pbrVertex.Normal = vertex.Normal;
-                    pbrVertex.Tangent = vertex.Tangent;
-                    pbrVertex.Color0 = vertex.Color0;
-                    pbrVertex.TexCoord0 = vertex.TexCoord0;
-                    pbrVertex.ModelTransformIndex = transformIndex;
-
-                    primitiveBuilder.Vertices[i + startVertex] = pbrVertex;
-                }
-
-                // Insert indicies with reverse winding order.
-                primitiveBuilder.Indices.resize(startIndex + primitive.Indices.size());
-                for (size_t i = 0; i < primitive.Indices.size(); i += 3) {
-                    primitiveBuilder.Indices[startIndex + i + 0] = startVertex + primitive.Indices[i + 0];
-                    primitiveBuilder.Indices[startIndex + i + 1] = startVertex + primitive.Indices[i + 2];
-                    primitiveBuilder.Indices[startIndex + i + 2] = startVertex + primitive.Indices[i + 1];
-                }
+                primitivesToLoad.push_back({&gltfPrimitive, transformIndex});
             }
         }
 
         // Recursively load all children.
         for (const int childNodeId : gltfNode.children) {
-            LoadNode(transformIndex, gltfModel, childNodeId, primitiveBuilderMap, model);
+            LoadNode(transformIndex, gltfModel, childNodeId, primitivesToLoad, model);
+        }
+    }
+
+    // Insert or append the primitive into the PBR primitive builder.
+    void AppendPrimitive(const GltfHelper::Primitive& primitive, Pbr::NodeIndex_t transformIndex, Pbr::PrimitiveBuilder& primitiveBuilder) {
+        // Use the starting offset for vertices and indices since multiple glTF primitives can
+        // be put into the same primitive builder.
+        const uint32_t startVertex = (uint32_t)primitiveBuilder.Vertices.size();
+        const uint32_t startIndex = (uint32_t)primitiveBuilder.Indices.size();
+
+        // Convert the GltfHelper vertices into the PBR vertex format.
+        primitiveBuilder.Vertices.resize(startVertex + primitive.Vertices.size());
+        for (size_t i = 0; i < primitive.Vertices.size(); i++) {
+            const GltfHelper::Vertex& vertex = primitive.Vertices[i];
+            Pbr::Vertex pbrVertex;
+            pbrVertex.Position = vertex.Position;
+            pbrVertex.Normal = vertex.Normal;
+            pbrVertex.Tangent = vertex.Tangent;
+            pbrVertex.Color0 = vertex.Color0;
+            pbrVertex.TexCoord0 = vertex.TexCoord0;
+            pbrVertex.ModelTransformIndex = transformIndex;
+
+            primitiveBuilder.Vertices[i + startVertex] = pbrVertex;
+        }
+
+        // Insert indicies with reverse winding order.
+        primitiveBuilder.Indices.resize(startIndex + primitive.Indices.size());
+        for (size_t i = 0; i < primitive.Indices.size(); i += 3) {
+            primitiveBuilder.Indices[startIndex + i + 0] = startVertex + primitive.Indices[i + 0];
+            primitiveBuilder.Indices[startIndex + i + 1] = startVertex + primitive.Indices[i + 2];
+            primitiveBuilder.Indices[startIndex + i + 2] = startVertex + primitive.Indices[i + 1];
+        }
+    }
+
+    // Split a primitive builder too large for 16-bit indices into parts that are not, if the index bytes saved outweigh the
+    // vertices duplicated between the parts. Otherwise the builder is kept whole with 32-bit indices.
+    std::vector<Pbr::PrimitiveBuilder> SplitFor16BitIndices(Pbr::PrimitiveBuilder primitiveBuilder) {
+        std::vector<Pbr::PrimitiveBuilder> parts;
+        if (primitiveBuilder.GetIndexFormat() != DXGI_FORMAT_R16_UINT) {
+            parts = primitiveBuilder.SplitFor16BitIndices();
+
+            size_t partsVertexCount = 0;
+            for (const Pbr::PrimitiveBuilder& part : parts) {
+                partsVertexCount += part.Vertices.size();
+            }
+            const size_t savedIndexBytes = primitiveBuilder.Indices.size() * (sizeof(uint32_t) - sizeof(uint16_t));
+            // The parts can have fewer vertices in total than the builder, since vertices no triangle uses are dropped.
+            const size_t vertexCount = primitiveBuilder.Vertices.size();
+            const size_t duplicatedVertexCount = partsVertexCount > vertexCount ? partsVertexCount - vertexCount : 0;
+            const size_t duplicatedVertexBytes = duplicatedVertexCount * sizeof(Pbr::Vertex);
+            if (savedIndexBytes <= duplicatedVertexBytes) {
+                parts.clear();
+            }
         }
+
+        if (parts.empty()) {
+            parts.push_back(std::move(primitiveBuilder));
+        }
+        return parts;
     }
 } // namespace
 
@@ -160,6 +192,7 @@ namespace Gltf {
     std::shared_ptr<Pbr::Model> FromGltfObject(const Pbr::Resources& pbrResources, const tinygltf::Model& gltfModel) {
         // Start off with an empty Pbr Model.
         auto model = std::make_shared<Pbr::Model>();
+        model->ReserveNodes(gltfModel.nodes.size() + 1); // The glTF nodes are added under a root node.
 
         // Read and transform mesh/node data. Primitives with the same material are merged to reduce draw calls.
         PrimitiveBuilderMap primitiveBuilderMap;
@@ -168,8 +201,24 @@ namespace Gltf {
             const tinygltf::Scene& defaultScene = gltfModel.scenes.at(defaultSceneId);
 
             // Process the root scene nodes. The children will be processed recursively.
+            std::vector<PrimitiveToLoad> primitivesToLoad;
             for (const int rootNodeId : defaultScene.nodes) {
-                LoadNode(Pbr::RootNodeIndex, gltfModel, rootNodeId, primitiveBuilderMap, *model);
+                LoadNode(Pbr::RootNodeIndex, gltfModel, rootNodeId, primitivesToLoad, *model);
+            }
+
+            // Read the primitive data from the glTF buffers. Missing tangents are generated here, which is the most expensive part
+            // of loading, so the primitives are read in parallel.
+            std::vector<const tinygltf::Primitive*> gltfPrimitives(primitivesToLoad.size());
+            std::transform(primitivesToLoad.begin(), primitivesToLoad.end(), gltfPrimitives.begin(), [](const PrimitiveToLoad& toLoad) {
+                return toLoad.GltfPrimitive;
+            });
+            const std::vector<GltfHelper::Primitive> primitives = GltfHelper::ReadPrimitives(gltfModel, gltfPrimitives);
+
+            // Primitives which use the same material are appended to reduce the number of draw calls.
+            // They are appended in node order, so the result does not depend on which thread read which primitive.
+            for (size_t i = 0; i < primitives.size(); i++) {
+                const PrimitiveToLoad& toLoad = primitivesToLoad[i];
+                AppendPrimitive(primitives[i], toLoad.TransformIndex, primitiveBuilderMap[toLoad.GltfPrimitive->material]);
             }
         }
 
@@ -255,10 +304,12 @@ namespace Gltf {
         }
 
         // Convert the primitive builders into primitives with their respective material and add it into the Pbr Model.
-        for (const auto& primitiveBuilderPair : primitiveBuilderMap) {
-            const Pbr::PrimitiveBuilder& primitiveBuilder = primitiveBuilderPair.second;
+        // Builders too large for 16-bit indices may become several primitives.
+        for (auto& primitiveBuilderPair : primitiveBuilderMap) {
             const std::shared_ptr<Pbr::Material>& material = materialMap.find(primitiveBuilderPair.first)->second;
-            model->AddPrimitive(Pbr::Primitive(pbrResources, primitiveBuilder, material));
+            for (const Pbr::PrimitiveBuilder& primitiveBuilder : SplitFor16BitIndices(std::move(primitiveBuilderPair.second))) {
+                model->AddPrimitive(Pbr::Primitive(pbrResources, primitiveBuilder, material));
+            }
         }
 
         return model;
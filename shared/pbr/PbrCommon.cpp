@@ -2,7 +2,10 @@
 // Copyright (C) Microsoft Corporation.  All Rights Reserved
 // Licensed under the MIT License. See License.txt in the project root for license information.
 #include "pch.h"
+#include <algorithm>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
 // Implementation is in the Gltf library so this isn't needed: #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "PbrCommon.h"
@@ -17,7 +20,7 @@ namespace Pbr {
             if (FAILED(hr)) {
                 std::stringstream ss;
                 ss << std::hex << "Error in PBR renderer: 0x" << hr;
-                throw std::exception(ss.str().c_str());
+                throw std::runtime_error(ss.str());
             }
         }
     } // namespace Internal
@@ -150,7 +153,7 @@ namespace Pbr {
         };
 
         // Create each face in turn.
-        const XMVECTORF32 sideLengthHalfVector = {{{sideLengths.x / 2, sideLengths.y / 2, sideLengths.z / 2}}};
+        const XMVECTOR sideLengthHalfVector = XMVectorSet(sideLengths.x / 2, sideLengths.y / 2, sideLengths.z / 2, 0);
 
         for (int i = 0; i < FaceCount; i++) {
             XMVECTOR normal = faceNormals[i];
@@ -237,6 +240,70 @@ namespace Pbr {
         return *this;
     }
 
+    DXGI_FORMAT PrimitiveBuilder::GetIndexFormat() const {
+        return IndexFormat::ForVertexCount(Vertices.size());
+    }
+
+    std::vector<PrimitiveBuilder> PrimitiveBuilder::SplitFor16BitIndices() const {
+        if (GetIndexFormat() == DXGI_FORMAT_R16_UINT) {
+            return {*this};
+        }
+
+        constexpr uint32_t NoPart = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> vertexPart(Vertices.size(), NoPart); // The last part each vertex was added to.
+        std::vector<uint32_t> vertexIndexInPart(Vertices.size());
+
+        std::vector<PrimitiveBuilder> parts(1);
+        for (size_t i = 0; i + TRIANGLE_VERTEX_COUNT <= Indices.size(); i += TRIANGLE_VERTEX_COUNT) {
+            const uint32_t* const triangle = &Indices[i];
+
+            // Start a new part if the vertices of the triangle that are not yet in the current part do not fit.
+            uint32_t newVertexCount = 0;
+            for (uint32_t corner = 0; corner < TRIANGLE_VERTEX_COUNT; corner++) {
+                const bool isRepeated = std::find(triangle, triangle + corner, triangle[corner]) != triangle + corner;
+                if (!isRepeated && vertexPart[triangle[corner]] != parts.size() - 1) {
+                    newVertexCount++;
+                }
+            }
+            if (parts.back().Vertices.size() + newVertexCount > IndexFormat::Max16BitVertexCount) {
+                parts.emplace_back();
+            }
+
+            const uint32_t partIndex = (uint32_t)parts.size() - 1;
+            PrimitiveBuilder& part = parts.back();
+            for (uint32_t corner = 0; corner < TRIANGLE_VERTEX_COUNT; corner++) {
+                const uint32_t vertex = triangle[corner];
+                if (vertexPart[vertex] != partIndex) {
+                    vertexPart[vertex] = partIndex;
+                    vertexIndexInPart[vertex] = (uint32_t)part.Vertices.size();
+                    part.Vertices.push_back(Vertices[vertex]);
+                }
+                part.Indices.push_back(vertexIndexInPart[vertex]);
+            }
+        }
+
+        return parts;
+    }
+
+    namespace IndexFormat {
+        DXGI_FORMAT ForVertexCount(size_t vertexCount) {
+            return vertexCount <= Max16BitVertexCount ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+        }
+
+        DXGI_FORMAT ForIndices(const uint32_t* indices, size_t indexCount) {
+            const bool fits16Bit = std::all_of(indices, indices + indexCount, [](uint32_t index) { return index < Max16BitVertexCount; });
+            return fits16Bit ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+        }
+
+        UINT GetIndexSize(DXGI_FORMAT format) {
+            return format == DXGI_FORMAT_R16_UINT ? sizeof(uint16_t) : sizeof(uint32_t);
+        }
+
+        void Narrow(const uint32_t* indices, size_t indexCount, uint16_t* narrowIndices) {
+            std::transform(indices, indices + indexCount, narrowIndices, [](uint32_t index) { return (uint16_t)index; });
+        }
+    } // namespace IndexFormat
+
     namespace Texture {
         std::array<uint8_t, 4> LoadRGBAUI4(RGBAColor color) {
             XMFLOAT4 colorf;
@@ -256,7 +323,7 @@ namespace Pbr {
             // If c == 3, a component will be padded with 1.0f
             stbi_unique_ptr rgbaData(stbi_load_from_memory(fileData, fileSize, &w, &h, &c, DesiredComponentCount), freeImageData);
             if (!rgbaData) {
-                throw std::exception("Failed to load image file data.");
+                throw std::runtime_error("Failed to load image file data.");
             }
 
             return CreateTexture(device, rgbaData.get(), w * h * DesiredComponentCount, w, h, DXGI_FORMAT_R8G8B8A8_UNORM);
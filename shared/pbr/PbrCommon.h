@@ -58,10 +58,35 @@ namespace Pbr {
         static const D3D11_INPUT_ELEMENT_DESC s_vertexDesc[6];
     };
 
+    namespace IndexFormat {
+        // Primitives with at most this many vertices use 16-bit indices. 0xFFFF is left out because it is the strip cut value.
+        constexpr uint32_t Max16BitVertexCount = 0xFFFF;
+
+        // The narrowest index format that can address the given number of vertices.
+        DXGI_FORMAT ForVertexCount(size_t vertexCount);
+
+        // The narrowest index format that can hold all of the given indices.
+        DXGI_FORMAT ForIndices(const uint32_t* indices, size_t indexCount);
+
+        // The size in bytes of one index of the given format.
+        UINT GetIndexSize(DXGI_FORMAT format);
+
+        // Narrow indices to 16 bits into an array of indexCount elements. All indices must be less than Max16BitVertexCount.
+        void Narrow(const uint32_t* indices, size_t indexCount, uint16_t* narrowIndices);
+    } // namespace IndexFormat
+
     struct PrimitiveBuilder {
         std::vector<Pbr::Vertex> Vertices;
         std::vector<uint32_t> Indices;
 
+        // The narrowest index format that can address all vertices of the builder.
+        DXGI_FORMAT GetIndexFormat() const;
+
+        // Split the triangles into builders of at most IndexFormat::Max16BitVertexCount vertices each, so every part can use 16-bit
+        // indices. Triangles keep their order and vertices used by several parts are duplicated into each of them. A builder that
+        // already fits is returned as the only part.
+        std::vector<PrimitiveBuilder> SplitFor16BitIndices() const;
+
         PrimitiveBuilder& AddAxis(float axisLength = 1.0f,
                                   float axisThickness = 0.1f,
                                   float originAdditionalThickness = 0.01f,
@@ -5,24 +5,22 @@
 #include "PbrCommon.h"
 #include "PbrResources.h"
 #include "PbrMaterial.h"
+#include "PbrRenderQueue.h"
 
 using namespace DirectX;
 
 namespace Pbr {
-    Material::Material(Pbr::Resources const& pbrResources) {
+    Material::Material(Pbr::Resources const& pbrResources)
+        : m_textureBindings(std::make_shared<TextureBindings>())
+        , m_constantBuffer(std::make_shared<winrt::com_ptr<ID3D11Buffer>>()) {
         const CD3D11_BUFFER_DESC constantBufferDesc(sizeof(ConstantBufferData), D3D11_BIND_CONSTANT_BUFFER);
-        Internal::ThrowIfFailed(pbrResources.GetDevice()->CreateBuffer(&constantBufferDesc, nullptr, m_constantBuffer.put()));
+        Internal::ThrowIfFailed(pbrResources.GetDevice()->CreateBuffer(&constantBufferDesc, nullptr, m_constantBuffer->put()));
     }
 
-    std::shared_ptr<Material> Material::Clone(Pbr::Resources const& pbrResources) const {
-        auto clone = std::make_shared<Material>(pbrResources);
-        clone->Name = Name;
-        clone->Hidden = Hidden;
-        clone->m_parameters = m_parameters;
-        clone->m_textures = m_textures;
-        clone->m_samplers = m_samplers;
-        clone->m_alphaBlended = m_alphaBlended;
-        clone->m_doubleSided = m_doubleSided;
+    std::shared_ptr<Material> Material::Clone() const {
+        // The copy shares the texture bindings and constant buffer, which are detached on the first modification.
+        auto clone = std::make_shared<Material>(*this);
+        clone->m_parametersChanged = true;
         return clone;
     }
 
@@ -59,10 +57,14 @@ namespace Pbr {
     void Material::SetTexture(ShaderSlots::PSMaterial slot,
                               _In_ ID3D11ShaderResourceView* textureView,
                               _In_opt_ ID3D11SamplerState* sampler) {
-        m_textures[slot].copy_from(textureView);
+        if (m_textureBindings.use_count() > 1) {
+            m_textureBindings = std::make_shared<TextureBindings>(*m_textureBindings);
+        }
+
+        m_textureBindings->Textures[slot].copy_from(textureView);
 
         if (sampler) {
-            m_samplers[slot].copy_from(sampler);
+            m_textureBindings->Samplers[slot].copy_from(sampler);
         }
     }
 
@@ -78,32 +80,67 @@ namespace Pbr {
         m_alphaBlended = alphaBlended;
     }
 
-    void Material::Bind(_In_ ID3D11DeviceContext* context, const Resources& pbrResources) const {
+    void Material::UpdateConstantBuffer(_In_ ID3D11DeviceContext* context, const Resources& pbrResources) const {
+        // The constant buffer is released when a shared material is modified, create a new one for this material.
+        if (!m_constantBuffer) {
+            m_constantBuffer = std::make_shared<winrt::com_ptr<ID3D11Buffer>>();
+            const CD3D11_BUFFER_DESC constantBufferDesc(sizeof(ConstantBufferData), D3D11_BIND_CONSTANT_BUFFER);
+            Internal::ThrowIfFailed(pbrResources.GetDevice()->CreateBuffer(&constantBufferDesc, nullptr, m_constantBuffer->put()));
+            m_parametersChanged = true;
+        }
+
         // If the parameters of the constant buffer have changed, update the constant buffer.
         if (m_parametersChanged) {
             m_parametersChanged = false;
-            context->UpdateSubresource(m_constantBuffer.get(), 0, nullptr, &m_parameters, 0, 0);
+            context->UpdateSubresource(m_constantBuffer->get(), 0, nullptr, &m_parameters, 0, 0);
         }
+    }
+
+    void Material::PrepareDrawState(_In_ ID3D11DeviceContext* context,
+                                    const Resources& pbrResources,
+                                    bool wireframe,
+                                    DrawState& state) const {
+        UpdateConstantBuffer(context, pbrResources);
+
+        state.BlendState = pbrResources.GetBlendState(m_alphaBlended);
+        state.DepthStencilState = pbrResources.GetDepthStencilState(m_alphaBlended);
+        state.RasterizerState = pbrResources.GetRasterizerState(m_doubleSided, wireframe);
+        state.MaterialConstantBuffer = m_constantBuffer->get();
+
+        static_assert(DrawState::TextureCount == TextureCount, "The draw state must hold all material textures");
+        for (size_t i = 0; i < TextureCount; i++) {
+            state.Textures[i] = m_textureBindings->Textures[i].get();
+            state.Samplers[i] = m_textureBindings->Samplers[i].get();
+        }
+    }
+
+    void Material::Bind(_In_ ID3D11DeviceContext* context, const Resources& pbrResources) const {
+        UpdateConstantBuffer(context, pbrResources);
 
         pbrResources.SetBlendState(context, m_alphaBlended);
         pbrResources.SetDepthStencilState(context, m_alphaBlended);
         pbrResources.SetRasterizerState(context, m_doubleSided, m_wireframe);
 
-        ID3D11Buffer* psConstantBuffers[] = {m_constantBuffer.get()};
+        ID3D11Buffer* psConstantBuffers[] = {m_constantBuffer->get()};
         context->PSSetConstantBuffers(Pbr::ShaderSlots::ConstantBuffers::Material, 1, psConstantBuffers);
 
         static_assert(Pbr::ShaderSlots::BaseColor == 0, "BaseColor must be the first slot");
 
         std::array<ID3D11ShaderResourceView*, TextureCount> textures;
-        std::transform(m_textures.begin(), m_textures.end(), textures.begin(), [](const auto& texture) { return texture.get(); });
+        std::transform(m_textureBindings->Textures.begin(), m_textureBindings->Textures.end(), textures.begin(), [](const auto& texture) { return texture.get(); });
         context->PSSetShaderResources(Pbr::ShaderSlots::BaseColor, (UINT)textures.size(), textures.data());
 
         std::array<ID3D11SamplerState*, TextureCount> samplers;
-        std::transform(m_samplers.begin(), m_samplers.end(), samplers.begin(), [](const auto& sampler) { return sampler.get(); });
+        std::transform(m_textureBindings->Samplers.begin(), m_textureBindings->Samplers.end(), samplers.begin(), [](const auto& sampler) { return sampler.get(); });
         context->PSSetSamplers(Pbr::ShaderSlots::BaseColor, (UINT)samplers.size(), samplers.data());
     }
 
     Material::ConstantBufferData& Material::Parameters() {
+        // Writing through a shared constant buffer would change every clone, so detach from it.
+        if (m_constantBuffer.use_count() > 1) {
+            m_constantBuffer = nullptr;
+        }
+
         m_parametersChanged = true;
         return m_parameters;
     }
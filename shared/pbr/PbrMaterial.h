@@ -15,6 +15,8 @@
 #include "PbrResources.h"
 
 namespace Pbr {
+    struct DrawState;
+
     // A Material contains the metallic roughness parameters and textures.
     // Primitives specify which Material to use when being rendered.
     struct Material final {
@@ -41,8 +43,9 @@ namespace Pbr {
         // Create a uninitialized material. Textures and shader coefficients must be set.
         Material(Pbr::Resources const& pbrResources);
 
-        // Create a clone of this material.
-        std::shared_ptr<Material> Clone(Pbr::Resources const& pbrResources) const;
+        // Create a clone of this material. The clone shares the textures and constant buffer of this material
+        // until either of them is modified through Parameters() or SetTexture().
+        std::shared_ptr<Material> Clone() const;
 
         // Create a flat (no texture) material.
         static std::shared_ptr<Material> CreateFlat(const Resources& pbrResources,
@@ -70,6 +73,14 @@ namespace Pbr {
         bool Hidden{false};
 
     private:
+        friend class RenderQueue;
+
+        // Create the constant buffer if it was released and update it if the parameters changed.
+        void UpdateConstantBuffer(_In_ ID3D11DeviceContext* context, const Resources& pbrResources) const;
+
+        // Update the constant buffer and fill in the material state of a draw.
+        void PrepareDrawState(_In_ ID3D11DeviceContext* context, const Resources& pbrResources, bool wireframe, DrawState& state) const;
+
         mutable bool m_parametersChanged{true};
         ConstantBufferData m_parameters;
 
@@ -78,8 +89,13 @@ namespace Pbr {
         bool m_wireframe{false};
 
         static constexpr size_t TextureCount = ShaderSlots::LastMaterialSlot + 1;
-        std::array<winrt::com_ptr<ID3D11ShaderResourceView>, TextureCount> m_textures;
-        std::array<winrt::com_ptr<ID3D11SamplerState>, TextureCount> m_samplers;
-        winrt::com_ptr<ID3D11Buffer> m_constantBuffer;
+        struct TextureBindings {
+            std::array<winrt::com_ptr<ID3D11ShaderResourceView>, TextureCount> Textures;
+            std::array<winrt::com_ptr<ID3D11SamplerState>, TextureCount> Samplers;
+        };
+
+        // Texture bindings and the constant buffer are shared between clones and copied on write.
+        std::shared_ptr<TextureBindings> m_textureBindings;
+        mutable std::shared_ptr<winrt::com_ptr<ID3D11Buffer>> m_constantBuffer;
     };
 } // namespace Pbr
@@ -0,0 +1,441 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include "PbrMeshSimplifier.h"
+
+using namespace DirectX;
+
+namespace {
+    constexpr size_t TriangleVertexCount = 3;
+
+    // Collapses along open borders also keep the distance to planes through the border edges small, with this much more weight
+    // than the triangle planes, so borders keep their shape.
+    constexpr float BorderWeight = 10.0f;
+
+    // A collapse is rejected when it turns a triangle by more than about 90 degrees.
+    constexpr float MinNormalCosine = 1e-2f;
+
+    // The sum of the squared distances to a set of weighted planes, as a function of the position.
+    struct Quadric {
+        float A00{0}, A11{0}, A22{0}, A01{0}, A02{0}, A12{0};
+        float B0{0}, B1{0}, B2{0};
+        float C{0};
+        float Weight{0};
+
+        static Quadric FromPlane(FXMVECTOR unitNormal, FXMVECTOR point, float weight) {
+            XMFLOAT3 n;
+            XMStoreFloat3(&n, unitNormal);
+            const float d = -XMVectorGetX(XMVector3Dot(unitNormal, point));
+
+            Quadric q;
+            q.A00 = weight * n.x * n.x;
+            q.A11 = weight * n.y * n.y;
+            q.A22 = weight * n.z * n.z;
+            q.A01 = weight * n.x * n.y;
+            q.A02 = weight * n.x * n.z;
+            q.A12 = weight * n.y * n.z;
+            q.B0 = weight * n.x * d;
+            q.B1 = weight * n.y * d;
+            q.B2 = weight * n.z * d;
+            q.C = weight * d * d;
+            q.Weight = weight;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& other) {
+            A00 += other.A00;
+            A11 += other.A11;
+            A22 += other.A22;
+            A01 += other.A01;
+            A02 += other.A02;
+            A12 += other.A12;
+            B0 += other.B0;
+            B1 += other.B1;
+            B2 += other.B2;
+            C += other.C;
+            Weight += other.Weight;
+            return *this;
+        }
+
+        // The mean squared distance to the planes.
+        float Evaluate(const XMFLOAT3& p) const {
+            const float rx = A00 * p.x + A01 * p.y + A02 * p.z;
+            const float ry = A01 * p.x + A11 * p.y + A12 * p.z;
+            const float rz = A02 * p.x + A12 * p.y + A22 * p.z;
+            const float sum = rx * p.x + ry * p.y + rz * p.z + 2 * (B0 * p.x + B1 * p.y + B2 * p.z) + C;
+            return Weight > 0 ? std::max(sum, 0.0f) / Weight : 0.0f;
+        }
+    };
+
+    enum class VertexKind : uint8_t {
+        Manifold, // Only moves onto any neighbor.
+        Border,   // On one open border, only moves along the border.
+        Locked,   // On a non-manifold edge or where borders meet, never moves.
+    };
+
+    struct Edge {
+        uint32_t A, B;  // A < B
+        uint32_t Count; // The number of triangles using the edge.
+    };
+
+    struct Collapse {
+        uint32_t From, To;
+        float Cost;
+    };
+
+    // The first vertex with the same position as each vertex, so triangles split by attribute seams stay connected.
+    std::vector<uint32_t> BuildPositionRemap(const XMFLOAT3* positions, size_t vertexCount) {
+        struct PositionHash {
+            size_t operator()(const XMFLOAT3& p) const {
+                uint32_t bits[3];
+                std::memcpy(bits, &p, sizeof(bits));
+                const uint64_t mixed = (uint64_t(bits[0]) * 73856093u) ^ (uint64_t(bits[1]) * 19349663u) ^ (uint64_t(bits[2]) * 83492791u);
+                return std::hash<uint64_t>()(mixed);
+            }
+        };
+        struct PositionEqual {
+            bool operator()(const XMFLOAT3& a, const XMFLOAT3& b) const {
+                return a.x == b.x && a.y == b.y && a.z == b.z;
+            }
+        };
+
+        std::unordered_map<XMFLOAT3, uint32_t, PositionHash, PositionEqual> firstVertex;
+        firstVertex.reserve(vertexCount);
+        std::vector<uint32_t> remap(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            remap[i] = firstVertex.emplace(positions[i], i).first->second;
+        }
+        return remap;
+    }
+
+    void RemoveDegenerateTriangles(std::vector<uint32_t>& indices) {
+        size_t write = 0;
+        for (size_t i = 0; i < indices.size(); i += TriangleVertexCount) {
+            const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            if (a != b && b != c && a != c) {
+                indices[write++] = a;
+                indices[write++] = b;
+                indices[write++] = c;
+            }
+        }
+        indices.resize(write);
+    }
+
+    XMVECTOR XM_CALLCONV TriangleNormal(FXMVECTOR p0, FXMVECTOR p1, FXMVECTOR p2) {
+        return XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+    }
+
+    std::vector<Edge> BuildEdges(const std::vector<uint32_t>& indices) {
+        std::vector<uint64_t> keys;
+        keys.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += TriangleVertexCount) {
+            for (size_t corner = 0; corner < TriangleVertexCount; corner++) {
+                const uint32_t a = indices[i + corner];
+                const uint32_t b = indices[i + (corner + 1) % TriangleVertexCount];
+                keys.push_back((uint64_t(std::min(a, b)) << 32) | std::max(a, b));
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<Edge> edges;
+        for (size_t i = 0; i < keys.size();) {
+            size_t end = i + 1;
+            while (end < keys.size() && keys[end] == keys[i]) {
+                end++;
+            }
+            edges.push_back({uint32_t(keys[i] >> 32), uint32_t(keys[i]), uint32_t(end - i)});
+            i = end;
+        }
+        return edges;
+    }
+
+    // The triangles using each vertex, as ranges of one array.
+    struct VertexTriangles {
+        std::vector<uint32_t> Offsets;
+        std::vector<uint32_t> Triangles;
+
+        VertexTriangles(const std::vector<uint32_t>& indices, size_t vertexCount)
+            : Offsets(vertexCount + 1, 0)
+            , Triangles(indices.size()) {
+            for (const uint32_t index : indices) {
+                Offsets[index + 1]++;
+            }
+            for (size_t i = 0; i < vertexCount; i++) {
+                Offsets[i + 1] += Offsets[i];
+            }
+            std::vector<uint32_t> next(Offsets.begin(), Offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++) {
+                Triangles[next[indices[i]]++] = static_cast<uint32_t>(i / TriangleVertexCount);
+            }
+        }
+
+        const uint32_t* begin(uint32_t vertex) const {
+            return Triangles.data() + Offsets[vertex];
+        }
+        const uint32_t* end(uint32_t vertex) const {
+            return Triangles.data() + Offsets[vertex + 1];
+        }
+    };
+
+    // Counts the triangles removed by moving vertex from onto vertex to, or returns nullopt if the move flips a triangle.
+    std::optional<size_t> CheckCollapse(const XMFLOAT3* positions,
+                                        const std::vector<uint32_t>& indices,
+                                        const VertexTriangles& vertexTriangles,
+                                        uint32_t from,
+                                        uint32_t to) {
+        size_t removedTriangleCount = 0;
+        for (const uint32_t* t = vertexTriangles.begin(from); t != vertexTriangles.end(from); t++) {
+            const uint32_t* triangle = &indices[*t * TriangleVertexCount];
+            if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+                removedTriangleCount++;
+                continue;
+            }
+
+            XMVECTOR corners[TriangleVertexCount];
+            for (size_t corner = 0; corner < TriangleVertexCount; corner++) {
+                corners[corner] = XMLoadFloat3(&positions[triangle[corner]]);
+            }
+            const XMVECTOR oldNormal = TriangleNormal(corners[0], corners[1], corners[2]);
+            for (size_t corner = 0; corner < TriangleVertexCount; corner++) {
+                if (triangle[corner] == from) {
+                    corners[corner] = XMLoadFloat3(&positions[to]);
+                }
+            }
+            const XMVECTOR newNormal = TriangleNormal(corners[0], corners[1], corners[2]);
+
+            const float cosine = XMVectorGetX(XMVector3Dot(oldNormal, newNormal));
+            const float lengths = XMVectorGetX(XMVectorMultiply(XMVector3Length(oldNormal), XMVector3Length(newNormal)));
+            if (cosine <= MinNormalCosine * lengths) {
+                return std::nullopt;
+            }
+        }
+        return removedTriangleCount;
+    }
+} // namespace
+
+namespace Pbr {
+    float SimplifyIndices(const DirectX::XMFLOAT3* positions,
+                          size_t vertexCount,
+                          std::vector<uint32_t>& indices,
+                          const SimplifyOptions& options) {
+        indices.resize(indices.size() / TriangleVertexCount * TriangleVertexCount);
+        if (std::any_of(indices.begin(), indices.end(), [vertexCount](uint32_t index) { return index >= vertexCount; })) {
+            throw std::out_of_range("Vertex index out of range");
+        }
+
+        // Work on one vertex per position.
+        const std::vector<uint32_t> remap = BuildPositionRemap(positions, vertexCount);
+        for (uint32_t& index : indices) {
+            index = remap[index];
+        }
+        RemoveDegenerateTriangles(indices);
+
+        // Every vertex starts with the planes of its triangles, weighted by area.
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t i = 0; i < indices.size(); i += TriangleVertexCount) {
+            const XMVECTOR p0 = XMLoadFloat3(&positions[indices[i]]);
+            const XMVECTOR normal = TriangleNormal(p0, XMLoadFloat3(&positions[indices[i + 1]]), XMLoadFloat3(&positions[indices[i + 2]]));
+            const float doubleArea = XMVectorGetX(XMVector3Length(normal));
+            if (doubleArea > 0) {
+                const Quadric quadric = Quadric::FromPlane(XMVectorScale(normal, 1 / doubleArea), p0, doubleArea / 2);
+                for (size_t corner = 0; corner < TriangleVertexCount; corner++) {
+                    quadrics[indices[i + corner]] += quadric;
+                }
+            }
+        }
+
+        // Add the planes through the border edges, perpendicular to their triangles.
+        {
+            const std::vector<Edge> edges = BuildEdges(indices);
+            for (size_t i = 0; i < indices.size(); i += TriangleVertexCount) {
+                for (size_t corner = 0; corner < TriangleVertexCount; corner++) {
+                    const uint32_t a = indices[i + corner];
+                    const uint32_t b = indices[i + (corner + 1) % TriangleVertexCount];
+                    const auto key = std::make_pair(std::min(a, b), std::max(a, b));
+                    const auto edge = std::lower_bound(
+                        edges.begin(), edges.end(), key, [](const Edge& e, const auto& k) { return std::make_pair(e.A, e.B) < k; });
+                    if (edge->Count != 1) {
+                        continue;
+                    }
+
+                    const XMVECTOR pa = XMLoadFloat3(&positions[a]);
+                    const XMVECTOR pb = XMLoadFloat3(&positions[b]);
+                    const XMVECTOR pc = XMLoadFloat3(&positions[indices[i + (corner + 2) % TriangleVertexCount]]);
+                    const XMVECTOR direction = XMVectorSubtract(pb, pa);
+                    const XMVECTOR normal = XMVector3Cross(direction, TriangleNormal(pa, pb, pc));
+                    const float length = XMVectorGetX(XMVector3Length(normal));
+                    if (length > 0) {
+                        const float weight = XMVectorGetX(XMVector3LengthSq(direction)) * BorderWeight;
+                        const Quadric quadric = Quadric::FromPlane(XMVectorScale(normal, 1 / length), pa, weight);
+                        quadrics[a] += quadric;
+                        quadrics[b] += quadric;
+                    }
+                }
+            }
+        }
+
+        const float maxCost = options.MaxError < std::sqrt(FLT_MAX) ? options.MaxError * options.MaxError : FLT_MAX;
+        const size_t targetTriangleCount = options.TargetIndexCount / TriangleVertexCount;
+        float largestCost = 0;
+
+        // Each pass collapses the cheapest edges whose neighborhoods do not overlap, then rebuilds the connectivity.
+        std::vector<VertexKind> kinds(vertexCount);
+        std::vector<uint8_t> borderEdgeCounts(vertexCount);
+        std::vector<uint32_t> collapseTo(vertexCount);
+        std::vector<bool> touched(vertexCount);
+        std::vector<Collapse> collapses;
+        while (indices.size() / TriangleVertexCount > targetTriangleCount) {
+            const std::vector<Edge> edges = BuildEdges(indices);
+            std::fill(kinds.begin(), kinds.end(), VertexKind::Manifold);
+            std::fill(borderEdgeCounts.begin(), borderEdgeCounts.end(), uint8_t(0));
+            for (const Edge& edge : edges) {
+                if (edge.Count > 2) {
+                    kinds[edge.A] = kinds[edge.B] = VertexKind::Locked;
+                } else if (edge.Count == 1) {
+                    for (const uint32_t vertex : {edge.A, edge.B}) {
+                        borderEdgeCounts[vertex] = static_cast<uint8_t>(std::min(borderEdgeCounts[vertex] + 1, 3));
+                        if (kinds[vertex] != VertexKind::Locked) {
+                            kinds[vertex] = borderEdgeCounts[vertex] > 2 ? VertexKind::Locked : VertexKind::Border;
+                        }
+                    }
+                }
+            }
+
+            collapses.clear();
+            for (const Edge& edge : edges) {
+                const auto canMove = [&](uint32_t from) {
+                    return kinds[from] == VertexKind::Manifold || (kinds[from] == VertexKind::Border && edge.Count == 1);
+                };
+                Quadric quadric = quadrics[edge.A];
+                quadric += quadrics[edge.B];
+                const float costAB = canMove(edge.A) ? quadric.Evaluate(positions[edge.B]) : FLT_MAX;
+                const float costBA = canMove(edge.B) ? quadric.Evaluate(positions[edge.A]) : FLT_MAX;
+                if (std::min(costAB, costBA) <= maxCost) {
+                    collapses.push_back(costAB <= costBA ? Collapse{edge.A, edge.B, costAB} : Collapse{edge.B, edge.A, costBA});
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+                return std::tie(a.Cost, a.From, a.To) < std::tie(b.Cost, b.From, b.To);
+            });
+
+            const VertexTriangles vertexTriangles(indices, vertexCount);
+            const size_t triangleCount = indices.size() / TriangleVertexCount;
+            size_t removedTriangleCount = 0;
+            std::fill(touched.begin(), touched.end(), false);
+            for (uint32_t i = 0; i < vertexCount; i++) {
+                collapseTo[i] = i;
+            }
+
+            for (const Collapse& collapse : collapses) {
+                if (triangleCount - removedTriangleCount <= targetTriangleCount) {
+                    break;
+                }
+                // The triangles around a collapsed vertex change, so their vertices wait for the next pass.
+                if (touched[collapse.From] || touched[collapse.To]) {
+                    continue;
+                }
+                const std::optional<size_t> removed = CheckCollapse(positions, indices, vertexTriangles, collapse.From, collapse.To);
+                if (!removed) {
+                    continue;
+                }
+
+                collapseTo[collapse.From] = collapse.To;
+                quadrics[collapse.To] += quadrics[collapse.From];
+                largestCost = std::max(largestCost, collapse.Cost);
+                removedTriangleCount += *removed;
+                touched[collapse.To] = true;
+                for (const uint32_t* t = vertexTriangles.begin(collapse.From); t != vertexTriangles.end(collapse.From); t++) {
+                    for (size_t corner = 0; corner < TriangleVertexCount; corner++) {
+                        touched[indices[*t * TriangleVertexCount + corner]] = true;
+                    }
+                }
+            }
+
+            if (removedTriangleCount == 0) {
+                break;
+            }
+            for (uint32_t& index : indices) {
+                index = collapseTo[index];
+            }
+            RemoveDegenerateTriangles(indices);
+        }
+
+        return std::sqrt(largestCost);
+    }
+
+    PrimitiveBuilder Simplify(const PrimitiveBuilder& builder, const SimplifyOptions& options, float* error) {
+        std::vector<XMFLOAT3> positions(builder.Vertices.size());
+        std::transform(builder.Vertices.begin(), builder.Vertices.end(), positions.begin(), [](const Vertex& v) { return v.Position; });
+
+        PrimitiveBuilder simplified;
+        simplified.Indices = builder.Indices;
+        const float simplifyError = SimplifyIndices(positions.data(), positions.size(), simplified.Indices, options);
+        if (error) {
+            *error = simplifyError;
+        }
+
+        // Keep the used vertices in the order of their first use.
+        constexpr uint32_t Unused = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> newIndex(builder.Vertices.size(), Unused);
+        for (uint32_t& index : simplified.Indices) {
+            if (newIndex[index] == Unused) {
+                newIndex[index] = static_cast<uint32_t>(simplified.Vertices.size());
+                simplified.Vertices.push_back(builder.Vertices[index]);
+            }
+            index = newIndex[index];
+        }
+        return simplified;
+    }
+
+    std::vector<LodLevel> BuildLodChain(const PrimitiveBuilder& builder, const LodChainOptions& options) {
+        std::vector<LodLevel> levels;
+        levels.push_back({builder, 0.0f});
+        while (levels.size() < options.MaxLevelCount) {
+            const LodLevel& previous = levels.back();
+            const size_t previousTriangleCount = previous.Builder.Indices.size() / TriangleVertexCount;
+            const size_t targetTriangleCount =
+                std::max(options.MinTriangleCount, static_cast<size_t>(previousTriangleCount * options.TriangleRatio));
+            if (targetTriangleCount >= previousTriangleCount || previous.Error >= options.MaxError) {
+                break;
+            }
+
+            SimplifyOptions simplifyOptions;
+            simplifyOptions.TargetIndexCount = targetTriangleCount * TriangleVertexCount;
+            simplifyOptions.MaxError = options.MaxError - previous.Error;
+            float error = 0;
+            PrimitiveBuilder simplified = Simplify(previous.Builder, simplifyOptions, &error);
+
+            // Stop when the error limit keeps the level close to the previous one, it would cost memory and gain little.
+            const size_t triangleCount = simplified.Indices.size() / TriangleVertexCount;
+            if (triangleCount > previousTriangleCount - (previousTriangleCount - targetTriangleCount) / 2) {
+                break;
+            }
+            // The errors of the levels add up, each level is simplified from the previous one.
+            levels.push_back({std::move(simplified), previous.Error + error});
+        }
+        return levels;
+    }
+
+    size_t SelectLodLevel(const float* levelErrors, size_t levelCount, float distance, float maxScreenError, float pixelsPerRadian) {
+        if (distance <= 0) {
+            return 0;
+        }
+
+        // An error of e at distance d covers about e / d radians.
+        const float maxError = maxScreenError / pixelsPerRadian * distance;
+        size_t level = 0;
+        while (level + 1 < levelCount && levelErrors[level + 1] <= maxError) {
+            level++;
+        }
+        return level;
+    }
+} // namespace Pbr
@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#pragma once
+
+#include <cfloat>
+#include <vector>
+#include "PbrCommon.h"
+
+namespace Pbr {
+    struct SimplifyOptions {
+        // Collapse edges until the triangle list has at most this many indices.
+        size_t TargetIndexCount = 0;
+        // The largest error allowed for a collapse, as a distance in model units. Simplification stops before the target index
+        // count when every remaining collapse would exceed it.
+        float MaxError = FLT_MAX;
+    };
+
+    // Simplify a triangle list by quadric error edge collapse. Each collapse moves one vertex onto a neighbor, so the remaining
+    // triangles reference the original vertices and no new positions are made. Vertices with equal positions are treated as one,
+    // vertices on open borders only move along the border, and collapses that flip a triangle are rejected.
+    // The indices are replaced by the simplified triangle list. Returns the error of the largest collapse made, as the
+    // root mean square distance to the planes of the triangles merged into the collapsed vertex.
+    float SimplifyIndices(const DirectX::XMFLOAT3* positions,
+                          size_t vertexCount,
+                          std::vector<uint32_t>& indices,
+                          const SimplifyOptions& options);
+
+    // Simplify the triangles of a builder and remove the vertices that are no longer used. Vertices merged by position take the
+    // attributes of the remaining vertex, so attribute seams are not preserved. Flat shaded meshes should be simplified with
+    // SimplifyIndices before their vertices are split per triangle.
+    PrimitiveBuilder Simplify(const PrimitiveBuilder& builder, const SimplifyOptions& options, float* error = nullptr);
+
+    struct LodChainOptions {
+        // The most levels in the chain, including the original as level 0.
+        uint32_t MaxLevelCount = 4;
+        // Each level aims for this fraction of the triangles of the previous level.
+        float TriangleRatio = 0.5f;
+        // No level is made with fewer triangles than this.
+        size_t MinTriangleCount = 32;
+        // The largest error of any level, in model units.
+        float MaxError = FLT_MAX;
+    };
+
+    struct LodLevel {
+        PrimitiveBuilder Builder;
+        // The error of the level compared to the original, in model units. Level 0 has no error.
+        float Error;
+    };
+
+    // Build levels of decreasing detail, each simplified from the previous one. The chain ends early when a level cannot be
+    // reduced enough within the error limit.
+    std::vector<LodLevel> BuildLodChain(const PrimitiveBuilder& builder, const LodChainOptions& options);
+
+    // The angular resolution of the display, to turn errors in model units into pixels. Most headsets show about 20 pixels per
+    // degree, i.e. about 1000 pixels per radian, in the center of the view.
+    constexpr float DefaultPixelsPerRadian = 1000.0f;
+
+    // Pick the coarsest level whose error, seen from the given distance, covers at most maxScreenError pixels.
+    // The errors must be in the same units as the distance, and increase from one level to the next.
+    size_t SelectLodLevel(const float* levelErrors,
+                          size_t levelCount,
+                          float distance,
+                          float maxScreenError = 1.0f,
+                          float pixelsPerRadian = DefaultPixelsPerRadian);
+} // namespace Pbr
@@ -12,11 +12,22 @@ using namespace DirectX;
 namespace
 {
     constexpr Pbr::NodeIndex_t RootParentNodeIndex = -1;
+
+    size_t HashNodeName(std::string_view name) {
+        return std::hash<std::string_view>()(name);
+    }
+
+    size_t HashNodeName(std::string_view name, Pbr::NodeIndex_t parentNodeIndex) {
+        const size_t nameHash = HashNodeName(name);
+        return nameHash ^ (parentNodeIndex + size_t{0x9e3779b9} + (nameHash << 6) + (nameHash >> 2));
+    }
 }
 
 namespace Pbr
 {
     Model::Model(bool createRootNode /*= true*/)
+        : m_primitives(std::make_shared<Primitive::Collection>())
+        , m_nodeNameIndex(std::make_shared<NodeNameIndex>())
     {
         if (createRootNode)
         {
@@ -31,61 +42,165 @@ namespace Pbr
         ID3D11ShaderResourceView* vsShaderResources[] = { m_modelTransformsResourceView.get() };
         context->VSSetShaderResources(Pbr::ShaderSlots::Transforms, _countof(vsShaderResources), vsShaderResources);
 
-        for (const Pbr::Primitive& primitive : m_primitives)
+        for (const Pbr::Primitive& primitive : *m_primitives)
         {
             if (primitive.GetMaterial()->Hidden) continue;
 
             primitive.GetMaterial()->SetWireframe(pbrResources.GetFillMode() == FillMode::Wireframe);
             primitive.GetMaterial()->Bind(context, pbrResources);
-            primitive.Render(context);
+            primitive.Render(pbrResources, context);
         }
 
         // Expect the caller to reset other state, but the geometry shader is cleared specially.
         //context->GSSetShader(nullptr, nullptr, 0);
     }
 
+    void Model::ReserveNodes(size_t nodeCount)
+    {
+        m_nodes.reserve(nodeCount);
+        GetMutableNodeNameIndex().Reserve(nodeCount);
+    }
+
     NodeIndex_t XM_CALLCONV Model::AddNode(FXMMATRIX transform, Pbr::NodeIndex_t parentIndex, std::string name)
     {
         auto newNodeIndex = (Pbr::NodeIndex_t)m_nodes.size();
         if (newNodeIndex != RootNodeIndex && parentIndex == RootParentNodeIndex)
         {
-            throw new std::exception("Only the first node can be the root");
+            throw std::invalid_argument("Only the first node can be the root");
         }
 
         m_nodes.emplace_back(transform, std::move(name), newNodeIndex, parentIndex);
+        GetMutableNodeNameIndex().Add(m_nodes.back());
         m_modelTransformsStructuredBuffer = nullptr; // Structured buffer will need to be recreated.
         return m_nodes.back().Index;
     }
 
     void Model::Clear()
     {
-        m_primitives.clear();
+        m_primitives = std::make_shared<Primitive::Collection>();
     }
 
-    std::shared_ptr<Model> Model::Clone(Pbr::Resources const& pbrResources) const
+    std::shared_ptr<Model> Model::Clone(Pbr::Resources const& /*pbrResources*/) const
     {
         auto clone = std::make_shared<Model>(false /* createRootNode */);
+        clone->Name = Name;
 
+        // The nodes are copied as they are, so the clone can share the node name index instead of building its own.
+        clone->m_nodes.reserve(m_nodes.size());
         for (const Node& node : m_nodes)
         {
-            clone->AddNode(node.GetTransform(), node.ParentNodeIndex, node.Name);
+            clone->m_nodes.emplace_back(node.GetTransform(), node.Name, node.Index, node.ParentNodeIndex);
+        }
+
+        clone->m_nodeNameIndex = m_nodeNameIndex;
+        clone->m_primitives = m_primitives;
+        return clone;
+    }
+
+    Primitive::Collection& Model::GetMutablePrimitives()
+    {
+        if (m_primitives.use_count() > 1)
+        {
+            // The primitive clones still share geometry and material resources, which are in turn copied on write.
+            auto primitives = std::make_shared<Primitive::Collection>();
+            primitives->reserve(m_primitives->size());
+            for (const Primitive& primitive : *m_primitives)
+            {
+                primitives->push_back(primitive.Clone());
+            }
+            m_primitives = std::move(primitives);
         }
 
-        for (const Primitive& primitive : m_primitives)
+        return *m_primitives;
+    }
+
+    Model::NodeNameIndex& Model::GetMutableNodeNameIndex()
+    {
+        if (m_nodeNameIndex.use_count() > 1)
         {
-            clone->AddPrimitive(primitive.Clone(pbrResources));
+            m_nodeNameIndex = std::make_shared<NodeNameIndex>(*m_nodeNameIndex);
         }
 
-        return clone;
+        return *m_nodeNameIndex;
     }
 
     std::optional<NodeIndex_t> Model::FindFirstNode(std::string_view name, std::optional<NodeIndex_t> const& parentNodeIndex) const {
-        // Children are guaranteed to come after their parents, so start looking after the parent index if one is provided.
-        const NodeIndex_t startIndex = parentNodeIndex ? parentNodeIndex.value() + 1 : Pbr::RootNodeIndex;
-        for (NodeIndex_t i = startIndex; i < m_nodes.size(); ++i) {
-            const Pbr::Node& node = m_nodes[i];
-            if ((!parentNodeIndex || node.ParentNodeIndex == parentNodeIndex.value()) && node.Name == name) {
-                return node.Index;
+        return parentNodeIndex ? m_nodeNameIndex->Find(m_nodes, name, parentNodeIndex.value()) : m_nodeNameIndex->Find(m_nodes, name);
+    }
+
+    std::vector<NodeIndex_t> Model::FindFirstNodes(const std::vector<std::string_view>& names) const {
+        std::vector<NodeIndex_t> nodeIndices(names.size(), NodeIndex_npos);
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (const auto nodeIndex = m_nodeNameIndex->Find(m_nodes, names[i])) {
+                nodeIndices[i] = nodeIndex.value();
+            }
+        }
+        return nodeIndices;
+    }
+
+    std::optional<NodeIndex_t> Model::FindNodeByPath(std::string_view path, char separator) const {
+        if (path.empty()) {
+            return {};
+        }
+
+        std::optional<NodeIndex_t> nodeIndex;
+        for (size_t begin = 0;;) {
+            const size_t end = std::min(path.find(separator, begin), path.size());
+            nodeIndex = FindFirstNode(path.substr(begin, end - begin), nodeIndex);
+            if (!nodeIndex || end == path.size()) {
+                return nodeIndex;
+            }
+            begin = end + 1;
+        }
+    }
+
+    void Model::NodeNameIndex::Reserve(size_t nodeCount) {
+        m_byName.reserve(nodeCount);
+        m_byParentAndName.reserve(nodeCount);
+        m_nextByName.reserve(nodeCount);
+        m_nextByParentAndName.reserve(nodeCount);
+    }
+
+    void Model::NodeNameIndex::Add(const Node& node) {
+        Add(m_byName, m_nextByName, HashNodeName(node.Name), node.Index);
+        Add(m_byParentAndName, m_nextByParentAndName, HashNodeName(node.Name, node.ParentNodeIndex), node.Index);
+    }
+
+    void Model::NodeNameIndex::Add(std::unordered_map<size_t, Chain>& chains,
+                                   std::vector<NodeIndex_t>& next,
+                                   size_t hash,
+                                   NodeIndex_t nodeIndex) {
+        // Nodes are added in index order, so appending to the chain keeps it sorted.
+        assert(next.size() == nodeIndex);
+        next.push_back(NodeIndex_npos);
+        const auto [chain, inserted] = chains.try_emplace(hash, Chain{nodeIndex, nodeIndex});
+        if (!inserted) {
+            next[chain->second.Last] = nodeIndex;
+            chain->second.Last = nodeIndex;
+        }
+    }
+
+    std::optional<NodeIndex_t> Model::NodeNameIndex::Find(const Node::Collection& nodes, std::string_view name) const {
+        const auto chain = m_byName.find(HashNodeName(name));
+        if (chain != m_byName.end()) {
+            for (NodeIndex_t i = chain->second.First; i != NodeIndex_npos; i = m_nextByName[i]) {
+                if (nodes[i].Name == name) {
+                    return i;
+                }
+            }
+        }
+        return {};
+    }
+
+    std::optional<NodeIndex_t> Model::NodeNameIndex::Find(const Node::Collection& nodes,
+                                                          std::string_view name,
+                                                          NodeIndex_t parentNodeIndex) const {
+        const auto chain = m_byParentAndName.find(HashNodeName(name, parentNodeIndex));
+        if (chain != m_byParentAndName.end()) {
+            for (NodeIndex_t i = chain->second.First; i != NodeIndex_npos; i = m_nextByParentAndName[i]) {
+                if (nodes[i].ParentNodeIndex == parentNodeIndex && nodes[i].Name == name) {
+                    return i;
+                }
             }
         }
         return {};
@@ -102,7 +217,7 @@ namespace Pbr
 
     void Model::AddPrimitive(Pbr::Primitive primitive)
     {
-        m_primitives.push_back(std::move(primitive));
+        GetMutablePrimitives().push_back(std::move(primitive));
     }
 
     void Model::UpdateTransforms(Pbr::Resources const& pbrResources, _In_ ID3D11DeviceContext* context) const
@@ -4,6 +4,8 @@
 #pragma once
 
 #include <optional>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <winrt/base.h>
@@ -54,6 +56,9 @@ namespace Pbr {
     public:
         Model(bool createRootNode = true);
 
+        // Reserve space for nodes that are about to be added.
+        void ReserveNodes(size_t nodeCount);
+
         // Add a node to the model.
         NodeIndex_t XM_CALLCONV AddNode(DirectX::FXMMATRIX transform, NodeIndex_t parentIndex, std::string name = "");
 
@@ -66,7 +71,8 @@ namespace Pbr {
         // Remove all primitives.
         void Clear();
 
-        // Create a clone of this model.
+        // Create a clone of this model. Nodes are copied so each clone has its own transforms, while primitives and
+        // materials are shared with this model until the clone modifies them through GetPrimitive().
         std::shared_ptr<Model> Clone(Pbr::Resources const& pbrResources) const;
 
         NodeIndex_t GetNodeCount() const {
@@ -80,19 +86,55 @@ namespace Pbr {
         }
 
         uint32_t GetPrimitiveCount() const {
-            return (uint32_t)m_primitives.size();
+            return (uint32_t)m_primitives->size();
         }
         Primitive& GetPrimitive(uint32_t index) {
-            return m_primitives[index];
+            return GetMutablePrimitives()[index];
         }
         const Primitive& GetPrimitive(uint32_t index) const {
-            return m_primitives[index];
+            return (*m_primitives)[index];
         }
 
         // Find the first node which matches a given name.
         std::optional<NodeIndex_t> FindFirstNode(std::string_view name, std::optional<NodeIndex_t> const& parentNodeIndex = {}) const;
 
+        // Find the first node of each name, or NodeIndex_npos for names without a node.
+        std::vector<NodeIndex_t> FindFirstNodes(const std::vector<std::string_view>& names) const;
+
+        // Find a node by the names along its path, such as "parent/child". The first name matches the first node with that name
+        // anywhere in the model, and each following name matches the first child of the node found so far.
+        std::optional<NodeIndex_t> FindNodeByPath(std::string_view path, char separator = '/') const;
+
     private:
+        friend class RenderQueue;
+
+        // Get the primitives for modification, detaching them from other clones of this model first.
+        Primitive::Collection& GetMutablePrimitives();
+
+        // Nodes indexed by a hash of their name, and by a hash of their parent and name. Nodes with the same hash are chained in
+        // index order, so the first node of a name is the first in its chain that matches.
+        struct NodeNameIndex {
+            void Reserve(size_t nodeCount);
+            void Add(const Node& node);
+            std::optional<NodeIndex_t> Find(const Node::Collection& nodes, std::string_view name) const;
+            std::optional<NodeIndex_t> Find(const Node::Collection& nodes, std::string_view name, NodeIndex_t parentNodeIndex) const;
+
+        private:
+            struct Chain {
+                NodeIndex_t First;
+                NodeIndex_t Last;
+            };
+            static void Add(std::unordered_map<size_t, Chain>& chains, std::vector<NodeIndex_t>& next, size_t hash, NodeIndex_t nodeIndex);
+
+            std::unordered_map<size_t, Chain> m_byName;
+            std::unordered_map<size_t, Chain> m_byParentAndName;
+            std::vector<NodeIndex_t> m_nextByName; // The next node in the chain of each node, or NodeIndex_npos.
+            std::vector<NodeIndex_t> m_nextByParentAndName;
+        };
+
+        // Get the node name index for modification, detaching it from other clones of this model first.
+        NodeNameIndex& GetMutableNodeNameIndex();
+
         // Compute the transform relative to the root of the model for a given node.
         DirectX::XMMATRIX GetNodeToModelRootTransform(NodeIndex_t nodeIndex) const;
 
@@ -102,12 +144,16 @@ namespace Pbr {
     private:
         // A model is made up of one or more Primitives. Each Primitive has a unique material.
         // Ideally primitives with the same material should be merged to reduce draw calls.
-        Primitive::Collection m_primitives;
+        // The collection is shared between clones of the model and copied on write.
+        std::shared_ptr<Primitive::Collection> m_primitives;
 
         // A model contains one or more nodes. Each vertex of a primitive references a node to have the
         // node's transform applied.
         Node::Collection m_nodes;
 
+        // The index is built as nodes are added, and shared between clones until one of them adds a node.
+        std::shared_ptr<NodeNameIndex> m_nodeNameIndex;
+
         // Temporary buffer holds the world transforms, computed from the node's local transforms.
         mutable std::vector<DirectX::XMFLOAT4X4> m_modelTransforms;
         mutable winrt::com_ptr<ID3D11Buffer> m_modelTransformsStructuredBuffer;
@@ -2,6 +2,7 @@
 // Copyright (C) Microsoft Corporation.  All Rights Reserved
 // Licensed under the MIT License. See License.txt in the project root for license information.
 #include "pch.h"
+#include <cstring>
 #include "PbrCommon.h"
 #include "PbrResources.h"
 #include "PbrPrimitive.h"
@@ -9,119 +10,258 @@
 using namespace DirectX;
 
 namespace {
-    UINT GetPbrVertexByteSize(size_t size) {
-        return (UINT)(sizeof(decltype(Pbr::PrimitiveBuilder::Vertices)::value_type) * size);
-    }
-
-    winrt::com_ptr<ID3D11Buffer> CreateVertexBuffer(_In_ ID3D11Device* device,
-                                                    const Pbr::PrimitiveBuilder& primitiveBuilder,
-                                                    bool updatableBuffers) {
-        // Create Vertex Buffer
+    winrt::com_ptr<ID3D11Buffer> CreateBuffer(_In_ ID3D11Device* device, UINT bindFlags, const void* data, UINT byteWidth) {
         D3D11_BUFFER_DESC desc{};
         desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.ByteWidth = GetPbrVertexByteSize(primitiveBuilder.Vertices.size());
-        desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        desc.ByteWidth = byteWidth;
+        desc.BindFlags = bindFlags;
 
-        if (updatableBuffers) {
-            desc.Usage = D3D11_USAGE_DYNAMIC;
-            desc.CPUAccessFlags |= D3D11_CPU_ACCESS_WRITE;
+        D3D11_SUBRESOURCE_DATA initData{};
+        initData.pSysMem = data;
+
+        winrt::com_ptr<ID3D11Buffer> buffer;
+        Pbr::Internal::ThrowIfFailed(device->CreateBuffer(&desc, data != nullptr ? &initData : nullptr, buffer.put()));
+        return buffer;
+    }
+
+    winrt::com_ptr<ID3D11Buffer> CreateVertexBuffer(_In_ ID3D11Device* device, const Pbr::Vertex* vertices, uint32_t vertexCount) {
+        return CreateBuffer(device, D3D11_BIND_VERTEX_BUFFER, vertices, (UINT)(sizeof(Pbr::Vertex) * vertexCount));
+    }
+
+    // Call func with the index data and its size in bytes. Indices narrowed to 16 bits, if that is the given format, are written to
+    // the scratch buffer, which can be reused to avoid an allocation per call.
+    template <typename TFunc>
+    void WithIndexData(const uint32_t* indices, uint32_t indexCount, DXGI_FORMAT format, std::vector<uint16_t>& scratch, TFunc&& func) {
+        if (format == DXGI_FORMAT_R16_UINT) {
+            scratch.resize(indexCount);
+            Pbr::IndexFormat::Narrow(indices, indexCount, scratch.data());
+            func(scratch.data(), (UINT)(sizeof(uint16_t) * indexCount));
+        } else {
+            func(indices, (UINT)(sizeof(uint32_t) * indexCount));
         }
+    }
 
-        D3D11_SUBRESOURCE_DATA initData{};
-        initData.pSysMem = primitiveBuilder.Vertices.data();
+    // Replace the index data with the indices in the given format. The data keeps its capacity, so this does not allocate once the
+    // data has grown to its largest size.
+    void AssignIndexData(const uint32_t* indices, uint32_t indexCount, DXGI_FORMAT format, std::vector<uint8_t>& indexData) {
+        indexData.resize(indexCount * Pbr::IndexFormat::GetIndexSize(format));
+        if (format == DXGI_FORMAT_R16_UINT) {
+            Pbr::IndexFormat::Narrow(indices, indexCount, reinterpret_cast<uint16_t*>(indexData.data()));
+        } else if (indexCount > 0) {
+            std::memcpy(indexData.data(), indices, indexData.size());
+        }
+    }
 
-        winrt::com_ptr<ID3D11Buffer> vertexBuffer;
-        Pbr::Internal::ThrowIfFailed(device->CreateBuffer(&desc, &initData, vertexBuffer.put()));
-        return vertexBuffer;
+    winrt::com_ptr<ID3D11Buffer>
+    CreateIndexBuffer(_In_ ID3D11Device* device, const uint32_t* indices, uint32_t indexCount, DXGI_FORMAT format) {
+        winrt::com_ptr<ID3D11Buffer> buffer;
+        std::vector<uint16_t> narrowIndices;
+        WithIndexData(indices, indexCount, format, narrowIndices, [&](const void* data, UINT byteWidth) {
+            buffer = CreateBuffer(device, D3D11_BIND_INDEX_BUFFER, data, byteWidth);
+        });
+        return buffer;
     }
 
-    winrt::com_ptr<ID3D11Buffer> CreateIndexBuffer(_In_ ID3D11Device* device,
-                                                   const Pbr::PrimitiveBuilder& primitiveBuilder,
-                                                   bool updatableBuffers) {
-        // Create Index Buffer
-        D3D11_BUFFER_DESC desc{};
+    // Make a GPU-side copy of a buffer, so it can be written to without affecting the original.
+    winrt::com_ptr<ID3D11Buffer> CopyBuffer(_In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context, ID3D11Buffer* source) {
+        D3D11_BUFFER_DESC desc;
+        source->GetDesc(&desc);
         desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.ByteWidth = (UINT)(sizeof(decltype(primitiveBuilder.Indices)::value_type) * primitiveBuilder.Indices.size());
-        desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+        desc.CPUAccessFlags = 0;
 
-        if (updatableBuffers) {
-            desc.Usage = D3D11_USAGE_DYNAMIC;
-            desc.CPUAccessFlags |= D3D11_CPU_ACCESS_WRITE;
+        winrt::com_ptr<ID3D11Buffer> buffer;
+        Pbr::Internal::ThrowIfFailed(device->CreateBuffer(&desc, nullptr, buffer.put()));
+        context->CopyResource(buffer.get(), source);
+        return buffer;
+    }
+
+    // Write data to the start of a buffer, reusing the buffer if it is large enough.
+    void WriteBuffer(_In_ ID3D11Device* device,
+                     _In_ ID3D11DeviceContext* context,
+                     winrt::com_ptr<ID3D11Buffer>& buffer,
+                     UINT bindFlags,
+                     const void* data,
+                     UINT byteWidth) {
+        if (byteWidth == 0) {
+            return;
         }
 
-        D3D11_SUBRESOURCE_DATA initData{};
-        initData.pSysMem = primitiveBuilder.Indices.data();
+        D3D11_BUFFER_DESC desc;
+        buffer->GetDesc(&desc);
 
-        winrt::com_ptr<ID3D11Buffer> indexBuffer;
-        Pbr::Internal::ThrowIfFailed(device->CreateBuffer(&desc, &initData, indexBuffer.put()));
-        return indexBuffer;
+        if (desc.ByteWidth < byteWidth) {
+            buffer = CreateBuffer(device, bindFlags, data, byteWidth);
+        } else {
+            const D3D11_BOX box{0, 0, 0, byteWidth, 1, 1};
+            context->UpdateSubresource(buffer.get(), 0, &box, data, byteWidth, byteWidth);
+        }
     }
 } // namespace
 
 namespace Pbr {
+    Primitive::Primitive(UINT indexCount, std::shared_ptr<Buffers> buffers, std::shared_ptr<Material> material)
+        : m_indexCount(indexCount)
+        , m_buffers(std::move(buffers))
+        , m_material(std::move(material)) {
+    }
+
     Primitive::Primitive(UINT indexCount,
                          winrt::com_ptr<ID3D11Buffer> indexBuffer,
                          winrt::com_ptr<ID3D11Buffer> vertexBuffer,
-                         std::shared_ptr<Material> material)
-        : m_indexCount(indexCount)
-        , m_indexBuffer(std::move(indexBuffer))
-        , m_vertexBuffer(std::move(vertexBuffer))
-        , m_material(std::move(material)) {
+                         std::shared_ptr<Material> material,
+                         DXGI_FORMAT indexFormat)
+        : Primitive(indexCount, std::make_shared<Buffers>(), std::move(material)) {
+        m_buffers->IndexBuffer = std::move(indexBuffer);
+        m_buffers->VertexBuffer = std::move(vertexBuffer);
+        m_buffers->IndexFormat = indexFormat;
     }
 
     Primitive::Primitive(Pbr::Resources const& pbrResources,
                          const Pbr::PrimitiveBuilder& primitiveBuilder,
                          std::shared_ptr<Pbr::Material> material,
                          bool updatableBuffers)
-        : Primitive((UINT)primitiveBuilder.Indices.size(),
-                    CreateIndexBuffer(pbrResources.GetDevice().get(), primitiveBuilder, updatableBuffers),
-                    CreateVertexBuffer(pbrResources.GetDevice().get(), primitiveBuilder, updatableBuffers),
-                    std::move(material)) {
+        : Primitive((UINT)primitiveBuilder.Indices.size(), std::make_shared<Buffers>(), std::move(material)) {
+        const uint32_t* const indices = primitiveBuilder.Indices.data();
+        const uint32_t indexCount = (uint32_t)primitiveBuilder.Indices.size();
+        m_buffers->IndexFormat = primitiveBuilder.GetIndexFormat();
+        if (updatableBuffers) {
+            m_buffers->Dynamic = true;
+            m_buffers->Vertices = primitiveBuilder.Vertices;
+            AssignIndexData(indices, indexCount, m_buffers->IndexFormat, m_buffers->IndexData);
+        } else {
+            m_buffers->IndexBuffer = CreateIndexBuffer(pbrResources.GetDevice().get(), indices, indexCount, m_buffers->IndexFormat);
+            m_buffers->VertexBuffer = CreateVertexBuffer(
+                pbrResources.GetDevice().get(), primitiveBuilder.Vertices.data(), (uint32_t)primitiveBuilder.Vertices.size());
+        }
+    }
+
+    Primitive::Primitive(Pbr::Resources const&,
+                         uint32_t maxVertexCount,
+                         uint32_t maxIndexCount,
+                         std::shared_ptr<Pbr::Material> material)
+        : Primitive(0, std::make_shared<Buffers>(), std::move(material)) {
+        m_buffers->Dynamic = true;
+        m_buffers->Vertices.reserve(maxVertexCount);
+        m_buffers->IndexFormat = IndexFormat::ForVertexCount(maxVertexCount);
+        m_buffers->IndexData.reserve(maxIndexCount * IndexFormat::GetIndexSize(m_buffers->IndexFormat));
     }
 
-    Primitive Primitive::Clone(Pbr::Resources const& pbrResources) const {
-        return Primitive(m_indexCount, m_indexBuffer, m_vertexBuffer, m_material->Clone(pbrResources));
+    Primitive Primitive::Clone() const {
+        Primitive clone(*this);
+        clone.m_material = m_material->Clone();
+        return clone;
     }
 
     void Primitive::UpdateBuffers(_In_ ID3D11Device* device,
                                   _In_ ID3D11DeviceContext* context,
                                   const Pbr::PrimitiveBuilder& primitiveBuilder) {
-        // Update vertex buffer.
-        {
-            D3D11_BUFFER_DESC vertDesc;
-            m_vertexBuffer->GetDesc(&vertDesc);
-
-            UINT requiredSize = GetPbrVertexByteSize(primitiveBuilder.Vertices.size());
-            if (vertDesc.ByteWidth >= requiredSize) {
-                context->UpdateSubresource(m_vertexBuffer.get(), 0, nullptr, primitiveBuilder.Vertices.data(), requiredSize, requiredSize);
-            } else {
-                m_vertexBuffer = CreateVertexBuffer(device, primitiveBuilder, true);
-            }
+        UpdateVertexBuffer(device, context, primitiveBuilder.Vertices.data(), (uint32_t)primitiveBuilder.Vertices.size());
+        UpdateIndexBuffer(device, context, primitiveBuilder.Indices.data(), (uint32_t)primitiveBuilder.Indices.size());
+    }
+
+    void Primitive::UpdateVertexBuffer(_In_ ID3D11Device* device,
+                                       _In_ ID3D11DeviceContext* context,
+                                       const Pbr::Vertex* vertices,
+                                       uint32_t vertexCount) {
+        DetachBuffers(device, context);
+        if (m_buffers->Dynamic) {
+            m_buffers->Vertices.assign(vertices, vertices + vertexCount);
+            m_buffers->VertexRange = {};
+        } else {
+            WriteBuffer(
+                device, context, m_buffers->VertexBuffer, D3D11_BIND_VERTEX_BUFFER, vertices, (UINT)(sizeof(Pbr::Vertex) * vertexCount));
         }
+    }
 
-        // Update index buffer.
-        {
-            D3D11_BUFFER_DESC idxDesc;
-            m_indexBuffer->GetDesc(&idxDesc);
+    void Primitive::UpdateVertexBufferRange(_In_ ID3D11Device* device,
+                                            _In_ ID3D11DeviceContext* context,
+                                            const Pbr::Vertex* vertices,
+                                            uint32_t firstVertex,
+                                            uint32_t vertexCount) {
+        if (vertexCount == 0) {
+            return;
+        }
 
-            UINT requiredSize = (UINT)(primitiveBuilder.Indices.size() * sizeof(decltype(primitiveBuilder.Indices)::value_type));
-            if (idxDesc.ByteWidth >= requiredSize) {
-                context->UpdateSubresource(m_indexBuffer.get(), 0, nullptr, primitiveBuilder.Indices.data(), requiredSize, requiredSize);
-            } else {
-                m_indexBuffer = CreateIndexBuffer(device, primitiveBuilder, true);
-            }
+        DetachBuffers(device, context);
+        if (m_buffers->Dynamic) {
+            assert(firstVertex + vertexCount <= m_buffers->Vertices.size());
+            std::copy(vertices, vertices + vertexCount, m_buffers->Vertices.begin() + firstVertex);
+            m_buffers->VertexRange = {};
+        } else {
+            const UINT byteOffset = (UINT)(sizeof(Pbr::Vertex) * firstVertex);
+            const UINT byteWidth = (UINT)(sizeof(Pbr::Vertex) * vertexCount);
+            const D3D11_BOX box{byteOffset, 0, 0, byteOffset + byteWidth, 1, 1};
+            context->UpdateSubresource(m_buffers->VertexBuffer.get(), 0, &box, vertices, byteWidth, byteWidth);
+        }
+    }
 
-            m_indexCount = (UINT)primitiveBuilder.Indices.size();
+    void Primitive::UpdateIndexBuffer(_In_ ID3D11Device* device,
+                                      _In_ ID3D11DeviceContext* context,
+                                      const uint32_t* indices,
+                                      uint32_t indexCount) {
+        DetachBuffers(device, context);
+
+        // The vertices may be updated after the indices, so the format depends on the indices rather than the current vertices.
+        m_buffers->IndexFormat = IndexFormat::ForIndices(indices, indexCount);
+        if (m_buffers->Dynamic) {
+            AssignIndexData(indices, indexCount, m_buffers->IndexFormat, m_buffers->IndexData);
+            m_buffers->IndexRange = {};
+        } else {
+            WithIndexData(indices, indexCount, m_buffers->IndexFormat, m_narrowIndices, [&](const void* data, UINT byteWidth) {
+                WriteBuffer(device, context, m_buffers->IndexBuffer, D3D11_BIND_INDEX_BUFFER, data, byteWidth);
+            });
+        }
+        m_indexCount = (UINT)indexCount;
+    }
+
+    void Primitive::DetachBuffers(_In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context) {
+        // Buffers shared with other clones must not be written to, so this primitive gets its own copies first.
+        // Both buffers are copied because the vertex and index buffers may be updated independently.
+        if (m_buffers.use_count() > 1 && m_buffers->Dynamic) {
+            m_buffers = std::make_shared<Buffers>(*m_buffers);
+        } else if (m_buffers.use_count() > 1) {
+            auto buffers = std::make_shared<Buffers>(*m_buffers);
+            buffers->IndexBuffer = CopyBuffer(device, context, m_buffers->IndexBuffer.get());
+            buffers->VertexBuffer = CopyBuffer(device, context, m_buffers->VertexBuffer.get());
+            m_buffers = std::move(buffers);
         }
     }
 
-    void Primitive::Render(_In_ ID3D11DeviceContext* context) const {
+    void Primitive::Render(Pbr::Resources const& pbrResources, _In_ ID3D11DeviceContext* context) const {
+        ID3D11Buffer* vertexBuffer = m_buffers->VertexBuffer.get();
+        ID3D11Buffer* indexBuffer = m_buffers->IndexBuffer.get();
+        UINT vertexOffset = 0;
+        UINT indexOffset = 0;
+
+        if (m_buffers->Dynamic) {
+            if (m_indexCount == 0 || m_buffers->Vertices.empty()) {
+                return;
+            }
+
+            // Write the geometry the first time it is rendered in a frame, later views and clones reuse the same ranges.
+            const uint64_t frameIndex = pbrResources.GetFrameIndex();
+            if (m_buffers->VertexRange.FrameIndex != frameIndex) {
+                m_buffers->VertexRange = pbrResources.WriteDynamicBuffer(context,
+                                                                         Resources::DynamicBufferType::Vertex,
+                                                                         m_buffers->Vertices.data(),
+                                                                         (UINT)(sizeof(Pbr::Vertex) * m_buffers->Vertices.size()));
+            }
+            if (m_buffers->IndexRange.FrameIndex != frameIndex) {
+                m_buffers->IndexRange = pbrResources.WriteDynamicBuffer(
+                    context, Resources::DynamicBufferType::Index, m_buffers->IndexData.data(), (UINT)m_buffers->IndexData.size());
+            }
+
+            vertexBuffer = m_buffers->VertexRange.Buffer.get();
+            indexBuffer = m_buffers->IndexRange.Buffer.get();
+            vertexOffset = m_buffers->VertexRange.Offset;
+            indexOffset = m_buffers->IndexRange.Offset;
+        }
+
         const UINT stride = sizeof(Pbr::Vertex);
-        const UINT offset = 0;
-        ID3D11Buffer* const vertexBuffers[] = {m_vertexBuffer.get()};
-        context->IASetVertexBuffers(0, 1, vertexBuffers, &stride, &offset);
-        context->IASetIndexBuffer(m_indexBuffer.get(), DXGI_FORMAT_R32_UINT, 0);
+        ID3D11Buffer* const vertexBuffers[] = {vertexBuffer};
+        context->IASetVertexBuffers(0, 1, vertexBuffers, &stride, &vertexOffset);
+        context->IASetIndexBuffer(indexBuffer, m_buffers->IndexFormat, indexOffset);
         context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        context->DrawIndexedInstanced(m_indexCount, 1, 0, 0, 0);
+        context->DrawIndexedInstanced(m_indexCount, pbrResources.GetViewInstanceCount(), 0, 0, 0);
     }
 } // namespace Pbr
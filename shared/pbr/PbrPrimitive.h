@@ -11,6 +11,7 @@
 
 namespace Pbr {
     // A primitive holds a vertex buffer, index buffer, and a pointer to a PBR material.
+    // Index buffers are 16-bit whenever the indices fit, see IndexFormat.
     struct Primitive final {
         using Collection = std::vector<Primitive>;
 
@@ -18,14 +19,36 @@ namespace Pbr {
         Primitive(UINT indexCount,
                   winrt::com_ptr<ID3D11Buffer> indexBuffer,
                   winrt::com_ptr<ID3D11Buffer> vertexBuffer,
-                  std::shared_ptr<Material> material);
+                  std::shared_ptr<Material> material,
+                  DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT);
+        // A primitive with updatable buffers is dynamic: its geometry is written to the ring buffers of the resources each frame
+        // it is rendered in, instead of to buffers of its own.
         Primitive(Pbr::Resources const& pbrResources,
                   const Pbr::PrimitiveBuilder& primitiveBuilder,
                   std::shared_ptr<Material> material,
                   bool updatableBuffers = false);
+        // Create an empty dynamic primitive with room for the given number of vertices and indices,
+        // for geometry that is streamed in every frame with UpdateVertexBuffer and UpdateIndexBuffer.
+        Primitive(Pbr::Resources const& pbrResources, uint32_t maxVertexCount, uint32_t maxIndexCount, std::shared_ptr<Material> material);
 
         void UpdateBuffers(_In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context, const Pbr::PrimitiveBuilder& primitiveBuilder);
 
+        // Update the vertex or index buffer. Dynamic primitives only copy the data until they are rendered. Other primitives update
+        // their buffer in place, and only reallocate it if it is too small for the new data.
+        void UpdateVertexBuffer(_In_ ID3D11Device* device,
+                                _In_ ID3D11DeviceContext* context,
+                                const Pbr::Vertex* vertices,
+                                uint32_t vertexCount);
+        void UpdateIndexBuffer(_In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context, const uint32_t* indices, uint32_t indexCount);
+
+        // Overwrite part of the vertex buffer, starting at the given vertex, and upload only that part. The range must be within the
+        // vertices of the last UpdateVertexBuffer, or of the builder the primitive was created from.
+        void UpdateVertexBufferRange(_In_ ID3D11Device* device,
+                                     _In_ ID3D11DeviceContext* context,
+                                     const Pbr::Vertex* vertices,
+                                     uint32_t firstVertex,
+                                     uint32_t vertexCount);
+
         // Get the material for the primitive.
         std::shared_ptr<Material>& GetMaterial() {
             return m_material;
@@ -41,13 +64,36 @@ namespace Pbr {
 
     protected:
         friend struct Model;
-        void Render(_In_ ID3D11DeviceContext* context) const;
-        Primitive Clone(Pbr::Resources const& pbrResources) const;
+        friend class RenderQueue;
+        // Draw one instance per view, see Resources::GetViewInstanceCount.
+        void Render(Pbr::Resources const& pbrResources, _In_ ID3D11DeviceContext* context) const;
+        Primitive Clone() const;
 
     private:
+        void DetachBuffers(_In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context);
+
+        // Geometry buffers are shared between clones. Updates copy shared buffers instead of writing to them.
+        struct Buffers {
+            winrt::com_ptr<ID3D11Buffer> IndexBuffer;
+            winrt::com_ptr<ID3D11Buffer> VertexBuffer;
+            DXGI_FORMAT IndexFormat{DXGI_FORMAT_R32_UINT};
+
+            // Dynamic geometry has no buffers of its own. It is kept here and written to ranges of the ring buffers of the
+            // resources at most once per frame, when first rendered in that frame. The indices are kept in IndexFormat.
+            bool Dynamic{false};
+            std::vector<Pbr::Vertex> Vertices;
+            std::vector<uint8_t> IndexData;
+            mutable DynamicBufferRange VertexRange;
+            mutable DynamicBufferRange IndexRange;
+        };
+
+        Primitive(UINT indexCount, std::shared_ptr<Buffers> buffers, std::shared_ptr<Material> material);
+
         UINT m_indexCount;
-        winrt::com_ptr<ID3D11Buffer> m_indexBuffer;
-        winrt::com_ptr<ID3D11Buffer> m_vertexBuffer;
+        std::shared_ptr<Buffers> m_buffers;
         std::shared_ptr<Material> m_material;
+
+        // Reused to narrow the indices of updates to buffers that are not dynamic.
+        std::vector<uint16_t> m_narrowIndices;
     };
 } // namespace Pbr
@@ -0,0 +1,223 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include <algorithm>
+#include <tuple>
+#include "PbrCommon.h"
+#include "PbrMaterial.h"
+#include "PbrModel.h"
+#include "PbrPrimitive.h"
+#include "PbrRenderQueue.h"
+
+using namespace DirectX;
+
+namespace {
+    // The order of opaque draws. The state that is most expensive to change comes first, so it changes least often.
+    auto SortKey(const Pbr::DrawState& state) {
+        return std::tie(state.Shading,
+                        state.BlendState,
+                        state.DepthStencilState,
+                        state.RasterizerState,
+                        state.Textures,
+                        state.Samplers,
+                        state.MaterialConstantBuffer,
+                        state.ModelTransforms,
+                        state.ModelToWorldIndex);
+    }
+} // namespace
+
+namespace Pbr {
+    // Binds the state to a device context, with the shaders and constant buffers of the resources.
+    class RenderQueue::ContextStateSink final : public StateSink {
+    public:
+        ContextStateSink(Pbr::Resources const& pbrResources,
+                         _In_ ID3D11DeviceContext* context,
+                         const std::vector<DirectX::XMFLOAT4X4>& modelToWorld)
+            : m_pbrResources(pbrResources)
+            , m_context(context)
+            , m_modelToWorld(modelToWorld) {
+        }
+
+        void SetShaders(ShadingMode shading) override {
+            m_pbrResources.BindShaders(m_context, shading);
+        }
+
+        void SetBlendState(ID3D11BlendState* blendState) override {
+            m_context->OMSetBlendState(blendState, nullptr, 0xFFFFFF);
+        }
+
+        void SetDepthStencilState(ID3D11DepthStencilState* depthStencilState) override {
+            m_context->OMSetDepthStencilState(depthStencilState, 1);
+        }
+
+        void SetRasterizerState(ID3D11RasterizerState* rasterizerState) override {
+            m_context->RSSetState(rasterizerState);
+        }
+
+        void SetTextures(uint32_t firstSlot, uint32_t count, ID3D11ShaderResourceView* const* textures) override {
+            m_context->PSSetShaderResources(ShaderSlots::BaseColor + firstSlot, count, textures);
+        }
+
+        void SetSamplers(uint32_t firstSlot, uint32_t count, ID3D11SamplerState* const* samplers) override {
+            m_context->PSSetSamplers(ShaderSlots::BaseColor + firstSlot, count, samplers);
+        }
+
+        void SetMaterialConstantBuffer(ID3D11Buffer* constantBuffer) override {
+            ID3D11Buffer* const constantBuffers[] = {constantBuffer};
+            m_context->PSSetConstantBuffers(ShaderSlots::ConstantBuffers::Material, 1, constantBuffers);
+        }
+
+        void SetModelTransforms(ID3D11ShaderResourceView* modelTransforms) override {
+            ID3D11ShaderResourceView* const shaderResources[] = {modelTransforms};
+            m_context->VSSetShaderResources(ShaderSlots::Transforms, 1, shaderResources);
+        }
+
+        void SetModelToWorld(uint32_t modelToWorldIndex) override {
+            m_pbrResources.SetModelToWorld(XMLoadFloat4x4(&m_modelToWorld[modelToWorldIndex]), m_context);
+        }
+
+        void Draw(const Primitive* primitive) override {
+            primitive->Render(m_pbrResources, m_context);
+        }
+
+    private:
+        Pbr::Resources const& m_pbrResources;
+        ID3D11DeviceContext* const m_context;
+        const std::vector<DirectX::XMFLOAT4X4>& m_modelToWorld;
+    };
+
+    StateTracker::StateTracker(StateSink& sink)
+        : m_sink(sink) {
+    }
+
+    void StateTracker::Reset() {
+        m_valid = false;
+    }
+
+    template <typename T>
+    void StateTracker::SetSlots(const std::array<T*, DrawState::TextureCount>& bound,
+                                const std::array<T*, DrawState::TextureCount>& state,
+                                void (StateSink::*set)(uint32_t, uint32_t, T* const*)) {
+        // Bind the smallest range of slots covering all changed slots in one call.
+        uint32_t first = 0;
+        uint32_t last = (uint32_t)state.size();
+        if (m_valid) {
+            while (first < last && bound[first] == state[first]) {
+                first++;
+            }
+            while (last > first && bound[last - 1] == state[last - 1]) {
+                last--;
+            }
+        }
+
+        if (first == last) {
+            m_statistics.SkippedBinds++;
+        } else {
+            (m_sink.*set)(first, last - first, state.data() + first);
+            m_statistics.Binds++;
+        }
+    }
+
+    void StateTracker::Draw(const DrawState& state, const Primitive* primitive) {
+        const auto set = [this](auto& bound, auto value, auto&& bind) {
+            if (m_valid && bound == value) {
+                m_statistics.SkippedBinds++;
+            } else {
+                bound = value;
+                bind(value);
+                m_statistics.Binds++;
+            }
+        };
+
+        set(m_bound.Shading, state.Shading, [this](ShadingMode shading) { m_sink.SetShaders(shading); });
+        set(m_bound.BlendState, state.BlendState, [this](ID3D11BlendState* blendState) { m_sink.SetBlendState(blendState); });
+        set(m_bound.DepthStencilState, state.DepthStencilState, [this](ID3D11DepthStencilState* depthStencilState) {
+            m_sink.SetDepthStencilState(depthStencilState);
+        });
+        set(m_bound.RasterizerState, state.RasterizerState, [this](ID3D11RasterizerState* rasterizerState) {
+            m_sink.SetRasterizerState(rasterizerState);
+        });
+        SetSlots(m_bound.Textures, state.Textures, &StateSink::SetTextures);
+        m_bound.Textures = state.Textures;
+        SetSlots(m_bound.Samplers, state.Samplers, &StateSink::SetSamplers);
+        m_bound.Samplers = state.Samplers;
+        set(m_bound.MaterialConstantBuffer, state.MaterialConstantBuffer, [this](ID3D11Buffer* constantBuffer) {
+            m_sink.SetMaterialConstantBuffer(constantBuffer);
+        });
+        set(m_bound.ModelTransforms, state.ModelTransforms, [this](ID3D11ShaderResourceView* modelTransforms) {
+            m_sink.SetModelTransforms(modelTransforms);
+        });
+        set(m_bound.ModelToWorldIndex, state.ModelToWorldIndex, [this](uint32_t index) { m_sink.SetModelToWorld(index); });
+        m_valid = true;
+
+        m_sink.Draw(primitive);
+        m_statistics.Draws++;
+    }
+
+    void XM_CALLCONV RenderQueue::Add(Pbr::Resources const& pbrResources,
+                                      _In_ ID3D11DeviceContext* context,
+                                      const Pbr::Model& model,
+                                      DirectX::FXMMATRIX modelToWorld,
+                                      ShadingMode shadingMode,
+                                      FillMode fillMode) {
+        model.UpdateTransforms(pbrResources, context);
+
+        DrawState state;
+        state.Shading = shadingMode;
+        state.ModelTransforms = model.m_modelTransformsResourceView.get();
+        state.ModelToWorldIndex = AddModelToWorld(modelToWorld);
+
+        for (const Pbr::Primitive& primitive : *model.m_primitives) {
+            const Material& material = *primitive.GetMaterial();
+            if (material.Hidden) {
+                continue;
+            }
+
+            material.PrepareDrawState(context, pbrResources, fillMode == FillMode::Wireframe, state);
+            AddDraw(state, material.m_alphaBlended, &primitive);
+        }
+    }
+
+    void RenderQueue::AddDraw(const DrawState& state, bool alphaBlended, const Primitive* primitive) {
+        m_draws.push_back(QueuedDraw{state, alphaBlended, primitive});
+    }
+
+    uint32_t XM_CALLCONV RenderQueue::AddModelToWorld(DirectX::FXMMATRIX modelToWorld) {
+        XMStoreFloat4x4(&m_modelToWorld.emplace_back(), modelToWorld);
+        return (uint32_t)m_modelToWorld.size() - 1;
+    }
+
+    StateTracker::Statistics RenderQueue::Submit(StateSink& sink) {
+        m_sortedDraws.clear();
+        for (const QueuedDraw& draw : m_draws) {
+            m_sortedDraws.push_back(&draw);
+        }
+
+        // Opaque draws are grouped by state, blended draws are kept in order after all opaque draws.
+        const auto firstBlended =
+            std::stable_partition(m_sortedDraws.begin(), m_sortedDraws.end(), [](const QueuedDraw* draw) { return !draw->AlphaBlended; });
+        std::stable_sort(m_sortedDraws.begin(), firstBlended, [](const QueuedDraw* a, const QueuedDraw* b) {
+            return SortKey(a->State) < SortKey(b->State);
+        });
+
+        StateTracker tracker(sink);
+        for (const QueuedDraw* draw : m_sortedDraws) {
+            tracker.Draw(draw->State, draw->Primitive);
+        }
+
+        Clear();
+        return tracker.GetStatistics();
+    }
+
+    StateTracker::Statistics RenderQueue::Submit(Pbr::Resources const& pbrResources, _In_ ID3D11DeviceContext* context) {
+        ContextStateSink sink(pbrResources, context, m_modelToWorld);
+        return Submit(sink);
+    }
+
+    void RenderQueue::Clear() {
+        m_draws.clear();
+        m_sortedDraws.clear();
+        m_modelToWorld.clear();
+    }
+} // namespace Pbr
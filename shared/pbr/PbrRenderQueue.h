@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#pragma once
+
+#include <array>
+#include <vector>
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include "PbrResources.h"
+
+namespace Pbr {
+    struct Model;
+    struct Primitive;
+
+    // The pipeline state a primitive is drawn with. The D3D objects are only compared by address, so states can be compared,
+    // sorted and deduplicated without a device.
+    struct DrawState {
+        static constexpr size_t TextureCount = ShaderSlots::LastMaterialSlot + 1;
+
+        ShadingMode Shading{ShadingMode::Regular};
+        ID3D11BlendState* BlendState{nullptr};
+        ID3D11DepthStencilState* DepthStencilState{nullptr};
+        ID3D11RasterizerState* RasterizerState{nullptr};
+        std::array<ID3D11ShaderResourceView*, TextureCount> Textures{};
+        std::array<ID3D11SamplerState*, TextureCount> Samplers{};
+        ID3D11Buffer* MaterialConstantBuffer{nullptr};
+        ID3D11ShaderResourceView* ModelTransforms{nullptr};
+        uint32_t ModelToWorldIndex{0}; // Index of the model to world transform in the render queue.
+    };
+
+    // Receives the state changes and draws of a render queue. The render queue implements it on a D3D11 device context,
+    // other implementations can count or record the binds that would reach the device.
+    struct StateSink {
+        virtual ~StateSink() = default;
+
+        virtual void SetShaders(ShadingMode shading) = 0;
+        virtual void SetBlendState(ID3D11BlendState* blendState) = 0;
+        virtual void SetDepthStencilState(ID3D11DepthStencilState* depthStencilState) = 0;
+        virtual void SetRasterizerState(ID3D11RasterizerState* rasterizerState) = 0;
+        virtual void SetTextures(uint32_t firstSlot, uint32_t count, ID3D11ShaderResourceView* const* textures) = 0;
+        virtual void SetSamplers(uint32_t firstSlot, uint32_t count, ID3D11SamplerState* const* samplers) = 0;
+        virtual void SetMaterialConstantBuffer(ID3D11Buffer* constantBuffer) = 0;
+        virtual void SetModelTransforms(ID3D11ShaderResourceView* modelTransforms) = 0;
+        virtual void SetModelToWorld(uint32_t modelToWorldIndex) = 0;
+        virtual void Draw(const Primitive* primitive) = 0;
+    };
+
+    // Remembers the state last sent to a sink and only sends the parts of a new state that differ from it.
+    class StateTracker final {
+    public:
+        struct Statistics {
+            uint32_t Draws{0};
+            uint32_t Binds{0};        // State changes sent to the sink.
+            uint32_t SkippedBinds{0}; // State changes left out because the state was already bound.
+        };
+
+        explicit StateTracker(StateSink& sink);
+
+        // Forget the bound state, so the next state is sent in full. Needed whenever the state was changed behind the tracker.
+        void Reset();
+
+        // Send the differences between the given state and the bound state, then draw the primitive.
+        void Draw(const DrawState& state, const Primitive* primitive);
+
+        const Statistics& GetStatistics() const {
+            return m_statistics;
+        }
+
+    private:
+        template <typename T>
+        void SetSlots(const std::array<T*, DrawState::TextureCount>& bound,
+                      const std::array<T*, DrawState::TextureCount>& state,
+                      void (StateSink::*set)(uint32_t, uint32_t, T* const*));
+
+        StateSink& m_sink;
+        bool m_valid{false};
+        DrawState m_bound;
+        Statistics m_statistics;
+    };
+
+    // Collects the draws of a pass and submits them ordered by their state, so consecutive draws share as much state as possible
+    // and only the differences are bound. Opaque draws are sorted by shaders, fixed function state, textures and material.
+    // Alpha blended draws follow in the order they were added, so they still blend in that order.
+    // Models, primitives and materials added to the queue must stay alive and unchanged until the queue is submitted.
+    class RenderQueue final {
+    public:
+        // Add the visible primitives of a model. Material constants and model transforms are updated here.
+        void XM_CALLCONV Add(Pbr::Resources const& pbrResources,
+                             _In_ ID3D11DeviceContext* context,
+                             const Pbr::Model& model,
+                             DirectX::FXMMATRIX modelToWorld,
+                             ShadingMode shadingMode,
+                             FillMode fillMode);
+
+        // Add a draw of a primitive with the given state. The state's ModelToWorldIndex must come from AddModelToWorld.
+        void AddDraw(const DrawState& state, bool alphaBlended, const Primitive* primitive);
+        uint32_t XM_CALLCONV AddModelToWorld(DirectX::FXMMATRIX modelToWorld);
+
+        // Sort and draw the queued draws into the sink, or into the device context with the given resources, then clear the queue.
+        // The resources must already be bound to the context for the pass, see Resources::Bind.
+        StateTracker::Statistics Submit(StateSink& sink);
+        StateTracker::Statistics Submit(Pbr::Resources const& pbrResources, _In_ ID3D11DeviceContext* context);
+
+        void Clear();
+
+        bool Empty() const {
+            return m_draws.empty();
+        }
+
+    private:
+        class ContextStateSink;
+
+        struct QueuedDraw {
+            DrawState State;
+            bool AlphaBlended;
+            const Pbr::Primitive* Primitive;
+        };
+
+        std::vector<QueuedDraw> m_draws;
+        std::vector<const QueuedDraw*> m_sortedDraws;
+        std::vector<DirectX::XMFLOAT4X4> m_modelToWorld;
+    };
+} // namespace Pbr
@@ -5,18 +5,21 @@
 #include "PbrCommon.h"
 #include "PbrResources.h"
 #include "PbrMaterial.h"
+#include "PbrRingAllocator.h"
 
 #include <PbrPixelShader.h>
 #include <PbrVertexShader.h>
 #include <HighlightPixelShader.h>
 #include <HighlightVertexShader.h>
+#include <PbrVertexShaderVprt.h>
+#include <HighlightVertexShaderVprt.h>
 
 using namespace DirectX;
 
 namespace {
     struct SceneConstantBuffer {
-        alignas(16) DirectX::XMFLOAT4X4 ViewProjection;
-        alignas(16) DirectX::XMFLOAT4 EyePosition;
+        alignas(16) DirectX::XMFLOAT4X4 ViewProjection[Pbr::Resources::MaxViewInstanceCount];
+        alignas(16) DirectX::XMFLOAT4 EyePosition[Pbr::Resources::MaxViewInstanceCount];
         alignas(16) DirectX::XMFLOAT3 LightDirection{};
         alignas(16) DirectX::XMFLOAT3 LightDiffuseColor{};
         alignas(16) int NumSpecularMipLevels{1};
@@ -27,6 +30,34 @@ namespace {
     struct ModelConstantBuffer {
         alignas(16) DirectX::XMFLOAT4X4 ModelToWorld;
     };
+
+    // Constant buffer ranges bound with VSSetConstantBuffers1 must start at and span multiples of 16 constants.
+    constexpr UINT ConstantBufferRangeAlignment = 16 * 16;
+
+    // Initial sizes of the dynamic ring buffers. A ring grows if a single frame writes more than it holds.
+    constexpr UINT InitialVertexRingSize = 2 * 1024 * 1024;
+    constexpr UINT InitialIndexRingSize = 1024 * 1024;
+    constexpr UINT InitialConstantRingSize = 1024 * 1024;
+
+    // A dynamic buffer that is sub-allocated in allocation order and reused once the frames that wrote it have retired.
+    struct FrameRingBuffer {
+        UINT BindFlags{0};
+        UINT Alignment{0};
+        winrt::com_ptr<ID3D11Buffer> Buffer;
+        std::unique_ptr<Pbr::RingAllocator> Allocator;
+
+        void Create(_In_ ID3D11Device* device, UINT bindFlags, UINT alignment, UINT capacity) {
+            const CD3D11_BUFFER_DESC desc(capacity, bindFlags, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
+            winrt::com_ptr<ID3D11Buffer> buffer;
+            Pbr::Internal::ThrowIfFailed(device->CreateBuffer(&desc, nullptr, buffer.put()));
+
+            // Ranges of the previous buffer written this frame keep it alive until they are no longer used.
+            BindFlags = bindFlags;
+            Alignment = alignment;
+            Buffer = std::move(buffer);
+            Allocator = std::make_unique<Pbr::RingAllocator>(capacity);
+        }
+    };
 } // namespace
 
 namespace Pbr {
@@ -49,6 +80,31 @@ namespace Pbr {
             Internal::ThrowIfFailed(device->CreateVertexShader(
                 g_HighlightVertexShader, sizeof(g_HighlightVertexShader), nullptr, Resources.HighlightVertexShader.put()));
 
+            // The view instancing vertex shaders output SV_RenderTargetArrayIndex, which needs VPRT support.
+            D3D11_FEATURE_DATA_D3D11_OPTIONS3 options{};
+            SupportsViewInstancing =
+                SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS3, &options, sizeof(options))) &&
+                options.VPAndRTArrayIndexFromAnyShaderFeedingRasterizer;
+            if (SupportsViewInstancing) {
+                Internal::ThrowIfFailed(device->CreateVertexShader(
+                    g_PbrVertexShaderVprt, sizeof(g_PbrVertexShaderVprt), nullptr, Resources.PbrVertexShaderVprt.put()));
+                Internal::ThrowIfFailed(device->CreateVertexShader(
+                    g_HighlightVertexShaderVprt, sizeof(g_HighlightVertexShaderVprt), nullptr, Resources.HighlightVertexShaderVprt.put()));
+            }
+
+            // Per-object constants are written to a ring buffer if ranges of dynamic constant buffers can be bound and written without
+            // discarding the whole buffer. Otherwise each object updates a single constant buffer.
+            D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+            RingBufferedConstants = SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) &&
+                                    options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+
+            Resources.RingBuffers[(size_t)DynamicBufferType::Vertex].Create(device, D3D11_BIND_VERTEX_BUFFER, 16, InitialVertexRingSize);
+            Resources.RingBuffers[(size_t)DynamicBufferType::Index].Create(device, D3D11_BIND_INDEX_BUFFER, 16, InitialIndexRingSize);
+            if (RingBufferedConstants) {
+                Resources.RingBuffers[(size_t)DynamicBufferType::Constant].Create(
+                    device, D3D11_BIND_CONSTANT_BUFFER, ConstantBufferRangeAlignment, InitialConstantRingSize);
+            }
+
             // Set up the constant buffers.
             static_assert((sizeof(SceneConstantBuffer) % 16) == 0, "Constant Buffer must be divisible by 16 bytes");
             const CD3D11_BUFFER_DESC pbrConstantBufferDesc(sizeof(SceneConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
@@ -111,6 +167,8 @@ namespace Pbr {
             winrt::com_ptr<ID3D11PixelShader> PbrPixelShader;
             winrt::com_ptr<ID3D11VertexShader> HighlightVertexShader;
             winrt::com_ptr<ID3D11PixelShader> HighlightPixelShader;
+            winrt::com_ptr<ID3D11VertexShader> PbrVertexShaderVprt;
+            winrt::com_ptr<ID3D11VertexShader> HighlightVertexShaderVprt;
             winrt::com_ptr<ID3D11Buffer> SceneConstantBuffer;
             winrt::com_ptr<ID3D11Buffer> ModelConstantBuffer;
             winrt::com_ptr<ID3D11ShaderResourceView> BrdfLut;
@@ -122,8 +180,59 @@ namespace Pbr {
                 RasterizerStates[2][2][2]; // Three dimensions for [DoubleSide][Wireframe][FrontCounterClockWise]
             winrt::com_ptr<ID3D11DepthStencilState> DepthStencilStates[2][2]; // Two dimensions for [ReverseZ][NoWrite]
             mutable std::map<uint32_t, winrt::com_ptr<ID3D11ShaderResourceView>> SolidColorTextureCache;
+
+            std::array<FrameRingBuffer, (size_t)DynamicBufferType::Count> RingBuffers;
+            std::deque<std::pair<uint64_t, winrt::com_ptr<ID3D11Query>>> PendingFrameQueries; // Event queries ending each frame.
+            std::vector<winrt::com_ptr<ID3D11Query>> FreeFrameQueries;
+            DynamicBufferRange ModelConstants;
+            ID3D11DeviceContext* Context1Source{nullptr};
+            winrt::com_ptr<ID3D11DeviceContext1> Context1;
         };
 
+        ID3D11DeviceContext1* GetContext1(_In_ ID3D11DeviceContext* context) {
+            if (Resources.Context1Source != context) {
+                Resources.Context1 = nullptr;
+                Internal::ThrowIfFailed(context->QueryInterface(winrt::guid_of<ID3D11DeviceContext1>(), Resources.Context1.put_void()));
+                Resources.Context1Source = context;
+            }
+            return Resources.Context1.get();
+        }
+
+        void RetireFrames(uint64_t completedFrameIndex) {
+            for (FrameRingBuffer& ring : Resources.RingBuffers) {
+                if (ring.Allocator) {
+                    ring.Allocator->RetireFrames(completedFrameIndex);
+                }
+            }
+        }
+
+        // Block until the GPU has finished the given frame.
+        void WaitForFrame(_In_ ID3D11DeviceContext* context, uint64_t frameIndex) {
+            auto& pendingFrames = Resources.PendingFrameQueries;
+            while (!pendingFrames.empty() && pendingFrames.front().first <= frameIndex) {
+                ID3D11Query* query = pendingFrames.front().second.get();
+                while (context->GetData(query, nullptr, 0, 0) == S_FALSE) {
+                    std::this_thread::yield();
+                }
+                RetireFrames(pendingFrames.front().first);
+                Resources.FreeFrameQueries.push_back(std::move(pendingFrames.front().second));
+                pendingFrames.pop_front();
+            }
+        }
+
+        void BindModelConstants(_In_ ID3D11DeviceContext* context) {
+            if (RingBufferedConstants && Resources.ModelConstants.Buffer) {
+                ID3D11Buffer* buffers[] = {Resources.ModelConstants.Buffer.get()};
+                const UINT firstConstant = Resources.ModelConstants.Offset / 16;
+                const UINT constantCount = ConstantBufferRangeAlignment / 16;
+                GetContext1(context)->VSSetConstantBuffers1(
+                    Pbr::ShaderSlots::ConstantBuffers::Model, 1, buffers, &firstConstant, &constantCount);
+            } else {
+                ID3D11Buffer* buffers[] = {Resources.ModelConstantBuffer.get()};
+                context->VSSetConstantBuffers(Pbr::ShaderSlots::ConstantBuffers::Model, 1, buffers);
+            }
+        }
+
         DeviceResources Resources;
         SceneConstantBuffer SceneBuffer;
         ModelConstantBuffer ModelBuffer;
@@ -135,6 +244,10 @@ namespace Pbr {
         FillMode Fill = FillMode::Solid;
         FrontFaceWindingOrder WindingOrder = FrontFaceWindingOrder::ClockWise;
         bool ReverseZ = false;
+        bool SupportsViewInstancing = false;
+        bool RingBufferedConstants = false;
+        uint32_t ViewInstanceCount = 1;
+        uint64_t FrameIndex = 1;
         mutable std::mutex m_cacheMutex;
     };
 
@@ -183,12 +296,42 @@ namespace Pbr {
 
     void XM_CALLCONV Resources::SetModelToWorld(DirectX::FXMMATRIX modelToWorld, _In_ ID3D11DeviceContext* context) const {
         XMStoreFloat4x4(&m_impl->ModelBuffer.ModelToWorld, XMMatrixTranspose(modelToWorld));
-        context->UpdateSubresource(m_impl->Resources.ModelConstantBuffer.get(), 0, nullptr, &m_impl->ModelBuffer, 0, 0);
+        if (m_impl->RingBufferedConstants) {
+            m_impl->Resources.ModelConstants =
+                WriteDynamicBuffer(context, DynamicBufferType::Constant, &m_impl->ModelBuffer, sizeof(ModelConstantBuffer));
+            m_impl->BindModelConstants(context);
+        } else {
+            context->UpdateSubresource(m_impl->Resources.ModelConstantBuffer.get(), 0, nullptr, &m_impl->ModelBuffer, 0, 0);
+        }
     }
 
     void XM_CALLCONV Resources::SetViewProjection(DirectX::FXMMATRIX view, DirectX::CXMMATRIX projection) {
-        XMStoreFloat4x4(&m_impl->SceneBuffer.ViewProjection, XMMatrixTranspose(XMMatrixMultiply(view, projection)));
-        XMStoreFloat4(&m_impl->SceneBuffer.EyePosition, XMMatrixInverse(nullptr, view).r[3]);
+        XMStoreFloat4x4(&m_impl->SceneBuffer.ViewProjection[0], XMMatrixTranspose(XMMatrixMultiply(view, projection)));
+        XMStoreFloat4(&m_impl->SceneBuffer.EyePosition[0], XMMatrixInverse(nullptr, view).r[3]);
+        m_impl->ViewInstanceCount = 1;
+    }
+
+    bool Resources::SupportsViewInstancing() const {
+        return m_impl->SupportsViewInstancing;
+    }
+
+    void Resources::SetViewProjections(const DirectX::XMMATRIX* views, const DirectX::XMMATRIX* projections, uint32_t viewCount) {
+        if (viewCount == 0 || viewCount > MaxViewInstanceCount) {
+            throw std::exception("Unsupported number of view instances");
+        }
+        if (viewCount > 1 && !m_impl->SupportsViewInstancing) {
+            throw std::exception("View instancing is not supported by the device");
+        }
+
+        for (uint32_t i = 0; i < viewCount; i++) {
+            XMStoreFloat4x4(&m_impl->SceneBuffer.ViewProjection[i], XMMatrixTranspose(XMMatrixMultiply(views[i], projections[i])));
+            XMStoreFloat4(&m_impl->SceneBuffer.EyePosition[i], XMMatrixInverse(nullptr, views[i]).r[3]);
+        }
+        m_impl->ViewInstanceCount = viewCount;
+    }
+
+    uint32_t Resources::GetViewInstanceCount() const {
+        return m_impl->ViewInstanceCount;
     }
 
     void Resources::SetEnvironmentMap(_In_ ID3D11ShaderResourceView* specularEnvironmentMap,
@@ -229,19 +372,90 @@ namespace Pbr {
         return m_impl->Resources.SolidColorTextureCache.emplace(colorKey, texture).first->second;
     }
 
-    void Resources::Bind(_In_ ID3D11DeviceContext* context) const {
-        context->UpdateSubresource(m_impl->Resources.SceneConstantBuffer.get(), 0, nullptr, &m_impl->SceneBuffer, 0, 0);
+    void Resources::BeginFrame(_In_ ID3D11DeviceContext* context) {
+        auto& pendingFrames = m_impl->Resources.PendingFrameQueries;
+        auto& freeQueries = m_impl->Resources.FreeFrameQueries;
 
-        if (m_impl->Shading == ShadingMode::Highlight) {
-            context->VSSetShader(m_impl->Resources.HighlightVertexShader.get(), nullptr, 0);
-            context->PSSetShader(m_impl->Resources.HighlightPixelShader.get(), nullptr, 0);
+        // Fence the frame that just ended, so its ring buffer space can be reused once the GPU has finished it.
+        winrt::com_ptr<ID3D11Query> query;
+        if (freeQueries.empty()) {
+            const CD3D11_QUERY_DESC queryDesc(D3D11_QUERY_EVENT);
+            Internal::ThrowIfFailed(GetDevice()->CreateQuery(&queryDesc, query.put()));
         } else {
-            context->VSSetShader(m_impl->Resources.PbrVertexShader.get(), nullptr, 0);
-            context->PSSetShader(m_impl->Resources.PbrPixelShader.get(), nullptr, 0);
+            query = std::move(freeQueries.back());
+            freeQueries.pop_back();
+        }
+        context->End(query.get());
+        pendingFrames.emplace_back(m_impl->FrameIndex, std::move(query));
+        for (FrameRingBuffer& ring : m_impl->Resources.RingBuffers) {
+            if (ring.Allocator) {
+                ring.Allocator->FinishFrame(m_impl->FrameIndex);
+            }
+        }
+
+        // Retire the frames the GPU has finished, without waiting or flushing.
+        while (!pendingFrames.empty() &&
+               context->GetData(pendingFrames.front().second.get(), nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK) {
+            m_impl->RetireFrames(pendingFrames.front().first);
+            freeQueries.push_back(std::move(pendingFrames.front().second));
+            pendingFrames.pop_front();
+        }
+
+        m_impl->FrameIndex++;
+        m_impl->Resources.ModelConstants = {};
+    }
+
+    uint64_t Resources::GetFrameIndex() const {
+        return m_impl->FrameIndex;
+    }
+
+    DynamicBufferRange Resources::WriteDynamicBuffer(_In_ ID3D11DeviceContext* context,
+                                                     DynamicBufferType type,
+                                                     const void* data,
+                                                     UINT size) const {
+        FrameRingBuffer& ring = m_impl->Resources.RingBuffers[(size_t)type];
+        if (!ring.Allocator) {
+            throw std::exception("The dynamic buffer is not supported by the device");
         }
 
-        ID3D11Buffer* vsBuffers[] = {m_impl->Resources.SceneConstantBuffer.get(), m_impl->Resources.ModelConstantBuffer.get()};
+        const UINT rangeSize = type == DynamicBufferType::Constant
+                                   ? (size + ConstantBufferRangeAlignment - 1) / ConstantBufferRangeAlignment * ConstantBufferRangeAlignment
+                                   : size;
+        std::optional<uint64_t> offset = ring.Allocator->Allocate(rangeSize, ring.Alignment);
+        while (!offset.has_value()) {
+            if (const std::optional<uint64_t> oldestFrame = ring.Allocator->GetOldestPendingFrame()) {
+                // The ring is full of frames in flight, so wait for the oldest one to free its space.
+                m_impl->WaitForFrame(context, oldestFrame.value());
+            } else {
+                // The current frame alone does not fit, so the ring grows for the following frames.
+                UINT capacity = (UINT)ring.Allocator->GetCapacity() * 2;
+                while (capacity < rangeSize) {
+                    capacity *= 2;
+                }
+                ring.Create(GetDevice().get(), ring.BindFlags, ring.Alignment, capacity);
+            }
+            offset = ring.Allocator->Allocate(rangeSize, ring.Alignment);
+        }
+
+        // Ranges in use are never written, so the buffer is mapped without discarding it, except when nothing else is in use.
+        const D3D11_MAP mapType =
+            ring.Allocator->GetUsedSize() == rangeSize ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        Internal::ThrowIfFailed(context->Map(ring.Buffer.get(), 0, mapType, 0, &mapped));
+        memcpy(static_cast<uint8_t*>(mapped.pData) + offset.value(), data, size);
+        context->Unmap(ring.Buffer.get(), 0);
+
+        return DynamicBufferRange{ring.Buffer, (UINT)offset.value(), m_impl->FrameIndex};
+    }
+
+    void Resources::Bind(_In_ ID3D11DeviceContext* context) const {
+        context->UpdateSubresource(m_impl->Resources.SceneConstantBuffer.get(), 0, nullptr, &m_impl->SceneBuffer, 0, 0);
+
+        BindShaders(context, m_impl->Shading);
+
+        ID3D11Buffer* vsBuffers[] = {m_impl->Resources.SceneConstantBuffer.get()};
         context->VSSetConstantBuffers(Pbr::ShaderSlots::ConstantBuffers::Scene, _countof(vsBuffers), vsBuffers);
+        m_impl->BindModelConstants(context);
         ID3D11Buffer* psBuffers[] = {m_impl->Resources.SceneConstantBuffer.get()};
         context->PSSetConstantBuffers(Pbr::ShaderSlots::ConstantBuffers::Scene, _countof(psBuffers), psBuffers);
         context->IASetInputLayout(m_impl->Resources.InputLayout.get());
@@ -283,19 +497,43 @@ namespace Pbr {
         m_impl->ReverseZ = reverseZ;
     }
 
+    void Resources::BindShaders(_In_ ID3D11DeviceContext* context, ShadingMode shading) const {
+        const bool viewInstancing = m_impl->ViewInstanceCount > 1;
+        if (shading == ShadingMode::Highlight) {
+            context->VSSetShader(viewInstancing ? m_impl->Resources.HighlightVertexShaderVprt.get()
+                                                : m_impl->Resources.HighlightVertexShader.get(),
+                                 nullptr,
+                                 0);
+            context->PSSetShader(m_impl->Resources.HighlightPixelShader.get(), nullptr, 0);
+        } else {
+            context->VSSetShader(
+                viewInstancing ? m_impl->Resources.PbrVertexShaderVprt.get() : m_impl->Resources.PbrVertexShader.get(), nullptr, 0);
+            context->PSSetShader(m_impl->Resources.PbrPixelShader.get(), nullptr, 0);
+        }
+    }
+
+    ID3D11BlendState* Resources::GetBlendState(bool enabled) const {
+        return enabled ? m_impl->Resources.AlphaBlendState.get() : m_impl->Resources.DefaultBlendState.get();
+    }
+
+    ID3D11RasterizerState* Resources::GetRasterizerState(bool doubleSided, bool wireframe) const {
+        const bool frontCounterClockWise = m_impl->WindingOrder == FrontFaceWindingOrder::CounterClockWise;
+        return m_impl->Resources.RasterizerStates[doubleSided ? 1 : 0][wireframe ? 1 : 0][frontCounterClockWise ? 1 : 0].get();
+    }
+
+    ID3D11DepthStencilState* Resources::GetDepthStencilState(bool disableDepthWrite) const {
+        return m_impl->Resources.DepthStencilStates[m_impl->ReverseZ ? 1 : 0][disableDepthWrite ? 1 : 0].get();
+    }
+
     void Resources::SetBlendState(_In_ ID3D11DeviceContext* context, bool enabled) const {
-        context->OMSetBlendState(
-            enabled ? m_impl->Resources.AlphaBlendState.get() : m_impl->Resources.DefaultBlendState.get(), nullptr, 0xFFFFFF);
+        context->OMSetBlendState(GetBlendState(enabled), nullptr, 0xFFFFFF);
     }
 
     void Resources::SetRasterizerState(_In_ ID3D11DeviceContext* context, bool doubleSided, bool wireframe) const {
-        context->RSSetState(m_impl->Resources
-                                .RasterizerStates[doubleSided ? 1 : 0][wireframe ? 1 : 0]
-                                                 [m_impl->WindingOrder == FrontFaceWindingOrder::CounterClockWise ? 1 : 0]
-                                .get());
+        context->RSSetState(GetRasterizerState(doubleSided, wireframe));
     }
 
     void Resources::SetDepthStencilState(_In_ ID3D11DeviceContext* context, bool disableDepthWrite) const {
-        context->OMSetDepthStencilState(m_impl->Resources.DepthStencilStates[m_impl->ReverseZ ? 1 : 0][disableDepthWrite ? 1 : 0].get(), 1);
+        context->OMSetDepthStencilState(GetDepthStencilState(disableDepthWrite), 1);
     }
 } // namespace Pbr
@@ -3,6 +3,7 @@
 // Licensed under the MIT License. See License.txt in the project root for license information.
 #pragma once
 
+#include <chrono>
 #include <vector>
 #include <map>
 #include <memory>
@@ -59,8 +60,19 @@ namespace Pbr {
         CounterClockWise,
     };
 
+    // A range of one of the dynamic ring buffers of the resources. The range only holds its data for the frame it was written in,
+    // afterwards the space is reused for other data once the GPU has finished that frame.
+    struct DynamicBufferRange {
+        winrt::com_ptr<ID3D11Buffer> Buffer;
+        UINT Offset{0};
+        uint64_t FrameIndex{0};
+    };
+
     // Global PBR resources required for rendering a scene.
     struct Resources final {
+        // Number of views the shaders can render in one draw call with view instancing.
+        static constexpr uint32_t MaxViewInstanceCount = 2;
+
         explicit Resources(_In_ ID3D11Device* d3dDevice);
         Resources(Resources&&);
 
@@ -95,10 +107,25 @@ namespace Pbr {
         // Set the current view and projection matrices.
         void XM_CALLCONV SetViewProjection(DirectX::FXMMATRIX view, DirectX::CXMMATRIX projection);
 
+        // True if the device can render several views in one draw call, by selecting the render target array slice from the vertex
+        // shader (VPRT). Otherwise each view must be rendered separately with SetViewProjection.
+        bool SupportsViewInstancing() const;
+
+        // Set the view and projection matrices of up to MaxViewInstanceCount views. Each draw call then renders all views, view i
+        // into slice i of the bound render target array. Requires SupportsViewInstancing.
+        void SetViewProjections(const DirectX::XMMATRIX* views, const DirectX::XMMATRIX* projections, uint32_t viewCount);
+
+        // The number of instances of each draw call, one per view set by SetViewProjection(s).
+        uint32_t GetViewInstanceCount() const;
+
         // Many 1x1 pixel colored textures are used in the PBR system. This is used to create textures backed by a cache to reduce the
         // number of textures created.
         winrt::com_ptr<ID3D11ShaderResourceView> CreateSolidColorTexture(RGBAColor color) const;
 
+        // Start a new frame. Dynamic geometry and per-object constants are written to ring buffers, and the space written during a
+        // frame is reused once the GPU has finished that frame. Call this once per frame on the rendering thread before rendering.
+        void BeginFrame(_In_ ID3D11DeviceContext* context);
+
         // Bind the the PBR resources to the current context.
         void Bind(_In_ ID3D11DeviceContext* context) const;
 
@@ -119,8 +146,20 @@ namespace Pbr {
         void SetBlendState(_In_ ID3D11DeviceContext* context, bool enabled) const;
         void SetRasterizerState(_In_ ID3D11DeviceContext* context, bool doubleSided, bool wireframe) const;
         void SetDepthStencilState(_In_ ID3D11DeviceContext* context, bool disableDepthWrite) const;
+        ID3D11BlendState* GetBlendState(bool enabled) const;
+        ID3D11RasterizerState* GetRasterizerState(bool doubleSided, bool wireframe) const;
+        ID3D11DepthStencilState* GetDepthStencilState(bool disableDepthWrite) const;
+        void BindShaders(_In_ ID3D11DeviceContext* context, ShadingMode shading) const;
+
+        enum class DynamicBufferType { Vertex, Index, Constant, Count };
+
+        // Write data to a new range of a dynamic ring buffer, valid until the end of the current frame.
+        DynamicBufferRange WriteDynamicBuffer(_In_ ID3D11DeviceContext* context, DynamicBufferType type, const void* data, UINT size) const;
+        uint64_t GetFrameIndex() const;
 
         friend struct Material;
+        friend struct Primitive;
+        friend class RenderQueue;
 
         struct Impl;
         std::unique_ptr<Impl> m_impl;
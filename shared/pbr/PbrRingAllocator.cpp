@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include <stdexcept>
+#include "PbrRingAllocator.h"
+
+namespace {
+    uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+} // namespace
+
+namespace Pbr {
+    RingAllocator::RingAllocator(uint64_t capacity)
+        : m_capacity(capacity) {
+    }
+
+    std::optional<uint64_t> RingAllocator::Allocate(uint64_t size, uint64_t alignment) {
+        if (size == 0 || size > m_capacity || alignment == 0) {
+            return std::nullopt;
+        }
+
+        if (m_usedSize == 0 && m_head != 0) {
+            // Nothing is in use, so start over at the beginning for the largest contiguous free space. Frames still pending
+            // made no allocations since the last retired frame, so their markers are moved to the new head as well.
+            m_head = m_tail = 0;
+            for (FrameMarker& frame : m_pendingFrames) {
+                frame.Head = 0;
+            }
+        }
+
+        uint64_t offset = AlignUp(m_head, alignment);
+        uint64_t consumed;
+        if (m_head >= m_tail && m_usedSize < m_capacity) {
+            // The free space is [head, capacity) followed by [0, tail).
+            if (offset + size <= m_capacity) {
+                consumed = offset + size - m_head;
+            } else if (size <= m_tail) {
+                // Skip the rest of the buffer and wrap around to the beginning, which is aligned for any alignment.
+                offset = 0;
+                consumed = m_capacity - m_head + size;
+            } else {
+                return std::nullopt;
+            }
+        } else if (m_head < m_tail && offset + size <= m_tail) {
+            // The free space is [head, tail).
+            consumed = offset + size - m_head;
+        } else {
+            return std::nullopt;
+        }
+
+        m_head = offset + size == m_capacity ? 0 : offset + size;
+        m_usedSize += consumed;
+        m_allocatedTotal += consumed;
+        return offset;
+    }
+
+    void RingAllocator::FinishFrame(uint64_t frameIndex) {
+        if (!m_pendingFrames.empty() && m_pendingFrames.back().FrameIndex >= frameIndex) {
+            throw std::invalid_argument("Frame indices must increase");
+        }
+        m_pendingFrames.push_back(FrameMarker{frameIndex, m_head, m_allocatedTotal});
+    }
+
+    void RingAllocator::RetireFrames(uint64_t completedFrameIndex) {
+        while (!m_pendingFrames.empty() && m_pendingFrames.front().FrameIndex <= completedFrameIndex) {
+            const FrameMarker& frame = m_pendingFrames.front();
+            m_tail = frame.Head;
+            m_usedSize = m_allocatedTotal - frame.AllocatedTotal;
+            m_pendingFrames.pop_front();
+        }
+    }
+
+    std::optional<uint64_t> RingAllocator::GetOldestPendingFrame() const {
+        if (m_pendingFrames.empty()) {
+            return std::nullopt;
+        }
+        return m_pendingFrames.front().FrameIndex;
+    }
+} // namespace Pbr
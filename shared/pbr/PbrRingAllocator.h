@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace Pbr {
+    // Hands out offsets into a buffer of fixed capacity in allocation order, wrapping around at the end. Space is not freed per
+    // allocation: FinishFrame marks the allocations made so far as belonging to a frame, and RetireFrames frees all allocations of
+    // the frames the GPU has finished with. The allocator only does the bookkeeping and never touches the buffer itself.
+    class RingAllocator final {
+    public:
+        explicit RingAllocator(uint64_t capacity);
+
+        // Returns the offset of a range of the given size and alignment, or nullopt if the free space has no contiguous range
+        // large enough. Space skipped for alignment or at the end of the buffer stays in use until the frame retires.
+        std::optional<uint64_t> Allocate(uint64_t size, uint64_t alignment = 1);
+
+        // Assign the allocations made since the previous call to the given frame. Frame indices must increase.
+        void FinishFrame(uint64_t frameIndex);
+
+        // Free the allocations of all finished frames up to and including the given frame.
+        void RetireFrames(uint64_t completedFrameIndex);
+
+        // The oldest frame that was finished but not yet retired, if any.
+        std::optional<uint64_t> GetOldestPendingFrame() const;
+
+        uint64_t GetCapacity() const {
+            return m_capacity;
+        }
+
+        // Bytes in use by pending frames and the current frame, including space skipped for alignment or wrapping.
+        uint64_t GetUsedSize() const {
+            return m_usedSize;
+        }
+
+    private:
+        struct FrameMarker {
+            uint64_t FrameIndex;
+            uint64_t Head;           // Head at the end of the frame, which becomes the tail once the frame retires.
+            uint64_t AllocatedTotal; // Total bytes consumed up to the end of the frame.
+        };
+
+        const uint64_t m_capacity;
+        uint64_t m_head{0}; // Where the next allocation starts.
+        uint64_t m_tail{0}; // Start of the oldest allocation in use.
+        uint64_t m_usedSize{0};
+        uint64_t m_allocatedTotal{0};
+        std::deque<FrameMarker> m_pendingFrames;
+    };
+} // namespace Pbr
@@ -9,4 +9,7 @@ struct PSInputFlat
     float4 PositionProj : SV_POSITION;
     float3 PositionWorld: POSITION1;
     nointerpolation float3 NormalWorld : Normal;
+#ifdef VIEW_INSTANCING
+    uint RenderTargetArrayIndex : SV_RenderTargetArrayIndex; // Not read by the pixel shader, so it is last.
+#endif
 };
\ No newline at end of file
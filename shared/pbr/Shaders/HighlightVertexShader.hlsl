@@ -20,6 +20,9 @@ struct VSInputFlat
     float4      Color0              : COLOR0;
     float2      TexCoord0           : TEXCOORD0;
     min16uint   ModelTransformIndex : TRANSFORMINDEX;
+#ifdef VIEW_INSTANCING
+    uint        InstanceId          : SV_InstanceID;
+#endif
 };
 
 #define VSOutputFlat PSInputFlat
@@ -27,9 +30,16 @@ VSOutputFlat main(VSInputFlat input)
 {
     VSOutputFlat output;
 
+#ifdef VIEW_INSTANCING
+    const uint viewIndex = input.InstanceId;
+    output.RenderTargetArrayIndex = viewIndex;
+#else
+    const uint viewIndex = 0;
+#endif
+
     const float4x4 modelTransform = mul(Transforms[input.ModelTransformIndex], ModelToWorld);
     const float4 transformedPosWorld = mul(input.Position, modelTransform);
-    output.PositionProj = mul(transformedPosWorld, ViewProjection);
+    output.PositionProj = mul(transformedPosWorld, ViewProjection[viewIndex]);
     output.PositionWorld = transformedPosWorld.xyz / transformedPosWorld.w;
     output.NormalWorld = mul(input.Normal, (float3x3)modelTransform).xyz;
 
@@ -123,7 +123,7 @@ float4 main(PSInputPbr input) : SV_TARGET
     float3 n = 2.0 * NormalTexture.Sample(NormalSampler, input.TexCoord0) - 1.0;
     n = normalize(mul(n * float3(NormalScale, NormalScale, 1.0), input.TBN));
 
-    const float3 v = normalize(EyePosition - input.PositionWorld);   // Vector from surface point to camera
+    const float3 v = normalize(EyePosition[input.ViewIndex].xyz - input.PositionWorld); // Vector from surface point to camera
     const float3 l = normalize(LightDirection);                           // Vector from surface point to light
     const float3 h = normalize(l + v);                                    // Half vector between both l and v
     const float3 reflection = -normalize(reflect(v, n));
@@ -11,4 +11,8 @@ struct PSInputPbr
     float3x3 TBN        : TANGENT;
     float2 TexCoord0    : TEXCOORD0;
     float4 Color0       : COLOR0;
+    nointerpolation uint ViewIndex : VIEWINDEX;
+#ifdef VIEW_INSTANCING
+    uint RenderTargetArrayIndex : SV_RenderTargetArrayIndex; // Not read by the pixel shader, so it is last.
+#endif
 };
\ No newline at end of file
@@ -34,6 +34,9 @@ struct VSInputPbr
     float4      Color0              : COLOR0;
     float2      TexCoord0           : TEXCOORD0;
     min16uint   ModelTransformIndex : TRANSFORMINDEX;
+#ifdef VIEW_INSTANCING
+    uint        InstanceId          : SV_InstanceID;
+#endif
 };
 
 #define VSOutputPbr PSInputPbr
@@ -41,9 +44,18 @@ VSOutputPbr main(VSInputPbr input)
 {
     VSOutputPbr output;
 
+#ifdef VIEW_INSTANCING
+    // Each instance renders the primitive into the render target array slice of one view.
+    const uint viewIndex = input.InstanceId;
+    output.RenderTargetArrayIndex = viewIndex;
+#else
+    const uint viewIndex = 0;
+#endif
+    output.ViewIndex = viewIndex;
+
     const float4x4 modelTransform = mul(Transforms[input.ModelTransformIndex], ModelToWorld);
     const float4 transformedPosWorld = mul(input.Position, modelTransform);
-    output.PositionProj = mul(transformedPosWorld, ViewProjection);
+    output.PositionProj = mul(transformedPosWorld, ViewProjection[viewIndex]);
     output.PositionWorld = transformedPosWorld.xyz / transformedPosWorld.w;
 
     const float3 normalW = normalize(mul(float4(input.Normal, 0.0), modelTransform).xyz);
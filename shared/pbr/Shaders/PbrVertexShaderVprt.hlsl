@@ -0,0 +1,8 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+//
+// The PbrVertexShader with view instancing, for GPUs that can output SV_RenderTargetArrayIndex from the vertex shader (VPRT).
+
+#define VIEW_INSTANCING
+#include "PbrVertexShader.hlsl"
@@ -2,13 +2,17 @@
 // Copyright (C) Microsoft Corporation.  All Rights Reserved
 // Licensed under the MIT License. See License.txt in the project root for license information.
 
+// Up to two views are rendered by one draw call with view instancing, where the instance ID selects the view.
+// Without view instancing, only the first view is used.
+#define MAX_VIEW_INSTANCE_COUNT 2
+
 cbuffer SceneBuffer : register(b0)
 {
-    float4x4 ViewProjection     : packoffset(c0);
-    float3 EyePosition          : packoffset(c4);
-    float3 LightDirection       : packoffset(c5);
-    float3 LightColor           : packoffset(c6);
-    int NumSpecularMipLevels    : packoffset(c7);
-    float3 HighlightPosition    : packoffset(c8);
-    float AnimationTime         : packoffset(c9);
+    float4x4 ViewProjection[MAX_VIEW_INSTANCE_COUNT]    : packoffset(c0);
+    float4 EyePosition[MAX_VIEW_INSTANCE_COUNT]         : packoffset(c8);
+    float3 LightDirection                               : packoffset(c10);
+    float3 LightColor                                   : packoffset(c11);
+    int NumSpecularMipLevels                            : packoffset(c12);
+    float3 HighlightPosition                            : packoffset(c13);
+    float AnimationTime                                 : packoffset(c14);
 };
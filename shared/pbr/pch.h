@@ -5,12 +5,15 @@
 
 #define NOMINMAX
 
+#include <array>
+#include <deque>
 #include <memory>
 #include <numeric>
 #include <optional>
 #include <string>
 #include <chrono>
 #include <mutex>
+#include <thread>
 
 #include <DirectXMath.h>
 
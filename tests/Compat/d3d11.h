@@ -0,0 +1,239 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// The part of the D3D11 API the pbr sources refer to, so they compile where the Windows SDK is not available. The interfaces
+// are abstract like the real ones and nothing implements them, so tests can only run code that takes no device or context.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+using UINT = uint32_t;
+using INT = int32_t;
+using BOOL = int32_t;
+using FLOAT = float;
+using BYTE = uint8_t;
+using SIZE_T = size_t;
+using HRESULT = int32_t;
+using LPCSTR = const char*;
+
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define S_OK ((HRESULT)0)
+
+template <typename T, size_t Count>
+constexpr size_t CompatCountOf(const T (&)[Count]) {
+    return Count;
+}
+#define _countof(array) CompatCountOf(array)
+
+inline uint32_t InterlockedIncrement(volatile uint32_t* value) {
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+enum DXGI_FORMAT {
+    DXGI_FORMAT_UNKNOWN = 0,
+    DXGI_FORMAT_R32G32B32A32_FLOAT = 2,
+    DXGI_FORMAT_R32G32B32_FLOAT = 6,
+    DXGI_FORMAT_R32G32_FLOAT = 16,
+    DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+    DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+    DXGI_FORMAT_R32_UINT = 42,
+    DXGI_FORMAT_R16_UINT = 57,
+};
+
+struct DXGI_SAMPLE_DESC {
+    UINT Count;
+    UINT Quality;
+};
+
+enum D3D11_USAGE { D3D11_USAGE_DEFAULT = 0, D3D11_USAGE_IMMUTABLE = 1, D3D11_USAGE_DYNAMIC = 2, D3D11_USAGE_STAGING = 3 };
+enum D3D11_BIND_FLAG {
+    D3D11_BIND_VERTEX_BUFFER = 0x1,
+    D3D11_BIND_INDEX_BUFFER = 0x2,
+    D3D11_BIND_CONSTANT_BUFFER = 0x4,
+    D3D11_BIND_SHADER_RESOURCE = 0x8,
+};
+enum D3D11_CPU_ACCESS_FLAG { D3D11_CPU_ACCESS_WRITE = 0x10000, D3D11_CPU_ACCESS_READ = 0x20000 };
+enum D3D11_RESOURCE_MISC_FLAG { D3D11_RESOURCE_MISC_TEXTURECUBE = 0x4, D3D11_RESOURCE_MISC_BUFFER_STRUCTURED = 0x40 };
+enum D3D11_SRV_DIMENSION {
+    D3D11_SRV_DIMENSION_BUFFER = 1,
+    D3D11_SRV_DIMENSION_TEXTURE2D = 4,
+    D3D11_SRV_DIMENSION_TEXTURECUBE = 9,
+};
+enum D3D11_TEXTURE_ADDRESS_MODE {
+    D3D11_TEXTURE_ADDRESS_WRAP = 1,
+    D3D11_TEXTURE_ADDRESS_MIRROR = 2,
+    D3D11_TEXTURE_ADDRESS_CLAMP = 3,
+};
+enum D3D11_FILTER { D3D11_FILTER_MIN_MAG_MIP_LINEAR = 0x15 };
+enum D3D11_COMPARISON_FUNC { D3D11_COMPARISON_NEVER = 1 };
+enum D3D11_INPUT_CLASSIFICATION { D3D11_INPUT_PER_VERTEX_DATA = 0, D3D11_INPUT_PER_INSTANCE_DATA = 1 };
+enum D3D11_MAP { D3D11_MAP_WRITE_DISCARD = 4 };
+constexpr UINT D3D11_APPEND_ALIGNED_ELEMENT = 0xffffffff;
+
+struct D3D11_INPUT_ELEMENT_DESC {
+    LPCSTR SemanticName;
+    UINT SemanticIndex;
+    DXGI_FORMAT Format;
+    UINT InputSlot;
+    UINT AlignedByteOffset;
+    D3D11_INPUT_CLASSIFICATION InputSlotClass;
+    UINT InstanceDataStepRate;
+};
+
+struct D3D11_SUBRESOURCE_DATA {
+    const void* pSysMem;
+    UINT SysMemPitch;
+    UINT SysMemSlicePitch;
+};
+
+struct D3D11_MAPPED_SUBRESOURCE {
+    void* pData;
+    UINT RowPitch;
+    UINT DepthPitch;
+};
+
+struct D3D11_BOX {
+    UINT left, top, front, right, bottom, back;
+};
+
+struct D3D11_BUFFER_DESC {
+    UINT ByteWidth;
+    D3D11_USAGE Usage;
+    UINT BindFlags;
+    UINT CPUAccessFlags;
+    UINT MiscFlags;
+    UINT StructureByteStride;
+};
+
+struct CD3D11_BUFFER_DESC : D3D11_BUFFER_DESC {
+    explicit CD3D11_BUFFER_DESC(
+        UINT byteWidth, UINT bindFlags, D3D11_USAGE usage = D3D11_USAGE_DEFAULT, UINT cpuAccessFlags = 0, UINT miscFlags = 0, UINT stride = 0)
+        : D3D11_BUFFER_DESC{byteWidth, usage, bindFlags, cpuAccessFlags, miscFlags, stride} {
+    }
+};
+
+struct D3D11_TEXTURE2D_DESC {
+    UINT Width;
+    UINT Height;
+    UINT MipLevels;
+    UINT ArraySize;
+    DXGI_FORMAT Format;
+    DXGI_SAMPLE_DESC SampleDesc;
+    D3D11_USAGE Usage;
+    UINT BindFlags;
+    UINT CPUAccessFlags;
+    UINT MiscFlags;
+};
+
+struct D3D11_SHADER_RESOURCE_VIEW_DESC {
+    DXGI_FORMAT Format;
+    D3D11_SRV_DIMENSION ViewDimension;
+    union {
+        struct {
+            union {
+                UINT FirstElement;
+                UINT ElementOffset;
+            };
+            union {
+                UINT NumElements;
+                UINT ElementWidth;
+            };
+        } Buffer;
+        struct {
+            UINT MostDetailedMip;
+            UINT MipLevels;
+        } Texture2D;
+        struct {
+            UINT MostDetailedMip;
+            UINT MipLevels;
+        } TextureCube;
+    };
+};
+
+struct D3D11_SAMPLER_DESC {
+    D3D11_FILTER Filter;
+    D3D11_TEXTURE_ADDRESS_MODE AddressU;
+    D3D11_TEXTURE_ADDRESS_MODE AddressV;
+    D3D11_TEXTURE_ADDRESS_MODE AddressW;
+    FLOAT MipLODBias;
+    UINT MaxAnisotropy;
+    D3D11_COMPARISON_FUNC ComparisonFunc;
+    FLOAT BorderColor[4];
+    FLOAT MinLOD;
+    FLOAT MaxLOD;
+};
+
+struct CD3D11_DEFAULT {};
+
+struct CD3D11_SAMPLER_DESC : D3D11_SAMPLER_DESC {
+    explicit CD3D11_SAMPLER_DESC(CD3D11_DEFAULT)
+        : D3D11_SAMPLER_DESC{D3D11_FILTER_MIN_MAG_MIP_LINEAR,
+                             D3D11_TEXTURE_ADDRESS_CLAMP,
+                             D3D11_TEXTURE_ADDRESS_CLAMP,
+                             D3D11_TEXTURE_ADDRESS_CLAMP,
+                             0,
+                             1,
+                             D3D11_COMPARISON_NEVER,
+                             {1, 1, 1, 1},
+                             -3.402823466e+38f,
+                             3.402823466e+38f} {
+    }
+};
+
+struct IUnknown {
+    virtual UINT AddRef() = 0;
+    virtual UINT Release() = 0;
+
+protected:
+    ~IUnknown() = default;
+};
+
+struct ID3D11DeviceChild : IUnknown {};
+struct ID3D11Resource : ID3D11DeviceChild {};
+struct ID3D11Buffer : ID3D11Resource {};
+struct ID3D11Texture2D : ID3D11Resource {};
+struct ID3D11View : ID3D11DeviceChild {};
+struct ID3D11ShaderResourceView : ID3D11View {};
+struct ID3D11RenderTargetView : ID3D11View {};
+struct ID3D11DepthStencilView : ID3D11View {};
+struct ID3D11SamplerState : ID3D11DeviceChild {};
+struct ID3D11BlendState : ID3D11DeviceChild {};
+struct ID3D11DepthStencilState : ID3D11DeviceChild {};
+struct ID3D11RasterizerState : ID3D11DeviceChild {};
+struct ID3D11InputLayout : ID3D11DeviceChild {};
+struct ID3D11VertexShader : ID3D11DeviceChild {};
+struct ID3D11PixelShader : ID3D11DeviceChild {};
+struct ID3D11GeometryShader : ID3D11DeviceChild {};
+struct ID3D11ClassInstance : ID3D11DeviceChild {};
+
+struct ID3D11Device : IUnknown {
+    virtual HRESULT CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Buffer** buffer) = 0;
+    virtual HRESULT CreateTexture2D(const D3D11_TEXTURE2D_DESC* desc,
+                                    const D3D11_SUBRESOURCE_DATA* initialData,
+                                    ID3D11Texture2D** texture2D) = 0;
+    virtual HRESULT CreateShaderResourceView(ID3D11Resource* resource,
+                                             const D3D11_SHADER_RESOURCE_VIEW_DESC* desc,
+                                             ID3D11ShaderResourceView** view) = 0;
+    virtual HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** samplerState) = 0;
+};
+
+struct ID3D11DeviceContext : ID3D11DeviceChild {
+    virtual void VSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views) = 0;
+    virtual void PSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views) = 0;
+    virtual void PSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers) = 0;
+    virtual void PSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers) = 0;
+    virtual void GSSetShader(ID3D11GeometryShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount) = 0;
+    virtual void OMSetBlendState(ID3D11BlendState* blendState, const FLOAT blendFactor[4], UINT sampleMask) = 0;
+    virtual void OMSetDepthStencilState(ID3D11DepthStencilState* depthStencilState, UINT stencilRef) = 0;
+    virtual void RSSetState(ID3D11RasterizerState* rasterizerState) = 0;
+    virtual void UpdateSubresource(ID3D11Resource* resource,
+                                   UINT subresource,
+                                   const D3D11_BOX* box,
+                                   const void* data,
+                                   UINT rowPitch,
+                                   UINT depthPitch) = 0;
+    virtual HRESULT Map(ID3D11Resource* resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags, D3D11_MAPPED_SUBRESOURCE* mapped) = 0;
+    virtual void Unmap(ID3D11Resource* resource, UINT subresource) = 0;
+};
@@ -0,0 +1,10 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// The sources under test enable the Win32 and D3D11 parts of the OpenXR headers, which need the Windows SDK. Only the platform
+// independent part is available to the tests.
+#pragma once
+
+#undef XR_USE_PLATFORM_WIN32
+#undef XR_USE_GRAPHICS_API_D3D11
+#include_next <openxr/openxr_platform.h>
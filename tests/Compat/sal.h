@@ -0,0 +1,21 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// The SAL annotations used by DirectXMath and the shared sources, which only matter to the MSVC code analysis.
+#pragma once
+
+#define _In_
+#define _In_opt_
+#define _In_z_
+#define _In_reads_(size)
+#define _In_reads_opt_(size)
+#define _In_reads_bytes_(size)
+#define _Out_
+#define _Out_opt_
+#define _Out_writes_(size)
+#define _Out_writes_bytes_(size)
+#define _Outptr_
+#define _Inout_
+#define _Success_(expression)
+#define _Analysis_assume_(expression)
+#define _Use_decl_annotations_
@@ -0,0 +1,8 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#define WINAPI_PARTITION_DESKTOP 1
+#define WINAPI_PARTITION_SYSTEM 1
+#define WINAPI_FAMILY_PARTITION(partitions) (partitions)
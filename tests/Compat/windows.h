@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// The part of windows.h and of the secure C runtime the shared sources refer to outside of the code that needs a device or an
+// OpenXR runtime.
+#pragma once
+
+#include <cstring>
+#include <d3d11.h>
+
+inline int strncpy_s(char* destination, size_t destinationSize, const char* source, size_t count) {
+    if (count >= destinationSize) {
+        return -1;
+    }
+    std::memcpy(destination, source, count);
+    destination[count] = '\0';
+    return 0;
+}
+
+template <size_t Size>
+int strcpy_s(char (&destination)[Size], const char* source) {
+    return strncpy_s(destination, Size, source, std::strlen(source));
+}
+
+inline int memcpy_s(void* destination, size_t destinationSize, const void* source, size_t count) {
+    if (count > destinationSize) {
+        return -1;
+    }
+    std::memcpy(destination, source, count);
+    return 0;
+}
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Enough of C++/WinRT for the shared headers to declare their COM members. Nothing under test creates COM objects.
+#pragma once
+
+#include <utility>
+
+namespace winrt {
+    template <typename T>
+    class com_ptr {
+    public:
+        com_ptr() noexcept = default;
+        com_ptr(std::nullptr_t) noexcept {
+        }
+
+        T* get() const noexcept {
+            return m_ptr;
+        }
+        T** put() noexcept {
+            m_ptr = nullptr;
+            return &m_ptr;
+        }
+        T* operator->() const noexcept {
+            return m_ptr;
+        }
+        explicit operator bool() const noexcept {
+            return m_ptr != nullptr;
+        }
+        bool operator==(std::nullptr_t) const noexcept {
+            return m_ptr == nullptr;
+        }
+
+    private:
+        T* m_ptr{nullptr};
+    };
+} // namespace winrt
@@ -0,0 +1,201 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <XrSceneLib/pch.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <XrSceneLib/ControllerModelCache.h>
+
+using engine::ControllerModel;
+using engine::ControllerModelCache;
+
+namespace {
+    constexpr XrControllerModelKeyMSFT Key = 0x1234;
+
+    std::shared_ptr<const ControllerModel> CreateModel(XrControllerModelKeyMSFT key) {
+        auto model = std::make_shared<ControllerModel>();
+        model->Key = key;
+        return model;
+    }
+
+    // Stands in for the glTF data the runtime returns and for the glTF parser, which only accepts the data of a valid model.
+    const std::vector<uint8_t> ValidGltf{'g', 'l', 'T', 'F', 1, 2, 3};
+
+    void ParseGltf(const std::vector<uint8_t>& data) {
+        if (data != ValidGltf) {
+            throw std::runtime_error("Invalid glTF data");
+        }
+    }
+
+    struct DiskCacheTest : ::testing::Test {
+        void SetUp() override {
+            Directory = std::filesystem::temp_directory_path() /
+                        fmt::format("ControllerModelCacheTests_{}", ::testing::UnitTest::GetInstance()->current_test_info()->name());
+            std::filesystem::remove_all(Directory);
+        }
+
+        void TearDown() override {
+            std::filesystem::remove_all(Directory);
+        }
+
+        // A cache as a new run of the app creates it, with the on-disk cache of the previous runs.
+        ControllerModelCache& NewRun() {
+            Cache.emplace();
+            Cache->SetDiskCacheDirectory(Directory);
+            return *Cache;
+        }
+
+        // Loads the model from the fake runtime, counting the loads.
+        bool Load(ControllerModelCache& cache) {
+            return cache.LoadGltfBinary(
+                Key,
+                [&](XrControllerModelKeyMSFT) {
+                    RuntimeLoads++;
+                    return ValidGltf;
+                },
+                ParseGltf);
+        }
+
+        std::filesystem::path CachedFile() const {
+            return Directory / fmt::format("controller_model_{:016x}.glb", Key);
+        }
+
+        std::filesystem::path Directory;
+        std::optional<ControllerModelCache> Cache;
+        uint32_t RuntimeLoads{0};
+    };
+} // namespace
+
+TEST(ControllerModelCache, LoadsEachKeyOnce) {
+    ControllerModelCache cache;
+    uint32_t loads = 0;
+    const ControllerModelCache::LoadFunction load = [&](XrControllerModelKeyMSFT key) {
+        loads++;
+        return CreateModel(key);
+    };
+
+    EXPECT_EQ(cache.Find(Key), nullptr);
+    const std::shared_ptr<const ControllerModel> model = cache.GetOrLoad(Key, load);
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ(model->Key, Key);
+    EXPECT_EQ(cache.GetOrLoad(Key, load), model);
+    EXPECT_EQ(cache.Find(Key), model);
+    EXPECT_EQ(cache.GetOrLoad(Key + 1, load)->Key, Key + 1);
+    EXPECT_EQ(loads, 2u);
+
+    const ControllerModelCache::Statistics statistics = cache.GetStatistics();
+    EXPECT_EQ(statistics.Misses, 2u);
+    EXPECT_EQ(statistics.Hits, 2u);
+}
+
+TEST(ControllerModelCache, ConcurrentCallersShareALoad) {
+    ControllerModelCache cache;
+    std::promise<void> loadStarted;
+    std::promise<void> finishLoad;
+    std::atomic<uint32_t> loads{0};
+    const ControllerModelCache::LoadFunction load = [&](XrControllerModelKeyMSFT key) {
+        if (loads++ == 0) {
+            loadStarted.set_value();
+            finishLoad.get_future().wait();
+        }
+        return CreateModel(key);
+    };
+
+    std::future<std::shared_ptr<const ControllerModel>> first = std::async(std::launch::async, [&] { return cache.GetOrLoad(Key, load); });
+    loadStarted.get_future().wait();
+    // The model is not loaded yet, Find does not wait for it.
+    EXPECT_EQ(cache.Find(Key), nullptr);
+    std::future<std::shared_ptr<const ControllerModel>> second = std::async(std::launch::async, [&] { return cache.GetOrLoad(Key, load); });
+    while (cache.GetStatistics().Hits == 0) {
+        std::this_thread::yield();
+    }
+    finishLoad.set_value();
+
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(loads, 1u);
+}
+
+TEST(ControllerModelCache, FailedLoadsAreNotCached) {
+    ControllerModelCache cache;
+    const ControllerModelCache::LoadFunction failingLoad = [](XrControllerModelKeyMSFT) -> std::shared_ptr<const ControllerModel> {
+        throw std::runtime_error("Load failed");
+    };
+    EXPECT_THROW(cache.GetOrLoad(Key, failingLoad), std::runtime_error);
+    EXPECT_EQ(cache.GetOrLoad(Key, [](XrControllerModelKeyMSFT) { return std::shared_ptr<const ControllerModel>(); }), nullptr);
+    EXPECT_EQ(cache.GetStatistics().Failures, 2u);
+
+    EXPECT_NE(cache.GetOrLoad(Key, CreateModel), nullptr);
+    EXPECT_NE(cache.Find(Key), nullptr);
+}
+
+TEST_F(DiskCacheTest, DisabledWithoutDirectory) {
+    ControllerModelCache cache;
+    cache.WriteGltfBinary(Key, ValidGltf.data(), ValidGltf.size());
+    EXPECT_FALSE(cache.ReadGltfBinary(Key).has_value());
+    EXPECT_FALSE(std::filesystem::exists(Directory));
+}
+
+TEST_F(DiskCacheTest, LaterRunsLoadFromDisk) {
+    ASSERT_TRUE(Load(NewRun()));
+    EXPECT_EQ(RuntimeLoads, 1u);
+    EXPECT_EQ(Cache->GetStatistics().DiskMisses, 1u);
+    EXPECT_TRUE(std::filesystem::exists(CachedFile()));
+
+    ASSERT_TRUE(Load(NewRun()));
+    EXPECT_EQ(RuntimeLoads, 1u);
+    EXPECT_EQ(Cache->GetStatistics().DiskHits, 1u);
+}
+
+TEST_F(DiskCacheTest, CorruptFileIsReplaced) {
+    ASSERT_TRUE(Load(NewRun()));
+
+    // A file cut short, e.g. by a full disk.
+    std::filesystem::resize_file(CachedFile(), ValidGltf.size() - 2);
+    ASSERT_TRUE(Load(NewRun()));
+    EXPECT_EQ(RuntimeLoads, 2u);
+    EXPECT_EQ(Cache->GetStatistics().DiskFailures, 1u);
+    EXPECT_EQ(Cache->ReadGltfBinary(Key), ValidGltf);
+
+    // The replaced file loads in the next run.
+    ASSERT_TRUE(Load(NewRun()));
+    EXPECT_EQ(RuntimeLoads, 2u);
+    EXPECT_EQ(Cache->GetStatistics().DiskFailures, 0u);
+}
+
+TEST_F(DiskCacheTest, FailuresOfRuntimeDataArePassedOn) {
+    ControllerModelCache& cache = NewRun();
+    const std::vector<uint8_t> invalidGltf{1, 2, 3};
+    EXPECT_THROW(cache.LoadGltfBinary(Key, [&](XrControllerModelKeyMSFT) { return invalidGltf; }, ParseGltf), std::runtime_error);
+
+    // The runtime returned no model.
+    bool parsed = false;
+    EXPECT_FALSE(cache.LoadGltfBinary(
+        Key + 1, [](XrControllerModelKeyMSFT) { return std::vector<uint8_t>(); }, [&](const std::vector<uint8_t>&) { parsed = true; }));
+    EXPECT_FALSE(parsed);
+    EXPECT_FALSE(cache.ReadGltfBinary(Key + 1).has_value());
+}
+
+TEST_F(DiskCacheTest, CachedModelsLoadThroughGetOrLoad) {
+    // How ControllerObject loads a model: the cache of loaded models calls the load function, which parses cached glTF data.
+    const ControllerModelCache::LoadFunction load = [&](XrControllerModelKeyMSFT key) -> std::shared_ptr<const ControllerModel> {
+        return Load(*Cache) ? CreateModel(key) : nullptr;
+    };
+
+    NewRun();
+    ASSERT_NE(Cache->GetOrLoad(Key, load), nullptr);
+    ASSERT_NE(Cache->GetOrLoad(Key, load), nullptr);
+    EXPECT_EQ(RuntimeLoads, 1u);
+
+    NewRun();
+    ASSERT_NE(Cache->GetOrLoad(Key, load), nullptr);
+    EXPECT_EQ(RuntimeLoads, 1u);
+    const ControllerModelCache::Statistics statistics = Cache->GetStatistics();
+    EXPECT_EQ(statistics.Misses, 1u);
+    EXPECT_EQ(statistics.DiskHits, 1u);
+}
@@ -0,0 +1,161 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <cmath>
+#include <deque>
+#include <gtest/gtest.h>
+#include <XrSceneLib/DynamicResolution.h>
+
+using engine::DynamicResolutionController;
+using Duration = DynamicResolutionController::Duration;
+
+namespace {
+    // With the default options, the target is 9 ms and the scale only goes up below 7.2 ms. Decreases aim at 8.1 ms in between.
+    constexpr Duration DisplayPeriod{10};
+    constexpr Duration Aim{8.1f};
+
+    // Renders frames whose GPU time is proportional to the number of pixels, and reports it a few frames late like a GPU timer.
+    class FrameSimulation {
+    public:
+        static constexpr size_t GpuLatencyFrames = 3;
+
+        explicit FrameSimulation(DynamicResolutionController& controller)
+            : m_controller(controller) {
+        }
+
+        // Render frames at a GPU time of fullScaleGpuTime at scale 1. Returns the number of scale changes.
+        uint32_t Run(uint32_t frameCount, Duration fullScaleGpuTime, Duration cpuTime = Duration{2}) {
+            uint32_t changes = 0;
+            for (uint32_t i = 0; i < frameCount; i++) {
+                const float scale = m_controller.GetScale();
+                m_pendingGpuTimes.push_back(fullScaleGpuTime * scale * scale);
+
+                std::optional<Duration> gpuTime;
+                if (m_pendingGpuTimes.size() > GpuLatencyFrames) {
+                    gpuTime = m_pendingGpuTimes.front();
+                    m_pendingGpuTimes.pop_front();
+                }
+                if (m_controller.Update(cpuTime, gpuTime, DisplayPeriod) != scale) {
+                    changes++;
+                }
+            }
+            return changes;
+        }
+
+    private:
+        DynamicResolutionController& m_controller;
+        std::deque<Duration> m_pendingGpuTimes;
+    };
+} // namespace
+
+TEST(DynamicResolution, StaysAtFullScaleWithinTheBudget) {
+    DynamicResolutionController controller;
+    FrameSimulation simulation(controller);
+    EXPECT_EQ(simulation.Run(500, Duration{8}), 0u);
+    EXPECT_EQ(controller.GetScale(), 1.0f);
+}
+
+TEST(DynamicResolution, DecreasesAfterTheDelay) {
+    DynamicResolutionController controller;
+    EXPECT_EQ(controller.Update(Duration{2}, Duration{12}, DisplayPeriod), 1.0f);
+    // The second frame over the target jumps to the scale expected to take 8.1 ms.
+    EXPECT_NEAR(controller.Update(Duration{2}, Duration{12}, DisplayPeriod), std::sqrt(8.1f / 12), 1e-6f);
+    EXPECT_NEAR(controller.GetSmoothedGpuFrameTime().count(), Aim.count(), 1e-4f);
+}
+
+TEST(DynamicResolution, SmoothingAbsorbsASpike) {
+    DynamicResolutionController controller;
+    FrameSimulation simulation(controller);
+    simulation.Run(100, Duration{8});
+    EXPECT_EQ(controller.Update(Duration{2}, Duration{12}, DisplayPeriod), 1.0f);
+    EXPECT_EQ(simulation.Run(100, Duration{8}), 0u);
+    EXPECT_EQ(controller.GetScale(), 1.0f);
+}
+
+// The scale settles at the first decrease, instead of moving back and forth around the target.
+TEST(DynamicResolution, SettlesWithoutOscillating) {
+    DynamicResolutionController controller;
+    FrameSimulation simulation(controller);
+    EXPECT_EQ(simulation.Run(2000, Duration{12}), 1u);
+    EXPECT_NEAR(controller.GetScale(), std::sqrt(8.1f / 12), 1e-6f);
+
+    // A load just above the target, where the scale after the decrease is close to the increase threshold.
+    DynamicResolutionController nearTarget;
+    FrameSimulation nearTargetSimulation(nearTarget);
+    EXPECT_EQ(nearTargetSimulation.Run(2000, Duration{9.5f}), 1u);
+}
+
+TEST(DynamicResolution, IncreasesStepByStepWhenTheLoadDrops) {
+    DynamicResolutionController controller;
+    FrameSimulation simulation(controller);
+    simulation.Run(100, Duration{16});
+    const float lowScale = controller.GetScale();
+    EXPECT_NEAR(lowScale, std::sqrt(8.1f / 16), 1e-6f);
+
+    // At a third of the load the scale goes back up, by at most 5% per step and only after 30 frames under the threshold.
+    const Duration lightLoad{16.0f / 3};
+    EXPECT_EQ(simulation.Run(30, lightLoad), 0u);
+    float previousScale = controller.GetScale();
+    uint32_t increases = 0;
+    for (uint32_t frame = 0; frame < 1000 && controller.GetScale() < 1.0f; frame++) {
+        simulation.Run(1, lightLoad);
+        if (controller.GetScale() != previousScale) {
+            EXPECT_LE(controller.GetScale(), previousScale * 1.05f + 1e-6f);
+            increases++;
+        }
+        previousScale = controller.GetScale();
+    }
+    EXPECT_EQ(controller.GetScale(), 1.0f);
+    EXPECT_EQ(increases, 7u);
+}
+
+TEST(DynamicResolution, CpuTimeOnlyHoldsBackIncreases) {
+    DynamicResolutionController controller;
+    FrameSimulation simulation(controller);
+    // The CPU time misses the display period, but a lower resolution would not help it.
+    EXPECT_EQ(simulation.Run(200, Duration{4}, Duration{15}), 0u);
+    EXPECT_EQ(controller.GetScale(), 1.0f);
+
+    simulation.Run(100, Duration{16});
+    // A steady load does not lower the scale any further.
+    EXPECT_EQ(simulation.Run(500, Duration{16}), 0u);
+    const float lowScale = controller.GetScale();
+    EXPECT_EQ(simulation.Run(500, Duration{4}, Duration{15}), 0u);
+    EXPECT_EQ(controller.GetScale(), lowScale);
+
+    EXPECT_GT(simulation.Run(500, Duration{4}), 0u);
+    EXPECT_EQ(controller.GetScale(), 1.0f);
+}
+
+TEST(DynamicResolution, ClampsToTheScaleRange) {
+    DynamicResolutionController controller;
+    FrameSimulation simulation(controller);
+    simulation.Run(100, Duration{100});
+    EXPECT_EQ(controller.GetScale(), 0.5f);
+}
+
+TEST(DynamicResolution, IgnoresFramesWithoutTimes) {
+    DynamicResolutionController controller;
+    for (uint32_t i = 0; i < 10; i++) {
+        EXPECT_EQ(controller.Update(Duration{2}, std::nullopt, DisplayPeriod), 1.0f);
+        EXPECT_EQ(controller.Update(Duration{2}, Duration{20}, Duration{0}), 1.0f);
+    }
+    EXPECT_EQ(controller.GetSmoothedGpuFrameTime().count(), 0.0f);
+}
+
+TEST(DynamicResolution, ResetStartsOverAtFullScale) {
+    DynamicResolutionController controller;
+    FrameSimulation simulation(controller);
+    simulation.Run(100, Duration{16});
+    ASSERT_LT(controller.GetScale(), 1.0f);
+
+    controller.Reset();
+    EXPECT_EQ(controller.GetScale(), 1.0f);
+    EXPECT_EQ(controller.GetSmoothedGpuFrameTime().count(), 0.0f);
+    EXPECT_EQ(controller.GetSmoothedCpuFrameTime().count(), 0.0f);
+
+    // The first frame of the new session is taken as it is, not blended with the times of the previous session.
+    EXPECT_EQ(controller.Update(Duration{3}, Duration{5}, DisplayPeriod), 1.0f);
+    EXPECT_EQ(controller.GetSmoothedGpuFrameTime().count(), 5.0f);
+    EXPECT_EQ(controller.GetSmoothedCpuFrameTime().count(), 3.0f);
+}
@@ -0,0 +1,307 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <XrSceneLib/GlyphAtlas.h>
+#include <XrSceneLib/TextLayout.h>
+
+using engine::AtlasRect;
+using engine::GlyphAtlas;
+using engine::GlyphQuad;
+using engine::TextLayout;
+
+namespace {
+    constexpr uint32_t GlyphWidth = 6;
+    constexpr uint32_t GlyphHeight = 8;
+    constexpr float GlyphAdvance = 7;
+
+    // Every glyph is a block of the same size, filled with the low byte of its codepoint. Spaces have no pixels.
+    struct FakeRasterizer final : engine::GlyphRasterizer {
+        explicit FakeRasterizer(std::vector<char32_t>& rasterized)
+            : Rasterized(rasterized) {
+        }
+
+        engine::FontMetrics GetFontMetrics() const override {
+            return {10, 3, 1};
+        }
+
+        engine::GlyphBitmap Rasterize(char32_t codepoint) override {
+            Rasterized.push_back(codepoint);
+            engine::GlyphBitmap bitmap;
+            bitmap.Advance = GlyphAdvance;
+            if (codepoint != U' ') {
+                bitmap.Width = GlyphWidth;
+                bitmap.Height = GlyphHeight;
+                bitmap.Top = GlyphHeight;
+                bitmap.Coverage.assign(GlyphWidth * GlyphHeight, static_cast<uint8_t>(codepoint));
+            }
+            return bitmap;
+        }
+
+        std::vector<char32_t>& Rasterized;
+    };
+
+    // The solid block and its padding take the first 5 rows. Below it, a glyph takes 7 pixels of a shelf including padding,
+    // and a shelf takes 9 rows, so this atlas has 2 shelves of 3 glyphs.
+    constexpr uint32_t SmallAtlasWidth = 22;
+    constexpr uint32_t SmallAtlasHeight = 23;
+    constexpr uint32_t FirstShelfY = 5;
+    constexpr uint32_t SecondShelfY = 14;
+
+    struct AtlasTest : ::testing::Test {
+        GlyphAtlas CreateAtlas(uint32_t width, uint32_t height) {
+            return GlyphAtlas(std::make_unique<FakeRasterizer>(Rasterized), width, height);
+        }
+
+        void Acquire(GlyphAtlas& atlas, std::u32string_view codepoints) {
+            for (char32_t codepoint : codepoints) {
+                ASSERT_NE(atlas.Acquire(codepoint), nullptr);
+            }
+        }
+
+        void Release(GlyphAtlas& atlas, std::u32string_view codepoints) {
+            for (char32_t codepoint : codepoints) {
+                atlas.Release(codepoint);
+            }
+        }
+
+        std::vector<char32_t> Rasterized;
+    };
+
+    engine::TextLayoutOptions LeadingOptions(float width, float height) {
+        engine::TextLayoutOptions options;
+        options.Width = width;
+        options.Height = height;
+        options.TextAlignment = engine::TextAlignment::Leading;
+        options.ParagraphAlignment = engine::ParagraphAlignment::Near;
+        return options;
+    }
+
+    std::vector<int32_t> GetQuadLefts(const TextLayout& layout) {
+        std::vector<int32_t> lefts;
+        for (const GlyphQuad& quad : layout.GetQuads()) {
+            lefts.push_back(quad.Left);
+        }
+        return lefts;
+    }
+
+    bool RectsEqual(const AtlasRect& a, const AtlasRect& b) {
+        return a.X == b.X && a.Y == b.Y && a.Width == b.Width && a.Height == b.Height;
+    }
+} // namespace
+
+TEST_F(AtlasTest, RasterizesEachGlyphOnce) {
+    GlyphAtlas atlas = CreateAtlas(64, 64);
+    const engine::AtlasGlyph* first = atlas.Acquire(U'a');
+    const engine::AtlasGlyph* second = atlas.Acquire(U'a');
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(Rasterized, (std::vector<char32_t>{U'a'}));
+    EXPECT_TRUE(RectsEqual(first->Rect, {0, FirstShelfY, GlyphWidth, GlyphHeight}));
+    EXPECT_EQ(atlas.GetPixels()[FirstShelfY * 64], static_cast<uint8_t>(U'a'));
+}
+
+TEST_F(AtlasTest, SpacesTakeNoPixels) {
+    GlyphAtlas atlas = CreateAtlas(64, 64);
+    const engine::AtlasGlyph* space = atlas.Acquire(U' ');
+    ASSERT_NE(space, nullptr);
+    EXPECT_EQ(space->Rect.Width, 0u);
+    EXPECT_EQ(space->Advance, GlyphAdvance);
+    EXPECT_EQ(atlas.Acquire(U'a')->Rect.X, 0u);
+}
+
+TEST_F(AtlasTest, DirtyRectCoversTheNewGlyphs) {
+    GlyphAtlas atlas = CreateAtlas(64, 64);
+    const std::optional<AtlasRect> solid = atlas.TakeDirtyRect();
+    ASSERT_TRUE(solid.has_value());
+    EXPECT_TRUE(RectsEqual(*solid, atlas.GetSolidRect()));
+    EXPECT_FALSE(atlas.TakeDirtyRect().has_value());
+
+    Acquire(atlas, U"ab");
+    const std::optional<AtlasRect> glyphs = atlas.TakeDirtyRect();
+    ASSERT_TRUE(glyphs.has_value());
+    EXPECT_TRUE(RectsEqual(*glyphs, {0, FirstShelfY, 2 * GlyphWidth + 1, GlyphHeight}));
+
+    // Glyphs already in the atlas don't change its pixels.
+    Acquire(atlas, U"ab");
+    EXPECT_FALSE(atlas.TakeDirtyRect().has_value());
+}
+
+TEST_F(AtlasTest, EvictsAShelfWithoutReferencedGlyphs) {
+    GlyphAtlas atlas = CreateAtlas(SmallAtlasWidth, SmallAtlasHeight);
+    Acquire(atlas, U"abcdef");
+    Release(atlas, U"abc");
+    atlas.TakeDirtyRect();
+
+    const engine::AtlasGlyph* glyph = atlas.Acquire(U'g');
+    ASSERT_NE(glyph, nullptr);
+    EXPECT_TRUE(RectsEqual(glyph->Rect, {0, FirstShelfY, GlyphWidth, GlyphHeight}));
+    EXPECT_EQ(atlas.GetEvictedShelfCount(), 1u);
+    EXPECT_EQ(atlas.GetGlyphCount(), 4u);
+
+    // The whole shelf is cleared and uploaded again.
+    const std::optional<AtlasRect> dirty = atlas.TakeDirtyRect();
+    ASSERT_TRUE(dirty.has_value());
+    EXPECT_TRUE(RectsEqual(*dirty, {0, FirstShelfY, SmallAtlasWidth, GlyphHeight}));
+    EXPECT_EQ(atlas.GetPixels()[FirstShelfY * SmallAtlasWidth + GlyphWidth + 1], 0);
+
+    // An evicted glyph is rasterized again when it is used again.
+    Rasterized.clear();
+    Acquire(atlas, U"a");
+    EXPECT_EQ(Rasterized, (std::vector<char32_t>{U'a'}));
+}
+
+TEST_F(AtlasTest, EvictsTheLeastRecentlyUsedShelf) {
+    GlyphAtlas atlas = CreateAtlas(SmallAtlasWidth, SmallAtlasHeight);
+    Acquire(atlas, U"abcdef");
+    Release(atlas, U"abcdef");
+
+    // Using a glyph of the first shelf again makes the second shelf the least recently used.
+    Acquire(atlas, U"a");
+    Release(atlas, U"a");
+
+    const engine::AtlasGlyph* glyph = atlas.Acquire(U'g');
+    ASSERT_NE(glyph, nullptr);
+    EXPECT_EQ(glyph->Rect.Y, SecondShelfY);
+    Rasterized.clear();
+    Acquire(atlas, U"abc");
+    EXPECT_TRUE(Rasterized.empty());
+}
+
+TEST_F(AtlasTest, KeepsReferencedGlyphs) {
+    GlyphAtlas atlas = CreateAtlas(SmallAtlasWidth, SmallAtlasHeight);
+    Acquire(atlas, U"abcdef");
+    // Each glyph is referenced twice, one release leaves it in use.
+    Acquire(atlas, U"abcdef");
+    Release(atlas, U"abcdef");
+
+    EXPECT_EQ(atlas.Acquire(U'g'), nullptr);
+    EXPECT_EQ(atlas.GetEvictedShelfCount(), 0u);
+    EXPECT_EQ(atlas.GetGlyphCount(), 6u);
+
+    Release(atlas, U"def");
+    EXPECT_NE(atlas.Acquire(U'g'), nullptr);
+    EXPECT_EQ(atlas.GetEvictedShelfCount(), 1u);
+}
+
+TEST(DecodeUtf8, DecodesMultiByteSequences) {
+    EXPECT_EQ(engine::DecodeUtf8("a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"), U"a\u00E9\u20AC\U0001F600");
+    EXPECT_EQ(engine::DecodeUtf8(""), U"");
+}
+
+TEST(DecodeUtf8, ReplacesInvalidSequences) {
+    // A lone continuation byte and a byte that never starts a sequence.
+    EXPECT_EQ(engine::DecodeUtf8("a\x80" "b\xFF"), U"a\uFFFDb\uFFFD");
+    // An overlong encoding of '/' and an encoded surrogate, each byte is replaced on its own.
+    EXPECT_EQ(engine::DecodeUtf8("\xC0\xAF"), U"\uFFFD\uFFFD");
+    EXPECT_EQ(engine::DecodeUtf8("\xED\xA0\x80"), U"\uFFFD\uFFFD\uFFFD");
+    // A sequence cut short by the end of the text, or by the next character.
+    EXPECT_EQ(engine::DecodeUtf8("a\xE2\x82"), U"a\uFFFD\uFFFD");
+    EXPECT_EQ(engine::DecodeUtf8("\xE2\x82z"), U"\uFFFD\uFFFDz");
+}
+
+TEST_F(AtlasTest, LayoutPlacesGlyphsOnTheBaseline) {
+    GlyphAtlas atlas = CreateAtlas(256, 256);
+    TextLayout layout(atlas, LeadingOptions(200, 50));
+    ASSERT_TRUE(layout.SetText("ab c"));
+
+    EXPECT_EQ(GetQuadLefts(layout), (std::vector<int32_t>{0, 7, 21}));
+    for (const GlyphQuad& quad : layout.GetQuads()) {
+        // The ascent is 10 and the glyphs reach 8 above the baseline.
+        EXPECT_EQ(quad.Top, 2);
+    }
+    EXPECT_FALSE(layout.SetText("ab c"));
+}
+
+TEST_F(AtlasTest, LayoutWrapsAtSpaces) {
+    GlyphAtlas atlas = CreateAtlas(256, 256);
+    TextLayout layout(atlas, LeadingOptions(20, 50));
+    ASSERT_TRUE(layout.SetText("ab cd"));
+
+    const std::vector<GlyphQuad>& quads = layout.GetQuads();
+    ASSERT_EQ(quads.size(), 4u);
+    EXPECT_EQ(GetQuadLefts(layout), (std::vector<int32_t>{0, 7, 0, 7}));
+    // The line height is the ascent, descent and line gap.
+    EXPECT_EQ(quads[2].Top - quads[0].Top, 14);
+}
+
+TEST_F(AtlasTest, ChangedQuadsAfterTextGrowsAndShrinks) {
+    GlyphAtlas atlas = CreateAtlas(256, 256);
+    TextLayout layout(atlas, LeadingOptions(200, 50));
+    ASSERT_TRUE(layout.SetText("abc"));
+    EXPECT_EQ(layout.GetChangedQuads(), (std::vector<size_t>{0, 1, 2}));
+    EXPECT_EQ(layout.GetPreviousQuadCount(), 0u);
+
+    // Appended glyphs are the only changes.
+    ASSERT_TRUE(layout.SetText("abcde"));
+    EXPECT_EQ(layout.GetChangedQuads(), (std::vector<size_t>{3, 4}));
+    EXPECT_EQ(layout.GetPreviousQuadCount(), 3u);
+
+    // Removed glyphs are only seen in the previous quad count.
+    ASSERT_TRUE(layout.SetText("ab"));
+    EXPECT_TRUE(layout.GetChangedQuads().empty());
+    EXPECT_EQ(layout.GetPreviousQuadCount(), 5u);
+    EXPECT_EQ(layout.GetQuads().size(), 2u);
+
+    // A different glyph in the middle changes its quad, the glyphs after it move.
+    ASSERT_TRUE(layout.SetText("axb"));
+    EXPECT_EQ(layout.GetChangedQuads(), (std::vector<size_t>{1, 2}));
+
+    // A space takes no quad, the glyph after it moves.
+    ASSERT_TRUE(layout.SetText("a b"));
+    EXPECT_EQ(layout.GetChangedQuads(), (std::vector<size_t>{1}));
+    EXPECT_EQ(layout.GetQuads().size(), 2u);
+}
+
+TEST_F(AtlasTest, CenteredTextMovesWhenItGrows) {
+    GlyphAtlas atlas = CreateAtlas(256, 256);
+    engine::TextLayoutOptions options = LeadingOptions(200, 50);
+    options.TextAlignment = engine::TextAlignment::Center;
+    TextLayout layout(atlas, options);
+    ASSERT_TRUE(layout.SetText("ab"));
+    ASSERT_TRUE(layout.SetText("abcd"));
+    EXPECT_EQ(layout.GetChangedQuads(), (std::vector<size_t>{0, 1, 2, 3}));
+}
+
+TEST_F(AtlasTest, LayoutReleasesItsGlyphs) {
+    GlyphAtlas atlas = CreateAtlas(SmallAtlasWidth, SmallAtlasHeight);
+    {
+        // The text fills the atlas, so another layout has no room while this one shows it.
+        TextLayout full(atlas, LeadingOptions(200, 50));
+        ASSERT_TRUE(full.SetText("abcdef"));
+        EXPECT_EQ(full.GetQuads().size(), 6u);
+
+        TextLayout other(atlas, LeadingOptions(200, 50));
+        ASSERT_TRUE(other.SetText("g"));
+        EXPECT_TRUE(other.GetQuads().empty());
+    }
+
+    TextLayout layout(atlas, LeadingOptions(200, 50));
+    ASSERT_TRUE(layout.SetText("g"));
+    EXPECT_EQ(layout.GetQuads().size(), 1u);
+    EXPECT_EQ(atlas.GetEvictedShelfCount(), 1u);
+}
+
+TEST_F(AtlasTest, NewTextKeepsTheGlyphsItShares) {
+    GlyphAtlas atlas = CreateAtlas(SmallAtlasWidth, SmallAtlasHeight);
+    TextLayout layout(atlas, LeadingOptions(200, 50));
+    ASSERT_TRUE(layout.SetText("abcdef"));
+
+    // The new text reuses "abc". "g" only fits once the old text released "def", in the place of "d".
+    Rasterized.clear();
+    atlas.TakeDirtyRect();
+    ASSERT_TRUE(layout.SetText("abcg"));
+    EXPECT_EQ(std::count(Rasterized.begin(), Rasterized.end(), U'g'), static_cast<ptrdiff_t>(Rasterized.size()));
+    ASSERT_EQ(layout.GetQuads().size(), 4u);
+    EXPECT_TRUE(RectsEqual(layout.GetQuads()[3].Rect, {0, SecondShelfY, GlyphWidth, GlyphHeight}));
+
+    // The quad of "g" is where the quad of "d" was, only the atlas pixels changed.
+    EXPECT_TRUE(layout.GetChangedQuads().empty());
+    const std::optional<AtlasRect> dirty = atlas.TakeDirtyRect();
+    ASSERT_TRUE(dirty.has_value());
+    EXPECT_TRUE(RectsEqual(*dirty, {0, SecondShelfY, SmallAtlasWidth, GlyphHeight}));
+}
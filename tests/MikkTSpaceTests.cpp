@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <mikktspace.h>
+
+namespace {
+    struct Vertex {
+        float Position[3];
+        float Normal[3];
+        float TexCoord[2];
+        float Tangent[4];
+    };
+
+    struct Mesh {
+        std::vector<Vertex> Vertices;
+        std::vector<uint32_t> Indices;
+    };
+
+    // A grid in the XY plane facing +Z, with U along +X and V along +Y. The noise makes every vertex its own tangent space.
+    Mesh CreateGrid(uint32_t sideLength, float noise, uint32_t seed) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> offset(-noise, noise);
+        Mesh mesh;
+        for (uint32_t y = 0; y <= sideLength; y++) {
+            for (uint32_t x = 0; x <= sideLength; x++) {
+                Vertex vertex{};
+                vertex.Position[0] = x + offset(random);
+                vertex.Position[1] = y + offset(random);
+                vertex.Position[2] = offset(random);
+                vertex.Normal[0] = offset(random);
+                vertex.Normal[2] = 1;
+                vertex.TexCoord[0] = static_cast<float>(x) / sideLength;
+                vertex.TexCoord[1] = static_cast<float>(y) / sideLength + offset(random);
+                mesh.Vertices.push_back(vertex);
+            }
+        }
+        for (uint32_t y = 0; y < sideLength; y++) {
+            for (uint32_t x = 0; x < sideLength; x++) {
+                const uint32_t a = y * (sideLength + 1) + x;
+                const uint32_t c = a + sideLength + 1;
+                mesh.Indices.insert(mesh.Indices.end(), {a, a + 1, c, a + 1, c + 1, c});
+            }
+        }
+        return mesh;
+    }
+
+    const Vertex& GetVertex(const SMikkTSpaceContext* context, int face, int vertex) {
+        const Mesh& mesh = *static_cast<const Mesh*>(context->m_pUserData);
+        return mesh.Vertices[mesh.Indices[face * 3 + vertex]];
+    }
+
+    void GenerateTangents(Mesh& mesh) {
+        SMikkTSpaceInterface mikkInterface{};
+        mikkInterface.m_getNumFaces = [](const SMikkTSpaceContext* context) {
+            return static_cast<int>(static_cast<const Mesh*>(context->m_pUserData)->Indices.size() / 3);
+        };
+        mikkInterface.m_getNumVerticesOfFace = [](const SMikkTSpaceContext*, int) { return 3; };
+        mikkInterface.m_getPosition = [](const SMikkTSpaceContext* context, float out[], int face, int vertex) {
+            std::memcpy(out, GetVertex(context, face, vertex).Position, sizeof(float) * 3);
+        };
+        mikkInterface.m_getNormal = [](const SMikkTSpaceContext* context, float out[], int face, int vertex) {
+            std::memcpy(out, GetVertex(context, face, vertex).Normal, sizeof(float) * 3);
+        };
+        mikkInterface.m_getTexCoord = [](const SMikkTSpaceContext* context, float out[], int face, int vertex) {
+            std::memcpy(out, GetVertex(context, face, vertex).TexCoord, sizeof(float) * 2);
+        };
+        mikkInterface.m_setTSpaceBasic = [](const SMikkTSpaceContext* context, const float tangent[], float sign, int face, int vertex) {
+            Vertex& target = const_cast<Vertex&>(GetVertex(context, face, vertex));
+            std::memcpy(target.Tangent, tangent, sizeof(float) * 3);
+            target.Tangent[3] = sign;
+        };
+
+        SMikkTSpaceContext context{&mikkInterface, &mesh};
+        ASSERT_TRUE(genTangSpaceDefault(&context));
+    }
+
+    std::vector<Mesh> CreateGrids(size_t count, uint32_t sideLength) {
+        std::vector<Mesh> meshes;
+        for (uint32_t i = 0; i < count; i++) {
+            meshes.push_back(CreateGrid(sideLength, 0.01f, i));
+        }
+        return meshes;
+    }
+
+    bool TangentsEqual(const std::vector<Mesh>& a, const std::vector<Mesh>& b) {
+        for (size_t mesh = 0; mesh < a.size(); mesh++) {
+            for (size_t vertex = 0; vertex < a[mesh].Vertices.size(); vertex++) {
+                if (std::memcmp(a[mesh].Vertices[vertex].Tangent, b[mesh].Vertices[vertex].Tangent, sizeof(float) * 4) != 0) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+} // namespace
+
+TEST(MikkTSpace, TangentsFollowTheTextureU) {
+    Mesh mesh = CreateGrid(8, 0, 0);
+    GenerateTangents(mesh);
+    genTangSpaceReleaseScratch();
+    for (const Vertex& vertex : mesh.Vertices) {
+        EXPECT_NEAR(vertex.Tangent[0], 1.0f, 1e-5f);
+        EXPECT_NEAR(vertex.Tangent[1], 0.0f, 1e-5f);
+        EXPECT_NEAR(vertex.Tangent[2], 0.0f, 1e-5f);
+        EXPECT_EQ(vertex.Tangent[3], 1.0f);
+    }
+}
+
+// Reusing or freeing the scratch memory between meshes of different sizes does not change the tangents.
+TEST(MikkTSpace, ScratchReuseKeepsTheTangents) {
+    std::vector<Mesh> fresh;
+    std::vector<Mesh> reused;
+    for (uint32_t sideLength : {40, 5, 60, 20}) {
+        fresh.push_back(CreateGrid(sideLength, 0.01f, sideLength));
+        reused.push_back(fresh.back());
+    }
+
+    for (Mesh& mesh : fresh) {
+        GenerateTangents(mesh);
+        genTangSpaceReleaseScratch();
+    }
+    for (Mesh& mesh : reused) {
+        GenerateTangents(mesh);
+    }
+    genTangSpaceReleaseScratch();
+    EXPECT_TRUE(TangentsEqual(fresh, reused));
+}
+
+// Threads generating tangents at the same time each use their own scratch memory.
+TEST(MikkTSpace, ThreadsGiveTheSameTangents) {
+    std::vector<Mesh> serial = CreateGrids(16, 30);
+    std::vector<Mesh> parallel = serial;
+    for (Mesh& mesh : serial) {
+        GenerateTangents(mesh);
+    }
+    genTangSpaceReleaseScratch();
+
+    constexpr size_t ThreadCount = 4;
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < ThreadCount; thread++) {
+        threads.emplace_back([&parallel, thread] {
+            for (size_t i = thread; i < parallel.size(); i += ThreadCount) {
+                GenerateTangents(parallel[i]);
+            }
+            genTangSpaceReleaseScratch();
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_TRUE(TangentsEqual(serial, parallel));
+}
+
+// Reports the time per mesh when the scratch memory is kept between meshes, as GltfHelper::ReadPrimitives does, and when it
+// is freed after every mesh, which costs the same heap allocations as a thread generating its first mesh.
+TEST(MikkTSpace, BenchmarkScratchReuse) {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    constexpr size_t MeshCount = 400;
+    std::vector<Mesh> kept = CreateGrids(MeshCount, 16);
+    std::vector<Mesh> freed = kept;
+
+    auto start = std::chrono::steady_clock::now();
+    for (Mesh& mesh : kept) {
+        GenerateTangents(mesh);
+    }
+    genTangSpaceReleaseScratch();
+    const Milliseconds keptDuration = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (Mesh& mesh : freed) {
+        GenerateTangents(mesh);
+        genTangSpaceReleaseScratch();
+    }
+    const Milliseconds freedDuration = std::chrono::steady_clock::now() - start;
+
+    std::cout << "[ BENCHMARK] " << MeshCount << " meshes of 512 triangles, ms per mesh: scratch kept "
+              << keptDuration.count() / MeshCount << ", scratch freed " << freedDuration.count() / MeshCount << std::endl;
+    EXPECT_TRUE(TangentsEqual(kept, freed));
+}
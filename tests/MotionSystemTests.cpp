@@ -0,0 +1,306 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <XrSceneLib/pch.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <gtest/gtest.h>
+#include <XrSceneLib/MotionSystem.h>
+
+using namespace DirectX;
+using engine::MotionSystem;
+using Seconds = std::chrono::duration<float>;
+
+namespace {
+    // A time step and frame durations that are exact in binary, so the accumulated time has no rounding error and the number
+    // of steps of an update does not depend on the order of the frames.
+    constexpr Seconds TimeStep{1.0f / 128};
+    constexpr uint32_t MaxStepsPerUpdate = 128;
+
+    // Object poses are interpolated between the last two steps, so after whole steps they are one step behind.
+    constexpr float Lag = TimeStep.count();
+
+    engine::Motion CreateMotion(const XMFLOAT3& linearVelocity, const XMFLOAT3& angularVelocity) {
+        engine::Motion motion;
+        motion.LinearVelocity = linearVelocity;
+        motion.AngularVelocity = angularVelocity;
+        return motion;
+    }
+
+    // Bodies with different velocities, accelerations and collision radii, bouncing in a box of collision planes.
+    void AddTestBodies(MotionSystem& system, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            const float f = static_cast<float>(i);
+            engine::Motion motion = CreateMotion({std::sin(f), std::cos(f), 0.5f}, {0.1f * f, -0.3f, 1.0f});
+            motion.SetGravity();
+            motion.CollisionRadius = 0.05f + 0.01f * (i % 5);
+            system.AddBody({{0, 0, 0, 1}, {0.1f * (i % 7), 1.0f, -0.1f * (i % 3)}}, motion);
+        }
+
+        // A floor and a wall. The planes face along +Z, so they are rotated to face up and towards -X.
+        const float halfSqrt2 = std::sqrt(0.5f);
+        const engine::CollisionPlane planes[] = {
+            {{{-halfSqrt2, 0, 0, halfSqrt2}, {0, 0, 0}}, {10, 10}},
+            {{{0, -halfSqrt2, 0, halfSqrt2}, {1, 0, 0}}, {10, 10}},
+        };
+        system.SetCollisionPlanes(planes, std::size(planes));
+    }
+
+    std::vector<XrPosef> GetBodyPoses(const MotionSystem& system) {
+        std::vector<XrPosef> poses(system.BodyCount());
+        for (size_t i = 0; i < poses.size(); i++) {
+            poses[i] = system.BodyPose(i);
+        }
+        return poses;
+    }
+
+    // The integration each object used to run in its own Update, for comparison with the motion system in the benchmark.
+    void IntegratePerObject(XrPosef& pose, engine::Motion& motion, float dt) {
+        const XMVECTOR position = xr::math::LoadXrVector3(pose.position);
+        const XMVECTOR orientation = xr::math::LoadXrQuaternion(pose.orientation);
+        const XMVECTOR linearVelocity = XMLoadFloat3(&motion.LinearVelocity);
+        const XMVECTOR angularVelocity = XMLoadFloat3(&motion.AngularVelocity);
+        XMStoreFloat3(&motion.LinearVelocity,
+                      XMVectorMultiplyAdd(XMLoadFloat3(&motion.LinearAcceleration), XMVectorReplicate(dt), linearVelocity));
+        XMStoreFloat3(&motion.AngularVelocity,
+                      XMVectorMultiplyAdd(XMLoadFloat3(&motion.AngularAcceleration), XMVectorReplicate(dt), angularVelocity));
+        xr::math::StoreXrVector3(&pose.position, XMVectorMultiplyAdd(linearVelocity, XMVectorReplicate(dt), position));
+
+        const XMVECTOR angularVelocityInWorld = XMVector3Rotate(angularVelocity, XMQuaternionInverse(orientation));
+        const float angle = XMVectorGetX(XMVector3Length(angularVelocityInWorld));
+        if (angle > 0.0f) {
+            xr::math::StoreXrQuaternion(&pose.orientation,
+                                        XMQuaternionMultiply(XMQuaternionRotationAxis(angularVelocityInWorld, angle * dt), orientation));
+        }
+    }
+
+    bool BitwiseEqual(const std::vector<XrPosef>& a, const std::vector<XrPosef>& b) {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(XrPosef)) == 0;
+    }
+} // namespace
+
+TEST(MotionSystem, RotationMatchesQuaternionIntegration) {
+    MotionSystem system(TimeStep);
+    const XMFLOAT3 angularVelocity{0.3f, 1.0f, -2.0f};
+    system.AddBody(xr::math::Pose::Identity(), CreateMotion({1, 0, 0}, angularVelocity));
+
+    XMVECTOR expected = XMQuaternionIdentity();
+    const XMVECTOR axis = XMLoadFloat3(&angularVelocity);
+    const float speed = XMVectorGetX(XMVector3Length(axis));
+    for (int i = 0; i < 128; i++) {
+        system.Step();
+        expected = XMQuaternionMultiply(expected, XMQuaternionRotationAxis(axis, speed * TimeStep.count()));
+    }
+
+    const XrPosef pose = system.BodyPose(0);
+    XMFLOAT4 expectedOrientation;
+    XMStoreFloat4(&expectedOrientation, expected);
+    EXPECT_NEAR(pose.orientation.x, expectedOrientation.x, 1e-4f);
+    EXPECT_NEAR(pose.orientation.y, expectedOrientation.y, 1e-4f);
+    EXPECT_NEAR(pose.orientation.z, expectedOrientation.z, 1e-4f);
+    EXPECT_NEAR(pose.orientation.w, expectedOrientation.w, 1e-4f);
+    EXPECT_NEAR(pose.position.x, 1.0f, 1e-5f);
+}
+
+TEST(MotionSystem, BodyComesToRestOnTheFloor) {
+    MotionSystem system(TimeStep);
+    engine::Motion motion;
+    motion.SetGravity();
+    motion.CollisionRadius = 0.1f;
+    const float halfSqrt2 = std::sqrt(0.5f);
+    const engine::CollisionPlane floor{{{-halfSqrt2, 0, 0, halfSqrt2}, {0, 0, 0}}, {10, 10}};
+    system.SetCollisionPlanes(&floor, 1);
+    system.AddBody({{0, 0, 0, 1}, {0, 1, 0}}, motion);
+
+    float lowest = 1;
+    for (int frame = 0; frame < 600; frame++) {
+        system.Update(Seconds(1.0f / 90));
+        lowest = std::min(lowest, system.InterpolatedBodyPose(0).position.y);
+    }
+
+    EXPECT_GE(lowest, motion.CollisionRadius - 1e-4f);
+    EXPECT_NEAR(system.BodyPose(0).position.y, motion.CollisionRadius, 1e-3f);
+    engine::Motion result;
+    system.GetBodyMotion(0, result);
+    EXPECT_NEAR(result.LinearVelocity.y, 0.0f, 0.1f);
+}
+
+// The same recorded frame durations give the same poses on every run.
+TEST(MotionSystem, ReplayIsDeterministic) {
+    std::vector<Seconds> frameDurations;
+    for (int frame = 0; frame < 500; frame++) {
+        frameDurations.push_back(Seconds((frame % 3 == 0 ? 7 : 9) / 1024.0f));
+    }
+
+    std::vector<std::vector<XrPosef>> runs;
+    for (int run = 0; run < 2; run++) {
+        MotionSystem system(TimeStep);
+        AddTestBodies(system, 37);
+        std::vector<XrPosef> poses;
+        for (const Seconds elapsed : frameDurations) {
+            system.Update(elapsed);
+            for (size_t i = 0; i < system.BodyCount(); i++) {
+                poses.push_back(system.InterpolatedBodyPose(i));
+            }
+        }
+        runs.push_back(std::move(poses));
+    }
+    EXPECT_TRUE(BitwiseEqual(runs[0], runs[1]));
+}
+
+// The simulation only depends on the time step, not on the frame rate it is updated at.
+TEST(MotionSystem, StepsDoNotDependOnFrameDurations) {
+    MotionSystem steady(TimeStep);
+    MotionSystem jittery(TimeStep);
+    AddTestBodies(steady, 37);
+    AddTestBodies(jittery, 37);
+
+    // Both run for 2 seconds, 256 steps, at 64 frames per second or alternating between 3/256 and 5/256 seconds.
+    for (int frame = 0; frame < 128; frame++) {
+        steady.Update(Seconds(1.0f / 64));
+    }
+    for (int frame = 0; frame < 128; frame++) {
+        jittery.Update(Seconds((frame % 2 == 0 ? 3 : 5) / 256.0f));
+    }
+    EXPECT_TRUE(BitwiseEqual(GetBodyPoses(steady), GetBodyPoses(jittery)));
+
+    // Stepping directly gives the same result too.
+    MotionSystem stepped(TimeStep);
+    AddTestBodies(stepped, 37);
+    for (int step = 0; step < 256; step++) {
+        stepped.Step();
+    }
+    EXPECT_TRUE(BitwiseEqual(GetBodyPoses(steady), GetBodyPoses(stepped)));
+}
+
+TEST(MotionSystem, RemovingABodyKeepsTheOthers) {
+    MotionSystem all(TimeStep);
+    MotionSystem removed(TimeStep);
+    AddTestBodies(all, 9);
+    AddTestBodies(removed, 9);
+    removed.RemoveBody(2);
+    for (int step = 0; step < 100; step++) {
+        all.Step();
+        removed.Step();
+    }
+
+    // The last body moved into the removed slot.
+    std::vector<XrPosef> expected = GetBodyPoses(all);
+    expected[2] = expected.back();
+    expected.pop_back();
+    EXPECT_TRUE(BitwiseEqual(GetBodyPoses(removed), expected));
+}
+
+TEST(MotionSystem, ObjectsFollowTheirMotion) {
+    MotionSystem system(TimeStep, MaxStepsPerUpdate);
+    engine::Object object;
+    object.Motion.LinearVelocity = {0, 0, 1};
+    object.Motion.SetEnabled(true);
+    system.Add(object);
+    EXPECT_EQ(system.BodyCount(), 1u);
+
+    system.Update(Seconds(0.5f));
+    EXPECT_NEAR(object.Pose().position.z, 0.5f - Lag, 1e-4f);
+
+    // A pose set on the object moves the body there without interpolation.
+    object.Pose().position = {5, 5, 5};
+    system.Update(Seconds(0));
+    EXPECT_FLOAT_EQ(object.Pose().position.x, 5.0f);
+    EXPECT_FLOAT_EQ(object.Pose().position.z, 5.0f);
+
+    system.Remove(object);
+    EXPECT_EQ(system.BodyCount(), 0u);
+}
+
+// Enabling or disabling the Motion of an object that was already added takes effect at the next update.
+TEST(MotionSystem, EnabledChangesAreTracked) {
+    MotionSystem system(TimeStep, MaxStepsPerUpdate);
+    engine::Object first;
+    engine::Object second;
+    first.Motion.LinearVelocity = {1, 0, 0};
+    second.Motion.LinearVelocity = {0, 1, 0};
+    system.Add(first);
+    system.Add(second);
+    EXPECT_EQ(system.BodyCount(), 0u);
+
+    first.Motion.SetEnabled(true);
+    second.Motion.SetEnabled(true);
+    system.Update(Seconds(0.25f));
+    EXPECT_EQ(system.BodyCount(), 2u);
+    EXPECT_NEAR(first.Pose().position.x, 0.25f - Lag, 1e-4f);
+    EXPECT_NEAR(second.Pose().position.y, 0.25f - Lag, 1e-4f);
+
+    first.Motion.SetEnabled(false);
+    system.Update(Seconds(0.25f));
+    EXPECT_EQ(system.BodyCount(), 1u);
+    EXPECT_NEAR(first.Pose().position.x, 0.25f - Lag, 1e-4f);
+    EXPECT_NEAR(second.Pose().position.y, 0.5f - Lag, 1e-4f);
+
+    // Toggling back and forth between updates leaves the object as it was.
+    second.Motion.SetEnabled(false);
+    second.Motion.SetEnabled(true);
+    system.Update(Seconds(0.25f));
+    EXPECT_EQ(system.BodyCount(), 1u);
+    EXPECT_NEAR(second.Pose().position.y, 0.75f - Lag, 1e-4f);
+}
+
+TEST(MotionSystem, RemovedObjectsAreNotTracked) {
+    MotionSystem system(TimeStep);
+    {
+        engine::Object object;
+        system.Add(object);
+        object.Motion.SetEnabled(true);
+        system.Remove(object);
+
+        // Objects that are not in a scene keep their Motion to themselves.
+        object.Motion.SetEnabled(false);
+        object.Motion.SetEnabled(true);
+    }
+    system.Update(Seconds(0.25f));
+    EXPECT_EQ(system.BodyCount(), 0u);
+}
+
+// Reports the time per step of 100k bodies colliding with two planes, and of the per-object integration it replaced, which had
+// no collision. The poses are compared with a run of fewer bodies, so the result does not depend on how many bodies are
+// simulated together.
+TEST(MotionSystem, Benchmark100kBodies) {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    constexpr size_t BodyCount = 100'000;
+    constexpr int StepCount = 60;
+    MotionSystem system(TimeStep);
+    AddTestBodies(system, BodyCount);
+
+    std::vector<XrPosef> poses = GetBodyPoses(system);
+    std::vector<engine::Motion> motions(BodyCount);
+    for (size_t i = 0; i < BodyCount; i++) {
+        system.GetBodyMotion(i, motions[i]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < StepCount; step++) {
+        system.Step();
+    }
+    const Milliseconds systemDuration = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int step = 0; step < StepCount; step++) {
+        for (size_t i = 0; i < BodyCount; i++) {
+            IntegratePerObject(poses[i], motions[i], TimeStep.count());
+        }
+    }
+    const Milliseconds perObjectDuration = std::chrono::steady_clock::now() - start;
+
+    std::cout << "[ BENCHMARK] " << BodyCount << " bodies, ms per step: motion system " << systemDuration.count() / StepCount
+              << ", per object " << perObjectDuration.count() / StepCount << std::endl;
+
+    MotionSystem few(TimeStep);
+    AddTestBodies(few, 37);
+    for (int step = 0; step < StepCount; step++) {
+        few.Step();
+    }
+    poses = GetBodyPoses(system);
+    poses.resize(few.BodyCount());
+    EXPECT_TRUE(BitwiseEqual(poses, GetBodyPoses(few)));
+}
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <numeric>
+#include <vector>
+#include <gtest/gtest.h>
+#include <pbr/PbrCommon.h>
+
+using Pbr::IndexFormat::Max16BitVertexCount;
+
+namespace {
+    // A builder whose vertices are numbered by their x coordinate, so the vertex a part index refers to can be recovered.
+    Pbr::PrimitiveBuilder CreateNumberedVertices(uint32_t vertexCount) {
+        Pbr::PrimitiveBuilder builder;
+        builder.Vertices.resize(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            builder.Vertices[i].Position = {static_cast<float>(i), 0, 0};
+        }
+        return builder;
+    }
+
+    // A strip of triangles (i, i + 1, i + 2), so neighboring triangles share two vertices.
+    Pbr::PrimitiveBuilder CreateTriangleStrip(uint32_t vertexCount) {
+        Pbr::PrimitiveBuilder builder = CreateNumberedVertices(vertexCount);
+        for (uint32_t i = 0; i + 2 < vertexCount; i++) {
+            builder.Indices.insert(builder.Indices.end(), {i, i + 1, i + 2});
+        }
+        return builder;
+    }
+
+    // The original vertex numbers of the triangles of all parts, in order.
+    std::vector<uint32_t> GetVertexNumbers(const std::vector<Pbr::PrimitiveBuilder>& parts) {
+        std::vector<uint32_t> numbers;
+        for (const Pbr::PrimitiveBuilder& part : parts) {
+            for (uint32_t index : part.Indices) {
+                numbers.push_back(static_cast<uint32_t>(part.Vertices[index].Position.x));
+            }
+        }
+        return numbers;
+    }
+} // namespace
+
+// A primitive of 0xFFFF vertices has indices up to 0xFFFE, so it fits in 16 bits while no index equals the strip cut value.
+TEST(IndexFormat, ForVertexCountIncludesTheLast16BitCount) {
+    EXPECT_EQ(Pbr::IndexFormat::ForVertexCount(0), DXGI_FORMAT_R16_UINT);
+    EXPECT_EQ(Pbr::IndexFormat::ForVertexCount(Max16BitVertexCount - 1), DXGI_FORMAT_R16_UINT);
+    EXPECT_EQ(Pbr::IndexFormat::ForVertexCount(Max16BitVertexCount), DXGI_FORMAT_R16_UINT);
+    EXPECT_EQ(Pbr::IndexFormat::ForVertexCount(Max16BitVertexCount + 1), DXGI_FORMAT_R32_UINT);
+}
+
+// Indices are compared with <, an index of 0xFFFF is the strip cut value and needs 32 bits.
+TEST(IndexFormat, ForIndicesExcludesTheStripCutValue) {
+    const std::vector<uint32_t> below{0, 1, Max16BitVertexCount - 1};
+    const std::vector<uint32_t> cut{0, Max16BitVertexCount, 1};
+    const std::vector<uint32_t> above{Max16BitVertexCount + 1};
+    EXPECT_EQ(Pbr::IndexFormat::ForIndices(below.data(), below.size()), DXGI_FORMAT_R16_UINT);
+    EXPECT_EQ(Pbr::IndexFormat::ForIndices(cut.data(), cut.size()), DXGI_FORMAT_R32_UINT);
+    EXPECT_EQ(Pbr::IndexFormat::ForIndices(above.data(), above.size()), DXGI_FORMAT_R32_UINT);
+    EXPECT_EQ(Pbr::IndexFormat::ForIndices(nullptr, 0), DXGI_FORMAT_R16_UINT);
+}
+
+TEST(IndexFormat, FormatsAgreeAtTheBoundary) {
+    // The largest index of a primitive with Max16BitVertexCount vertices.
+    const uint32_t largestIndex = Max16BitVertexCount - 1;
+    EXPECT_EQ(Pbr::IndexFormat::ForIndices(&largestIndex, 1), Pbr::IndexFormat::ForVertexCount(Max16BitVertexCount));
+}
+
+TEST(IndexFormat, GetIndexSize) {
+    EXPECT_EQ(Pbr::IndexFormat::GetIndexSize(DXGI_FORMAT_R16_UINT), 2u);
+    EXPECT_EQ(Pbr::IndexFormat::GetIndexSize(DXGI_FORMAT_R32_UINT), 4u);
+}
+
+TEST(IndexFormat, NarrowKeepsAll16BitIndices) {
+    std::vector<uint32_t> indices(Max16BitVertexCount);
+    std::iota(indices.rbegin(), indices.rend(), 0u);
+    std::vector<uint16_t> narrowIndices(indices.size());
+    Pbr::IndexFormat::Narrow(indices.data(), indices.size(), narrowIndices.data());
+    EXPECT_TRUE(std::equal(indices.begin(), indices.end(), narrowIndices.begin()));
+}
+
+TEST(PrimitiveBuilder, SplitKeepsABuilderThatFits) {
+    const Pbr::PrimitiveBuilder builder = CreateTriangleStrip(Max16BitVertexCount);
+    ASSERT_EQ(builder.GetIndexFormat(), DXGI_FORMAT_R16_UINT);
+
+    const std::vector<Pbr::PrimitiveBuilder> parts = builder.SplitFor16BitIndices();
+    ASSERT_EQ(parts.size(), 1u);
+    EXPECT_EQ(parts[0].Vertices.size(), builder.Vertices.size());
+    EXPECT_EQ(parts[0].Indices, builder.Indices);
+}
+
+TEST(PrimitiveBuilder, SplitAcrossThe16BitLimit) {
+    const Pbr::PrimitiveBuilder builder = CreateTriangleStrip(Max16BitVertexCount + 1);
+    ASSERT_EQ(builder.GetIndexFormat(), DXGI_FORMAT_R32_UINT);
+
+    const std::vector<Pbr::PrimitiveBuilder> parts = builder.SplitFor16BitIndices();
+    ASSERT_EQ(parts.size(), 2u);
+    for (const Pbr::PrimitiveBuilder& part : parts) {
+        EXPECT_LE(part.Vertices.size(), Max16BitVertexCount);
+        EXPECT_EQ(part.GetIndexFormat(), DXGI_FORMAT_R16_UINT);
+        EXPECT_EQ(Pbr::IndexFormat::ForIndices(part.Indices.data(), part.Indices.size()), DXGI_FORMAT_R16_UINT);
+    }
+    EXPECT_EQ(parts[0].Vertices.size(), Max16BitVertexCount);
+    // The first triangle of the second part shares two vertices with the last triangle of the first part, they are duplicated.
+    EXPECT_EQ(parts[1].Vertices.size(), 3u);
+
+    // Triangles keep their order and their vertices.
+    EXPECT_EQ(GetVertexNumbers(parts), builder.Indices);
+}
+
+TEST(PrimitiveBuilder, SplitLargeMeshIntoSeveralParts) {
+    constexpr uint32_t VertexCount = 3 * Max16BitVertexCount + 100;
+    const Pbr::PrimitiveBuilder builder = CreateTriangleStrip(VertexCount);
+
+    const std::vector<Pbr::PrimitiveBuilder> parts = builder.SplitFor16BitIndices();
+    ASSERT_EQ(parts.size(), 4u);
+    size_t triangleCount = 0;
+    for (const Pbr::PrimitiveBuilder& part : parts) {
+        EXPECT_LE(part.Vertices.size(), Max16BitVertexCount);
+        EXPECT_EQ(part.Indices.size() % 3, 0u);
+        triangleCount += part.Indices.size() / 3;
+    }
+    EXPECT_EQ(triangleCount, builder.Indices.size() / 3);
+    EXPECT_EQ(GetVertexNumbers(parts), builder.Indices);
+}
+
+TEST(PrimitiveBuilder, SplitDropsUnreferencedVertices) {
+    // One triangle far apart in a builder too large for 16-bit indices.
+    Pbr::PrimitiveBuilder builder = CreateNumberedVertices(Max16BitVertexCount + 10);
+    builder.Indices = {0, Max16BitVertexCount + 5, Max16BitVertexCount + 9};
+
+    const std::vector<Pbr::PrimitiveBuilder> parts = builder.SplitFor16BitIndices();
+    ASSERT_EQ(parts.size(), 1u);
+    EXPECT_EQ(parts[0].Vertices.size(), 3u);
+    EXPECT_EQ(parts[0].Indices, (std::vector<uint32_t>{0, 1, 2}));
+    EXPECT_EQ(GetVertexNumbers(parts), builder.Indices);
+}
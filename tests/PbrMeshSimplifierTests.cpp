@@ -0,0 +1,179 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include <pbr/PbrMeshSimplifier.h>
+
+using namespace DirectX;
+
+namespace {
+    // A UV sphere, with the vertices of the seam and the poles repeated like the vertices of a textured sphere.
+    Pbr::PrimitiveBuilder CreateSphere(uint32_t rings, float radius) {
+        Pbr::PrimitiveBuilder builder;
+        const uint32_t segments = rings * 2;
+        for (uint32_t ring = 0; ring <= rings; ring++) {
+            for (uint32_t segment = 0; segment <= segments; segment++) {
+                const float theta = XM_PI * ring / rings;
+                const float phi = XM_2PI * segment / segments;
+                Pbr::Vertex vertex{};
+                vertex.Position = {
+                    radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi)};
+                builder.Vertices.push_back(vertex);
+            }
+        }
+        const auto index = [segments](uint32_t ring, uint32_t segment) { return ring * (segments + 1) + segment; };
+        for (uint32_t ring = 0; ring < rings; ring++) {
+            for (uint32_t segment = 0; segment < segments; segment++) {
+                builder.Indices.insert(builder.Indices.end(), {index(ring, segment), index(ring, segment + 1), index(ring + 1, segment)});
+                builder.Indices.insert(builder.Indices.end(),
+                                       {index(ring + 1, segment), index(ring, segment + 1), index(ring + 1, segment + 1)});
+            }
+        }
+        return builder;
+    }
+
+    // A unit square in the XZ plane facing +Y with a little noise in height, like a scanned floor.
+    Pbr::PrimitiveBuilder CreateFloor(uint32_t sideLength) {
+        Pbr::PrimitiveBuilder builder;
+        for (uint32_t x = 0; x <= sideLength; x++) {
+            for (uint32_t z = 0; z <= sideLength; z++) {
+                Pbr::Vertex vertex{};
+                vertex.Position = {static_cast<float>(x) / sideLength, 0.001f * std::sin(x * 1.7f) * std::cos(z * 2.3f),
+                                   static_cast<float>(z) / sideLength};
+                builder.Vertices.push_back(vertex);
+            }
+        }
+        const auto index = [sideLength](uint32_t x, uint32_t z) { return x * (sideLength + 1) + z; };
+        for (uint32_t x = 0; x < sideLength; x++) {
+            for (uint32_t z = 0; z < sideLength; z++) {
+                builder.Indices.insert(builder.Indices.end(), {index(x, z), index(x, z + 1), index(x + 1, z)});
+                builder.Indices.insert(builder.Indices.end(), {index(x + 1, z), index(x, z + 1), index(x + 1, z + 1)});
+            }
+        }
+        return builder;
+    }
+
+    size_t TriangleCount(const Pbr::PrimitiveBuilder& builder) {
+        return builder.Indices.size() / 3;
+    }
+
+    XMVECTOR TriangleCross(const Pbr::PrimitiveBuilder& builder, size_t triangle) {
+        const XMVECTOR p0 = XMLoadFloat3(&builder.Vertices[builder.Indices[triangle * 3]].Position);
+        const XMVECTOR p1 = XMLoadFloat3(&builder.Vertices[builder.Indices[triangle * 3 + 1]].Position);
+        const XMVECTOR p2 = XMLoadFloat3(&builder.Vertices[builder.Indices[triangle * 3 + 2]].Position);
+        return XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+    }
+
+    // How far the centers of the triangles lie inside a sphere, the simplified surface never lies outside it.
+    float MaxDepthInSphere(const Pbr::PrimitiveBuilder& builder, float radius) {
+        float maxDepth = 0;
+        for (size_t i = 0; i < builder.Indices.size(); i += 3) {
+            XMVECTOR center = XMVectorZero();
+            for (size_t corner = 0; corner < 3; corner++) {
+                center = XMVectorAdd(center, XMLoadFloat3(&builder.Vertices[builder.Indices[i + corner]].Position));
+            }
+            maxDepth = std::max(maxDepth, radius - XMVectorGetX(XMVector3Length(center)) / 3);
+        }
+        return maxDepth;
+    }
+
+    float Area(const Pbr::PrimitiveBuilder& builder) {
+        float area = 0;
+        for (size_t triangle = 0; triangle < TriangleCount(builder); triangle++) {
+            area += XMVectorGetX(XMVector3Length(TriangleCross(builder, triangle))) / 2;
+        }
+        return area;
+    }
+} // namespace
+
+TEST(PbrMeshSimplifier, LodChainHalvesTheTriangles) {
+    const Pbr::PrimitiveBuilder sphere = CreateSphere(32, 1.0f);
+    Pbr::LodChainOptions options;
+    options.MaxLevelCount = 5;
+    const std::vector<Pbr::LodLevel> chain = Pbr::BuildLodChain(sphere, options);
+
+    ASSERT_EQ(chain.size(), 5u);
+    EXPECT_EQ(chain[0].Error, 0.0f);
+    EXPECT_EQ(chain[0].Builder.Indices, sphere.Indices);
+    for (size_t level = 1; level < chain.size(); level++) {
+        const Pbr::PrimitiveBuilder& builder = chain[level].Builder;
+        EXPECT_LE(TriangleCount(builder), TriangleCount(chain[level - 1].Builder) / 2) << "level " << level;
+        EXPECT_GE(TriangleCount(builder), options.MinTriangleCount) << "level " << level;
+        EXPECT_GT(chain[level].Error, chain[level - 1].Error) << "level " << level;
+        // The reported error is a root mean square, the largest deviation stays within a small multiple of it.
+        EXPECT_LT(MaxDepthInSphere(builder, 1.0f), chain[level].Error * 3) << "level " << level;
+
+        // Unused vertices are removed, and the remaining ones keep their original positions on the sphere.
+        EXPECT_LT(builder.Vertices.size(), chain[level - 1].Builder.Vertices.size()) << "level " << level;
+        for (const Pbr::Vertex& vertex : builder.Vertices) {
+            EXPECT_NEAR(XMVectorGetX(XMVector3Length(XMLoadFloat3(&vertex.Position))), 1.0f, 1e-5f);
+        }
+    }
+}
+
+TEST(PbrMeshSimplifier, LodChainIsDeterministic) {
+    const Pbr::PrimitiveBuilder sphere = CreateSphere(24, 1.0f);
+    const std::vector<Pbr::LodLevel> first = Pbr::BuildLodChain(sphere, {});
+    const std::vector<Pbr::LodLevel> second = Pbr::BuildLodChain(sphere, {});
+    ASSERT_EQ(first.size(), second.size());
+    for (size_t level = 0; level < first.size(); level++) {
+        EXPECT_EQ(first[level].Builder.Indices, second[level].Builder.Indices);
+        EXPECT_EQ(first[level].Error, second[level].Error);
+    }
+}
+
+TEST(PbrMeshSimplifier, MaxErrorStopsTheSimplification) {
+    const Pbr::PrimitiveBuilder sphere = CreateSphere(32, 1.0f);
+    std::vector<uint32_t> indices = sphere.Indices;
+    Pbr::SimplifyOptions options;
+    options.MaxError = 0.01f;
+    const float error = Pbr::SimplifyIndices(&sphere.Vertices[0].Position, sphere.Vertices.size(), indices, options);
+    EXPECT_GT(error, 0.0f);
+    EXPECT_LE(error, options.MaxError);
+    EXPECT_LT(indices.size(), sphere.Indices.size() / 4);
+    EXPECT_GT(indices.size(), 0u);
+
+    // A chain limited to the same error ends before reaching it.
+    Pbr::LodChainOptions chainOptions;
+    chainOptions.MaxLevelCount = 10;
+    chainOptions.MaxError = options.MaxError;
+    const std::vector<Pbr::LodLevel> chain = Pbr::BuildLodChain(sphere, chainOptions);
+    EXPECT_LT(chain.size(), chainOptions.MaxLevelCount);
+    EXPECT_LE(chain.back().Error, chainOptions.MaxError);
+}
+
+TEST(PbrMeshSimplifier, FlatSurfaceKeepsItsBorder) {
+    const Pbr::PrimitiveBuilder floor = CreateFloor(50);
+    Pbr::SimplifyOptions options;
+    options.TargetIndexCount = 20 * 3;
+    float error = 0;
+    const Pbr::PrimitiveBuilder simplified = Pbr::Simplify(floor, options, &error);
+
+    EXPECT_LE(TriangleCount(simplified), 20u);
+    EXPECT_LT(error, 0.01f);
+    // Border vertices only move along the border, so the square keeps its outline.
+    EXPECT_NEAR(Area(simplified), 1.0f, 0.01f);
+    // No collapse flips a triangle, they all still face up.
+    for (size_t triangle = 0; triangle < TriangleCount(simplified); triangle++) {
+        EXPECT_GT(XMVectorGetY(TriangleCross(simplified, triangle)), 0.0f) << "triangle " << triangle;
+    }
+}
+
+TEST(PbrMeshSimplifier, SelectsTheCoarsestLevelWithinThePixelError) {
+    // At the default 1000 pixels per radian, an error of 1 mm covers a pixel at 1 m.
+    const float errors[] = {0.0f, 0.001f, 0.004f, 0.016f};
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 4, 0.0f), 0u);
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 4, -1.0f), 0u);
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 4, 0.9f), 0u);
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 4, 1.1f), 1u);
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 4, 3.9f), 1u);
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 4, 4.1f), 2u);
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 4, 100.0f), 3u);
+
+    // Allowing 4 pixels reaches each level at a quarter of the distance.
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 4, 1.1f, 4.0f), 2u);
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 4, 0.9f, 1.0f, 2000.0f), 0u);
+    EXPECT_EQ(Pbr::SelectLodLevel(errors, 1, 100.0f), 0u);
+}
@@ -0,0 +1,151 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <pbr/PbrModel.h>
+
+using Pbr::NodeIndex_t;
+
+namespace {
+    // A model shaped like a large glTF scene: groups of parts under a few levels of parents, where many nodes share names,
+    // both under different parents and under the same parent.
+    std::shared_ptr<Pbr::Model> CreateModel(size_t nodeCount, uint32_t seed) {
+        auto model = std::make_shared<Pbr::Model>();
+        model->ReserveNodes(nodeCount);
+        std::mt19937 random(seed);
+        while (model->GetNodeCount() < nodeCount) {
+            const NodeIndex_t parent = static_cast<NodeIndex_t>(random() % model->GetNodeCount());
+            model->AddNode(DirectX::XMMatrixIdentity(), parent, "node" + std::to_string(random() % (nodeCount / 4)));
+        }
+        return model;
+    }
+
+    // The linear scans the index replaced, which define the first node of a name.
+    std::optional<NodeIndex_t> LinearFindFirstNode(const Pbr::Model& model,
+                                                   std::string_view name,
+                                                   std::optional<NodeIndex_t> parentNodeIndex = {}) {
+        for (NodeIndex_t i = 0; i < model.GetNodeCount(); i++) {
+            const Pbr::Node& node = model.GetNode(i);
+            if ((!parentNodeIndex || node.ParentNodeIndex == *parentNodeIndex) && node.Name == name) {
+                return i;
+            }
+        }
+        return {};
+    }
+
+    std::optional<NodeIndex_t> LinearFindNodeByPath(const Pbr::Model& model, const std::vector<std::string>& names) {
+        std::optional<NodeIndex_t> nodeIndex;
+        for (const std::string& name : names) {
+            nodeIndex = LinearFindFirstNode(model, name, nodeIndex);
+            if (!nodeIndex) {
+                break;
+            }
+        }
+        return nodeIndex;
+    }
+
+    // The names from the root's child down to the node.
+    std::vector<std::string> GetPath(const Pbr::Model& model, NodeIndex_t nodeIndex) {
+        std::vector<std::string> names;
+        for (NodeIndex_t i = nodeIndex; i != Pbr::RootNodeIndex; i = model.GetNode(i).ParentNodeIndex) {
+            names.insert(names.begin(), model.GetNode(i).Name);
+        }
+        return names;
+    }
+
+    std::string JoinPath(const std::vector<std::string>& names) {
+        std::string path;
+        for (const std::string& name : names) {
+            path += path.empty() ? name : "/" + name;
+        }
+        return path;
+    }
+} // namespace
+
+TEST(PbrModel, FindFirstNodeMatchesLinearScan) {
+    const std::shared_ptr<Pbr::Model> model = CreateModel(4000, 1);
+    for (NodeIndex_t i = 0; i < model->GetNodeCount(); i++) {
+        const Pbr::Node& node = model->GetNode(i);
+        EXPECT_EQ(model->FindFirstNode(node.Name), LinearFindFirstNode(*model, node.Name)) << node.Name;
+        EXPECT_EQ(model->FindFirstNode(node.Name, node.ParentNodeIndex), LinearFindFirstNode(*model, node.Name, node.ParentNodeIndex))
+            << node.Name;
+        // Under another parent the node is not found, or another node of the same name is.
+        const NodeIndex_t otherParent = static_cast<NodeIndex_t>((node.ParentNodeIndex + 1) % model->GetNodeCount());
+        EXPECT_EQ(model->FindFirstNode(node.Name, otherParent), LinearFindFirstNode(*model, node.Name, otherParent)) << node.Name;
+    }
+    EXPECT_EQ(model->FindFirstNode("missing"), std::nullopt);
+    EXPECT_EQ(model->FindFirstNode("root"), Pbr::RootNodeIndex);
+}
+
+TEST(PbrModel, DuplicateNamesFindTheFirstNode) {
+    Pbr::Model model;
+    const NodeIndex_t a = model.AddNode(DirectX::XMMatrixIdentity(), Pbr::RootNodeIndex, "part");
+    const NodeIndex_t group = model.AddNode(DirectX::XMMatrixIdentity(), Pbr::RootNodeIndex, "group");
+    const NodeIndex_t b = model.AddNode(DirectX::XMMatrixIdentity(), group, "part");
+    model.AddNode(DirectX::XMMatrixIdentity(), group, "part");
+    const NodeIndex_t c = model.AddNode(DirectX::XMMatrixIdentity(), b, "part");
+
+    EXPECT_EQ(model.FindFirstNode("part"), a);
+    EXPECT_EQ(model.FindFirstNode("part", group), b);
+    EXPECT_EQ(model.FindFirstNode("part", b), c);
+    EXPECT_EQ(model.FindFirstNodes({"group", "missing", "part"}), (std::vector<NodeIndex_t>{group, Pbr::NodeIndex_npos, a}));
+    // The first name matches the first node of that name anywhere, each following name the first child of that name.
+    EXPECT_EQ(model.FindNodeByPath("group/part/part"), c);
+    EXPECT_EQ(model.FindNodeByPath("part/part"), std::nullopt);
+    EXPECT_EQ(model.FindNodeByPath(""), std::nullopt);
+
+    EXPECT_THROW(model.AddNode(DirectX::XMMatrixIdentity(), Pbr::NodeIndex_npos, "root"), std::invalid_argument);
+}
+
+TEST(PbrModel, FindNodeByPathMatchesLinearScan) {
+    const std::shared_ptr<Pbr::Model> model = CreateModel(4000, 2);
+    std::vector<std::string_view> names;
+    for (NodeIndex_t i = 1; i < model->GetNodeCount(); i++) {
+        const std::vector<std::string> path = GetPath(*model, i);
+        EXPECT_EQ(model->FindNodeByPath(JoinPath(path)), LinearFindNodeByPath(*model, path)) << JoinPath(path);
+        names.push_back(model->GetNode(i).Name);
+    }
+
+    const std::vector<NodeIndex_t> nodeIndices = model->FindFirstNodes(names);
+    ASSERT_EQ(nodeIndices.size(), names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        EXPECT_EQ(nodeIndices[i], LinearFindFirstNode(*model, names[i]));
+    }
+}
+
+// Reports the time to find every node of a large model by name and by path, with the index and with the linear scans.
+TEST(PbrModel, BenchmarkFindNode) {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    constexpr size_t NodeCount = 10000;
+    const std::shared_ptr<Pbr::Model> model = CreateModel(NodeCount, 4);
+    std::vector<std::string> paths;
+    for (NodeIndex_t i = 1; i < model->GetNodeCount(); i++) {
+        paths.push_back(JoinPath(GetPath(*model, i)));
+    }
+
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (NodeIndex_t i = 1; i < model->GetNodeCount(); i++) {
+        found += model->FindFirstNode(model->GetNode(i).Name).has_value();
+        found += model->FindNodeByPath(paths[i - 1]).has_value();
+    }
+    const Milliseconds indexDuration = std::chrono::steady_clock::now() - start;
+
+    size_t linearFound = 0;
+    start = std::chrono::steady_clock::now();
+    for (NodeIndex_t i = 1; i < model->GetNodeCount(); i++) {
+        linearFound += LinearFindFirstNode(*model, model->GetNode(i).Name).has_value();
+        linearFound += LinearFindNodeByPath(*model, GetPath(*model, i)).has_value();
+    }
+    const Milliseconds linearDuration = std::chrono::steady_clock::now() - start;
+
+    std::cout << "[ BENCHMARK] " << NodeCount << " nodes, ms to find each by name and by path: index " << indexDuration.count()
+              << ", linear scan " << linearDuration.count() << std::endl;
+    EXPECT_EQ(found, linearFound);
+}
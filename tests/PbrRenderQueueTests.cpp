@@ -0,0 +1,195 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <pbr/PbrRenderQueue.h>
+
+using Pbr::DrawState;
+using Pbr::StateTracker;
+
+namespace {
+    // The queue only compares D3D objects by address, so distinct fake addresses stand in for them.
+    template <typename T>
+    T* FakeObject(uintptr_t id) {
+        return reinterpret_cast<T*>(id * 0x100);
+    }
+
+    const Pbr::Primitive* FakePrimitive(uintptr_t id) {
+        return FakeObject<const Pbr::Primitive>(id);
+    }
+
+    // Counts every call that would reach the device context and records the draws in order.
+    struct CountingStateSink final : Pbr::StateSink {
+        void SetShaders(Pbr::ShadingMode) override {
+            Calls.push_back("Shaders");
+        }
+        void SetBlendState(ID3D11BlendState*) override {
+            Calls.push_back("BlendState");
+        }
+        void SetDepthStencilState(ID3D11DepthStencilState*) override {
+            Calls.push_back("DepthStencilState");
+        }
+        void SetRasterizerState(ID3D11RasterizerState*) override {
+            Calls.push_back("RasterizerState");
+        }
+        void SetTextures(uint32_t firstSlot, uint32_t count, ID3D11ShaderResourceView* const*) override {
+            Calls.push_back("Textures " + std::to_string(firstSlot) + " " + std::to_string(count));
+        }
+        void SetSamplers(uint32_t firstSlot, uint32_t count, ID3D11SamplerState* const*) override {
+            Calls.push_back("Samplers " + std::to_string(firstSlot) + " " + std::to_string(count));
+        }
+        void SetMaterialConstantBuffer(ID3D11Buffer*) override {
+            Calls.push_back("MaterialConstantBuffer");
+        }
+        void SetModelTransforms(ID3D11ShaderResourceView*) override {
+            Calls.push_back("ModelTransforms");
+        }
+        void SetModelToWorld(uint32_t modelToWorldIndex) override {
+            Calls.push_back("ModelToWorld " + std::to_string(modelToWorldIndex));
+        }
+        void Draw(const Pbr::Primitive* primitive) override {
+            Draws.push_back(primitive);
+        }
+
+        size_t Binds() const {
+            return Calls.size();
+        }
+
+        std::vector<std::string> Calls;
+        std::vector<const Pbr::Primitive*> Draws;
+    };
+
+    // A material with its own textures, samplers and constant buffer, like Pbr::Material::PrepareDrawState fills in.
+    DrawState CreateMaterialState(uintptr_t materialId) {
+        DrawState state;
+        state.BlendState = FakeObject<ID3D11BlendState>(1);
+        state.DepthStencilState = FakeObject<ID3D11DepthStencilState>(1);
+        state.RasterizerState = FakeObject<ID3D11RasterizerState>(1);
+        for (size_t slot = 0; slot < DrawState::TextureCount; slot++) {
+            state.Textures[slot] = FakeObject<ID3D11ShaderResourceView>(materialId * 10 + slot);
+            state.Samplers[slot] = FakeObject<ID3D11SamplerState>(1);
+        }
+        state.MaterialConstantBuffer = FakeObject<ID3D11Buffer>(materialId);
+        state.ModelTransforms = FakeObject<ID3D11ShaderResourceView>(1000);
+        return state;
+    }
+
+    constexpr uint32_t FullStateBinds = 9;
+} // namespace
+
+TEST(StateTracker, FirstDrawBindsTheFullState) {
+    CountingStateSink sink;
+    StateTracker tracker(sink);
+    tracker.Draw(CreateMaterialState(1), FakePrimitive(1));
+
+    EXPECT_EQ(sink.Binds(), FullStateBinds);
+    EXPECT_EQ(sink.Calls[4], "Textures 0 5");
+    EXPECT_EQ(sink.Calls[5], "Samplers 0 5");
+    EXPECT_EQ(tracker.GetStatistics().Draws, 1u);
+    EXPECT_EQ(tracker.GetStatistics().Binds, FullStateBinds);
+    EXPECT_EQ(tracker.GetStatistics().SkippedBinds, 0u);
+}
+
+TEST(StateTracker, SkipsTheBoundState) {
+    CountingStateSink sink;
+    StateTracker tracker(sink);
+    const DrawState state = CreateMaterialState(1);
+    tracker.Draw(state, FakePrimitive(1));
+    tracker.Draw(state, FakePrimitive(2));
+
+    EXPECT_EQ(sink.Binds(), FullStateBinds);
+    EXPECT_EQ(sink.Draws, (std::vector{FakePrimitive(1), FakePrimitive(2)}));
+    EXPECT_EQ(tracker.GetStatistics().Draws, 2u);
+    EXPECT_EQ(tracker.GetStatistics().Binds, FullStateBinds);
+    EXPECT_EQ(tracker.GetStatistics().SkippedBinds, FullStateBinds);
+}
+
+TEST(StateTracker, BindsOnlyTheChangedSlotRange) {
+    CountingStateSink sink;
+    StateTracker tracker(sink);
+    DrawState state = CreateMaterialState(1);
+    tracker.Draw(state, FakePrimitive(1));
+    sink.Calls.clear();
+
+    state.Textures[Pbr::ShaderSlots::Normal] = FakeObject<ID3D11ShaderResourceView>(500);
+    state.Textures[Pbr::ShaderSlots::Emissive] = FakeObject<ID3D11ShaderResourceView>(501);
+    tracker.Draw(state, FakePrimitive(1));
+    EXPECT_EQ(sink.Calls, (std::vector<std::string>{"Textures 2 3"}));
+}
+
+TEST(StateTracker, ResetBindsTheFullStateAgain) {
+    CountingStateSink sink;
+    StateTracker tracker(sink);
+    const DrawState state = CreateMaterialState(1);
+    tracker.Draw(state, FakePrimitive(1));
+    tracker.Reset();
+    tracker.Draw(state, FakePrimitive(1));
+
+    EXPECT_EQ(sink.Binds(), 2 * FullStateBinds);
+    EXPECT_EQ(tracker.GetStatistics().SkippedBinds, 0u);
+}
+
+TEST(RenderQueue, GroupsOpaqueDrawsByState) {
+    Pbr::RenderQueue queue;
+    // Two materials alternating, as objects added in scene order would be.
+    for (uint32_t i = 0; i < 6; i++) {
+        DrawState state = CreateMaterialState(1 + i % 2);
+        state.ModelToWorldIndex = queue.AddModelToWorld(DirectX::XMMatrixIdentity());
+        queue.AddDraw(state, false, FakePrimitive(i));
+    }
+
+    CountingStateSink sink;
+    const StateTracker::Statistics statistics = queue.Submit(sink);
+    EXPECT_EQ(sink.Draws,
+              (std::vector{FakePrimitive(0), FakePrimitive(2), FakePrimitive(4), FakePrimitive(1), FakePrimitive(3), FakePrimitive(5)}));
+    // The full state once, the material once more, and a model to world transform for every other draw.
+    EXPECT_EQ(statistics.Binds, FullStateBinds + 2 + 5);
+    EXPECT_EQ(statistics.Binds, sink.Binds());
+    EXPECT_EQ(statistics.Draws, 6u);
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(RenderQueue, KeepsBlendedDrawsInOrderAfterOpaqueDraws) {
+    Pbr::RenderQueue queue;
+    const uint32_t modelToWorldIndex = queue.AddModelToWorld(DirectX::XMMatrixIdentity());
+    DrawState blended = CreateMaterialState(1);
+    blended.ModelToWorldIndex = modelToWorldIndex;
+    blended.BlendState = FakeObject<ID3D11BlendState>(2);
+    DrawState opaque = CreateMaterialState(2);
+    opaque.ModelToWorldIndex = modelToWorldIndex;
+
+    queue.AddDraw(blended, true, FakePrimitive(3));
+    queue.AddDraw(opaque, false, FakePrimitive(2));
+    queue.AddDraw(CreateMaterialState(3), true, FakePrimitive(1));
+    queue.AddDraw(opaque, false, FakePrimitive(0));
+
+    CountingStateSink sink;
+    queue.Submit(sink);
+    EXPECT_EQ(sink.Draws, (std::vector{FakePrimitive(2), FakePrimitive(0), FakePrimitive(3), FakePrimitive(1)}));
+}
+
+// A scene of many placed objects sharing a few models, like Scene_Placement. Every object has its own model to world
+// transform, everything else is shared by the objects of a model.
+TEST(RenderQueue, PlacedObjectsShareTheirModelState) {
+    constexpr uint32_t ModelCount = 3;
+    constexpr uint32_t ObjectCount = 300;
+    Pbr::RenderQueue queue;
+    for (uint32_t object = 0; object < ObjectCount; object++) {
+        DrawState state = CreateMaterialState(1 + object % ModelCount);
+        state.ModelToWorldIndex = queue.AddModelToWorld(DirectX::XMMatrixTranslation(static_cast<float>(object), 0, 0));
+        queue.AddDraw(state, false, FakePrimitive(object % ModelCount));
+    }
+
+    CountingStateSink sink;
+    const StateTracker::Statistics statistics = queue.Submit(sink);
+    EXPECT_EQ(statistics.Draws, ObjectCount);
+    // Without the queue every draw binds the full state.
+    const uint32_t unsortedBinds = ObjectCount * FullStateBinds;
+    const uint32_t sortedBinds = FullStateBinds + (ModelCount - 1) * 2 + (ObjectCount - 1);
+    EXPECT_EQ(statistics.Binds, sortedBinds);
+    EXPECT_EQ(statistics.Binds + statistics.SkippedBinds, unsortedBinds);
+    EXPECT_EQ(sink.Binds(), sortedBinds);
+}
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <pbr/PbrRingAllocator.h>
+
+using Pbr::RingAllocator;
+
+TEST(RingAllocator, AllocatesInOrderWithAlignment) {
+    RingAllocator ring(1024);
+    EXPECT_EQ(ring.Allocate(100, 16), 0u);
+    EXPECT_EQ(ring.Allocate(100, 16), 112u);
+    EXPECT_EQ(ring.GetUsedSize(), 212u);
+}
+
+TEST(RingAllocator, RejectsInvalidRequests) {
+    RingAllocator ring(1024);
+    EXPECT_FALSE(ring.Allocate(0));
+    EXPECT_FALSE(ring.Allocate(1025));
+    EXPECT_FALSE(ring.Allocate(16, 0));
+    EXPECT_EQ(ring.GetUsedSize(), 0u);
+}
+
+TEST(RingAllocator, WrapsAroundAndReclaimsRetiredFrames) {
+    RingAllocator ring(1024);
+    ASSERT_EQ(ring.Allocate(100, 16), 0u);
+    ASSERT_EQ(ring.Allocate(100, 16), 112u);
+    ring.FinishFrame(1);
+    ASSERT_EQ(ring.Allocate(500), 212u);
+    ring.FinishFrame(2);
+    EXPECT_EQ(ring.GetUsedSize(), 712u);
+
+    // 312 bytes are left at the end and nothing at the front.
+    EXPECT_FALSE(ring.Allocate(400));
+    ASSERT_EQ(ring.Allocate(300), 712u);
+    ring.FinishFrame(3);
+
+    ring.RetireFrames(1);
+    EXPECT_EQ(ring.GetUsedSize(), 800u);
+    // The free space is split into 12 bytes at the end and 212 at the front.
+    EXPECT_FALSE(ring.Allocate(256));
+    // Wrapping skips the 12 bytes at the end, they stay in use until the frame retires.
+    EXPECT_EQ(ring.Allocate(200), 0u);
+    EXPECT_EQ(ring.GetUsedSize(), 1012u);
+    EXPECT_FALSE(ring.Allocate(16));
+    ring.FinishFrame(4);
+
+    ring.RetireFrames(3);
+    EXPECT_EQ(ring.GetUsedSize(), 212u);
+    EXPECT_EQ(ring.GetOldestPendingFrame(), 4u);
+    EXPECT_EQ(ring.Allocate(812, 4), 200u);
+    EXPECT_FALSE(ring.Allocate(1));
+    EXPECT_EQ(ring.GetUsedSize(), 1024u);
+
+    ring.RetireFrames(4);
+    ring.FinishFrame(5);
+    ring.RetireFrames(5);
+    EXPECT_EQ(ring.GetUsedSize(), 0u);
+    EXPECT_FALSE(ring.GetOldestPendingFrame());
+    EXPECT_EQ(ring.Allocate(1024), 0u);
+}
+
+TEST(RingAllocator, FrameIndicesMustIncrease) {
+    RingAllocator ring(1024);
+    ring.FinishFrame(2);
+    EXPECT_ANY_THROW(ring.FinishFrame(2));
+    EXPECT_ANY_THROW(ring.FinishFrame(1));
+}
+
+// An empty frame is still pending when the ring restarts at the beginning after going idle. Its marker must move with the head,
+// or retiring it later moves the tail past allocations of the frames in flight.
+TEST(RingAllocator, IdleResetKeepsPendingEmptyFrames) {
+    RingAllocator ring(4096);
+    ASSERT_EQ(ring.Allocate(1000), 0u);
+    ring.FinishFrame(1);
+    ring.FinishFrame(2);
+    ring.RetireFrames(1);
+    EXPECT_EQ(ring.GetUsedSize(), 0u);
+
+    ASSERT_EQ(ring.Allocate(1000), 0u);
+    ring.FinishFrame(3);
+    ring.RetireFrames(2);
+    EXPECT_EQ(ring.GetUsedSize(), 1000u);
+
+    // Frame 3 still uses [0, 1000), so only [1000, 4096) is free.
+    EXPECT_EQ(ring.Allocate(3000), 1000u);
+    EXPECT_FALSE(ring.Allocate(500));
+    EXPECT_EQ(ring.GetUsedSize(), 4000u);
+}
+
+// Random allocations, frames and retirements, checking that live allocations never overlap, stay aligned and in bounds.
+TEST(RingAllocator, RandomOperationsNeverOverlap) {
+    constexpr uint64_t Capacity = 4096;
+    struct Allocation {
+        uint64_t Offset;
+        uint64_t Size;
+        uint64_t Frame;
+    };
+
+    std::mt19937 random(1);
+    RingAllocator ring(Capacity);
+    std::vector<Allocation> live;
+    uint64_t frame = 0;
+    uint64_t retired = 0;
+    size_t allocationCount = 0;
+    for (int step = 0; step < 200000; step++) {
+        const uint32_t operation = random() % 10;
+        if (operation < 6) {
+            const uint64_t size = 1 + random() % 900;
+            const uint64_t alignment = uint64_t{1} << (random() % 5);
+            if (const std::optional<uint64_t> offset = ring.Allocate(size, alignment)) {
+                allocationCount++;
+                ASSERT_EQ(*offset % alignment, 0u);
+                ASSERT_LE(*offset + size, Capacity);
+                for (const Allocation& other : live) {
+                    ASSERT_FALSE(*offset < other.Offset + other.Size && other.Offset < *offset + size)
+                        << "step " << step << ": [" << *offset << ", " << *offset + size << ") overlaps [" << other.Offset << ", "
+                        << other.Offset + other.Size << ")";
+                }
+                live.push_back({*offset, size, frame + 1});
+            }
+        } else if (operation < 8) {
+            ring.FinishFrame(++frame);
+        } else if (frame > retired) {
+            retired += 1 + random() % (frame - retired);
+            ring.RetireFrames(retired);
+            std::erase_if(live, [&](const Allocation& allocation) { return allocation.Frame <= retired; });
+        }
+        ASSERT_LE(ring.GetUsedSize(), Capacity);
+    }
+    EXPECT_GT(allocationCount, 10000u);
+}
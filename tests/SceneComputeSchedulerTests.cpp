@@ -0,0 +1,240 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <XrSceneLib/pch.h>
+#include <functional>
+#include <optional>
+#include <vector>
+#include <gtest/gtest.h>
+#include <XrUtility/XrSceneComputeScheduler.hpp>
+
+using xr::su::SceneComputeReason;
+using xr::su::SceneComputeRequest;
+using xr::su::SceneComputeScheduler;
+using xr::su::SceneComputeSchedulerOptions;
+
+namespace {
+    constexpr XrTime FrameDuration = 16'666'667; // 60 Hz
+    constexpr XrTime Second = 1'000'000'000;
+
+    struct PoseSample {
+        XrTime Time;
+        XrPosef Pose;
+    };
+
+    // Builds a head pose trace at 60 Hz, like one recorded from a device, out of segments of standing, walking and turning.
+    class PoseTrace {
+    public:
+        PoseTrace& Stand(float seconds) {
+            return Move(seconds, m_pose.position, m_yaw);
+        }
+
+        PoseTrace& Walk(float seconds, const XrVector3f& to) {
+            return Move(seconds, to, m_yaw);
+        }
+
+        PoseTrace& Turn(float seconds, float toYaw) {
+            return Move(seconds, m_pose.position, toYaw);
+        }
+
+        const std::vector<PoseSample>& Samples() const {
+            return m_samples;
+        }
+
+    private:
+        PoseTrace& Move(float seconds, const XrVector3f& to, float toYaw) {
+            const XrVector3f from = m_pose.position;
+            const float fromYaw = m_yaw;
+            const size_t frameCount = static_cast<size_t>(seconds * Second / FrameDuration);
+            for (size_t frame = 1; frame <= frameCount; frame++) {
+                const float t = static_cast<float>(frame) / frameCount;
+                m_pose.position = {from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t, from.z + (to.z - from.z) * t};
+                m_yaw = fromYaw + (toYaw - fromYaw) * t;
+                m_pose.orientation = xr::math::Quaternion::RotationAxisAngle({0, 1, 0}, m_yaw);
+                m_time += FrameDuration;
+                m_samples.push_back({m_time, m_pose});
+            }
+            return *this;
+        }
+
+        XrPosef m_pose{xr::math::Pose::Identity()};
+        float m_yaw{0};
+        XrTime m_time{0};
+        std::vector<PoseSample> m_samples;
+    };
+
+    struct StartedCompute {
+        XrTime Time;
+        SceneComputeRequest Request;
+    };
+
+    // Plays a trace to the scheduler, with a fake runtime that finishes every compute after the given duration.
+    class FakeRuntime {
+    public:
+        FakeRuntime(SceneComputeScheduler& scheduler, float computeSeconds, bool succeeds = true)
+            : Succeeds(succeeds)
+            , m_scheduler(scheduler)
+            , m_computeDuration(static_cast<XrTime>(computeSeconds * Second)) {
+        }
+
+        // Whether the computes that complete from now on succeed.
+        bool Succeeds;
+        // Called with the time of each frame, e.g. to request a region at some point of the trace.
+        std::function<void(XrTime)> OnFrame;
+
+        std::vector<StartedCompute> Play(const PoseTrace& trace) {
+            std::vector<StartedCompute> started;
+            for (const PoseSample& sample : trace.Samples()) {
+                if (OnFrame) {
+                    OnFrame(sample.Time);
+                }
+                if (m_completionTime && sample.Time >= *m_completionTime) {
+                    m_scheduler.OnComputeCompleted(sample.Time, Succeeds);
+                    m_completionTime.reset();
+                }
+                if (const auto request = m_scheduler.Update(sample.Time, sample.Pose)) {
+                    EXPECT_FALSE(m_completionTime.has_value()) << "A compute started while another one was running";
+                    started.push_back({sample.Time, *request});
+                    m_completionTime = sample.Time + m_computeDuration;
+                }
+            }
+            return started;
+        }
+
+    private:
+        SceneComputeScheduler& m_scheduler;
+        const XrTime m_computeDuration;
+        std::optional<XrTime> m_completionTime;
+    };
+
+    float Seconds(XrTime time) {
+        return static_cast<float>(time) / Second;
+    }
+} // namespace
+
+TEST(SceneComputeScheduler, StandingStillComputesWhenTheSceneIsStale) {
+    SceneComputeScheduler scheduler;
+    FakeRuntime runtime(scheduler, 0.5f);
+    const std::vector<StartedCompute> started = runtime.Play(PoseTrace().Stand(70));
+
+    ASSERT_EQ(started.size(), 3u);
+    EXPECT_EQ(started[0].Request.Reasons, SceneComputeReason::Initial);
+    EXPECT_EQ(started[0].Time, FrameDuration);
+    for (size_t i = 1; i < started.size(); i++) {
+        EXPECT_EQ(started[i].Request.Reasons, SceneComputeReason::Stale);
+        EXPECT_NEAR(Seconds(started[i].Time - started[i - 1].Time), 30, 0.02f);
+    }
+}
+
+TEST(SceneComputeScheduler, WalkingComputesAboutEveryMeter) {
+    SceneComputeScheduler scheduler;
+    FakeRuntime runtime(scheduler, 0.2f);
+    const std::vector<StartedCompute> started = runtime.Play(PoseTrace().Stand(1).Walk(5, {0, 0, -5}).Stand(5));
+
+    // Each compute starts about a meter further along, where the head was more than a meter away from the previous start.
+    ASSERT_EQ(started.size(), 5u);
+    for (size_t i = 1; i < started.size(); i++) {
+        EXPECT_TRUE(HasReason(started[i].Request.Reasons, SceneComputeReason::Translation));
+        const float distance = started[i - 1].Request.Center.z - started[i].Request.Center.z;
+        EXPECT_GT(distance, 1.0f);
+        EXPECT_LT(distance, 1.1f);
+        // Computes started while walking faster than FastMotionSpeed are coarse.
+        EXPECT_EQ(started[i].Request.LevelOfDetail, XR_MESH_COMPUTE_LOD_COARSE_MSFT);
+    }
+}
+
+// A scene whose bounds are not centered on the head, here the bounds of a requested region that enclose the head bounds, only
+// triggers Translation once the head moved from where it was when the compute started.
+TEST(SceneComputeScheduler, TranslationIsMeasuredFromTheHead) {
+    SceneComputeScheduler scheduler;
+    scheduler.RequestRegion({0, 0, -1.5f}, 7.0f);
+    FakeRuntime runtime(scheduler, 0.5f);
+
+    const std::vector<StartedCompute> standing = runtime.Play(PoseTrace().Stand(10));
+    ASSERT_EQ(standing.size(), 1u);
+    EXPECT_EQ(standing[0].Request.Reasons, SceneComputeReason::Initial | SceneComputeReason::Requested);
+    EXPECT_EQ(standing[0].Request.Center.z, -1.5f);
+    EXPECT_EQ(standing[0].Request.Radius, 7.0f);
+
+    const std::vector<StartedCompute> walking = runtime.Play(PoseTrace().Walk(2, {0.8f, 0, 0}).Stand(2).Walk(1, {1.2f, 0, 0}).Stand(2));
+    ASSERT_EQ(walking.size(), 1u);
+    EXPECT_EQ(walking[0].Request.Reasons, SceneComputeReason::Translation);
+    EXPECT_GT(walking[0].Request.Center.x, 1.0f);
+}
+
+// A region far from the head is computed on its own. The next compute restores the view, but not for Translation, because the
+// head did not move.
+TEST(SceneComputeScheduler, RequestedRegionIsComputedOnItsOwn) {
+    SceneComputeScheduler scheduler;
+    FakeRuntime runtime(scheduler, 0.2f);
+    runtime.OnFrame = [&](XrTime time) {
+        if (time == 5 * 60 * FrameDuration) {
+            scheduler.RequestRegion({0, 0, -10}, 2.0f);
+        }
+    };
+
+    const std::vector<StartedCompute> started = runtime.Play(PoseTrace().Stand(10));
+    ASSERT_EQ(started.size(), 3u);
+    EXPECT_EQ(started[1].Request.Reasons, SceneComputeReason::Requested);
+    EXPECT_EQ(started[1].Request.Center.z, -10.0f);
+    EXPECT_EQ(started[2].Request.Reasons, SceneComputeReason::Coverage);
+    EXPECT_EQ(started[2].Request.Center.z, 0.0f);
+}
+
+TEST(SceneComputeScheduler, FailingComputesBackOff) {
+    SceneComputeScheduler scheduler;
+    FakeRuntime runtime(scheduler, 0.1f, false);
+    const std::vector<StartedCompute> started = runtime.Play(PoseTrace().Stand(100));
+
+    // Without a scene the head always has a reason to compute, but retries wait 1, 2, 4, 8, 16 and then 30 seconds.
+    const std::vector<float> expectedIntervals{1, 2, 4, 8, 16, 30, 30};
+    ASSERT_EQ(started.size(), expectedIntervals.size() + 1);
+    EXPECT_EQ(started[0].Request.Reasons, SceneComputeReason::Initial);
+    for (size_t i = 1; i < started.size(); i++) {
+        EXPECT_EQ(started[i].Request.Reasons, SceneComputeReason::Initial | SceneComputeReason::Retry);
+        EXPECT_NEAR(Seconds(started[i].Time - started[i - 1].Time), expectedIntervals[i - 1], 0.02f);
+    }
+}
+
+TEST(SceneComputeScheduler, SuccessEndsTheBackOff) {
+    SceneComputeScheduler scheduler;
+    FakeRuntime runtime(scheduler, 0.1f, false);
+    runtime.OnFrame = [&](XrTime time) { runtime.Succeeds = time > 10 * Second; };
+    const std::vector<StartedCompute> started = runtime.Play(PoseTrace().Stand(16).Walk(0.1f, {0, 0, -1.5f}).Stand(2));
+
+    // The computes at 0, 1, 3 and 7 seconds fail, the one at 15 seconds succeeds. The walk then starts a compute after the
+    // minimum interval, instead of the 16 seconds of the back-off.
+    ASSERT_EQ(started.size(), 6u);
+    EXPECT_NEAR(Seconds(started[4].Time), 15, 0.02f);
+    EXPECT_EQ(started[5].Request.Reasons, SceneComputeReason::Translation);
+    EXPECT_LT(Seconds(started[5].Time - started[4].Time), 1.2f);
+}
+
+TEST(SceneComputeScheduler, SlowComputesStayWithinTheDutyCycle) {
+    SceneComputeScheduler scheduler;
+    FakeRuntime runtime(scheduler, 2.0f);
+    const std::vector<StartedCompute> started = runtime.Play(PoseTrace().Walk(40, {0, 0, -40}));
+
+    // A 2 second compute may take a quarter of the time, so computes start 8 seconds apart while the head keeps moving.
+    ASSERT_EQ(started.size(), 5u);
+    for (size_t i = 1; i < started.size(); i++) {
+        EXPECT_NEAR(Seconds(started[i].Time - started[i - 1].Time), 8, 0.02f);
+        // The bounds shrink with the compute duration, to bring it back to the target duration of a second.
+        EXPECT_LT(started[i].Request.Radius, started[0].Request.Radius);
+        EXPECT_GE(started[i].Request.Radius, SceneComputeSchedulerOptions().MinRadius);
+    }
+}
+
+TEST(SceneComputeScheduler, TurningAwayFromTheSceneEdge) {
+    SceneComputeSchedulerOptions options;
+    options.MaxRadius = 2.5f;
+    SceneComputeScheduler scheduler(options);
+    FakeRuntime runtime(scheduler, 0.2f);
+    // Walk to near the edge of the scene without passing the translation threshold, then turn towards the edge.
+    const PoseTrace trace = PoseTrace().Stand(1).Walk(1, {0.9f, 0, 0}).Stand(1).Turn(1, -DirectX::XM_PIDIV2).Stand(1);
+    const std::vector<StartedCompute> started = runtime.Play(trace);
+
+    ASSERT_EQ(started.size(), 2u);
+    EXPECT_TRUE(HasReason(started[1].Request.Reasons, SceneComputeReason::Rotation));
+    EXPECT_FALSE(HasReason(started[1].Request.Reasons, SceneComputeReason::Translation));
+}
@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include <XrSceneLib/pch.h>
+#include <vector>
+#include <gtest/gtest.h>
+#include <XrUtility/XrSceneFragmentStore.hpp>
+
+using xr::su::SceneFragment;
+using xr::su::SceneFragmentStore;
+
+namespace {
+    SceneFragment::Id FragmentId(uint8_t index) {
+        XrUuidMSFT uuid{};
+        uuid.bytes[0] = index;
+        return SceneFragment::Id{uuid};
+    }
+
+    // The data of a fragment stands in for what the runtime serializes, it differs for every id and update time.
+    std::vector<uint8_t> FragmentData(const SceneFragment::Id& id, XrTime updateTime, size_t size = 16) {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++) {
+            data[i] = static_cast<uint8_t>(static_cast<XrUuidMSFT>(id).bytes[0] * 31 + updateTime * 7 + i);
+        }
+        return data;
+    }
+
+    // A fake scene that serves the fragment data and counts the reads.
+    struct FakeScene {
+        std::vector<SceneFragment> Fragments;
+        size_t FragmentSize{16};
+        size_t Reads{0};
+
+        SceneFragmentStore::ReadFragmentData Reader() {
+            return [this](const SceneFragment::Id& id) {
+                Reads++;
+                for (const SceneFragment& fragment : Fragments) {
+                    if (fragment.id == id) {
+                        return FragmentData(id, fragment.updateTime, FragmentSize);
+                    }
+                }
+                ADD_FAILURE() << "Read of a fragment that is not in the scene";
+                return std::vector<uint8_t>();
+            };
+        }
+    };
+
+    // The data the store passes to xrDeserializeSceneMSFT.
+    std::vector<std::vector<uint8_t>> DeserializeData(const SceneFragmentStore& store) {
+        std::vector<std::vector<uint8_t>> result;
+        for (const XrDeserializeSceneFragmentMSFT& fragment : store.GetDeserializeFragments()) {
+            result.emplace_back(fragment.buffer, fragment.buffer + fragment.bufferSize);
+        }
+        return result;
+    }
+
+    std::vector<std::vector<uint8_t>> ExpectedData(const std::vector<SceneFragment>& fragments, size_t size = 16) {
+        std::vector<std::vector<uint8_t>> result;
+        for (const SceneFragment& fragment : fragments) {
+            result.push_back(FragmentData(fragment.id, fragment.updateTime, size));
+        }
+        return result;
+    }
+
+    SceneFragmentStore FromLog(const std::vector<uint8_t>& log) {
+        return SceneFragmentStore::FromLog(log.data(), log.size());
+    }
+} // namespace
+
+TEST(SceneFragmentStore, UpdateReadsOnlyChangedFragments) {
+    FakeScene scene{{{FragmentId(1), 10}, {FragmentId(2), 10}, {FragmentId(3), 10}}};
+    SceneFragmentStore store;
+    EXPECT_EQ(store.Update(scene.Fragments, scene.Reader()), 3u);
+    EXPECT_EQ(scene.Reads, 3u);
+
+    EXPECT_EQ(store.Update(scene.Fragments, scene.Reader()), 0u);
+    EXPECT_EQ(scene.Reads, 3u);
+
+    scene.Fragments[1].updateTime = 20;
+    scene.Fragments.push_back({FragmentId(4), 20});
+    EXPECT_EQ(store.GetChangedFragments(scene.Fragments).size(), 2u);
+    EXPECT_EQ(store.Update(scene.Fragments, scene.Reader()), 2u);
+    EXPECT_EQ(scene.Reads, 5u);
+    EXPECT_EQ(DeserializeData(store), ExpectedData(scene.Fragments));
+}
+
+TEST(SceneFragmentStore, LogRestoresTheLastScene) {
+    FakeScene scene{{{FragmentId(1), 10}, {FragmentId(2), 10}}};
+    SceneFragmentStore store;
+    store.Update(scene.Fragments, scene.Reader());
+    // A new store has no log yet, the first save writes a whole one.
+    ASSERT_TRUE(store.NeedsCompaction());
+    std::vector<uint8_t> log = store.Compact();
+    EXPECT_TRUE(store.TakePendingLog().empty());
+
+    // Replace a fragment, add one and remove one. The changes are appended to the log.
+    scene.Fragments = {{FragmentId(3), 20}, {FragmentId(1), 20}};
+    store.Update(scene.Fragments, scene.Reader());
+    EXPECT_FALSE(store.NeedsCompaction());
+    const std::vector<uint8_t> appended = store.TakePendingLog();
+    ASSERT_FALSE(appended.empty());
+    log.insert(log.end(), appended.begin(), appended.end());
+
+    const SceneFragmentStore restored = FromLog(log);
+    EXPECT_EQ(restored.size(), 2u);
+    EXPECT_EQ(DeserializeData(restored), ExpectedData(scene.Fragments));
+    EXPECT_FALSE(restored.NeedsCompaction());
+    EXPECT_TRUE(restored.GetChangedFragments(scene.Fragments).empty());
+}
+
+TEST(SceneFragmentStore, CompactionDropsReplacedFragments) {
+    // Fragments large enough for the log to pass the minimum size of compaction.
+    FakeScene scene{{{FragmentId(1), 1}, {FragmentId(2), 1}}, 256 * 1024};
+    SceneFragmentStore store;
+    store.Update(scene.Fragments, scene.Reader());
+    std::vector<uint8_t> log = store.Compact();
+    const size_t compactSize = log.size();
+
+    XrTime updateTime = 1;
+    while (!store.NeedsCompaction()) {
+        ASSERT_LT(updateTime, 10);
+        scene.Fragments[0].updateTime = ++updateTime;
+        store.Update(scene.Fragments, scene.Reader());
+        const std::vector<uint8_t> appended = store.TakePendingLog();
+        log.insert(log.end(), appended.begin(), appended.end());
+    }
+    EXPECT_GT(log.size(), compactSize * 2);
+
+    // The log holding every replaced fragment restores the same scene as the compacted log.
+    const std::vector<uint8_t> compacted = store.Compact();
+    EXPECT_EQ(compacted.size(), compactSize);
+    EXPECT_FALSE(store.NeedsCompaction());
+    EXPECT_EQ(DeserializeData(FromLog(log)), ExpectedData(scene.Fragments, scene.FragmentSize));
+    EXPECT_EQ(DeserializeData(FromLog(compacted)), ExpectedData(scene.Fragments, scene.FragmentSize));
+}
+
+// A log cut short, e.g. because the application exited while appending, restores the scene of the last complete update.
+TEST(SceneFragmentStore, TruncatedLogKeepsTheCompleteRecords) {
+    FakeScene scene{{{FragmentId(1), 10}, {FragmentId(2), 10}}};
+    const std::vector<SceneFragment> firstFragments = scene.Fragments;
+    SceneFragmentStore store;
+    store.Update(scene.Fragments, scene.Reader());
+    std::vector<uint8_t> log = store.Compact();
+    const size_t firstSize = log.size();
+
+    scene.Fragments = {{FragmentId(2), 10}, {FragmentId(3), 20}};
+    store.Update(scene.Fragments, scene.Reader());
+    const std::vector<uint8_t> appended = store.TakePendingLog();
+    log.insert(log.end(), appended.begin(), appended.end());
+
+    for (size_t size = 0; size < log.size(); size++) {
+        const SceneFragmentStore truncated = SceneFragmentStore::FromLog(log.data(), size);
+        if (size < firstSize) {
+            EXPECT_TRUE(truncated.empty()) << "size " << size;
+        } else {
+            EXPECT_EQ(DeserializeData(truncated), ExpectedData(firstFragments)) << "size " << size;
+        }
+    }
+
+    // A log that ends within a record is rewritten, and the compacted log is complete again.
+    SceneFragmentStore truncated = SceneFragmentStore::FromLog(log.data(), log.size() - 1);
+    EXPECT_TRUE(truncated.NeedsCompaction());
+    const SceneFragmentStore rewritten = FromLog(truncated.Compact());
+    EXPECT_FALSE(rewritten.NeedsCompaction());
+    EXPECT_EQ(DeserializeData(rewritten), ExpectedData(firstFragments));
+}
+
+TEST(SceneFragmentStore, UnknownLogIsIgnored) {
+    FakeScene scene{{{FragmentId(1), 10}}};
+    SceneFragmentStore store;
+    store.Update(scene.Fragments, scene.Reader());
+    std::vector<uint8_t> log = store.Compact();
+
+    // A log of another version of the format.
+    log[4]++;
+    const SceneFragmentStore other = FromLog(log);
+    EXPECT_TRUE(other.empty());
+    EXPECT_TRUE(other.NeedsCompaction());
+
+    // A record of an unknown type ends the log.
+    log[4]--;
+    log.push_back(0xFF);
+    const SceneFragmentStore extended = FromLog(log);
+    EXPECT_EQ(DeserializeData(extended), ExpectedData(scene.Fragments));
+    EXPECT_TRUE(extended.NeedsCompaction());
+}